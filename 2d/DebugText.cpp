@@ -1,28 +1,49 @@
-﻿#include "DebugText.h"
+﻿#include "ConstantBufferAllocator.h"
+#include "D3D12RenderContext.h"
+#include "DebugText.h"
+#include "DirectXCommon.h"
+#include "SpriteBatch.h"
 #include "TextureManager.h"
+#include "WinApp.h"
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <d3dcompiler.h>
+#include <d3dx12.h>
+
+#pragma comment(lib, "d3dcompiler.lib")
+
+using namespace DirectX;
+using namespace Microsoft::WRL;
 
 DebugText::DebugText() {}
 
-DebugText::~DebugText() {
-	for (int i = 0; i < _countof(spriteDatas_); i++) {
-		delete spriteDatas_[i];
-	}
-}
+DebugText::~DebugText() {}
 
 DebugText* DebugText::GetInstance() {
 	static DebugText instance;
 	return &instance;
 }
 
-void DebugText::Initialize() {
+void DebugText::Initialize(const std::wstring& directoryPath) {
 
 	// デバッグテキスト用テクスチャ読み込み
 	textureHandle_ = TextureManager::Load("debugfont.png");
-	// 全てのスプライトデータについて
-	for (int i = 0; i < _countof(spriteDatas_); i++) {
-		// スプライトを生成する
-		spriteDatas_[i] = Sprite::Create(textureHandle_, {0, 0});
-	}
+	D3D12_RESOURCE_DESC resDesc = TextureManager::GetInstance()->GetResoureDesc(textureHandle_);
+	textureWidth_ = (float)resDesc.Width;
+	textureHeight_ = (float)resDesc.Height;
+
+	// 文字描画用のパイプライン生成
+	InitializeGraphicsPipeline(directoryPath);
+
+	// 射影行列計算
+	XMStoreFloat4x4(
+	  &matProjection_, XMMatrixOrthographicOffCenterLH(
+	                     0.0f, (float)WinApp::kWindowWidth, (float)WinApp::kWindowHeight, 0.0f,
+	                     0.0f, 1.0f));
+
+	// 最大文字数分の配列を確保しておく
+	glyphs_.reserve(kMaxCharCount);
 }
 
 // 1文字列追加
@@ -30,14 +51,22 @@ void DebugText::Print(const std::string& text, float x, float y, float scale) {
 	SetPos(x, y);
 	SetScale(scale);
 
-	NPrint((int)text.size(), text.c_str());
+	NPrint((int)text.size(), text.c_str(), color_);
+}
+
+void DebugText::Print(
+  const std::string& text, float x, float y, float scale, const XMFLOAT4& color) {
+	SetPos(x, y);
+	SetScale(scale);
+
+	NPrint((int)text.size(), text.c_str(), SpriteBatch::PackColor(color));
 }
 
 void DebugText::Printf(const char* fmt, ...) {
 	va_list args;
 	va_start(args, fmt);
 	int w = vsnprintf(buffer, kBufferSize - 1, fmt, args);
-	NPrint(w, buffer);
+	NPrint(w, buffer, color_);
 	va_end(args);
 }
 
@@ -49,30 +78,206 @@ void DebugText::ConsolePrintf(const char* fmt, ...) {
 	OutputDebugStringA(buffer);
 }
 
+void DebugText::SetColor(const XMFLOAT4& color) { color_ = SpriteBatch::PackColor(color); }
+
 // まとめて描画
 void DebugText::DrawAll(ID3D12GraphicsCommandList* cmdList) {
-	// 全ての文字のスプライトについて
-	for (int i = 0; i < spriteIndex_; i++) {
-		// スプライト描画
-		spriteDatas_[i]->Draw();
+	// DirectXCommonのコマンドリストに積む
+	D3D12RenderContext* renderContext = DirectXCommon::GetInstance()->GetRenderContext();
+	assert(renderContext->GetCommandList() == cmdList);
+	DrawAll(renderContext);
+}
+
+void DebugText::DrawAll(RenderContext* renderContext) {
+	if (glyphs_.empty()) {
+		return;
+	}
+
+	// 全ての文字のインスタンスデータを1回で転送
+	void* instanceMap = nullptr;
+	D3D12_VERTEX_BUFFER_VIEW vbView{};
+	vbView.SizeInBytes = static_cast<UINT>(sizeof(Glyph) * glyphs_.size());
+	vbView.StrideInBytes = sizeof(Glyph);
+	vbView.BufferLocation =
+	  ConstantBufferAllocator::GetInstance()->Allocate(vbView.SizeInBytes, &instanceMap);
+	memcpy(instanceMap, glyphs_.data(), vbView.SizeInBytes);
+
+	// パイプラインステートとルートシグネチャの設定
+	renderContext->SetPipelineState(pipelineState_.Get());
+	renderContext->SetGraphicsRootSignature(rootSignature_.Get());
+	// プリミティブ形状を設定（矩形の4頂点は頂点シェーダで作る）
+	renderContext->SetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP);
+	renderContext->SetVertexBuffers(0, 1, &vbView);
+	// 射影行列とフォントのテクスチャ
+	renderContext->SetGraphicsRootConstantBufferView(
+	  0, ConstantBufferAllocator::GetInstance()->Upload(matProjection_));
+	TextureManager::GetInstance()->SetGraphicsRootDescriptorTable(renderContext, 1, textureHandle_);
+
+	// 全ての文字を1回で描画
+	renderContext->DrawInstanced(4, static_cast<UINT>(glyphs_.size()), 0, 0);
+
+	glyphs_.clear();
+}
+
+void DebugText::InitializeGraphicsPipeline(const std::wstring& directoryPath) {
+	ID3D12Device* device = DirectXCommon::GetInstance()->GetDevice();
+	// nullptrチェック
+	assert(device);
+
+	HRESULT result = S_FALSE;
+	ComPtr<ID3DBlob> vsBlob;    // 頂点シェーダオブジェクト
+	ComPtr<ID3DBlob> psBlob;    // ピクセルシェーダオブジェクト
+	ComPtr<ID3DBlob> errorBlob; // エラーオブジェクト
+
+	// シェーダの読み込みとコンパイル
+	const struct {
+		std::wstring file;
+		const char* target;
+		ComPtr<ID3DBlob>* blob;
+	} shaders[] = {
+	  {directoryPath + L"/shaders/DebugTextVS.hlsl", "vs_5_0", &vsBlob},
+	  {directoryPath + L"/shaders/DebugTextPS.hlsl", "ps_5_0", &psBlob},
+	};
+	for (const auto& shader : shaders) {
+		result = D3DCompileFromFile(
+		  shader.file.c_str(), // シェーダファイル名
+		  nullptr,
+		  D3D_COMPILE_STANDARD_FILE_INCLUDE, // インクルード可能にする
+		  "main", shader.target, // エントリーポイント名、シェーダーモデル指定
+		  D3DCOMPILE_DEBUG | D3DCOMPILE_SKIP_OPTIMIZATION, // デバッグ用設定
+		  0, shader.blob->ReleaseAndGetAddressOf(), &errorBlob);
+		if (FAILED(result)) {
+			// errorBlobからエラー内容をstring型にコピー
+			std::string errstr;
+			errstr.resize(errorBlob->GetBufferSize());
+
+			std::copy_n(
+			  (char*)errorBlob->GetBufferPointer(), errorBlob->GetBufferSize(), errstr.begin());
+			errstr += "\n";
+			// エラー内容を出力ウィンドウに表示
+			OutputDebugStringA(errstr.c_str());
+			exit(1);
+		}
 	}
 
-	spriteIndex_ = 0;
+	// 頂点レイアウト（全て1文字ごとのインスタンスデータ）
+	D3D12_INPUT_ELEMENT_DESC inputLayout[] = {
+	  {// 左上座標(1行で書いたほうが見やすい)
+	   "POSITION", 0, DXGI_FORMAT_R32G32_FLOAT, 0, D3D12_APPEND_ALIGNED_ELEMENT,
+	   D3D12_INPUT_CLASSIFICATION_PER_INSTANCE_DATA, 1},
+	  {// 表示サイズ(1行で書いたほうが見やすい)
+	   "SIZE",     0, DXGI_FORMAT_R32G32_FLOAT, 0, D3D12_APPEND_ALIGNED_ELEMENT,
+	   D3D12_INPUT_CLASSIFICATION_PER_INSTANCE_DATA, 1},
+	  {// uv矩形(1行で書いたほうが見やすい)
+	   "TEXCOORD", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, 0, D3D12_APPEND_ALIGNED_ELEMENT,
+	   D3D12_INPUT_CLASSIFICATION_PER_INSTANCE_DATA, 1},
+	  {// 色(1行で書いたほうが見やすい)
+	   "COLOR",    0, DXGI_FORMAT_R8G8B8A8_UNORM, 0, D3D12_APPEND_ALIGNED_ELEMENT,
+	   D3D12_INPUT_CLASSIFICATION_PER_INSTANCE_DATA, 1},
+	};
+
+	// グラフィックスパイプラインの流れを設定
+	D3D12_GRAPHICS_PIPELINE_STATE_DESC gpipeline{};
+	gpipeline.VS = CD3DX12_SHADER_BYTECODE(vsBlob.Get());
+	gpipeline.PS = CD3DX12_SHADER_BYTECODE(psBlob.Get());
+
+	// サンプルマスク
+	gpipeline.SampleMask = D3D12_DEFAULT_SAMPLE_MASK; // 標準設定
+	// ラスタライザステート
+	gpipeline.RasterizerState = CD3DX12_RASTERIZER_DESC(D3D12_DEFAULT);
+	gpipeline.RasterizerState.CullMode = D3D12_CULL_MODE_NONE;
+	// デプスステンシルステート
+	gpipeline.DepthStencilState = CD3DX12_DEPTH_STENCIL_DESC(D3D12_DEFAULT);
+	gpipeline.DepthStencilState.DepthFunc = D3D12_COMPARISON_FUNC_ALWAYS; // 常に上書きルール
+
+	// レンダーターゲットのブレンド設定（通常αブレンド）
+	D3D12_RENDER_TARGET_BLEND_DESC& blenddesc = gpipeline.BlendState.RenderTarget[0];
+	blenddesc.RenderTargetWriteMask = D3D12_COLOR_WRITE_ENABLE_ALL; // RBGA全てのチャンネルを描画
+	blenddesc.BlendEnable = true;
+	blenddesc.BlendOp = D3D12_BLEND_OP_ADD;
+	blenddesc.SrcBlend = D3D12_BLEND_SRC_ALPHA;
+	blenddesc.DestBlend = D3D12_BLEND_INV_SRC_ALPHA;
+	blenddesc.BlendOpAlpha = D3D12_BLEND_OP_ADD;
+	blenddesc.SrcBlendAlpha = D3D12_BLEND_ONE;
+	blenddesc.DestBlendAlpha = D3D12_BLEND_ZERO;
+
+	// 深度バッファのフォーマット
+	gpipeline.DSVFormat = DXGI_FORMAT_D32_FLOAT;
+
+	// 頂点レイアウトの設定
+	gpipeline.InputLayout.pInputElementDescs = inputLayout;
+	gpipeline.InputLayout.NumElements = _countof(inputLayout);
+
+	// 図形の形状設定（三角形）
+	gpipeline.PrimitiveTopologyType = D3D12_PRIMITIVE_TOPOLOGY_TYPE_TRIANGLE;
+
+	gpipeline.NumRenderTargets = 1;                            // 描画対象は1つ
+	gpipeline.RTVFormats[0] = DXGI_FORMAT_R8G8B8A8_UNORM_SRGB; // 0～255指定のRGBA
+	gpipeline.SampleDesc.Count = 1; // 1ピクセルにつき1回サンプリング
+
+	// デスクリプタレンジ
+	CD3DX12_DESCRIPTOR_RANGE descRangeSRV;
+	descRangeSRV.Init(D3D12_DESCRIPTOR_RANGE_TYPE_SRV, 1, 0); // t0 レジスタ
+
+	// ルートパラメータ
+	CD3DX12_ROOT_PARAMETER rootparams[2] = {};
+	rootparams[0].InitAsConstantBufferView(0, 0, D3D12_SHADER_VISIBILITY_ALL);
+	rootparams[1].InitAsDescriptorTable(1, &descRangeSRV, D3D12_SHADER_VISIBILITY_ALL);
+
+	// スタティックサンプラー
+	CD3DX12_STATIC_SAMPLER_DESC samplerDesc =
+	  CD3DX12_STATIC_SAMPLER_DESC(0, D3D12_FILTER_MIN_MAG_MIP_LINEAR); // s0 レジスタ
+	samplerDesc.AddressU = D3D12_TEXTURE_ADDRESS_MODE_CLAMP;
+	samplerDesc.AddressV = D3D12_TEXTURE_ADDRESS_MODE_CLAMP;
+	samplerDesc.AddressW = D3D12_TEXTURE_ADDRESS_MODE_CLAMP;
+
+	// ルートシグネチャの設定
+	CD3DX12_VERSIONED_ROOT_SIGNATURE_DESC rootSignatureDesc;
+	rootSignatureDesc.Init_1_0(
+	  _countof(rootparams), rootparams, 1, &samplerDesc,
+	  D3D12_ROOT_SIGNATURE_FLAG_ALLOW_INPUT_ASSEMBLER_INPUT_LAYOUT);
+
+	ComPtr<ID3DBlob> rootSigBlob;
+	// バージョン自動判定のシリアライズ
+	result = D3DX12SerializeVersionedRootSignature(
+	  &rootSignatureDesc, D3D_ROOT_SIGNATURE_VERSION_1_0, &rootSigBlob, &errorBlob);
+	assert(SUCCEEDED(result));
+	// ルートシグネチャの生成
+	result = device->CreateRootSignature(
+	  0, rootSigBlob->GetBufferPointer(), rootSigBlob->GetBufferSize(),
+	  IID_PPV_ARGS(&rootSignature_));
+	assert(SUCCEEDED(result));
+
+	gpipeline.pRootSignature = rootSignature_.Get();
+
+	// グラフィックスパイプラインの生成
+	result = device->CreateGraphicsPipelineState(&gpipeline, IID_PPV_ARGS(&pipelineState_));
+	assert(SUCCEEDED(result));
 }
 
-void DebugText::NPrint(int len, const char* text) {
+void DebugText::NPrint(int len, const char* text, uint32_t color) {
+	// 書き込み位置（改行で行頭に戻る）
+	float x = posX_;
+	float y = posY_;
 	// 全ての文字について
 	for (int i = 0; i < len; i++) {
 		// 最大文字数超過
-		if (spriteIndex_ >= kMaxCharCount) {
+		if (glyphs_.size() >= size_t(kMaxCharCount)) {
 			break;
 		}
 
 		// 1文字取り出す(※ASCIIコードでしか成り立たない)
 		const unsigned char& character = text[i];
 
+		// 改行
+		if (character == '\n') {
+			x = posX_;
+			y += kFontHeight * scale_;
+			continue;
+		}
+
 		int fontIndex = character - 32;
-		if (character >= 0x7f) {
+		if (character < 32 || character >= 0x7f) {
 			fontIndex = 0;
 		}
 
@@ -80,15 +285,17 @@ void DebugText::NPrint(int len, const char* text) {
 		int fontIndexX = fontIndex % kFontLineCount;
 
 		// 座標計算
-		spriteDatas_[spriteIndex_]->SetPosition(
-		  {this->posX_ + kFontWidth * this->scale_ * i, this->posY_});
-		spriteDatas_[spriteIndex_]->SetTextureRect(
-		  {(float)fontIndexX * kFontWidth, (float)fontIndexY * kFontHeight},
-		  {(float)kFontWidth, (float)kFontHeight});
-		spriteDatas_[spriteIndex_]->SetSize(
-		  {kFontWidth * this->scale_, kFontHeight * this->scale_});
+		Glyph glyph;
+		glyph.position = {x, y};
+		glyph.size = {kFontWidth * scale_, kFontHeight * scale_};
+		float left = fontIndexX * kFontWidth / textureWidth_;
+		float top = fontIndexY * kFontHeight / textureHeight_;
+		glyph.uvRect = {
+		  left, top, left + kFontWidth / textureWidth_, top + kFontHeight / textureHeight_};
+		glyph.color = color;
+		glyphs_.push_back(glyph);
 
 		// 文字を１つ進める
-		spriteIndex_++;
+		x += kFontWidth * scale_;
 	}
-}
\ No newline at end of file
+}
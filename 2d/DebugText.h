@@ -1,20 +1,36 @@
 ﻿#pragma once
 
-#include "Sprite.h"
+#include "RenderContext.h"
+#include <DirectXMath.h>
 #include <Windows.h>
+#include <cstdint>
+#include <d3d12.h>
 #include <string>
+#include <vector>
+#include <wrl.h>
 
 /// <summary>
 /// デバッグ用文字表示
+/// 文字ごとのインスタンスデータを1つの配列に書き込み、1フレームに1回転送してインスタンシングで描く
 /// </summary>
 class DebugText {
   public:
 	// デバッグテキスト用のテクスチャ番号を指定
-	static const int kMaxCharCount = 256; // 最大文字数
-	static const int kFontWidth = 9;      // フォント画像内1文字分の横幅
-	static const int kFontHeight = 18;    // フォント画像内1文字分の縦幅
-	static const int kFontLineCount = 14; // フォント画像内1行分の文字数
-	static const int kBufferSize = 256;   // 書式付き文字列展開用バッファサイズ
+	static const int kMaxCharCount = 16384; // 最大文字数
+	static const int kFontWidth = 9;        // フォント画像内1文字分の横幅
+	static const int kFontHeight = 18;      // フォント画像内1文字分の縦幅
+	static const int kFontLineCount = 14;   // フォント画像内1行分の文字数
+	static const int kBufferSize = 256;     // 書式付き文字列展開用バッファサイズ
+
+	/// <summary>
+	/// 1文字分のインスタンスデータ
+	/// </summary>
+	struct Glyph {
+		DirectX::XMFLOAT2 position; // 左上のスクリーン座標
+		DirectX::XMFLOAT2 size;     // 表示サイズ
+		DirectX::XMFLOAT4 uvRect;   // テクスチャ座標（左上uv、右下uv）
+		uint32_t color;             // 色（RGBA8）
+	};
 
 	/// <summary>
 	/// シングルトンインスタンスの取得
@@ -25,10 +41,11 @@ class DebugText {
 	/// <summary>
 	/// 初期化
 	/// </summary>
-	void Initialize();
+	/// <param name="directoryPath">シェーダのあるディレクトリ</param>
+	void Initialize(const std::wstring& directoryPath = L"Resources/");
 
 	/// <summary>
-	/// 文字列追加
+	/// 文字列追加（改行文字で次の行に進む）
 	/// </summary>
 	/// <param name="text">文字列</param>
 	/// <param name="x">表示座標X</param>
@@ -36,6 +53,17 @@ class DebugText {
 	/// <param name="scale">倍率</param>
 	void Print(const std::string& text, float x, float y, float scale = 1.0f);
 
+	/// <summary>
+	/// 色付き文字列追加（色はこの文字列だけに使う）
+	/// </summary>
+	/// <param name="text">文字列</param>
+	/// <param name="x">表示座標X</param>
+	/// <param name="y">表示座標Y</param>
+	/// <param name="scale">倍率</param>
+	/// <param name="color">色(RGBA)</param>
+	void Print(
+	  const std::string& text, float x, float y, float scale, const DirectX::XMFLOAT4& color);
+
 	/// <summary>
 	/// 書式付き文字列追加
 	/// </summary>
@@ -49,11 +77,18 @@ class DebugText {
 	void ConsolePrintf(const char* fmt, ...);
 
 	/// <summary>
-	/// 描画フラッシュ
+	/// 描画フラッシュ（全ての文字を1回のインスタンシング描画で描く）
+	/// パイプラインを文字描画用に切り替えるので、スプライト描画の最後に呼ぶ
 	/// </summary>
 	/// <param name="cmdList">描画コマンドリスト</param>
 	void DrawAll(ID3D12GraphicsCommandList* cmdList);
 
+	/// <summary>
+	/// 描画フラッシュ（全ての文字を1回のインスタンシング描画で描く）
+	/// </summary>
+	/// <param name="renderContext">描画コマンドの発行先</param>
+	void DrawAll(RenderContext* renderContext);
+
 	/// <summary>
 	/// 描画座標の指定
 	/// </summary>
@@ -70,17 +105,37 @@ class DebugText {
 	/// <param name="scale">倍率</param>
 	void SetScale(float scale) { scale_ = scale; }
 
+	/// <summary>
+	/// 描画色の指定
+	/// </summary>
+	/// <param name="color">色(RGBA)</param>
+	void SetColor(const DirectX::XMFLOAT4& color);
+
+	/// <summary>
+	/// 積まれている文字数の取得
+	/// </summary>
+	size_t GetGlyphCount() const { return glyphs_.size(); }
+
   private:
 	// テクスチャハンドル
 	uint32_t textureHandle_ = 0;
-	// スプライトデータの配列
-	Sprite* spriteDatas_[kMaxCharCount] = {};
-	// スプライトデータ配列の添え字番号
-	int spriteIndex_ = 0;
+	// フォント画像のサイズ
+	float textureWidth_ = 1.0f;
+	float textureHeight_ = 1.0f;
+	// ルートシグネチャ
+	Microsoft::WRL::ComPtr<ID3D12RootSignature> rootSignature_;
+	// パイプラインステートオブジェクト
+	Microsoft::WRL::ComPtr<ID3D12PipelineState> pipelineState_;
+	// 射影行列
+	DirectX::XMFLOAT4X4 matProjection_;
+	// 文字のインスタンスデータの配列
+	std::vector<Glyph> glyphs_;
 
 	float posX_ = 0.0f;
 	float posY_ = 0.0f;
 	float scale_ = 1.0f;
+	// 描画色（RGBA8）
+	uint32_t color_ = 0xffffffff;
 	// 書式付き文字列展開用バッファ
 	char buffer[kBufferSize];
 
@@ -88,5 +143,6 @@ class DebugText {
 	~DebugText();
 	DebugText(const DebugText&) = delete;
 	DebugText& operator=(const DebugText&) = delete;
-	void NPrint(int len, const char* text);
+	void InitializeGraphicsPipeline(const std::wstring& directoryPath);
+	void NPrint(int len, const char* text, uint32_t color);
 };
@@ -0,0 +1,133 @@
+﻿#include "RectPacker.h"
+#include <algorithm>
+#include <cassert>
+
+namespace {
+
+// aがbに含まれるか
+bool IsContained(const RectPacker::Rect& a, const RectPacker::Rect& b) {
+	return a.x >= b.x && a.y >= b.y && a.x + a.width <= b.x + b.width &&
+	       a.y + a.height <= b.y + b.height;
+}
+
+} // namespace
+
+void RectPacker::Initialize(uint32_t width, uint32_t height) {
+	width_ = width;
+	height_ = height;
+	usedArea_ = 0;
+
+	freeRects_.clear();
+	Rect all;
+	all.width = width;
+	all.height = height;
+	freeRects_.push_back(all);
+}
+
+bool RectPacker::Insert(uint32_t width, uint32_t height, Rect& result) {
+	assert(width > 0 && height > 0);
+
+	// 短い辺の余りが最も小さい空き領域を探す（同じなら長い辺の余りで比べる）
+	uint32_t bestShortSide = UINT32_MAX;
+	uint32_t bestLongSide = UINT32_MAX;
+	bool found = false;
+	for (const Rect& freeRect : freeRects_) {
+		if (freeRect.width < width || freeRect.height < height) {
+			continue;
+		}
+		uint32_t leftoverX = freeRect.width - width;
+		uint32_t leftoverY = freeRect.height - height;
+		uint32_t shortSide = (std::min)(leftoverX, leftoverY);
+		uint32_t longSide = (std::max)(leftoverX, leftoverY);
+		if (shortSide < bestShortSide || (shortSide == bestShortSide && longSide < bestLongSide)) {
+			bestShortSide = shortSide;
+			bestLongSide = longSide;
+			result.x = freeRect.x;
+			result.y = freeRect.y;
+			found = true;
+		}
+	}
+	if (!found) {
+		return false;
+	}
+	result.width = width;
+	result.height = height;
+
+	SplitFreeRects(result);
+	PruneFreeRects();
+
+	usedArea_ += uint64_t(width) * height;
+	return true;
+}
+
+float RectPacker::GetOccupancy() const {
+	uint64_t area = uint64_t(width_) * height_;
+	if (area == 0) {
+		return 0.0f;
+	}
+	return float(double(usedArea_) / double(area));
+}
+
+void RectPacker::SplitFreeRects(const Rect& used) {
+	newFreeRects_.clear();
+
+	for (size_t i = 0; i < freeRects_.size();) {
+		const Rect freeRect = freeRects_[i];
+		// 重ならなければそのまま
+		if (used.x >= freeRect.x + freeRect.width || used.x + used.width <= freeRect.x ||
+		    used.y >= freeRect.y + freeRect.height || used.y + used.height <= freeRect.y) {
+			i++;
+			continue;
+		}
+
+		// 重なった部分を除いた上下左右の残りを新しい空き領域にする
+		if (used.x > freeRect.x) {
+			Rect rect = freeRect;
+			rect.width = used.x - freeRect.x;
+			newFreeRects_.push_back(rect);
+		}
+		if (used.x + used.width < freeRect.x + freeRect.width) {
+			Rect rect = freeRect;
+			rect.x = used.x + used.width;
+			rect.width = freeRect.x + freeRect.width - rect.x;
+			newFreeRects_.push_back(rect);
+		}
+		if (used.y > freeRect.y) {
+			Rect rect = freeRect;
+			rect.height = used.y - freeRect.y;
+			newFreeRects_.push_back(rect);
+		}
+		if (used.y + used.height < freeRect.y + freeRect.height) {
+			Rect rect = freeRect;
+			rect.y = used.y + used.height;
+			rect.height = freeRect.y + freeRect.height - rect.y;
+			newFreeRects_.push_back(rect);
+		}
+
+		// 元の空き領域は末尾と入れ替えて取り除く
+		freeRects_[i] = freeRects_.back();
+		freeRects_.pop_back();
+	}
+
+	freeRects_.insert(freeRects_.end(), newFreeRects_.begin(), newFreeRects_.end());
+}
+
+void RectPacker::PruneFreeRects() {
+	for (size_t i = 0; i < freeRects_.size(); i++) {
+		for (size_t j = i + 1; j < freeRects_.size();) {
+			if (IsContained(freeRects_[j], freeRects_[i])) {
+				// jがiに含まれるならjを取り除く
+				freeRects_.erase(freeRects_.begin() + j);
+			} else if (IsContained(freeRects_[i], freeRects_[j])) {
+				// iがjに含まれるならiを取り除いてやり直す
+				freeRects_.erase(freeRects_.begin() + i);
+				j = i + 1;
+				if (i >= freeRects_.size()) {
+					break;
+				}
+			} else {
+				j++;
+			}
+		}
+	}
+}
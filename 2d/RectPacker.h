@@ -0,0 +1,73 @@
+﻿#pragma once
+
+#include <cstdint>
+#include <vector>
+
+/// <summary>
+/// 矩形詰め込み（MaxRects法）
+/// 空き領域を重なりを許す矩形の集合で持ち、短い辺の余りが最も小さい位置に置く
+/// GPUに依存せず、幅と高さだけで処理する
+/// </summary>
+class RectPacker {
+  public: // サブクラス
+	/// <summary>
+	/// 矩形
+	/// </summary>
+	struct Rect {
+		uint32_t x = 0;
+		uint32_t y = 0;
+		uint32_t width = 0;
+		uint32_t height = 0;
+	};
+
+  public: // メンバ関数
+	/// <summary>
+	/// 初期化（全体を空き領域にする）
+	/// </summary>
+	/// <param name="width">領域の幅</param>
+	/// <param name="height">領域の高さ</param>
+	void Initialize(uint32_t width, uint32_t height);
+
+	/// <summary>
+	/// 矩形を置く
+	/// </summary>
+	/// <param name="width">幅</param>
+	/// <param name="height">高さ</param>
+	/// <param name="result">置いた位置</param>
+	/// <returns>置ける場所が無ければfalse</returns>
+	bool Insert(uint32_t width, uint32_t height, Rect& result);
+
+	/// <summary>
+	/// 使用率の取得
+	/// </summary>
+	/// <returns>置いた矩形の面積 / 領域の面積</returns>
+	float GetOccupancy() const;
+
+	/// <summary>
+	/// 領域の幅の取得
+	/// </summary>
+	uint32_t GetWidth() const { return width_; }
+
+	/// <summary>
+	/// 領域の高さの取得
+	/// </summary>
+	uint32_t GetHeight() const { return height_; }
+
+  private: // メンバ関数
+	// 置いた矩形と重なる空き領域を分割する
+	void SplitFreeRects(const Rect& used);
+
+	// 他の空き領域に含まれる空き領域を取り除く
+	void PruneFreeRects();
+
+  private: // メンバ変数
+	// 領域の幅と高さ
+	uint32_t width_ = 0;
+	uint32_t height_ = 0;
+	// 置いた矩形の面積の合計
+	uint64_t usedArea_ = 0;
+	// 空き領域
+	std::vector<Rect> freeRects_;
+	// 分割で増えた空き領域（作業用）
+	std::vector<Rect> newFreeRects_;
+};
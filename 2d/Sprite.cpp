@@ -1,4 +1,7 @@
-﻿#include "Sprite.h"
+﻿#include "D3D12RenderContext.h"
+#include "DirectXCommon.h"
+#include "Sprite.h"
+#include "TextureAtlas.h"
 #include "TextureManager.h"
 #include <cassert>
 #include <d3dcompiler.h>
@@ -14,11 +17,12 @@ using namespace Microsoft::WRL;
 /// </summary>
 ID3D12Device* Sprite::sDevice_ = nullptr;
 UINT Sprite::sDescriptorHandleIncrementSize_;
-ID3D12GraphicsCommandList* Sprite::sCommandList_ = nullptr;
+RenderContext* Sprite::sRenderContext_ = nullptr;
 ComPtr<ID3D12RootSignature> Sprite::sRootSignature_;
 std::array<ComPtr<ID3D12PipelineState>, size_t(Sprite::BlendMode::kCountOfBlendMode)>
   Sprite::sPipelineStates_;
 XMMATRIX Sprite::sMatProjection_;
+Sprite::Stats Sprite::sStats_;
 
 void Sprite::StaticInitialize(
   ID3D12Device* device, int window_width, int window_height, const std::wstring& directoryPath) {
@@ -221,26 +225,33 @@ void Sprite::StaticInitialize(
 }
 
 void Sprite::PreDraw(ID3D12GraphicsCommandList* commandList, BlendMode blendMode) {
+	// DirectXCommonのコマンドリストに積む
+	D3D12RenderContext* renderContext = DirectXCommon::GetInstance()->GetRenderContext();
+	assert(renderContext->GetCommandList() == commandList);
+	PreDraw(renderContext, blendMode);
+}
+
+void Sprite::PreDraw(RenderContext* renderContext, BlendMode blendMode) {
 	// PreDrawとPostDrawがペアで呼ばれていなければエラー
-	assert(Sprite::sCommandList_ == nullptr);
+	assert(Sprite::sRenderContext_ == nullptr);
 
 	// ブレンドモード設定が間違ってる
 	assert(0 <= size_t(blendMode) && size_t(blendMode) < size_t(BlendMode::kCountOfBlendMode));
 
-	// コマンドリストをセット
-	sCommandList_ = commandList;
+	// 描画コマンドの発行先をセット
+	sRenderContext_ = renderContext;
 
 	// パイプラインステートの設定
-	sCommandList_->SetPipelineState(sPipelineStates_[size_t(blendMode)].Get());
+	sRenderContext_->SetPipelineState(sPipelineStates_[size_t(blendMode)].Get());
 	// ルートシグネチャの設定
-	sCommandList_->SetGraphicsRootSignature(sRootSignature_.Get());
+	sRenderContext_->SetGraphicsRootSignature(sRootSignature_.Get());
 	// プリミティブ形状を設定
-	sCommandList_->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP);
+	sRenderContext_->SetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP);
 }
 
 void Sprite::PostDraw() {
-	// コマンドリストを解除
-	Sprite::sCommandList_ = nullptr;
+	// 描画コマンドの発行先を解除
+	Sprite::sRenderContext_ = nullptr;
 }
 
 Sprite* Sprite::Create(
@@ -274,6 +285,37 @@ Sprite* Sprite::Create(
 	return sprite;
 }
 
+Sprite* Sprite::Create(
+  const std::string& name, XMFLOAT2 position, XMFLOAT4 color, XMFLOAT2 anchorpoint, bool isFlipX,
+  bool isFlipY) {
+	// アトラスに無ければ単体のテクスチャを使う
+	const TextureAtlas::Region* region = TextureAtlas::GetInstance()->Find(name);
+	if (region == nullptr) {
+		uint32_t textureHandle = TextureManager::Load(name);
+		Sprite* sprite = Create(textureHandle, position, color, anchorpoint, isFlipX, isFlipY);
+		// 読み込んだ参照はスプライトが持ち、破棄する時に解放する
+		sprite->ownedTextureHandle_ = textureHandle;
+		return sprite;
+	}
+
+	// スプライトのサイズをアトラス内の画像のサイズに設定
+	Sprite* sprite = new Sprite(
+	  region->textureHandle, position, region->texSize, color, anchorpoint, isFlipX, isFlipY);
+	if (sprite == nullptr) {
+		return nullptr;
+	}
+	sprite->texBase_ = region->texBase;
+
+	// 初期化
+	if (!sprite->Initialize()) {
+		delete sprite;
+		assert(0);
+		return nullptr;
+	}
+
+	return sprite;
+}
+
 Sprite::Sprite() {}
 
 Sprite::Sprite(
@@ -290,139 +332,123 @@ Sprite::Sprite(
 	texSize_ = size;
 }
 
+Sprite::~Sprite() {
+	if (ownedTextureHandle_ != UINT32_MAX) {
+		TextureManager::Release(ownedTextureHandle_);
+	}
+}
+
 bool Sprite::Initialize() {
 	// nullptrチェック
 	assert(sDevice_);
 
-	HRESULT result = S_FALSE;
-
-	resourceDesc_ = TextureManager::GetInstance()->GetResoureDesc(textureHandle_);
-
-	{
-		// ヒーププロパティ
-		CD3DX12_HEAP_PROPERTIES heapProps = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD);
-		// リソース設定
-		CD3DX12_RESOURCE_DESC resourceDesc =
-		  CD3DX12_RESOURCE_DESC::Buffer(sizeof(VertexPosUv) * kVertNum);
-
-		// 頂点バッファ生成
-		result = sDevice_->CreateCommittedResource(
-		  &heapProps, D3D12_HEAP_FLAG_NONE, &resourceDesc, D3D12_RESOURCE_STATE_GENERIC_READ,
-		  nullptr, IID_PPV_ARGS(&vertBuff_));
-		assert(SUCCEEDED(result));
-
-		// 頂点バッファマッピング
-		result = vertBuff_->Map(0, nullptr, (void**)&vertMap_);
-		assert(SUCCEEDED(result));
-	}
+	// 頂点データとワールド行列は最初の描画で作る
+	SetDirty(kDirtyVertices | kDirtyResourceDesc | kDirtyWorld);
 
-	// 頂点バッファへのデータ転送
-	TransferVertices();
-
-	// 頂点バッファビューの作成
-	vbView_.BufferLocation = vertBuff_->GetGPUVirtualAddress();
+	// 頂点バッファビューの作成（アドレスは描画時に決まる）
 	vbView_.SizeInBytes = sizeof(VertexPosUv) * 4;
 	vbView_.StrideInBytes = sizeof(VertexPosUv);
 
-	{
-		// ヒーププロパティ
-		CD3DX12_HEAP_PROPERTIES heapProps = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD);
-		// リソース設定
-		CD3DX12_RESOURCE_DESC resourceDesc =
-		  CD3DX12_RESOURCE_DESC::Buffer((sizeof(ConstBufferData) + 0xff) & ~0xff);
-
-		// 定数バッファの生成
-		result = sDevice_->CreateCommittedResource(
-		  &heapProps, D3D12_HEAP_FLAG_NONE, &resourceDesc, D3D12_RESOURCE_STATE_GENERIC_READ,
-		  nullptr, IID_PPV_ARGS(&constBuff_));
-		assert(SUCCEEDED(result));
-	}
-
-	// 定数バッファマッピング
-	result = constBuff_->Map(0, nullptr, (void**)&constMap_);
-	assert(SUCCEEDED(result));
-
 	return true;
 }
 
 void Sprite::SetTextureHandle(uint32_t textureHandle) {
 	textureHandle_ = textureHandle;
-	resourceDesc_ = TextureManager::GetInstance()->GetResoureDesc(textureHandle_);
+
+	// テクスチャのサイズが変わるとuv座標も変わる
+	SetDirty(kDirtyVertices | kDirtyResourceDesc);
 }
 
 void Sprite::SetRotation(float rotation) {
 	rotation_ = rotation;
 
-	// 頂点バッファへのデータ転送
-	TransferVertices();
+	// 頂点データは変わらないので、ワールド行列だけ作り直す
+	SetDirty(kDirtyWorld);
 }
 
 void Sprite::SetPosition(const DirectX::XMFLOAT2& position) {
 	position_ = position;
 
-	// 頂点バッファへのデータ転送
-	TransferVertices();
+	// 頂点データは変わらないので、ワールド行列だけ作り直す
+	SetDirty(kDirtyWorld);
 }
 
 void Sprite::SetSize(const DirectX::XMFLOAT2& size) {
 	size_ = size;
 
-	// 頂点バッファへのデータ転送
-	TransferVertices();
+	// 頂点データは描画時に作り直す
+	SetDirty(kDirtyVertices);
 }
 
 void Sprite::SetAnchorPoint(const DirectX::XMFLOAT2& anchorpoint) {
 	anchorPoint_ = anchorpoint;
 
-	// 頂点バッファへのデータ転送
-	TransferVertices();
+	// 頂点データは描画時に作り直す
+	SetDirty(kDirtyVertices);
 }
 
 void Sprite::SetIsFlipX(bool isFlipX) {
 	isFlipX_ = isFlipX;
 
-	// 頂点バッファへのデータ転送
-	TransferVertices();
+	// 頂点データは描画時に作り直す
+	SetDirty(kDirtyVertices);
 }
 
 void Sprite::SetIsFlipY(bool isFlipY) {
 	isFlipY_ = isFlipY;
 
-	// 頂点バッファへのデータ転送
-	TransferVertices();
+	// 頂点データは描画時に作り直す
+	SetDirty(kDirtyVertices);
 }
 
 void Sprite::SetTextureRect(const DirectX::XMFLOAT2& texBase, const DirectX::XMFLOAT2& texSize) {
 	texBase_ = texBase;
 	texSize_ = texSize;
 
-	// 頂点バッファへのデータ転送
-	TransferVertices();
+	// 頂点データは描画時に作り直す
+	SetDirty(kDirtyVertices);
 }
 
 void Sprite::Draw() {
-	// ワールド行列の更新
-	matWorld_ = XMMatrixIdentity();
-	matWorld_ *= XMMatrixRotationZ(rotation_);
-	matWorld_ *= XMMatrixTranslation(position_.x, position_.y, 0.0f);
+	// 設定が変わっていれば頂点データとワールド行列を作り直す
+	UpdateVertices();
+	UpdateMatrix();
 
-	// 定数バッファにデータ転送
-	constMap_->color = color_;
-	constMap_->mat = matWorld_ * sMatProjection_; // 行列の合成
+	// 定数バッファにデータ転送（描画ごとに確保するので、同じスプライトを複数回描画できる）
+	ConstBufferData constData;
+	constData.color = color_;
+	constData.mat = matWorld_ * sMatProjection_; // 行列の合成
 
 	// 頂点バッファの設定
-	sCommandList_->IASetVertexBuffers(0, 1, &vbView_);
+	vbView_.BufferLocation = ConstantBufferAllocator::GetInstance()->Upload(vertices_, vertCache_);
+	sRenderContext_->SetVertexBuffers(0, 1, &vbView_);
 
 	// 定数バッファビューをセット
-	sCommandList_->SetGraphicsRootConstantBufferView(0, constBuff_->GetGPUVirtualAddress());
+	sRenderContext_->SetGraphicsRootConstantBufferView(
+	  0, ConstantBufferAllocator::GetInstance()->Upload(constData));
 	// シェーダリソースビューをセット
-	TextureManager::GetInstance()->SetGraphicsRootDescriptorTable(sCommandList_, 1, textureHandle_);
+	TextureManager::GetInstance()->SetGraphicsRootDescriptorTable(sRenderContext_, 1, textureHandle_);
 	// 描画コマンド
-	sCommandList_->DrawInstanced(4, 1, 0, 0);
+	sRenderContext_->DrawInstanced(4, 1, 0, 0);
 }
 
-void Sprite::TransferVertices() {
-	HRESULT result = S_FALSE;
+void Sprite::SetDirty(uint32_t flags) {
+	// 以前は設定のたびに頂点データを作り直していた
+	sStats_.vertexRequestCount++;
+	dirtyFlags_ |= flags;
+}
+
+void Sprite::UpdateVertices() const {
+	if (!(dirtyFlags_ & kDirtyVertices)) {
+		return;
+	}
+	sStats_.vertexRebuildCount++;
+
+	// テクスチャ情報取得
+	if (dirtyFlags_ & kDirtyResourceDesc) {
+		resourceDesc_ = TextureManager::GetInstance()->GetResoureDesc(textureHandle_);
+	}
+	dirtyFlags_ &= ~(kDirtyVertices | kDirtyResourceDesc);
 
 	// 左下、左上、右下、右上
 	enum { LB, LT, RB, RT };
@@ -442,14 +468,14 @@ void Sprite::TransferVertices() {
 	}
 
 	// 頂点データ
-	VertexPosUv vertices[kVertNum];
+	VertexPosUv* vertices = vertices_;
 
 	vertices[LB].pos = {left, bottom, 0.0f};  // 左下
 	vertices[LT].pos = {left, top, 0.0f};     // 左上
 	vertices[RB].pos = {right, bottom, 0.0f}; // 右下
 	vertices[RT].pos = {right, top, 0.0f};    // 右上
 
-	// テクスチャ情報取得
+	// uv座標
 	{
 		float tex_left = texBase_.x / resourceDesc_.Width;
 		float tex_right = (texBase_.x + texSize_.x) / resourceDesc_.Width;
@@ -462,6 +488,21 @@ void Sprite::TransferVertices() {
 		vertices[RT].uv = {tex_right, tex_top};    // 右上
 	}
 
-	// 頂点バッファへのデータ転送
-	memcpy(vertMap_, vertices, sizeof(vertices));
+	// 頂点バッファは次の描画で転送し直す（GPUが前のフレームで読んでいる領域には書かない）
+	vertCache_.Invalidate();
+}
+
+void Sprite::UpdateMatrix() {
+	// 以前は描画のたびに作り直していた
+	sStats_.worldRequestCount++;
+	if (!(dirtyFlags_ & kDirtyWorld)) {
+		return;
+	}
+	sStats_.worldRebuildCount++;
+	dirtyFlags_ &= ~kDirtyWorld;
+
+	// ワールド行列の更新
+	matWorld_ = XMMatrixIdentity();
+	matWorld_ *= XMMatrixRotationZ(rotation_);
+	matWorld_ *= XMMatrixTranslation(position_.x, position_.y, 0.0f);
 }
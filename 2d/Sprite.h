@@ -1,5 +1,7 @@
 ﻿#pragma once
 
+#include "ConstantBufferAllocator.h"
+#include "RenderContext.h"
 #include <DirectXMath.h>
 #include <Windows.h>
 #include <d3d12.h>
@@ -10,6 +12,9 @@
 /// スプライト
 /// </summary>
 class Sprite {
+	// 一括描画は頂点データを直接読む
+	friend class SpriteBatch;
+
   public:
 	enum class BlendMode {
 		kNone,     //!< ブレンドなし
@@ -39,6 +44,28 @@ class Sprite {
 		DirectX::XMMATRIX mat;   // ３Ｄ変換行列
 	};
 
+	/// <summary>
+	/// 頂点データとワールド行列の作り直しの統計
+	/// </summary>
+	struct Stats {
+		// 設定の回数（以前は設定のたびに頂点データを作り直していた）
+		uint32_t vertexRequestCount = 0;
+		// 頂点データを実際に作り直した回数
+		uint32_t vertexRebuildCount = 0;
+		// 描画の回数（以前は描画のたびにワールド行列を作り直していた）
+		uint32_t worldRequestCount = 0;
+		// ワールド行列を実際に作り直した回数
+		uint32_t worldRebuildCount = 0;
+
+		/// <summary>
+		/// 省いた作り直しの回数を取得
+		/// </summary>
+		uint32_t GetSkippedCount() const {
+			return (vertexRequestCount - vertexRebuildCount) +
+			       (worldRequestCount - worldRebuildCount);
+		}
+	};
+
   public: // 静的メンバ関数
 	/// <summary>
 	/// 静的初期化
@@ -57,6 +84,12 @@ class Sprite {
 	static void
 	  PreDraw(ID3D12GraphicsCommandList* cmdList, BlendMode blendMode = BlendMode::kNormal);
 
+	/// <summary>
+	/// 描画前処理
+	/// </summary>
+	/// <param name="renderContext">描画コマンドの発行先</param>
+	static void PreDraw(RenderContext* renderContext, BlendMode blendMode = BlendMode::kNormal);
+
 	/// <summary>
 	/// 描画後処理
 	/// </summary>
@@ -76,15 +109,46 @@ class Sprite {
 	  uint32_t textureHandle, DirectX::XMFLOAT2 position, DirectX::XMFLOAT4 color = {1, 1, 1, 1},
 	  DirectX::XMFLOAT2 anchorpoint = {0.0f, 0.0f}, bool isFlipX = false, bool isFlipY = false);
 
-  private: // 静的メンバ変数
+	/// <summary>
+	/// 画像の名前からスプライト生成
+	/// テクスチャアトラスにあればそのページと範囲を使い、無ければ画像を単体で読み込む
+	/// </summary>
+	/// <param name="name">画像のファイル名</param>
+	/// <param name="position">座標</param>
+	/// <param name="color">色</param>
+	/// <param name="anchorpoint">アンカーポイント</param>
+	/// <param name="isFlipX">左右反転</param>
+	/// <param name="isFlipY">上下反転</param>
+	/// <returns>生成されたスプライト</returns>
+	static Sprite* Create(
+	  const std::string& name, DirectX::XMFLOAT2 position, DirectX::XMFLOAT4 color = {1, 1, 1, 1},
+	  DirectX::XMFLOAT2 anchorpoint = {0.0f, 0.0f}, bool isFlipX = false, bool isFlipY = false);
+
+	/// <summary>
+	/// 作り直しの統計を取得
+	/// </summary>
+	static const Stats& GetStats() { return sStats_; }
+
+	/// <summary>
+	/// 作り直しの統計をリセット
+	/// </summary>
+	static void ResetStats() { sStats_ = Stats(); }
+
+  private: // 定数
 	// 頂点数
 	static const int kVertNum = 4;
+	// 作り直しが必要なもの
+	static const uint32_t kDirtyVertices = 1 << 0;     // 頂点データ
+	static const uint32_t kDirtyResourceDesc = 1 << 1; // テクスチャのリソース設定
+	static const uint32_t kDirtyWorld = 1 << 2;        // ワールド行列
+
+  private: // 静的メンバ変数
 	// デバイス
 	static ID3D12Device* sDevice_;
 	// デスクリプタサイズ
 	static UINT sDescriptorHandleIncrementSize_;
-	// コマンドリスト
-	static ID3D12GraphicsCommandList* sCommandList_;
+	// 描画コマンドの発行先
+	static RenderContext* sRenderContext_;
 	// ルートシグネチャ
 	static Microsoft::WRL::ComPtr<ID3D12RootSignature> sRootSignature_;
 	// パイプラインステートオブジェクト
@@ -93,6 +157,8 @@ class Sprite {
 	  sPipelineStates_;
 	// 射影行列
 	static DirectX::XMMATRIX sMatProjection_;
+	// 作り直しの統計
+	static Stats sStats_;
 
   public: // メンバ関数
 	/// <summary>
@@ -106,6 +172,11 @@ class Sprite {
 	  uint32_t textureHandle, DirectX::XMFLOAT2 position, DirectX::XMFLOAT2 size,
 	  DirectX::XMFLOAT4 color, DirectX::XMFLOAT2 anchorpoint, bool isFlipX, bool isFlipY);
 
+	/// <summary>
+	/// デストラクタ（名前から読み込んだテクスチャの参照を解放する）
+	/// </summary>
+	~Sprite();
+
 	/// <summary>
 	/// 初期化
 	/// </summary>
@@ -189,18 +260,18 @@ class Sprite {
 	void Draw();
 
   private: // メンバ変数
-	// 頂点バッファ
-	Microsoft::WRL::ComPtr<ID3D12Resource> vertBuff_;
-	// 定数バッファ
-	Microsoft::WRL::ComPtr<ID3D12Resource> constBuff_;
-	// 頂点バッファマップ
-	VertexPosUv* vertMap_ = nullptr;
-	// 定数バッファマップ
-	ConstBufferData* constMap_ = nullptr;
+	// 頂点データ（設定が変わったら描画時に作り直し、フレームごとの確保から転送する）
+	mutable VertexPosUv vertices_[kVertNum] = {};
+	// 頂点データの転送先
+	mutable ConstantBufferAllocator::FrameCache vertCache_;
+	// 作り直しが必要なもののフラグ
+	mutable uint32_t dirtyFlags_ = kDirtyVertices | kDirtyResourceDesc | kDirtyWorld;
 	// 頂点バッファビュー
 	D3D12_VERTEX_BUFFER_VIEW vbView_{};
 	// テクスチャ番号
 	UINT textureHandle_ = 0;
+	// 名前から読み込んで参照を持っているテクスチャ（無ければUINT32_MAX）
+	uint32_t ownedTextureHandle_ = UINT32_MAX;
 	// Z軸回りの回転角
 	float rotation_ = 0.0f;
 	// 座標
@@ -222,11 +293,22 @@ class Sprite {
 	// テクスチャ幅、高さ
 	DirectX::XMFLOAT2 texSize_ = {100.0f, 100.0f};
 	// リソース設定
-	D3D12_RESOURCE_DESC resourceDesc_;
+	mutable D3D12_RESOURCE_DESC resourceDesc_{};
 
   private: // メンバ関数
 	/// <summary>
-	/// 頂点データ転送
+	/// 作り直しが必要な印を付ける
+	/// </summary>
+	/// <param name="flags">作り直しが必要なもの</param>
+	void SetDirty(uint32_t flags);
+
+	/// <summary>
+	/// 設定が変わっていれば頂点データを作り直す
+	/// </summary>
+	void UpdateVertices() const;
+
+	/// <summary>
+	/// 設定が変わっていればワールド行列を作り直す
 	/// </summary>
-	void TransferVertices();
+	void UpdateMatrix();
 };
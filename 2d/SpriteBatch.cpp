@@ -0,0 +1,371 @@
+﻿#include "ConstantBufferAllocator.h"
+#include "SpriteBatch.h"
+#include "TextureManager.h"
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <d3dcompiler.h>
+#include <d3dx12.h>
+
+#pragma comment(lib, "d3dcompiler.lib")
+
+using namespace DirectX;
+using namespace Microsoft::WRL;
+
+/// <summary>
+/// 静的メンバ変数の実体
+/// </summary>
+ComPtr<ID3D12RootSignature> SpriteBatch::sRootSignature_;
+std::array<ComPtr<ID3D12PipelineState>, size_t(Sprite::BlendMode::kCountOfBlendMode)>
+  SpriteBatch::sPipelineStates_;
+ComPtr<ID3D12Resource> SpriteBatch::sIndexBuff_;
+D3D12_INDEX_BUFFER_VIEW SpriteBatch::sIbView_{};
+XMMATRIX SpriteBatch::sMatProjection_;
+
+namespace {
+
+// シェーダの読み込みとコンパイル
+ComPtr<ID3DBlob> CompileShader(const std::wstring& file, const char* target) {
+	ComPtr<ID3DBlob> blob;
+	ComPtr<ID3DBlob> errorBlob;
+	HRESULT result = D3DCompileFromFile(
+	  file.c_str(), // シェーダファイル名
+	  nullptr,
+	  D3D_COMPILE_STANDARD_FILE_INCLUDE, // インクルード可能にする
+	  "main", target, // エントリーポイント名、シェーダーモデル指定
+	  D3DCOMPILE_DEBUG | D3DCOMPILE_SKIP_OPTIMIZATION, // デバッグ用設定
+	  0, &blob, &errorBlob);
+	if (FAILED(result)) {
+		// errorBlobからエラー内容をstring型にコピー
+		std::string errstr;
+		errstr.resize(errorBlob->GetBufferSize());
+
+		std::copy_n(
+		  (char*)errorBlob->GetBufferPointer(), errorBlob->GetBufferSize(), errstr.begin());
+		errstr += "\n";
+		// エラー内容を出力ウィンドウに表示
+		OutputDebugStringA(errstr.c_str());
+		exit(1);
+	}
+	return blob;
+}
+
+// ブレンドモードごとのブレンド設定（Spriteと同じ）
+D3D12_RENDER_TARGET_BLEND_DESC GetBlendDesc(Sprite::BlendMode blendMode) {
+	D3D12_RENDER_TARGET_BLEND_DESC blenddesc{};
+	blenddesc.RenderTargetWriteMask = D3D12_COLOR_WRITE_ENABLE_ALL; // RBGA全てのチャンネルを描画
+	if (blendMode == Sprite::BlendMode::kNone) {
+		blenddesc.BlendEnable = false;
+		return blenddesc;
+	}
+
+	blenddesc.BlendEnable = true;
+	blenddesc.BlendOpAlpha = D3D12_BLEND_OP_ADD;
+	blenddesc.SrcBlendAlpha = D3D12_BLEND_ONE;
+	blenddesc.DestBlendAlpha = D3D12_BLEND_ZERO;
+	switch (blendMode) {
+	case Sprite::BlendMode::kNormal: // 通常αブレンド
+		blenddesc.BlendOp = D3D12_BLEND_OP_ADD;
+		blenddesc.SrcBlend = D3D12_BLEND_SRC_ALPHA;
+		blenddesc.DestBlend = D3D12_BLEND_INV_SRC_ALPHA;
+		break;
+	case Sprite::BlendMode::kAdd: // 加算
+		blenddesc.BlendOp = D3D12_BLEND_OP_ADD;
+		blenddesc.SrcBlend = D3D12_BLEND_SRC_ALPHA;
+		blenddesc.DestBlend = D3D12_BLEND_ONE;
+		break;
+	case Sprite::BlendMode::kSubtract: // 減算
+		blenddesc.BlendOp = D3D12_BLEND_OP_REV_SUBTRACT;
+		blenddesc.SrcBlend = D3D12_BLEND_SRC_ALPHA;
+		blenddesc.DestBlend = D3D12_BLEND_ONE;
+		break;
+	case Sprite::BlendMode::kMultily: // 乗算
+		blenddesc.BlendOp = D3D12_BLEND_OP_ADD;
+		blenddesc.SrcBlend = D3D12_BLEND_ZERO;
+		blenddesc.DestBlend = D3D12_BLEND_SRC_COLOR;
+		break;
+	case Sprite::BlendMode::kScreen: // スクリーン
+		blenddesc.BlendOp = D3D12_BLEND_OP_ADD;
+		blenddesc.SrcBlend = D3D12_BLEND_INV_DEST_COLOR;
+		blenddesc.DestBlend = D3D12_BLEND_ONE;
+		break;
+	default:
+		assert(0);
+		break;
+	}
+	return blenddesc;
+}
+
+} // namespace
+
+void SpriteBatch::StaticInitialize(
+  ID3D12Device* device, int window_width, int window_height, const std::wstring& directoryPath) {
+	// nullptrチェック
+	assert(device);
+
+	HRESULT result = S_FALSE;
+	ComPtr<ID3DBlob> errorBlob; // エラーオブジェクト
+
+	// シェーダの読み込みとコンパイル
+	ComPtr<ID3DBlob> vsBlob = CompileShader(directoryPath + L"/shaders/SpriteBatchVS.hlsl", "vs_5_0");
+	ComPtr<ID3DBlob> psBlob = CompileShader(directoryPath + L"/shaders/SpriteBatchPS.hlsl", "ps_5_0");
+
+	// 頂点レイアウト
+	D3D12_INPUT_ELEMENT_DESC inputLayout[] = {
+	  {// xy座標(1行で書いたほうが見やすい)
+	   "POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, D3D12_APPEND_ALIGNED_ELEMENT,
+	   D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0},
+	  {// uv座標(1行で書いたほうが見やすい)
+	   "TEXCOORD", 0, DXGI_FORMAT_R32G32_FLOAT,    0, D3D12_APPEND_ALIGNED_ELEMENT,
+	   D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0},
+	  {// 色(1行で書いたほうが見やすい)
+	   "COLOR",    0, DXGI_FORMAT_R8G8B8A8_UNORM,  0, D3D12_APPEND_ALIGNED_ELEMENT,
+	   D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0},
+	};
+
+	// グラフィックスパイプラインの流れを設定
+	D3D12_GRAPHICS_PIPELINE_STATE_DESC gpipeline{};
+	gpipeline.VS = CD3DX12_SHADER_BYTECODE(vsBlob.Get());
+	gpipeline.PS = CD3DX12_SHADER_BYTECODE(psBlob.Get());
+
+	// サンプルマスク
+	gpipeline.SampleMask = D3D12_DEFAULT_SAMPLE_MASK; // 標準設定
+	// ラスタライザステート
+	gpipeline.RasterizerState = CD3DX12_RASTERIZER_DESC(D3D12_DEFAULT);
+	gpipeline.RasterizerState.CullMode = D3D12_CULL_MODE_NONE;
+	// デプスステンシルステート
+	gpipeline.DepthStencilState = CD3DX12_DEPTH_STENCIL_DESC(D3D12_DEFAULT);
+	gpipeline.DepthStencilState.DepthFunc = D3D12_COMPARISON_FUNC_ALWAYS; // 常に上書きルール
+
+	// 深度バッファのフォーマット
+	gpipeline.DSVFormat = DXGI_FORMAT_D32_FLOAT;
+
+	// 頂点レイアウトの設定
+	gpipeline.InputLayout.pInputElementDescs = inputLayout;
+	gpipeline.InputLayout.NumElements = _countof(inputLayout);
+
+	// 図形の形状設定（三角形）
+	gpipeline.PrimitiveTopologyType = D3D12_PRIMITIVE_TOPOLOGY_TYPE_TRIANGLE;
+
+	gpipeline.NumRenderTargets = 1;                            // 描画対象は1つ
+	gpipeline.RTVFormats[0] = DXGI_FORMAT_R8G8B8A8_UNORM_SRGB; // 0～255指定のRGBA
+	gpipeline.SampleDesc.Count = 1; // 1ピクセルにつき1回サンプリング
+
+	// デスクリプタレンジ
+	CD3DX12_DESCRIPTOR_RANGE descRangeSRV;
+	descRangeSRV.Init(D3D12_DESCRIPTOR_RANGE_TYPE_SRV, 1, 0); // t0 レジスタ
+
+	// ルートパラメータ
+	CD3DX12_ROOT_PARAMETER rootparams[2] = {};
+	rootparams[0].InitAsConstantBufferView(0, 0, D3D12_SHADER_VISIBILITY_ALL);
+	rootparams[1].InitAsDescriptorTable(1, &descRangeSRV, D3D12_SHADER_VISIBILITY_ALL);
+
+	// スタティックサンプラー
+	CD3DX12_STATIC_SAMPLER_DESC samplerDesc =
+	  CD3DX12_STATIC_SAMPLER_DESC(0, D3D12_FILTER_MIN_MAG_MIP_LINEAR); // s0 レジスタ
+	samplerDesc.AddressU = D3D12_TEXTURE_ADDRESS_MODE_CLAMP;
+	samplerDesc.AddressV = D3D12_TEXTURE_ADDRESS_MODE_CLAMP;
+	samplerDesc.AddressW = D3D12_TEXTURE_ADDRESS_MODE_CLAMP;
+
+	// ルートシグネチャの設定
+	CD3DX12_VERSIONED_ROOT_SIGNATURE_DESC rootSignatureDesc;
+	rootSignatureDesc.Init_1_0(
+	  _countof(rootparams), rootparams, 1, &samplerDesc,
+	  D3D12_ROOT_SIGNATURE_FLAG_ALLOW_INPUT_ASSEMBLER_INPUT_LAYOUT);
+
+	ComPtr<ID3DBlob> rootSigBlob;
+	// バージョン自動判定のシリアライズ
+	result = D3DX12SerializeVersionedRootSignature(
+	  &rootSignatureDesc, D3D_ROOT_SIGNATURE_VERSION_1_0, &rootSigBlob, &errorBlob);
+	assert(SUCCEEDED(result));
+	// ルートシグネチャの生成
+	result = device->CreateRootSignature(
+	  0, rootSigBlob->GetBufferPointer(), rootSigBlob->GetBufferSize(),
+	  IID_PPV_ARGS(&sRootSignature_));
+	assert(SUCCEEDED(result));
+
+	gpipeline.pRootSignature = sRootSignature_.Get();
+
+	// ブレンドモードごとにグラフィックスパイプラインを生成
+	for (size_t i = 0; i < sPipelineStates_.size(); i++) {
+		gpipeline.BlendState.RenderTarget[0] = GetBlendDesc(Sprite::BlendMode(i));
+		result = device->CreateGraphicsPipelineState(&gpipeline, IID_PPV_ARGS(&sPipelineStates_[i]));
+		assert(SUCCEEDED(result));
+	}
+
+	// インデックスバッファ生成（矩形ごとに同じ並びなので最大数分を最初に作る）
+	UINT sizeIB = static_cast<UINT>(sizeof(uint16_t) * 6 * kMaxQuadCount);
+	CD3DX12_HEAP_PROPERTIES heapProps = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD);
+	CD3DX12_RESOURCE_DESC resourceDesc = CD3DX12_RESOURCE_DESC::Buffer(sizeIB);
+	result = device->CreateCommittedResource(
+	  &heapProps, D3D12_HEAP_FLAG_NONE, &resourceDesc, D3D12_RESOURCE_STATE_GENERIC_READ, nullptr,
+	  IID_PPV_ARGS(&sIndexBuff_));
+	assert(SUCCEEDED(result));
+
+	// インデックスバッファへのデータ転送（左下、左上、右下 / 右下、左上、右上）
+	uint16_t* indexMap = nullptr;
+	result = sIndexBuff_->Map(0, nullptr, (void**)&indexMap);
+	assert(SUCCEEDED(result));
+	for (uint32_t i = 0; i < kMaxQuadCount; i++) {
+		uint16_t base = static_cast<uint16_t>(i * 4);
+		indexMap[i * 6 + 0] = base + 0;
+		indexMap[i * 6 + 1] = base + 1;
+		indexMap[i * 6 + 2] = base + 2;
+		indexMap[i * 6 + 3] = base + 2;
+		indexMap[i * 6 + 4] = base + 1;
+		indexMap[i * 6 + 5] = base + 3;
+	}
+	sIndexBuff_->Unmap(0, nullptr);
+
+	// インデックスバッファビューの作成
+	sIbView_.BufferLocation = sIndexBuff_->GetGPUVirtualAddress();
+	sIbView_.Format = DXGI_FORMAT_R16_UINT;
+	sIbView_.SizeInBytes = sizeIB;
+
+	// 射影行列計算
+	sMatProjection_ = XMMatrixOrthographicOffCenterLH(
+	  0.0f, (float)window_width, (float)window_height, 0.0f, 0.0f, 1.0f);
+}
+
+uint32_t SpriteBatch::PackColor(const XMFLOAT4& color) {
+	auto toByte = [](float value) {
+		return static_cast<uint32_t>((std::min)((std::max)(value, 0.0f), 1.0f) * 255.0f + 0.5f);
+	};
+	return toByte(color.x) | (toByte(color.y) << 8) | (toByte(color.z) << 16) |
+	       (toByte(color.w) << 24);
+}
+
+void SpriteBatch::Begin(RenderContext* renderContext, SortMode sortMode) {
+	// BeginとEndがペアで呼ばれていなければエラー
+	assert(renderContext_ == nullptr);
+	assert(renderContext);
+
+	renderContext_ = renderContext;
+	sortMode_ = sortMode;
+	quads_.clear();
+}
+
+void SpriteBatch::Draw(const Sprite& sprite, Sprite::BlendMode blendMode) {
+	// 設定が変わっていれば頂点データを作り直す
+	sprite.UpdateVertices();
+
+	// スプライトの頂点（アンカーポイント基準）を回転、平行移動してスクリーン座標にする
+	float s = sinf(sprite.rotation_);
+	float c = cosf(sprite.rotation_);
+	uint32_t color = PackColor(sprite.color_);
+
+	Vertex vertices[4];
+	for (int i = 0; i < 4; i++) {
+		const Sprite::VertexPosUv& src = sprite.vertices_[i];
+		vertices[i].pos = {
+		  src.pos.x * c - src.pos.y * s + sprite.position_.x,
+		  src.pos.x * s + src.pos.y * c + sprite.position_.y, src.pos.z};
+		vertices[i].uv = src.uv;
+		vertices[i].color = color;
+	}
+
+	DrawQuad(sprite.textureHandle_, vertices, blendMode);
+}
+
+void SpriteBatch::DrawQuad(
+  uint32_t textureHandle, const Vertex (&vertices)[4], Sprite::BlendMode blendMode) {
+	// Beginが呼ばれていなければエラー
+	assert(renderContext_);
+	// ブレンドモード設定が間違ってる
+	assert(size_t(blendMode) < size_t(Sprite::BlendMode::kCountOfBlendMode));
+
+	quads_.emplace_back();
+	Quad& quad = quads_.back();
+	quad.textureHandle = textureHandle;
+	quad.blendMode = blendMode;
+	memcpy(quad.vertices, vertices, sizeof(quad.vertices));
+}
+
+void SpriteBatch::End() {
+	// Beginが呼ばれていなければエラー
+	assert(renderContext_);
+
+	quadCount_ = static_cast<uint32_t>(quads_.size());
+	drawCount_ = 0;
+	if (quads_.empty()) {
+		renderContext_ = nullptr;
+		return;
+	}
+
+	// 並べ替えキーを作る（同じキーの中では積んだ順を保つ）
+	sortKeys_.resize(quads_.size());
+	for (uint32_t i = 0; i < quadCount_; i++) {
+		const Quad& quad = quads_[i];
+		uint64_t state = (uint64_t(quad.blendMode) << 24) | (quad.textureHandle & 0xffffff);
+		sortKeys_[i] = (state << 32) | i;
+	}
+	if (sortMode_ == SortMode::kTexture) {
+		std::sort(sortKeys_.begin(), sortKeys_.end());
+	}
+
+	// ルートシグネチャと共通のインデックスバッファ、射影行列を設定
+	renderContext_->SetGraphicsRootSignature(sRootSignature_.Get());
+	renderContext_->SetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+	renderContext_->SetIndexBuffer(&sIbView_);
+	renderContext_->SetGraphicsRootConstantBufferView(
+	  0, ConstantBufferAllocator::GetInstance()->Upload(sMatProjection_));
+
+	// ブレンドモードとテクスチャが同じ矩形の並びごとに描画
+	// 頂点データはkMaxQuadCount個ずつ転送する（1回の確保が大きくなりすぎないように）
+	size_t currentBlendMode = SIZE_MAX;
+	uint32_t currentTexture = UINT32_MAX;
+	uint32_t chunkBegin = 0;
+	uint32_t chunkEnd = 0;
+	uint32_t runBegin = 0;
+	while (runBegin < quadCount_) {
+		// 転送済みの矩形を描き終えたら、次の矩形をまとめて転送
+		if (runBegin == chunkEnd) {
+			chunkBegin = runBegin;
+			chunkEnd = (std::min)(chunkBegin + kMaxQuadCount, quadCount_);
+			UploadVertices(chunkBegin, chunkEnd);
+		}
+
+		uint64_t state = sortKeys_[runBegin] >> 32;
+		uint32_t runEnd = runBegin + 1;
+		while (runEnd < chunkEnd && (sortKeys_[runEnd] >> 32) == state) {
+			runEnd++;
+		}
+
+		const Quad& quad = quads_[sortKeys_[runBegin] & 0xffffffff];
+		if (size_t(quad.blendMode) != currentBlendMode) {
+			currentBlendMode = size_t(quad.blendMode);
+			renderContext_->SetPipelineState(sPipelineStates_[currentBlendMode].Get());
+		}
+		if (quad.textureHandle != currentTexture) {
+			currentTexture = quad.textureHandle;
+			TextureManager::GetInstance()->SetGraphicsRootDescriptorTable(
+			  renderContext_, 1, currentTexture);
+		}
+
+		// インデックスは矩形ごとに共通なので、頂点の開始位置をずらして描く
+		renderContext_->DrawIndexedInstanced(
+		  (runEnd - runBegin) * 6, 1, 0, (runBegin - chunkBegin) * 4, 0);
+		drawCount_++;
+
+		runBegin = runEnd;
+	}
+
+	renderContext_ = nullptr;
+}
+
+void SpriteBatch::UploadVertices(uint32_t begin, uint32_t end) {
+	// 並べ替えた順に頂点データを転送
+	Vertex* vertexMap = nullptr;
+	D3D12_VERTEX_BUFFER_VIEW vbView{};
+	vbView.SizeInBytes = static_cast<UINT>(sizeof(Vertex) * 4 * (end - begin));
+	vbView.StrideInBytes = sizeof(Vertex);
+	vbView.BufferLocation = ConstantBufferAllocator::GetInstance()->Allocate(
+	  vbView.SizeInBytes, reinterpret_cast<void**>(&vertexMap));
+	for (uint32_t i = begin; i < end; i++) {
+		memcpy(
+		  &vertexMap[(i - begin) * 4], quads_[sortKeys_[i] & 0xffffffff].vertices,
+		  sizeof(Vertex) * 4);
+	}
+
+	renderContext_->SetVertexBuffers(0, 1, &vbView);
+}
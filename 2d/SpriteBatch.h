@@ -0,0 +1,140 @@
+﻿#pragma once
+
+#include "RenderContext.h"
+#include "Sprite.h"
+#include <DirectXMath.h>
+#include <Windows.h>
+#include <array>
+#include <cstdint>
+#include <d3d12.h>
+#include <string>
+#include <vector>
+#include <wrl.h>
+
+/// <summary>
+/// スプライトの一括描画
+/// Begin～Endの間に積んだ矩形の頂点データをkMaxQuadCount個ずつまとめて転送し、
+/// テクスチャとブレンドモードが同じものを1回の描画で描く
+/// </summary>
+class SpriteBatch {
+  public: // 定数
+	// 1回の描画で描ける最大矩形数（16bitインデックスで足りる数）
+	static const uint32_t kMaxQuadCount = 4096;
+
+  public: // 列挙子
+	/// <summary>
+	/// 並べ替えの方法
+	/// </summary>
+	enum class SortMode {
+		kDeferred, // 積んだ順（隣り合う同じテクスチャだけまとめる）
+		kTexture,  // ブレンドモードとテクスチャ順（同じテクスチャは積んだ順）
+	};
+
+  public: // サブクラス
+	/// <summary>
+	/// 頂点データ構造体
+	/// </summary>
+	struct Vertex {
+		DirectX::XMFLOAT3 pos; // xyz座標（スクリーン座標）
+		DirectX::XMFLOAT2 uv;  // uv座標
+		uint32_t color;        // 色 (RGBA 8bitずつ)
+	};
+
+  public: // 静的メンバ関数
+	/// <summary>
+	/// 静的初期化
+	/// </summary>
+	/// <param name="device">デバイス</param>
+	/// <param name="window_width">画面幅</param>
+	/// <param name="window_height">画面高さ</param>
+	static void StaticInitialize(
+	  ID3D12Device* device, int window_width, int window_height,
+	  const std::wstring& directoryPath = L"Resources/");
+
+	/// <summary>
+	/// 色を頂点データの形式に変換
+	/// </summary>
+	/// <param name="color">色</param>
+	/// <returns>RGBA 8bitずつ</returns>
+	static uint32_t PackColor(const DirectX::XMFLOAT4& color);
+
+  public: // メンバ関数
+	/// <summary>
+	/// 積み始め
+	/// </summary>
+	/// <param name="renderContext">描画コマンドの発行先</param>
+	/// <param name="sortMode">並べ替えの方法</param>
+	void Begin(RenderContext* renderContext, SortMode sortMode = SortMode::kTexture);
+
+	/// <summary>
+	/// スプライトを積む
+	/// </summary>
+	/// <param name="sprite">スプライト</param>
+	/// <param name="blendMode">ブレンドモード</param>
+	void Draw(const Sprite& sprite, Sprite::BlendMode blendMode = Sprite::BlendMode::kNormal);
+
+	/// <summary>
+	/// 矩形を積む
+	/// </summary>
+	/// <param name="textureHandle">テクスチャハンドル</param>
+	/// <param name="vertices">左下、左上、右下、右上の頂点</param>
+	/// <param name="blendMode">ブレンドモード</param>
+	void DrawQuad(
+	  uint32_t textureHandle, const Vertex (&vertices)[4],
+	  Sprite::BlendMode blendMode = Sprite::BlendMode::kNormal);
+
+	/// <summary>
+	/// 積んだ矩形をまとめて描画
+	/// </summary>
+	void End();
+
+	/// <summary>
+	/// 直前のEndで描画した矩形数を取得
+	/// </summary>
+	uint32_t GetQuadCount() const { return quadCount_; }
+
+	/// <summary>
+	/// 直前のEndで発行した描画命令数を取得
+	/// </summary>
+	uint32_t GetDrawCount() const { return drawCount_; }
+
+  private: // サブクラス
+	// 積んだ矩形
+	struct Quad {
+		uint32_t textureHandle;
+		Sprite::BlendMode blendMode;
+		Vertex vertices[4];
+	};
+
+  private: // メンバ関数
+	// 並べ替えた矩形のbegin～endの頂点データを転送して頂点バッファに設定
+	void UploadVertices(uint32_t begin, uint32_t end);
+
+  private: // 静的メンバ変数
+	// ルートシグネチャ
+	static Microsoft::WRL::ComPtr<ID3D12RootSignature> sRootSignature_;
+	// パイプラインステートオブジェクト
+	static std::array<
+	  Microsoft::WRL::ComPtr<ID3D12PipelineState>, size_t(Sprite::BlendMode::kCountOfBlendMode)>
+	  sPipelineStates_;
+	// インデックスバッファ（全ての矩形で共通）
+	static Microsoft::WRL::ComPtr<ID3D12Resource> sIndexBuff_;
+	// インデックスバッファビュー
+	static D3D12_INDEX_BUFFER_VIEW sIbView_;
+	// 射影行列
+	static DirectX::XMMATRIX sMatProjection_;
+
+  private: // メンバ変数
+	// 描画コマンドの発行先
+	RenderContext* renderContext_ = nullptr;
+	// 並べ替えの方法
+	SortMode sortMode_ = SortMode::kTexture;
+	// 積んだ矩形
+	std::vector<Quad> quads_;
+	// 並べ替えキー（上位にブレンドモードとテクスチャ、下位に積んだ順）
+	std::vector<uint64_t> sortKeys_;
+	// 直前のEndで描画した矩形数
+	uint32_t quadCount_ = 0;
+	// 直前のEndで発行した描画命令数
+	uint32_t drawCount_ = 0;
+};
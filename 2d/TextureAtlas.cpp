@@ -0,0 +1,283 @@
+﻿#include "TextureAtlas.h"
+#include "TextureManager.h"
+#include <DirectXTex.h>
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+using namespace DirectX;
+
+const std::string TextureAtlas::kBaseDirectory = "Resources/";
+
+namespace {
+
+// ファイル名をユニコードのフルパスに変換
+std::wstring ToFullPath(const std::string& directoryPath, const std::string& fileName) {
+	std::string fullPath = directoryPath + fileName;
+	wchar_t wfilePath[256];
+	MultiByteToWideChar(CP_ACP, 0, fullPath.c_str(), -1, wfilePath, _countof(wfilePath));
+	return wfilePath;
+}
+
+} // namespace
+
+TextureAtlas* TextureAtlas::GetInstance() {
+	static TextureAtlas instance;
+	return &instance;
+}
+
+void TextureAtlas::CopyWithExtrude(
+  uint32_t* pagePixels, uint32_t pageWidth, const RectPacker::Rect& rect, uint32_t padding,
+  const uint8_t* pixels, size_t rowPitch) {
+	assert(rect.width >= padding * 2 + 1 && rect.height >= padding * 2 + 1);
+	uint32_t width = rect.width - padding * 2;
+	uint32_t height = rect.height - padding * 2;
+
+	// 画像の行をコピーし、左右の余白を行の端の画素で埋める
+	for (uint32_t y = 0; y < height; y++) {
+		uint32_t* row = &pagePixels[size_t(rect.y + padding + y) * pageWidth + rect.x];
+		memcpy(row + padding, pixels + rowPitch * y, sizeof(uint32_t) * width);
+		std::fill(row, row + padding, row[padding]);
+		std::fill(row + padding + width, row + rect.width, row[padding + width - 1]);
+	}
+
+	// 上下の余白を最初と最後の行で埋める（角は左右に引き伸ばした画素になる）
+	const uint32_t* firstRow = &pagePixels[size_t(rect.y + padding) * pageWidth + rect.x];
+	const uint32_t* lastRow = firstRow + size_t(height - 1) * pageWidth;
+	for (uint32_t y = 0; y < padding; y++) {
+		memcpy(
+		  &pagePixels[size_t(rect.y + y) * pageWidth + rect.x], firstRow,
+		  sizeof(uint32_t) * rect.width);
+		memcpy(
+		  &pagePixels[size_t(rect.y + padding + height + y) * pageWidth + rect.x], lastRow,
+		  sizeof(uint32_t) * rect.width);
+	}
+}
+
+uint32_t TextureAtlas::GetMipLevels(uint32_t padding) {
+	// ミップレベルmの1テクセルは2^m画素なので、2^m <= 余白 のレベルまで
+	uint32_t levels = 1;
+	while ((1u << levels) <= padding) {
+		levels++;
+	}
+	return levels;
+}
+
+void TextureAtlas::Build(
+  const std::string& atlasName, const std::vector<std::string>& fileNames, uint32_t pageSize,
+  uint32_t padding) {
+	HRESULT result = S_FALSE;
+
+	// 全ての画像をRGBA8で読み込む
+	std::vector<ScratchImage> images(fileNames.size());
+	for (size_t i = 0; i < fileNames.size(); i++) {
+		result = LoadFromWICFile(
+		  ToFullPath(kBaseDirectory, fileNames[i]).c_str(), WIC_FLAGS_IGNORE_SRGB, nullptr,
+		  images[i]);
+		assert(SUCCEEDED(result));
+
+		if (images[i].GetMetadata().format != DXGI_FORMAT_R8G8B8A8_UNORM) {
+			ScratchImage converted;
+			result = Convert(
+			  *images[i].GetImage(0, 0, 0), DXGI_FORMAT_R8G8B8A8_UNORM, TEX_FILTER_DEFAULT,
+			  TEX_THRESHOLD_DEFAULT, converted);
+			assert(SUCCEEDED(result));
+			images[i] = std::move(converted);
+		}
+	}
+
+	// 長い辺の大きい順に詰めると隙間が少ない
+	std::vector<size_t> order(fileNames.size());
+	for (size_t i = 0; i < order.size(); i++) {
+		order[i] = i;
+	}
+	std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+		const TexMetadata& ma = images[a].GetMetadata();
+		const TexMetadata& mb = images[b].GetMetadata();
+		size_t longA = (std::max)(ma.width, ma.height);
+		size_t longB = (std::max)(mb.width, mb.height);
+		if (longA != longB) {
+			return longA > longB;
+		}
+		return ma.width * ma.height > mb.width * mb.height;
+	});
+
+	// このアトラスのページは既存のページの後ろに追加する
+	const size_t firstPage = pages_.size();
+	for (size_t index : order) {
+		const Image& image = *images[index].GetImage(0, 0, 0);
+		uint32_t width = static_cast<uint32_t>(image.width);
+		uint32_t height = static_cast<uint32_t>(image.height);
+		// 1ページに入らない画像
+		assert(width + padding * 2 <= pageSize && height + padding * 2 <= pageSize);
+
+		// 空きのあるページを前から探し、無ければページを増やす
+		RectPacker::Rect rect;
+		size_t page = firstPage;
+		for (; page < pages_.size(); page++) {
+			if (pages_[page].packer.Insert(width + padding * 2, height + padding * 2, rect)) {
+				break;
+			}
+		}
+		if (page == pages_.size()) {
+			pages_.emplace_back();
+			Page& newPage = pages_.back();
+			newPage.atlasName = atlasName;
+			newPage.fileName = atlasName + "_" + std::to_string(page - firstPage) + ".png";
+			newPage.padding = padding;
+			newPage.packer.Initialize(pageSize, pageSize);
+			newPage.pixels.assign(size_t(pageSize) * pageSize, 0);
+			bool inserted = newPage.packer.Insert(width + padding * 2, height + padding * 2, rect);
+			assert(inserted);
+			(void)inserted;
+		}
+
+		// ページの画素にコピー（余白は端の画素で埋める）
+		Page& target = pages_[page];
+		CopyWithExtrude(
+		  target.pixels.data(), pageSize, rect, padding, image.pixels, image.rowPitch);
+		uint32_t left = rect.x + padding;
+		uint32_t top = rect.y + padding;
+
+		// 対応表に登録（テクスチャハンドルはページの生成後に決まる）
+		Region& region = regions_[fileNames[index]];
+		region.page = static_cast<uint32_t>(page);
+		region.texBase = {float(left), float(top)};
+		region.texSize = {float(width), float(height)};
+	}
+
+	// ページのテクスチャを生成
+	for (size_t page = firstPage; page < pages_.size(); page++) {
+		Page& target = pages_[page];
+		Image image{};
+		image.width = target.packer.GetWidth();
+		image.height = target.packer.GetHeight();
+		image.format = DXGI_FORMAT_R8G8B8A8_UNORM;
+		image.rowPitch = sizeof(uint32_t) * image.width;
+		image.slicePitch = image.rowPitch * image.height;
+		image.pixels = reinterpret_cast<uint8_t*>(target.pixels.data());
+		target.textureHandle =
+		  TextureManager::Create(target.fileName, image, GetMipLevels(target.padding));
+	}
+	for (const std::string& fileName : fileNames) {
+		Region& region = regions_[fileName];
+		region.textureHandle = pages_[region.page].textureHandle;
+	}
+}
+
+void TextureAtlas::Save(const std::string& atlasName) {
+	HRESULT result = S_FALSE;
+
+	std::ofstream file(kBaseDirectory + atlasName + ".atlas");
+	assert(file);
+
+	// 余白（読み込み時のミップレベル数を決める）
+	for (const Page& page : pages_) {
+		if (page.atlasName == atlasName) {
+			file << "padding " << page.padding << "\n";
+			break;
+		}
+	}
+
+	// ページ画像を書き出す（ページ番号はアトラス内の通し番号にする）
+	std::vector<uint32_t> pageNumbers(pages_.size(), UINT32_MAX);
+	uint32_t pageCount = 0;
+	for (size_t page = 0; page < pages_.size(); page++) {
+		const Page& source = pages_[page];
+		if (source.atlasName != atlasName) {
+			continue;
+		}
+		// Loadで読み込んだページは画素を持たない
+		assert(!source.pixels.empty());
+
+		Image image{};
+		image.width = source.packer.GetWidth();
+		image.height = source.packer.GetHeight();
+		image.format = DXGI_FORMAT_R8G8B8A8_UNORM;
+		image.rowPitch = sizeof(uint32_t) * image.width;
+		image.slicePitch = image.rowPitch * image.height;
+		image.pixels = reinterpret_cast<uint8_t*>(const_cast<uint32_t*>(source.pixels.data()));
+		result = SaveToWICFile(
+		  image, WIC_FLAGS_NONE, GetWICCodec(WIC_CODEC_PNG),
+		  ToFullPath(kBaseDirectory, source.fileName).c_str());
+		assert(SUCCEEDED(result));
+
+		file << "page " << source.fileName << "\n";
+		pageNumbers[page] = pageCount++;
+	}
+
+	// 対応表を書き出す（名前 ページ番号 x y 幅 高さ）
+	for (const auto& pair : regions_) {
+		const Region& region = pair.second;
+		if (pageNumbers[region.page] == UINT32_MAX) {
+			continue;
+		}
+		file << "region " << pair.first << " " << pageNumbers[region.page] << " "
+		     << region.texBase.x << " " << region.texBase.y << " " << region.texSize.x << " "
+		     << region.texSize.y << "\n";
+	}
+}
+
+void TextureAtlas::Load(const std::string& atlasName) {
+	std::ifstream file(kBaseDirectory + atlasName + ".atlas");
+	assert(file);
+
+	const size_t firstPage = pages_.size();
+	// 余白の記録がなければミップマップを作らない
+	uint32_t padding = 0;
+	std::string line;
+	while (std::getline(file, line)) {
+		std::istringstream lineStream(line);
+		std::string key;
+		lineStream >> key;
+
+		// 余白
+		if (key == "padding") {
+			lineStream >> padding;
+		}
+		// ページ画像
+		if (key == "page") {
+			pages_.emplace_back();
+			Page& page = pages_.back();
+			page.atlasName = atlasName;
+			page.padding = padding;
+			lineStream >> page.fileName;
+
+			ScratchImage image;
+			HRESULT result = LoadFromWICFile(
+			  ToFullPath(kBaseDirectory, page.fileName).c_str(), WIC_FLAGS_IGNORE_SRGB, nullptr,
+			  image);
+			assert(SUCCEEDED(result));
+			(void)result;
+			page.textureHandle =
+			  TextureManager::Create(page.fileName, *image.GetImage(0, 0, 0), GetMipLevels(padding));
+		}
+		// 画像の位置
+		if (key == "region") {
+			std::string name;
+			uint32_t page = 0;
+			Region region;
+			lineStream >> name >> page >> region.texBase.x >> region.texBase.y >> region.texSize.x >>
+			  region.texSize.y;
+			assert(firstPage + page < pages_.size());
+			region.page = static_cast<uint32_t>(firstPage + page);
+			region.textureHandle = pages_[region.page].textureHandle;
+			regions_[name] = region;
+		}
+	}
+}
+
+const TextureAtlas::Region* TextureAtlas::Find(const std::string& name) const {
+	auto it = regions_.find(name);
+	if (it == regions_.end()) {
+		return nullptr;
+	}
+	return &it->second;
+}
+
+float TextureAtlas::GetOccupancy(uint32_t page) const {
+	assert(page < pages_.size());
+	return pages_[page].packer.GetOccupancy();
+}
@@ -0,0 +1,141 @@
+﻿#pragma once
+
+#include "RectPacker.h"
+#include <DirectXMath.h>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/// <summary>
+/// テクスチャアトラス
+/// 複数の画像をページ単位の大きなテクスチャに詰め込み、名前からページとテクスチャ範囲を引く
+/// Buildで実行時に作るか、Saveで書き出したものをLoadで読み込んで使う
+/// </summary>
+class TextureAtlas {
+  public: // 定数
+	// 1ページの標準サイズ
+	static const uint32_t kDefaultPageSize = 2048;
+	// 画像の周りの標準の余白（端の画素を引き伸ばして埋め、隣の画像がにじまないようにする）
+	static const uint32_t kDefaultPadding = 2;
+
+  public: // サブクラス
+	/// <summary>
+	/// アトラス内の画像の位置
+	/// </summary>
+	struct Region {
+		// ページ番号
+		uint32_t page = 0;
+		// ページのテクスチャハンドル
+		uint32_t textureHandle = 0;
+		// テクスチャ左上座標
+		DirectX::XMFLOAT2 texBase = {0, 0};
+		// テクスチャサイズ
+		DirectX::XMFLOAT2 texSize = {0, 0};
+	};
+
+  public: // 静的メンバ関数
+	/// <summary>
+	/// シングルトンインスタンスの取得
+	/// </summary>
+	/// <returns>シングルトンインスタンス</returns>
+	static TextureAtlas* GetInstance();
+
+	/// <summary>
+	/// ページの画素に画像をコピーし、画像の端の画素を周りの余白に引き伸ばす
+	/// （バイリニア補間や縮小で余白の色がにじまないようにする）
+	/// </summary>
+	/// <param name="pagePixels">ページの画素（RGBA8）</param>
+	/// <param name="pageWidth">ページの幅</param>
+	/// <param name="rect">余白を含めて置いた位置</param>
+	/// <param name="padding">余白</param>
+	/// <param name="pixels">画像の画素（RGBA8）</param>
+	/// <param name="rowPitch">画像の1行のバイト数</param>
+	static void CopyWithExtrude(
+	  uint32_t* pagePixels, uint32_t pageWidth, const RectPacker::Rect& rect, uint32_t padding,
+	  const uint8_t* pixels, size_t rowPitch);
+
+	/// <summary>
+	/// ページのミップレベル数の取得
+	/// 1テクセルが余白より大きくなる縮小では隣の画像と混ざるので、そこまでは作らない
+	/// </summary>
+	/// <param name="padding">余白</param>
+	/// <returns>ミップレベル数</returns>
+	static uint32_t GetMipLevels(uint32_t padding);
+
+  public: // メンバ関数
+	/// <summary>
+	/// 画像を読み込んでページに詰め込み、ページのテクスチャを生成する
+	/// </summary>
+	/// <param name="atlasName">アトラス名（ページのファイル名に使う）</param>
+	/// <param name="fileNames">画像のファイル名（PNG/JPGなど）</param>
+	/// <param name="pageSize">1ページの幅と高さ</param>
+	/// <param name="padding">画像の周りの余白</param>
+	void Build(
+	  const std::string& atlasName, const std::vector<std::string>& fileNames,
+	  uint32_t pageSize = kDefaultPageSize, uint32_t padding = kDefaultPadding);
+
+	/// <summary>
+	/// Buildで作ったページ画像と対応表を書き出す
+	/// </summary>
+	/// <param name="atlasName">アトラス名</param>
+	void Save(const std::string& atlasName);
+
+	/// <summary>
+	/// 書き出したページ画像と対応表を読み込む
+	/// </summary>
+	/// <param name="atlasName">アトラス名</param>
+	void Load(const std::string& atlasName);
+
+	/// <summary>
+	/// 名前で画像の位置を検索
+	/// </summary>
+	/// <param name="name">画像のファイル名</param>
+	/// <returns>見つからなければnullptr</returns>
+	const Region* Find(const std::string& name) const;
+
+	/// <summary>
+	/// ページ数の取得
+	/// </summary>
+	size_t GetPageCount() const { return pages_.size(); }
+
+	/// <summary>
+	/// ページの使用率の取得（Buildで作ったページのみ）
+	/// </summary>
+	/// <param name="page">ページ番号</param>
+	/// <returns>詰め込んだ画像の面積 / ページの面積</returns>
+	float GetOccupancy(uint32_t page) const;
+
+  private: // サブクラス
+	// ページ
+	struct Page {
+		// アトラス名
+		std::string atlasName;
+		// ファイル名
+		std::string fileName;
+		// テクスチャハンドル
+		uint32_t textureHandle = 0;
+		// 画像の周りの余白
+		uint32_t padding = 0;
+		// 詰め込み
+		RectPacker packer;
+		// 画素（RGBA8、Buildで作った時だけ持つ）
+		std::vector<uint32_t> pixels;
+	};
+
+  private: // メンバ関数
+	TextureAtlas() = default;
+	~TextureAtlas() = default;
+	TextureAtlas(const TextureAtlas&) = delete;
+	TextureAtlas& operator=(const TextureAtlas&) = delete;
+
+  private: // 静的メンバ変数
+	// ファイルを置くディレクトリ
+	static const std::string kBaseDirectory;
+
+  private: // メンバ変数
+	// ページ
+	std::vector<Page> pages_;
+	// 画像の名前→位置の対応表
+	std::unordered_map<std::string, Region> regions_;
+};
@@ -0,0 +1,87 @@
+﻿#pragma once
+
+#include <DirectXMath.h>
+#include <cstdint>
+
+/// <summary>
+/// クック済みモデルのバイナリフォーマット
+/// [FileHeader][SourceEntry * sourceCount][MaterialEntry * materialCount]
+/// [MeshEntry * meshCount][頂点・インデックスのデータ領域]
+/// </summary>
+namespace CookedModel {
+
+// ファイル識別子 'CMDL'
+const uint32_t kMagic = 0x4C444D43;
+// フォーマットのバージョン（レイアウトを変えたら上げる）
+const uint32_t kVersion = 4;
+// 拡張子
+const char* const kExtension = ".cooked";
+// 文字列領域のサイズ
+const size_t kNameLength = 128;
+const size_t kPathLength = 256;
+// データ領域のアライメント
+const uint64_t kDataAlignment = 16;
+
+/// <summary>
+/// インポート設定フラグ
+/// </summary>
+enum ImportFlag : uint32_t {
+	kImportSmoothing = 1 << 0, // エッジ平滑化
+	kImportOptimize = 1 << 1,  // 頂点キャッシュ・オーバードロー最適化
+	kImportTangents = 1 << 2,  // 接線の生成
+	kImportLodShift = 8,       // LODレベル数の位置（8bit）
+	kImportLodMask = 0xff << kImportLodShift,
+};
+
+/// <summary>
+/// ファイルヘッダ
+/// </summary>
+struct FileHeader {
+	uint32_t magic;         // ファイル識別子
+	uint32_t version;       // バージョン
+	uint32_t importFlags;   // インポート設定フラグ
+	uint32_t sourceCount;   // 元ファイル数
+	uint32_t materialCount; // マテリアル数
+	uint32_t meshCount;     // メッシュ数
+	uint64_t fileSize;      // ファイル全体のサイズ（書き込み途中の検出用）
+};
+
+/// <summary>
+/// 元ファイル情報（更新検出用）
+/// </summary>
+struct SourceEntry {
+	char fileName[kPathLength]; // ディレクトリからの相対パス
+	uint64_t fileSize;          // ファイルサイズ
+	uint64_t lastWriteTime;     // 最終更新日時
+};
+
+/// <summary>
+/// マテリアル情報
+/// </summary>
+struct MaterialEntry {
+	char name[kNameLength];                // マテリアル名
+	char textureFilename[kPathLength];     // テクスチャファイル名
+	DirectX::XMFLOAT3 ambient;             // アンビエント影響度
+	DirectX::XMFLOAT3 diffuse;             // ディフューズ影響度
+	DirectX::XMFLOAT3 specular;            // スペキュラー影響度
+	float alpha;                           // アルファ
+};
+
+/// <summary>
+/// メッシュ情報
+/// </summary>
+struct MeshEntry {
+	char name[kNameLength]; // メッシュ名
+	int32_t materialIndex;  // マテリアル番号（-1で未割り当て）
+	uint32_t vertexCount;   // 頂点数
+	uint32_t indexCount;    // インデックス数
+	uint32_t tangentCount;  // 接線数（0なら接線なし）
+	uint64_t vertexOffset;  // 頂点データのファイル先頭からのオフセット
+	uint64_t indexOffset;   // インデックスデータのファイル先頭からのオフセット
+	uint64_t tangentOffset; // 接線データのファイル先頭からのオフセット
+	uint32_t lodCount;      // LODレベル数（0ならLODなし）
+	uint32_t reserved;      // 予約
+	uint64_t lodOffset;     // LODレベル（Mesh::LodLevel）のファイル先頭からのオフセット
+};
+
+} // namespace CookedModel
@@ -0,0 +1,96 @@
+﻿#include "Frustum.h"
+#include <algorithm>
+#include <cmath>
+
+using namespace DirectX;
+
+XMFLOAT4 Frustum::TransformSphere(const XMFLOAT4& sphere, const XMMATRIX& matrix) {
+	XMVECTOR center = XMVector3Transform(XMVectorSet(sphere.x, sphere.y, sphere.z, 1.0f), matrix);
+	XMVECTOR scaleSq = XMVectorMax(
+	  XMVectorMax(XMVector3LengthSq(matrix.r[0]), XMVector3LengthSq(matrix.r[1])),
+	  XMVector3LengthSq(matrix.r[2]));
+
+	XMFLOAT4 result;
+	XMStoreFloat4(
+	  &result, XMVectorSetW(center, sphere.w * XMVectorGetX(XMVectorSqrt(scaleSq))));
+	return result;
+}
+
+void Frustum::Extract(const XMMATRIX& matrix) {
+	// 列ベクトルを行として取り出す（クリップ座標の各成分）
+	XMMATRIX columns = XMMatrixTranspose(matrix);
+
+	planes_[0] = XMVectorAdd(columns.r[3], columns.r[0]);      // 左
+	planes_[1] = XMVectorSubtract(columns.r[3], columns.r[0]); // 右
+	planes_[2] = XMVectorAdd(columns.r[3], columns.r[1]);      // 下
+	planes_[3] = XMVectorSubtract(columns.r[3], columns.r[1]); // 上
+	planes_[4] = columns.r[2];                                 // 手前（深度0）
+	planes_[5] = XMVectorSubtract(columns.r[3], columns.r[2]); // 奥
+	for (XMVECTOR& plane : planes_) {
+		plane = XMPlaneNormalize(plane);
+	}
+
+	// 成分ごとに並べ替える
+	XMMATRIX group0(planes_[0], planes_[1], planes_[2], planes_[3]);
+	XMMATRIX group1(planes_[4], planes_[5], planes_[5], planes_[5]);
+	group0 = XMMatrixTranspose(group0);
+	group1 = XMMatrixTranspose(group1);
+	planeX_[0] = group0.r[0];
+	planeY_[0] = group0.r[1];
+	planeZ_[0] = group0.r[2];
+	planeW_[0] = group0.r[3];
+	planeX_[1] = group1.r[0];
+	planeY_[1] = group1.r[1];
+	planeZ_[1] = group1.r[2];
+	planeW_[1] = group1.r[3];
+}
+
+bool Frustum::IntersectsSphere(const XMFLOAT3& center, float radius) const {
+	XMVECTOR c = XMLoadFloat3(&center);
+	XMVECTOR negativeRadius = XMVectorReplicate(-radius);
+	for (const XMVECTOR& plane : planes_) {
+		// どれか1枚の平面の完全に外側なら見えない
+		if (XMVector4Less(XMPlaneDotCoord(plane, c), negativeRadius)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+bool Frustum::IntersectsBox(const XMFLOAT3& center, const XMFLOAT3& extents) const {
+	XMVECTOR c = XMLoadFloat3(&center);
+	XMVECTOR e = XMLoadFloat3(&extents);
+	for (const XMVECTOR& plane : planes_) {
+		// 法線方向への箱の広がり
+		XMVECTOR distance = XMPlaneDotCoord(plane, c);
+		XMVECTOR radius = XMVector3Dot(XMVectorAbs(plane), e);
+		if (XMVector4Less(XMVectorAdd(distance, radius), XMVectorZero())) {
+			return false;
+		}
+	}
+	return true;
+}
+
+size_t Frustum::CullSpheres(const XMFLOAT4* spheres, size_t count, uint8_t* visible) const {
+	size_t visibleCount = 0;
+	for (size_t i = 0; i < count; i++) {
+		XMVECTOR sphere = XMLoadFloat4(&spheres[i]);
+		XMVECTOR x = XMVectorSplatX(sphere);
+		XMVECTOR y = XMVectorSplatY(sphere);
+		XMVECTOR z = XMVectorSplatZ(sphere);
+		XMVECTOR negativeRadius = XMVectorNegate(XMVectorSplatW(sphere));
+
+		// 4平面ずつ符号付き距離を求め、1つでも半径より外側なら見えない
+		XMVECTOR outside = XMVectorFalseInt();
+		for (int g = 0; g < 2; g++) {
+			XMVECTOR distance = XMVectorMultiplyAdd(
+			  planeX_[g], x,
+			  XMVectorMultiplyAdd(planeY_[g], y, XMVectorMultiplyAdd(planeZ_[g], z, planeW_[g])));
+			outside = XMVectorOrInt(outside, XMVectorLess(distance, negativeRadius));
+		}
+		bool isVisible = XMComparisonAllFalse(XMVector4EqualIntR(outside, XMVectorTrueInt()));
+		visible[i] = isVisible ? 1 : 0;
+		visibleCount += isVisible ? 1 : 0;
+	}
+	return visibleCount;
+}
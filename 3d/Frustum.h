@@ -0,0 +1,72 @@
+﻿#pragma once
+
+#include <DirectXMath.h>
+#include <cstddef>
+#include <cstdint>
+
+/// <summary>
+/// 視錐台（カリング用）
+/// </summary>
+class Frustum {
+  private: // エイリアス
+	// DirectX::を省略
+	using XMFLOAT3 = DirectX::XMFLOAT3;
+	using XMFLOAT4 = DirectX::XMFLOAT4;
+	using XMMATRIX = DirectX::XMMATRIX;
+	using XMVECTOR = DirectX::XMVECTOR;
+
+  public: // 定数
+	// 平面の数（左、右、下、上、手前、奥）
+	static const int kPlaneCount = 6;
+
+  public: // 静的メンバ関数
+	/// <summary>
+	/// 境界球を行列で変換する（半径は最大の軸スケールで拡大）
+	/// </summary>
+	/// <param name="sphere">境界球（xyzが中心、wが半径）</param>
+	/// <param name="matrix">変換行列</param>
+	/// <returns>変換後の境界球</returns>
+	static XMFLOAT4 TransformSphere(const XMFLOAT4& sphere, const XMMATRIX& matrix);
+
+  public: // メンバ関数
+	/// <summary>
+	/// 行列から平面を取り出す
+	/// ワールド×ビュー×射影を渡せばローカル座標、ビュー×射影ならワールド座標の視錐台になる
+	/// </summary>
+	/// <param name="matrix">射影までの変換行列（D3Dの深度0～1）</param>
+	void Extract(const XMMATRIX& matrix);
+
+	/// <summary>
+	/// 球との判定
+	/// </summary>
+	/// <param name="center">中心</param>
+	/// <param name="radius">半径</param>
+	/// <returns>少しでも内側にあればtrue</returns>
+	bool IntersectsSphere(const XMFLOAT3& center, float radius) const;
+
+	/// <summary>
+	/// 軸平行な箱との判定
+	/// </summary>
+	/// <param name="center">中心</param>
+	/// <param name="extents">中心から各面までの距離</param>
+	/// <returns>少しでも内側にあればtrue</returns>
+	bool IntersectsBox(const XMFLOAT3& center, const XMFLOAT3& extents) const;
+
+	/// <summary>
+	/// 球をまとめて判定する（平面を4つずつSIMDで処理）
+	/// </summary>
+	/// <param name="spheres">境界球の配列（xyzが中心、wが半径）</param>
+	/// <param name="count">境界球の数</param>
+	/// <param name="visible">出力先の判定結果（見えていれば1）</param>
+	/// <returns>見えている球の数</returns>
+	size_t CullSpheres(const XMFLOAT4* spheres, size_t count, uint8_t* visible) const;
+
+  private: // メンバ変数
+	// 平面（xyzが内向きの法線、wが距離）
+	XMVECTOR planes_[kPlaneCount];
+	// 平面の成分ごとの配列（4平面ずつ、足りない分は最後の平面を繰り返す）
+	XMVECTOR planeX_[2];
+	XMVECTOR planeY_[2];
+	XMVECTOR planeZ_[2];
+	XMVECTOR planeW_[2];
+};
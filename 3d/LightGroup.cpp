@@ -18,24 +18,6 @@ void LightGroup::Initialize() {
 
 	DefaultLightSetting();
 
-	// ヒーププロパティ
-	CD3DX12_HEAP_PROPERTIES heapProps = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD);
-	// リソース設定
-	CD3DX12_RESOURCE_DESC resourceDesc =
-	  CD3DX12_RESOURCE_DESC::Buffer((sizeof(ConstBufferData) + 0xff) & ~0xff);
-
-	HRESULT result;
-	// 定数バッファの生成
-	result = DirectXCommon::GetInstance()->GetDevice()->CreateCommittedResource(
-	  &heapProps, // アップロード可能
-	  D3D12_HEAP_FLAG_NONE, &resourceDesc, D3D12_RESOURCE_STATE_GENERIC_READ, nullptr,
-	  IID_PPV_ARGS(&constBuff_));
-	assert(SUCCEEDED(result));
-
-	// 定数バッファとのデータリンク
-	result = constBuff_->Map(0, nullptr, (void**)&constMap_);
-	assert(SUCCEEDED(result));
-
 	// 定数バッファへデータ転送
 	TransferConstBuffer();
 }
@@ -48,75 +30,81 @@ void LightGroup::Update() {
 	}
 }
 
-void LightGroup::Draw(ID3D12GraphicsCommandList* cmdList, UINT rootParameterIndex) {
+void LightGroup::Draw(RenderContext* renderContext, UINT rootParameterIndex) {
 	// 定数バッファビューをセット
-	cmdList->SetGraphicsRootConstantBufferView(
-	  rootParameterIndex, constBuff_->GetGPUVirtualAddress());
+	renderContext->SetGraphicsRootConstantBufferView(rootParameterIndex, GetGPUVirtualAddress());
+}
+
+D3D12_GPU_VIRTUAL_ADDRESS LightGroup::GetGPUVirtualAddress() {
+	return ConstantBufferAllocator::GetInstance()->Upload(constData_, constCache_);
 }
 
 void LightGroup::TransferConstBuffer() {
 	// 環境光
-	constMap_->ambientColor = ambientColor_;
+	constData_.ambientColor = ambientColor_;
 	// 平行光源
 	for (int i = 0; i < kDirLightNum; i++) {
 		// ライトが有効なら設定を転送
 		if (dirLights_[i].IsActive()) {
-			constMap_->dirLights[i].active = 1;
-			constMap_->dirLights[i].lightv = -dirLights_[i].GetLightDir();
-			constMap_->dirLights[i].lightcolor = dirLights_[i].GetLightColor();
+			constData_.dirLights[i].active = 1;
+			constData_.dirLights[i].lightv = -dirLights_[i].GetLightDir();
+			constData_.dirLights[i].lightcolor = dirLights_[i].GetLightColor();
 		}
 		// ライトが無効ならライト色を0に
 		else {
-			constMap_->dirLights[i].active = 0;
+			constData_.dirLights[i].active = 0;
 		}
 	}
 	// 点光源
 	for (int i = 0; i < kPointLightNum; i++) {
 		// ライトが有効なら設定を転送
 		if (pointLights_[i].IsActive()) {
-			constMap_->pointLights[i].active = 1;
-			constMap_->pointLights[i].lightpos = pointLights_[i].GetLightPos();
-			constMap_->pointLights[i].lightcolor = pointLights_[i].GetLightColor();
-			constMap_->pointLights[i].lightatten = pointLights_[i].GetLightAtten();
+			constData_.pointLights[i].active = 1;
+			constData_.pointLights[i].lightpos = pointLights_[i].GetLightPos();
+			constData_.pointLights[i].lightcolor = pointLights_[i].GetLightColor();
+			constData_.pointLights[i].lightatten = pointLights_[i].GetLightAtten();
 		}
 		// ライトが無効ならライト色を0に
 		else {
-			constMap_->pointLights[i].active = 0;
+			constData_.pointLights[i].active = 0;
 		}
 	}
 	// スポットライト
 	for (int i = 0; i < kSpotLightNum; i++) {
 		// ライトが有効なら設定を転送
 		if (spotLights_[i].IsActive()) {
-			constMap_->spotLights[i].active = 1;
-			constMap_->spotLights[i].lightv = -spotLights_[i].GetLightDir();
-			constMap_->spotLights[i].lightpos = spotLights_[i].GetLightPos();
-			constMap_->spotLights[i].lightcolor = spotLights_[i].GetLightColor();
-			constMap_->spotLights[i].lightatten = spotLights_[i].GetLightAtten();
-			constMap_->spotLights[i].lightfactoranglecos = spotLights_[i].GetLightFactorAngleCos();
+			constData_.spotLights[i].active = 1;
+			constData_.spotLights[i].lightv = -spotLights_[i].GetLightDir();
+			constData_.spotLights[i].lightpos = spotLights_[i].GetLightPos();
+			constData_.spotLights[i].lightcolor = spotLights_[i].GetLightColor();
+			constData_.spotLights[i].lightatten = spotLights_[i].GetLightAtten();
+			constData_.spotLights[i].lightfactoranglecos = spotLights_[i].GetLightFactorAngleCos();
 		}
 		// ライトが無効ならライト色を0に
 		else {
-			constMap_->spotLights[i].active = 0;
+			constData_.spotLights[i].active = 0;
 		}
 	}
 	// 丸影
 	for (int i = 0; i < kCircleShadowNum; i++) {
 		// 有効なら設定を転送
 		if (circleShadows_[i].IsActive()) {
-			constMap_->circleShadows[i].active = 1;
-			constMap_->circleShadows[i].dir = -circleShadows_[i].GetDir();
-			constMap_->circleShadows[i].casterPos = circleShadows_[i].GetCasterPos();
-			constMap_->circleShadows[i].distanceCasterLight =
+			constData_.circleShadows[i].active = 1;
+			constData_.circleShadows[i].dir = -circleShadows_[i].GetDir();
+			constData_.circleShadows[i].casterPos = circleShadows_[i].GetCasterPos();
+			constData_.circleShadows[i].distanceCasterLight =
 			  circleShadows_[i].GetDistanceCasterLight();
-			constMap_->circleShadows[i].atten = circleShadows_[i].GetAtten();
-			constMap_->circleShadows[i].factorAngleCos = circleShadows_[i].GetFactorAngleCos();
+			constData_.circleShadows[i].atten = circleShadows_[i].GetAtten();
+			constData_.circleShadows[i].factorAngleCos = circleShadows_[i].GetFactorAngleCos();
 		}
 		// 無効なら色を0に
 		else {
-			constMap_->circleShadows[i].active = 0;
+			constData_.circleShadows[i].active = 0;
 		}
 	}
+
+	// 定数バッファは次の描画で転送し直す
+	constCache_.Invalidate();
 }
 
 void LightGroup::DefaultLightSetting() {
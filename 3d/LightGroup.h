@@ -6,8 +6,10 @@
 #include <DirectXMath.h>
 #include <d3dx12.h>
 
+#include "ConstantBufferAllocator.h"
 #include "DirectionalLight.h"
 #include "PointLight.h"
+#include "RenderContext.h"
 #include "SpotLight.h"
 #include "CircleShadow.h"
 
@@ -75,7 +77,15 @@ public: // メンバ関数
 	/// <summary>
 	/// 描画
 	/// </summary>
-	void Draw(ID3D12GraphicsCommandList* cmdList, UINT rootParameterIndex);
+	/// <param name="renderContext">描画コマンドの発行先</param>
+	/// <param name="rootParameterIndex">ルートパラメータ番号</param>
+	void Draw(RenderContext* renderContext, UINT rootParameterIndex);
+
+	/// <summary>
+	/// 定数バッファのGPUアドレスを取得（このフレームで未転送なら転送する）
+	/// </summary>
+	/// <returns>GPUアドレス</returns>
+	D3D12_GPU_VIRTUAL_ADDRESS GetGPUVirtualAddress();
 
 	/// <summary>
 	/// 定数バッファ転送
@@ -227,10 +237,10 @@ public: // メンバ関数
 	void SetCircleShadowFactorAngle(int index, const XMFLOAT2& lightFactorAngle);
 
 private: // メンバ変数
-	// 定数バッファ
-	ComPtr<ID3D12Resource> constBuff_;
-	// 定数バッファのマップ
-	ConstBufferData* constMap_ = nullptr;
+	// 定数バッファへ転送するデータ
+	ConstBufferData constData_{};
+	// 定数バッファ（フレームごとの確保から転送する）
+	ConstantBufferAllocator::FrameCache constCache_;
 
 	// 環境光の色
 	XMFLOAT3 ambientColor_ = { 1,1,1 };
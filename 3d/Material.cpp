@@ -7,6 +7,11 @@
 using namespace DirectX;
 using namespace std;
 
+/// <summary>
+/// 静的メンバ変数の実体
+/// </summary>
+std::atomic<uint32_t> Material::sNextSortId_{0};
+
 Material* Material::Create() {
 	Material* instance = new Material;
 
@@ -15,29 +20,14 @@ Material* Material::Create() {
 	return instance;
 }
 
-void Material::Initialize() {
-	// 定数バッファの生成
-	CreateConstantBuffer();
+Material::~Material() {
+	if (textureLoaded_) {
+		TextureManager::Release(textureHandle_);
+	}
 }
 
-void Material::CreateConstantBuffer() {
-	HRESULT result;
-
-	// ヒーププロパティ
-	CD3DX12_HEAP_PROPERTIES heapProps = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD);
-	// リソース設定
-	CD3DX12_RESOURCE_DESC resourceDesc =
-	  CD3DX12_RESOURCE_DESC::Buffer((sizeof(ConstBufferData) + 0xff) & ~0xff);
-
-	// 定数バッファの生成
-	result = DirectXCommon::GetInstance()->GetDevice()->CreateCommittedResource(
-	  &heapProps, D3D12_HEAP_FLAG_NONE, &resourceDesc, D3D12_RESOURCE_STATE_GENERIC_READ, nullptr,
-	  IID_PPV_ARGS(&constBuff_));
-	assert(SUCCEEDED(result));
-
-	// 定数バッファとのデータリンク
-	result = constBuff_->Map(0, nullptr, (void**)&constMap_);
-	assert(SUCCEEDED(result));
+void Material::Initialize() {
+	// 定数バッファは描画時にフレームごとの確保から転送する（ワーカースレッドでの読み込みにも対応）
 }
 
 void Material::LoadTexture(const std::string& directoryPath) {
@@ -55,40 +45,50 @@ void Material::LoadTexture(const std::string& directoryPath) {
 	// ファイルパスを結合
 	string filepath = directoryPath + textureFilename_;
 
-	// テクスチャ読み込み
-	textureHandle_ = TextureManager::Load(filepath);
+	// テクスチャ読み込み（同じテクスチャの読み込み直しでも解放されないよう、先に読み込む）
+	uint32_t textureHandle = TextureManager::Load(filepath);
+	if (textureLoaded_) {
+		TextureManager::Release(textureHandle_);
+	}
+	textureHandle_ = textureHandle;
+	textureLoaded_ = true;
 }
 
 void Material::Update() {
-	// 定数バッファへデータ転送
-	constMap_->ambient = ambient_;
-	constMap_->diffuse = diffuse_;
-	constMap_->specular = specular_;
-	constMap_->alpha = alpha_;
+	// 定数バッファへ転送するデータを更新
+	constData_.ambient = ambient_;
+	constData_.diffuse = diffuse_;
+	constData_.specular = specular_;
+	constData_.alpha = alpha_;
+	constCache_.Invalidate();
 }
 
 void Material::SetGraphicsCommand(
-  ID3D12GraphicsCommandList* commandList, UINT rooParameterIndexMaterial,
+  RenderContext* renderContext, UINT rooParameterIndexMaterial,
   UINT rooParameterIndexTexture) {
 
 	// SRVをセット
 	TextureManager::GetInstance()->SetGraphicsRootDescriptorTable(
-	  commandList, rooParameterIndexTexture, textureHandle_);
+	  renderContext, rooParameterIndexTexture, textureHandle_);
 
 	// マテリアルの定数バッファをセット
-	commandList->SetGraphicsRootConstantBufferView(
-	  rooParameterIndexMaterial, constBuff_->GetGPUVirtualAddress());
+	renderContext->SetGraphicsRootConstantBufferView(
+	  rooParameterIndexMaterial, GetGPUVirtualAddress());
 }
 
 void Material::SetGraphicsCommand(
-  ID3D12GraphicsCommandList* commandList, UINT rooParameterIndexMaterial,
+  RenderContext* renderContext, UINT rooParameterIndexMaterial,
   UINT rooParameterIndexTexture, uint32_t textureHandle) {
 
 	// SRVをセット
 	TextureManager::GetInstance()->SetGraphicsRootDescriptorTable(
-	  commandList, rooParameterIndexTexture, textureHandle);
+	  renderContext, rooParameterIndexTexture, textureHandle);
 
 	// マテリアルの定数バッファをセット
-	commandList->SetGraphicsRootConstantBufferView(
-	  rooParameterIndexMaterial, constBuff_->GetGPUVirtualAddress());
-}
\ No newline at end of file
+	renderContext->SetGraphicsRootConstantBufferView(
+	  rooParameterIndexMaterial, GetGPUVirtualAddress());
+}
+
+D3D12_GPU_VIRTUAL_ADDRESS Material::GetGPUVirtualAddress() {
+	return ConstantBufferAllocator::GetInstance()->Upload(constData_, constCache_);
+}
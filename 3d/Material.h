@@ -1,6 +1,9 @@
 ﻿#pragma once
 
+#include "ConstantBufferAllocator.h"
+#include "RenderContext.h"
 #include <DirectXMath.h>
+#include <atomic>
 #include <d3d12.h>
 #include <d3dx12.h>
 #include <string>
@@ -47,12 +50,12 @@ class Material {
 
   public:
 	/// <summary>
-	/// 定数バッファの取得
+	/// デストラクタ（読み込んだテクスチャの参照を解放する）
 	/// </summary>
-	/// <returns></returns>
-	ID3D12Resource* GetConstantBuffer() { return constBuff_.Get(); }
+	~Material();
 
-	/// テクスチャ読み込み
+	/// <summary>
+	/// テクスチャ読み込み（読み込み済みなら前のテクスチャの参照を解放する）
 	/// </summary>
 	/// <param name="directoryPath">読み込みディレクトリパス</param>
 	void LoadTexture(const std::string& directoryPath);
@@ -65,34 +68,53 @@ class Material {
 	/// <summary>
 	/// グラフィックスコマンドのセット
 	/// </summary>
-	/// <param name="commandList">コマンドリスト</param>
+	/// <param name="renderContext">描画コマンドの発行先</param>
 	/// <param name="rooParameterIndexMaterial">マテリアルのルートパラメータ番号</param>
 	/// <param name="rooParameterIndexTexture">テクスチャのルートパラメータ番号</param>
 	void SetGraphicsCommand(
-	  ID3D12GraphicsCommandList* commandList, UINT rooParameterIndexMaterial,
+	  RenderContext* renderContext, UINT rooParameterIndexMaterial,
 	  UINT rooParameterIndexTexture);
 
 	/// <summary>
 	/// グラフィックスコマンドのセット（テクスチャ差し替え版）
 	/// </summary>
-	/// <param name="commandList">コマンドリスト</param>
+	/// <param name="renderContext">描画コマンドの発行先</param>
 	/// <param name="rooParameterIndexMaterial">マテリアルのルートパラメータ番号</param>
 	/// <param name="rooParameterIndexTexture">テクスチャのルートパラメータ番号</param>
 	/// <param name="textureHandle">差し替えるテクスチャハンドル</param>
 	void SetGraphicsCommand(
-	  ID3D12GraphicsCommandList* commandList, UINT rooParameterIndexMaterial,
+	  RenderContext* renderContext, UINT rooParameterIndexMaterial,
 	  UINT rooParameterIndexTexture, uint32_t textureHandle);
 
 	// テクスチャハンドル
 	uint32_t GetTextureHadle() { return textureHandle_; }
 
+	/// <summary>
+	/// 定数バッファのGPUアドレスを取得（このフレームで未転送なら転送する）
+	/// </summary>
+	/// <returns>GPUアドレス</returns>
+	D3D12_GPU_VIRTUAL_ADDRESS GetGPUVirtualAddress();
+
+	/// <summary>
+	/// 並べ替え用の番号を取得（生成順の連番）
+	/// </summary>
+	uint32_t GetSortId() const { return sortId_; }
+
+  private: // 静的メンバ変数
+	// 次に割り当てる並べ替え用の番号（ワーカースレッドでも生成される）
+	static std::atomic<uint32_t> sNextSortId_;
+
   private:
-	// 定数バッファ
-	ComPtr<ID3D12Resource> constBuff_;
-	// 定数バッファのマップ
-	ConstBufferData* constMap_ = nullptr;
+	// 定数バッファへ転送するデータ
+	ConstBufferData constData_{};
+	// 定数バッファ（フレームごとの確保から転送する）
+	ConstantBufferAllocator::FrameCache constCache_;
 	// テクスチャハンドル
 	uint32_t textureHandle_ = 0;
+	// テクスチャの参照を持っているか
+	bool textureLoaded_ = false;
+	// 並べ替え用の番号
+	uint32_t sortId_ = sNextSortId_++;
 
   private:
 	// コンストラクタ
@@ -107,9 +129,4 @@ class Material {
 	/// 初期化
 	/// </summary>
 	void Initialize();
-
-	/// <summary>
-	/// 定数バッファの生成
-	/// </summary>
-	void CreateConstantBuffer();
 };
@@ -1,47 +1,427 @@
 ﻿#include "DirectXCommon.h"
+#include "JobSystem.h"
 #include "Mesh.h"
+#include "MeshSimplifier.h"
+#include <algorithm>
 #include <cassert>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
 #include <d3dcompiler.h>
 
 #pragma comment(lib, "d3dcompiler.lib")
 
 using namespace DirectX;
 
+namespace {
+
+// 並列処理の1単位あたりの要素数
+const size_t kParallelChunkSize = 1024;
+
+// [0, count) をチャンクに分けて処理する
+template<class F> void ForEachChunk(JobSystem* jobSystem, size_t count, const F& function) {
+	auto range = [&](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; i++) {
+			function(i);
+		}
+	};
+	if (jobSystem) {
+		jobSystem->ParallelFor(count, kParallelChunkSize, range);
+	} else {
+		range(0, count);
+	}
+}
+
+// 全レーンが同じ値の3つのベクトルをX,Y,Zに並べる（スカラーに取り出さずにレジスタ上で組み立てる）
+inline XMVECTOR XM_CALLCONV MergeSplatXYZ(FXMVECTOR x, FXMVECTOR y, FXMVECTOR z) {
+	// (x, y, x, y) のZだけをzに差し替える
+	return XMVectorSelect(XMVectorMergeXY(x, y), z, g_XMSelect0010);
+}
+
+} // namespace
+
 void Mesh::SetName(const std::string& name_) { this->name_ = name_; }
 
 void Mesh::AddVertex(const VertexPosNormalUv& vertex) { vertices_.emplace_back(vertex); }
 
-void Mesh::AddIndex(unsigned short index) { indices_.emplace_back(index); }
+void Mesh::AddIndex(uint32_t index) { indices_.emplace_back(index); }
+
+void Mesh::SetGeometry(
+  const VertexPosNormalUv* vertices, size_t vertexCount, const uint32_t* indices,
+  size_t indexCount) {
+	vertices_.assign(vertices, vertices + vertexCount);
+	indices_.assign(indices, indices + indexCount);
+}
 
-void Mesh::AddSmoothData(unsigned short indexPosition, unsigned short indexVertex) {
-	smoothData_[indexPosition].emplace_back(indexVertex);
+void Mesh::AddSmoothData(uint32_t indexPosition, uint32_t indexVertex) {
+	if (smoothPositions_.size() <= indexVertex) {
+		smoothPositions_.resize(indexVertex + 1, UINT32_MAX);
+	}
+	smoothPositions_[indexVertex] = indexPosition;
 }
 
 void Mesh::CalculateSmoothedVertexNormals() {
-	auto itr = smoothData_.begin();
-	for (; itr != smoothData_.end(); ++itr) {
-		// 各面用の共通頂点コレクション
-		std::vector<unsigned short>& v = itr->second;
-		// 全頂点の法線を平均する
-		XMVECTOR normal = {};
-		for (unsigned short index : v) {
-			normal += XMVectorSet(
-			  vertices_[index].normal.x, vertices_[index].normal.y, vertices_[index].normal.z, 0);
+	if (smoothPositions_.empty()) {
+		return;
+	}
+	smoothPositions_.resize(vertices_.size(), UINT32_MAX);
+
+	// 座標インデックスを詰めたグループ番号に変換
+	uint32_t maxPosition = 0;
+	for (uint32_t position : smoothPositions_) {
+		if (position != UINT32_MAX) {
+			maxPosition = (std::max)(maxPosition, position);
+		}
+	}
+	std::vector<uint32_t> groupOfPosition(size_t(maxPosition) + 1, UINT32_MAX);
+	std::vector<uint32_t> groups(vertices_.size(), UINT32_MAX);
+	uint32_t groupCount = 0;
+	for (size_t i = 0; i < vertices_.size(); i++) {
+		uint32_t position = smoothPositions_[i];
+		if (position == UINT32_MAX) {
+			continue;
+		}
+		if (groupOfPosition[position] == UINT32_MAX) {
+			groupOfPosition[position] = groupCount++;
+		}
+		groups[i] = groupOfPosition[position];
+	}
+
+	// グループごとの法線の和（面の重み付き和と、縮退時用の元の法線の和）
+	std::vector<XMFLOAT4A> weightedNormals(groupCount, XMFLOAT4A(0, 0, 0, 0));
+	std::vector<XMFLOAT4A> sourceNormals(groupCount, XMFLOAT4A(0, 0, 0, 0));
+
+	for (size_t i = 0; i < vertices_.size(); i++) {
+		if (groups[i] != UINT32_MAX) {
+			XMFLOAT4A& sum = sourceNormals[groups[i]];
+			XMStoreFloat4A(
+			  &sum, XMVectorAdd(XMLoadFloat4A(&sum), XMLoadFloat3(&vertices_[i].normal)));
+		}
+	}
+
+	// 三角形ごとに面法線を求め、各角の角度で重み付けしてグループに足し込む
+	for (size_t t = 0; t + 2 < indices_.size(); t += 3) {
+		uint32_t i0 = indices_[t + 0];
+		uint32_t i1 = indices_[t + 1];
+		uint32_t i2 = indices_[t + 2];
+		if (groups[i0] == UINT32_MAX && groups[i1] == UINT32_MAX && groups[i2] == UINT32_MAX) {
+			continue;
+		}
+
+		XMVECTOR p0 = XMLoadFloat3(&vertices_[i0].pos);
+		XMVECTOR p1 = XMLoadFloat3(&vertices_[i1].pos);
+		XMVECTOR p2 = XMLoadFloat3(&vertices_[i2].pos);
+		XMVECTOR e01 = XMVectorSubtract(p1, p0);
+		XMVECTOR e12 = XMVectorSubtract(p2, p1);
+		XMVECTOR e20 = XMVectorSubtract(p0, p2);
+
+		// 外積の長さは面積の2倍なので、そのまま面積の重みになる
+		XMVECTOR faceNormal = XMVector3Cross(e01, XMVectorNegate(e20));
+
+		// 各角の角度（辺を正規化して3角分の内積をまとめて求める）
+		XMVECTOR d01 = XMVector3Normalize(e01);
+		XMVECTOR d12 = XMVector3Normalize(e12);
+		XMVECTOR d20 = XMVector3Normalize(e20);
+		XMVECTOR cosines = XMVectorNegate(MergeSplatXYZ(
+		  XMVector3Dot(d20, d01), XMVector3Dot(d01, d12), XMVector3Dot(d12, d20)));
+		XMVECTOR angles = XMVectorACos(XMVectorClamp(cosines, g_XMNegativeOne, g_XMOne));
+
+		const uint32_t corners[3] = {i0, i1, i2};
+		const XMVECTOR weights[3] = {
+		  XMVectorSplatX(angles), XMVectorSplatY(angles), XMVectorSplatZ(angles)};
+		for (int k = 0; k < 3; k++) {
+			uint32_t group = groups[corners[k]];
+			if (group == UINT32_MAX) {
+				continue;
+			}
+			XMFLOAT4A& sum = weightedNormals[group];
+			XMStoreFloat4A(&sum, XMVectorMultiplyAdd(faceNormal, weights[k], XMLoadFloat4A(&sum)));
+		}
+	}
+
+	// グループごとに正規化（面が全て縮退していたら元の法線の平均を使う）
+	for (uint32_t g = 0; g < groupCount; g++) {
+		XMVECTOR normal = XMLoadFloat4A(&weightedNormals[g]);
+		if (XMVector3LessOrEqual(XMVector3LengthSq(normal), g_XMEpsilon)) {
+			normal = XMLoadFloat4A(&sourceNormals[g]);
+		}
+		XMStoreFloat4A(&weightedNormals[g], XMVector3Normalize(normal));
+	}
+
+	// 頂点に書き戻す
+	for (size_t i = 0; i < vertices_.size(); i++) {
+		if (groups[i] != UINT32_MAX) {
+			XMStoreFloat3(&vertices_[i].normal, XMLoadFloat4A(&weightedNormals[groups[i]]));
+		}
+	}
+}
+
+void Mesh::CalculateTangents(JobSystem* jobSystem) {
+	size_t triangleCount = indices_.size() / 3;
+	size_t vertexCount = vertices_.size();
+	tangents_.assign(vertexCount, XMFLOAT4(1.0f, 0.0f, 0.0f, 1.0f));
+	if (triangleCount == 0) {
+		return;
+	}
+
+	// 三角形ごとの接線・従法線（正規化済み）と角ごとの角度の重み
+	struct TriangleFrame {
+		XMFLOAT3 tangent;
+		XMFLOAT3 bitangent;
+		float weights[3];
+	};
+	std::vector<TriangleFrame> frames(triangleCount);
+
+	ForEachChunk(jobSystem, triangleCount, [&](size_t t) {
+		const VertexPosNormalUv& v0 = vertices_[indices_[t * 3 + 0]];
+		const VertexPosNormalUv& v1 = vertices_[indices_[t * 3 + 1]];
+		const VertexPosNormalUv& v2 = vertices_[indices_[t * 3 + 2]];
+		XMVECTOR p0 = XMLoadFloat3(&v0.pos);
+		XMVECTOR e1 = XMVectorSubtract(XMLoadFloat3(&v1.pos), p0);
+		XMVECTOR e2 = XMVectorSubtract(XMLoadFloat3(&v2.pos), p0);
+
+		// UVの差分（インポート時にVを反転しているので元の向きに戻す）
+		float du1 = v1.uv.x - v0.uv.x;
+		float dv1 = -(v1.uv.y - v0.uv.y);
+		float du2 = v2.uv.x - v0.uv.x;
+		float dv2 = -(v2.uv.y - v0.uv.y);
+
+		// 接線 = (dv2 * e1 - dv1 * e2)、従法線 = (du1 * e2 - du2 * e1) の向き
+		// UVが縮退していても向きが決まるように、行列式で割らずに符号だけ掛ける
+		float determinant = du1 * dv2 - du2 * dv1;
+		float sign = determinant < 0.0f ? -1.0f : 1.0f;
+		XMVECTOR tangent = XMVectorScale(
+		  XMVectorSubtract(XMVectorScale(e1, dv2), XMVectorScale(e2, dv1)), sign);
+		XMVECTOR bitangent = XMVectorScale(
+		  XMVectorSubtract(XMVectorScale(e2, du1), XMVectorScale(e1, du2)), sign);
+
+		TriangleFrame& frame = frames[t];
+		XMStoreFloat3(&frame.tangent, XMVector3Normalize(tangent));
+		XMStoreFloat3(&frame.bitangent, XMVector3Normalize(bitangent));
+
+		// 各角の角度（MikkTSpaceと同じく角度で重み付けする）
+		XMVECTOR d1 = XMVector3Normalize(e1);
+		XMVECTOR d2 = XMVector3Normalize(e2);
+		XMVECTOR d12 = XMVector3Normalize(XMVectorSubtract(e2, e1));
+		XMVECTOR cosines = MergeSplatXYZ(
+		  XMVector3Dot(d1, d2), XMVectorNegate(XMVector3Dot(d1, d12)), XMVector3Dot(d2, d12));
+		XMFLOAT3 angles;
+		XMStoreFloat3(&angles, XMVectorACos(XMVectorClamp(cosines, g_XMNegativeOne, g_XMOne)));
+		frame.weights[0] = angles.x;
+		frame.weights[1] = angles.y;
+		frame.weights[2] = angles.z;
+	});
+
+	// 頂点→角の隣接情報（CSR形式）
+	std::vector<uint32_t> offsets(vertexCount + 1, 0);
+	for (size_t i = 0; i < triangleCount * 3; i++) {
+		offsets[indices_[i] + 1]++;
+	}
+	for (size_t v = 0; v < vertexCount; v++) {
+		offsets[v + 1] += offsets[v];
+	}
+	std::vector<uint32_t> corners(triangleCount * 3);
+	{
+		std::vector<uint32_t> cursor(offsets.begin(), offsets.end() - 1);
+		for (size_t i = 0; i < triangleCount * 3; i++) {
+			corners[cursor[indices_[i]]++] = static_cast<uint32_t>(i);
+		}
+	}
+
+	// 頂点ごとに周囲の三角形の接線を集めて、法線に対して直交化する
+	// 頂点ごとに書き込み先が分かれているので、並列でも結果は逐次と同じになる
+	ForEachChunk(jobSystem, vertexCount, [&](size_t v) {
+		XMVECTOR tangent = XMVectorZero();
+		XMVECTOR bitangent = XMVectorZero();
+		for (uint32_t a = offsets[v]; a < offsets[v + 1]; a++) {
+			const TriangleFrame& frame = frames[corners[a] / 3];
+			XMVECTOR weight = XMVectorReplicate(frame.weights[corners[a] % 3]);
+			tangent = XMVectorMultiplyAdd(XMLoadFloat3(&frame.tangent), weight, tangent);
+			bitangent = XMVectorMultiplyAdd(XMLoadFloat3(&frame.bitangent), weight, bitangent);
+		}
+
+		// Gram-Schmidtで法線と直交させる
+		XMVECTOR normal = XMVector3Normalize(XMLoadFloat3(&vertices_[v].normal));
+		tangent = XMVectorSubtract(tangent, XMVectorMultiply(normal, XMVector3Dot(normal, tangent)));
+		if (XMVector3LessOrEqual(XMVector3LengthSq(tangent), g_XMEpsilon)) {
+			// 接線が決まらない場合は法線に直交する任意の向き
+			XMVECTOR axis = fabsf(vertices_[v].normal.x) < 0.9f ? g_XMIdentityR0 : g_XMIdentityR1;
+			tangent = XMVector3Cross(XMVector3Cross(normal, axis), normal);
+		}
+		tangent = XMVector3Normalize(tangent);
+
+		// 従法線の向き
+		float handedness =
+		  XMVectorGetX(XMVector3Dot(XMVector3Cross(normal, tangent), bitangent)) < 0.0f ? -1.0f
+		                                                                               : 1.0f;
+		XMStoreFloat4(&tangents_[v], XMVectorSetW(tangent, handedness));
+	});
+}
+
+void Mesh::SetTangents(const XMFLOAT4* tangents, size_t tangentCount) {
+	tangents_.assign(tangents, tangents + tangentCount);
+}
+
+void Mesh::Optimize() {
+	// LODの範囲が崩れるので、LOD生成より前に行う
+	assert(lods_.empty());
+
+	size_t indexCount = indices_.size() / 3 * 3;
+	if (indexCount == 0) {
+		return;
+	}
+
+	// 最適化前の統計
+	cacheStatisticsBefore_ =
+	  MeshOptimizer::AnalyzeVertexCache(indices_.data(), indexCount, vertices_.size());
+
+	// 頂点キャッシュ向けに三角形を並べ替え
+	std::vector<uint32_t> optimized(indexCount);
+	std::vector<uint32_t> clusters;
+	MeshOptimizer::OptimizeVertexCache(
+	  optimized.data(), indices_.data(), indexCount, vertices_.size(),
+	  MeshOptimizer::kDefaultCacheSize, &clusters);
+
+	// オーバードローが減るようにクラスタを並べ替え
+	MeshOptimizer::OptimizeOverdraw(
+	  optimized.data(), indexCount, &vertices_[0].pos.x, sizeof(VertexPosNormalUv),
+	  vertices_.size(), clusters);
+
+	// 頂点フェッチ向けに頂点を参照順に並べ替え
+	std::vector<uint32_t> remap(vertices_.size());
+	size_t vertexCount = MeshOptimizer::OptimizeVertexFetchRemap(
+	  remap.data(), optimized.data(), indexCount, vertices_.size());
+	MeshOptimizer::RemapVertices(vertices_, remap.data(), vertexCount);
+	if (!tangents_.empty()) {
+		MeshOptimizer::RemapVertices(tangents_, remap.data(), vertexCount);
+	}
+	indices_.swap(optimized);
+
+	// 平滑化用データも頂点と同じように並べ替える
+	if (!smoothPositions_.empty()) {
+		smoothPositions_.resize(remap.size(), UINT32_MAX);
+		MeshOptimizer::RemapVertices(smoothPositions_, remap.data(), vertexCount);
+	}
+
+	// 最適化後の統計
+	cacheStatisticsAfter_ =
+	  MeshOptimizer::AnalyzeVertexCache(indices_.data(), indices_.size(), vertices_.size());
+}
+
+void Mesh::BuildLods(uint32_t levelCount, float reduction) {
+	size_t baseIndexCount = indices_.size() / 3 * 3;
+	lods_.clear();
+	if (baseIndexCount == 0) {
+		return;
+	}
+	lods_.push_back({0, static_cast<uint32_t>(baseIndexCount), 0.0f});
+
+	levelCount = (std::min)(levelCount, kMaxLodLevels - 1);
+	std::vector<uint32_t> source(indices_.begin(), indices_.begin() + baseIndexCount);
+	std::vector<uint32_t> simplified(baseIndexCount);
+	std::vector<uint32_t> optimized(baseIndexCount);
+
+	for (uint32_t level = 1; level <= levelCount; level++) {
+		size_t targetIndexCount = static_cast<size_t>(float(source.size() / 3) * reduction) * 3;
+		if (targetIndexCount == 0) {
+			break;
 		}
-		normal = XMVector3Normalize(normal / (float)v.size());
 
-		for (unsigned short index : v) {
-			vertices_[index].normal = {normal.m128_f32[0], normal.m128_f32[1], normal.m128_f32[2]};
+		// 直前のレベルを簡略化（誤差の上限は設けず、三角形数で止める）
+		float error = 0.0f;
+		size_t indexCount = MeshSimplifier::Simplify(
+		  simplified.data(), source.data(), source.size(), &vertices_[0].pos.x,
+		  sizeof(VertexPosNormalUv), vertices_.size(), targetIndexCount, FLT_MAX, &error);
+
+		// ほとんど減らなければ打ち切り
+		if (indexCount == 0 || indexCount > source.size() * 9 / 10) {
+			break;
 		}
+
+		// 頂点キャッシュ向けに並べ替え
+		MeshOptimizer::OptimizeVertexCache(
+		  optimized.data(), simplified.data(), indexCount, vertices_.size());
+
+		// 誤差は直前のレベルからの累積
+		LodLevel lod;
+		lod.indexOffset = static_cast<uint32_t>(indices_.size());
+		lod.indexCount = static_cast<uint32_t>(indexCount);
+		lod.error = lods_.back().error + error;
+		indices_.insert(indices_.end(), optimized.begin(), optimized.begin() + indexCount);
+		lods_.push_back(lod);
+
+		source.assign(optimized.begin(), optimized.begin() + indexCount);
 	}
 }
 
+void Mesh::SetLods(const LodLevel* lods, size_t lodCount) { lods_.assign(lods, lods + lodCount); }
+
+void Mesh::BuildMeshlets() {
+	size_t indexCount = lods_.empty() ? indices_.size() : lods_[0].indexCount;
+	if (vertices_.empty()) {
+		meshlets_ = {};
+		return;
+	}
+	MeshletBuilder::Build(
+	  meshlets_, indices_.data(), indexCount, &vertices_[0].pos.x, sizeof(VertexPosNormalUv),
+	  vertices_.size());
+}
+
+void Mesh::CalculateBounds() {
+	if (vertices_.empty()) {
+		boxCenter_ = {0, 0, 0};
+		boxExtents_ = {0, 0, 0};
+		boundingSphere_ = {0, 0, 0, 0};
+		return;
+	}
+
+	// AABBの中心を球の中心とし、最も遠い頂点までを半径とする
+	XMVECTOR minimum = XMLoadFloat3(&vertices_[0].pos);
+	XMVECTOR maximum = minimum;
+	for (const VertexPosNormalUv& vertex : vertices_) {
+		XMVECTOR position = XMLoadFloat3(&vertex.pos);
+		minimum = XMVectorMin(minimum, position);
+		maximum = XMVectorMax(maximum, position);
+	}
+	XMVECTOR center = XMVectorScale(XMVectorAdd(minimum, maximum), 0.5f);
+	XMStoreFloat3(&boxCenter_, center);
+	XMStoreFloat3(&boxExtents_, XMVectorScale(XMVectorSubtract(maximum, minimum), 0.5f));
+	XMVECTOR radiusSq = XMVectorZero();
+	for (const VertexPosNormalUv& vertex : vertices_) {
+		radiusSq = XMVectorMax(
+		  radiusSq, XMVector3LengthSq(XMVectorSubtract(XMLoadFloat3(&vertex.pos), center)));
+	}
+	XMStoreFloat4(&boundingSphere_, XMVectorSetW(center, XMVectorGetX(XMVectorSqrt(radiusSq))));
+}
+
 void Mesh::SetMaterial(Material* material) { this->material_ = material; }
 
+DXGI_FORMAT Mesh::GetIndexFormat() const {
+	// 16bitで全頂点を指せるならR16_UINTで十分
+	return vertices_.size() <= 0xffff ? DXGI_FORMAT_R16_UINT : DXGI_FORMAT_R32_UINT;
+}
+
 void Mesh::CreateBuffers() {
 	HRESULT result;
 
-	UINT sizeVB = static_cast<UINT>(sizeof(VertexPosNormalUv) * vertices_.size());
+	// 接線がある場合は接線ありの頂点に詰め直す
+	std::vector<VertexPosNormalUvTangent> tangentVertices;
+	const void* vertexData = vertices_.data();
+	UINT vertexStride = sizeof(VertexPosNormalUv);
+	if (!tangents_.empty()) {
+		assert(tangents_.size() == vertices_.size());
+		tangentVertices.resize(vertices_.size());
+		for (size_t i = 0; i < vertices_.size(); i++) {
+			tangentVertices[i].pos = vertices_[i].pos;
+			tangentVertices[i].normal = vertices_[i].normal;
+			tangentVertices[i].uv = vertices_[i].uv;
+			tangentVertices[i].tangent = tangents_[i];
+		}
+		vertexData = tangentVertices.data();
+		vertexStride = sizeof(VertexPosNormalUvTangent);
+	}
+
+	UINT sizeVB = static_cast<UINT>(vertexStride * vertices_.size());
 
 	// ヒーププロパティ
 	CD3DX12_HEAP_PROPERTIES heapProps = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD);
@@ -55,24 +435,28 @@ void Mesh::CreateBuffers() {
 	assert(SUCCEEDED(result));
 
 	// 頂点バッファへのデータ転送
-	VertexPosNormalUv* vertMap = nullptr;
-	result = vertBuff_->Map(0, nullptr, (void**)&vertMap);
+	void* vertMap = nullptr;
+	result = vertBuff_->Map(0, nullptr, &vertMap);
 	if (SUCCEEDED(result)) {
-		std::copy(vertices_.begin(), vertices_.end(), vertMap);
+		memcpy(vertMap, vertexData, sizeVB);
 		vertBuff_->Unmap(0, nullptr);
 	}
 
 	// 頂点バッファビューの作成
 	vbView_.BufferLocation = vertBuff_->GetGPUVirtualAddress();
 	vbView_.SizeInBytes = sizeVB;
-	vbView_.StrideInBytes = sizeof(vertices_[0]);
+	vbView_.StrideInBytes = vertexStride;
 
 	if (FAILED(result)) {
 		assert(0);
 		return;
 	}
 
-	UINT sizeIB = static_cast<UINT>(sizeof(unsigned short) * indices_.size());
+	// インデックスの型は頂点数で切り替える
+	DXGI_FORMAT indexFormat = GetIndexFormat();
+	size_t indexStride =
+	  indexFormat == DXGI_FORMAT_R16_UINT ? sizeof(uint16_t) : sizeof(uint32_t);
+	UINT sizeIB = static_cast<UINT>(indexStride * indices_.size());
 	// リソース設定
 	resourceDesc.Width = sizeIB;
 	// インデックスバッファ生成
@@ -85,46 +469,69 @@ void Mesh::CreateBuffers() {
 	}
 
 	// インデックスバッファへのデータ転送
-	unsigned short* indexMap = nullptr;
-	result = indexBuff_->Map(0, nullptr, (void**)&indexMap);
+	void* indexMap = nullptr;
+	result = indexBuff_->Map(0, nullptr, &indexMap);
 	if (SUCCEEDED(result)) {
-		std::copy(indices_.begin(), indices_.end(), indexMap);
+		if (indexFormat == DXGI_FORMAT_R16_UINT) {
+			// 16bitに詰めて転送
+			uint16_t* indexMap16 = static_cast<uint16_t*>(indexMap);
+			for (size_t i = 0; i < indices_.size(); i++) {
+				indexMap16[i] = static_cast<uint16_t>(indices_[i]);
+			}
+		} else {
+			std::copy(indices_.begin(), indices_.end(), static_cast<uint32_t*>(indexMap));
+		}
 		indexBuff_->Unmap(0, nullptr);
 	}
 
 	// インデックスバッファビューの作成
 	ibView_.BufferLocation = indexBuff_->GetGPUVirtualAddress();
-	ibView_.Format = DXGI_FORMAT_R16_UINT;
+	ibView_.Format = indexFormat;
 	ibView_.SizeInBytes = sizeIB;
 }
 
 void Mesh::Draw(
-  ID3D12GraphicsCommandList* commandList, UINT rooParameterIndexMaterial,
+  RenderContext* renderContext, UINT rooParameterIndexMaterial,
   UINT rooParameterIndexTexture) {
-	// 頂点バッファをセット
-	commandList->IASetVertexBuffers(0, 1, &vbView_);
-	// インデックスバッファをセット
-	commandList->IASetIndexBuffer(&ibView_);
-
-	// マテリアルのグラフィックスコマンドをセット
-	material_->SetGraphicsCommand(commandList, rooParameterIndexMaterial, rooParameterIndexTexture);
-
-	// 描画コマンド
-	commandList->DrawIndexedInstanced((UINT)indices_.size(), 1, 0, 0, 0);
+	Draw(
+	  renderContext, rooParameterIndexMaterial, rooParameterIndexTexture,
+	  material_->GetTextureHadle(), 0);
 }
 
 void Mesh::Draw(
-  ID3D12GraphicsCommandList* commandList, UINT rooParameterIndexMaterial,
+  RenderContext* renderContext, UINT rooParameterIndexMaterial,
   UINT rooParameterIndexTexture, uint32_t textureHandle) {
+	Draw(renderContext, rooParameterIndexMaterial, rooParameterIndexTexture, textureHandle, 0);
+}
+
+void Mesh::Draw(
+  RenderContext* renderContext, UINT rooParameterIndexMaterial,
+  UINT rooParameterIndexTexture, uint32_t textureHandle, uint32_t lodLevel,
+  UINT instanceCount) {
 	// 頂点バッファをセット
-	commandList->IASetVertexBuffers(0, 1, &vbView_);
+	renderContext->SetVertexBuffers(0, 1, &vbView_);
 	// インデックスバッファをセット
-	commandList->IASetIndexBuffer(&ibView_);
+	renderContext->SetIndexBuffer(&ibView_);
 
 	// マテリアルのグラフィックスコマンドをセット
 	material_->SetGraphicsCommand(
-	  commandList, rooParameterIndexMaterial, rooParameterIndexTexture, textureHandle);
+	  renderContext, rooParameterIndexMaterial, rooParameterIndexTexture, textureHandle);
 
 	// 描画コマンド
-	commandList->DrawIndexedInstanced((UINT)indices_.size(), 1, 0, 0, 0);
+	UINT indexCount = 0;
+	UINT startIndex = 0;
+	GetIndexRange(lodLevel, indexCount, startIndex);
+	renderContext->DrawIndexedInstanced(indexCount, instanceCount, startIndex, 0, 0);
+}
+
+void Mesh::GetIndexRange(uint32_t lodLevel, UINT& indexCount, UINT& startIndex) const {
+	// LODがなければインデックス全体
+	if (lods_.empty()) {
+		indexCount = (UINT)indices_.size();
+		startIndex = 0;
+		return;
+	}
+	const LodLevel& lod = lods_[(std::min)(size_t(lodLevel), lods_.size() - 1)];
+	indexCount = lod.indexCount;
+	startIndex = lod.indexOffset;
 }
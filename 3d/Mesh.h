@@ -1,6 +1,9 @@
 ﻿#pragma once
 
 #include "Material.h"
+#include "MeshOptimizer.h"
+#include "MeshletBuilder.h"
+#include "RenderContext.h"
 #include <DirectXMath.h>
 #include <Windows.h>
 #include <d3d12.h>
@@ -9,6 +12,8 @@
 #include <vector>
 #include <wrl.h>
 
+class JobSystem;
+
 /// <summary>
 /// 形状データ
 /// </summary>
@@ -30,6 +35,26 @@ class Mesh {
 		XMFLOAT2 uv;     // uv座標
 	};
 
+	// 頂点データ構造体（接線あり）
+	// 先頭はVertexPosNormalUvと同じ配置なので、接線を使わないシェーダでもそのまま描画できる
+	struct VertexPosNormalUvTangent {
+		XMFLOAT3 pos;     // xyz座標
+		XMFLOAT3 normal;  // 法線ベクトル
+		XMFLOAT2 uv;      // uv座標
+		XMFLOAT4 tangent; // 接線ベクトル（wは従法線の向き ±1）
+	};
+
+	// 詳細度（LOD）レベル
+	// 全レベルのインデックスを1つのインデックスバッファに並べ、範囲で区別する
+	struct LodLevel {
+		uint32_t indexOffset; // 先頭インデックス
+		uint32_t indexCount;  // インデックス数
+		float error;          // 元の形状からの誤差（モデル空間の距離）
+	};
+
+	// LODレベルの最大数（元の形状を含む）
+	static const uint32_t kMaxLodLevels = 8;
+
   public: // メンバ関数
 	/// <summary>
 	/// 名前を取得
@@ -53,7 +78,18 @@ class Mesh {
 	/// 頂点インデックスの追加
 	/// </summary>
 	/// <param name="index">インデックス</param>
-	void AddIndex(unsigned short index);
+	void AddIndex(uint32_t index);
+
+	/// <summary>
+	/// 頂点データとインデックスをまとめてセット
+	/// </summary>
+	/// <param name="vertices">頂点データ配列</param>
+	/// <param name="vertexCount">頂点数</param>
+	/// <param name="indices">インデックス配列</param>
+	/// <param name="indexCount">インデックス数</param>
+	void SetGeometry(
+	  const VertexPosNormalUv* vertices, size_t vertexCount, const uint32_t* indices,
+	  size_t indexCount);
 
 	/// <summary>
 	/// 頂点データの数を取得
@@ -66,13 +102,123 @@ class Mesh {
 	/// </summary>
 	/// <param name="indexPosition">座標インデックス</param>
 	/// <param name="indexVertex">頂点インデックス</param>
-	void AddSmoothData(unsigned short indexPosition, unsigned short indexVertex);
+	void AddSmoothData(uint32_t indexPosition, uint32_t indexVertex);
 
 	/// <summary>
 	/// 平滑化された頂点法線の計算
+	/// 同じ座標を共有する頂点に、面積と角度で重み付けした面法線の和を割り当てる
 	/// </summary>
 	void CalculateSmoothedVertexNormals();
 
+	/// <summary>
+	/// 接線の計算（MikkTSpaceと同じ右手系の規約で、wに従法線の向きを入れる）
+	/// 法線が確定した後（平滑化より後）に行う
+	/// </summary>
+	/// <param name="jobSystem">三角形単位の並列処理に使うジョブシステム（nullptrなら逐次）</param>
+	void CalculateTangents(JobSystem* jobSystem = nullptr);
+
+	/// <summary>
+	/// 接線をまとめてセット
+	/// </summary>
+	/// <param name="tangents">接線配列（頂点数と同じ個数）</param>
+	/// <param name="tangentCount">接線数</param>
+	void SetTangents(const XMFLOAT4* tangents, size_t tangentCount);
+
+	/// <summary>
+	/// 接線を持っているか
+	/// </summary>
+	/// <returns>接線を持っていればtrue</returns>
+	bool HasTangents() const { return !tangents_.empty(); }
+
+	/// <summary>
+	/// 接線配列を取得
+	/// </summary>
+	/// <returns>接線配列</returns>
+	inline const std::vector<XMFLOAT4>& GetTangents() { return tangents_; }
+
+	/// <summary>
+	/// 頂点キャッシュ・オーバードロー・頂点フェッチの最適化
+	/// 頂点番号が変わるため、平滑化より後に行う
+	/// </summary>
+	void Optimize();
+
+	/// <summary>
+	/// 簡略化したLODレベルの生成
+	/// インデックス配列の後ろに追加するため、インデックスを扱う他の処理より後に行う
+	/// </summary>
+	/// <param name="levelCount">追加するレベル数</param>
+	/// <param name="reduction">1レベルごとの三角形数の比率</param>
+	void BuildLods(uint32_t levelCount, float reduction = 0.5f);
+
+	/// <summary>
+	/// LODレベルをまとめてセット
+	/// </summary>
+	/// <param name="lods">LODレベル配列</param>
+	/// <param name="lodCount">LODレベル数</param>
+	void SetLods(const LodLevel* lods, size_t lodCount);
+
+	/// <summary>
+	/// LODレベル配列を取得（空なら元の形状のみ）
+	/// </summary>
+	/// <returns>LODレベル配列</returns>
+	inline const std::vector<LodLevel>& GetLods() const { return lods_; }
+
+	/// <summary>
+	/// LODレベル数を取得（元の形状を含む）
+	/// </summary>
+	/// <returns>LODレベル数</returns>
+	size_t GetLodCount() const { return lods_.empty() ? 1 : lods_.size(); }
+
+	/// <summary>
+	/// メッシュレットの構築（最も詳細なLODレベルを分割する）
+	/// </summary>
+	void BuildMeshlets();
+
+	/// <summary>
+	/// メッシュレットを取得（空なら未構築）
+	/// </summary>
+	/// <returns>メッシュレット</returns>
+	const MeshletBuilder::MeshletData& GetMeshlets() const { return meshlets_; }
+
+	/// <summary>
+	/// 境界（軸平行な箱と球）の計算
+	/// </summary>
+	void CalculateBounds();
+
+	/// <summary>
+	/// 境界箱の中心を取得
+	/// </summary>
+	/// <returns>境界箱の中心</returns>
+	const XMFLOAT3& GetBoxCenter() const { return boxCenter_; }
+
+	/// <summary>
+	/// 境界箱の大きさを取得
+	/// </summary>
+	/// <returns>境界箱の中心から各面までの距離</returns>
+	const XMFLOAT3& GetBoxExtents() const { return boxExtents_; }
+
+	/// <summary>
+	/// 境界球を取得
+	/// </summary>
+	/// <returns>境界球（xyzが中心、wが半径）</returns>
+	const XMFLOAT4& GetBoundingSphere() const { return boundingSphere_; }
+
+	/// <summary>
+	/// 最適化前の頂点キャッシュ統計を取得
+	/// </summary>
+	/// <returns>頂点キャッシュ統計</returns>
+	const MeshOptimizer::VertexCacheStatistics& GetCacheStatisticsBefore() const {
+		return cacheStatisticsBefore_;
+	}
+
+	/// <summary>
+	/// 最適化後の頂点キャッシュ統計を取得
+	/// </summary>
+	/// <returns>頂点キャッシュ統計</returns>
+	const MeshOptimizer::VertexCacheStatistics& GetCacheStatisticsAfter() const {
+		return cacheStatisticsAfter_;
+	}
+
 	/// <summary>
 	/// マテリアルの取得
 	/// </summary>
@@ -102,27 +248,56 @@ class Mesh {
 	/// <returns>インデックスバッファ</returns>
 	const D3D12_INDEX_BUFFER_VIEW& GetIBView() { return ibView_; }
 
+	/// <summary>
+	/// インデックスバッファのフォーマット取得
+	/// 頂点数が16bitに収まる場合はR16_UINT、超える場合はR32_UINT
+	/// </summary>
+	/// <returns>インデックスフォーマット</returns>
+	DXGI_FORMAT GetIndexFormat() const;
+
+	/// <summary>
+	/// LODレベルの描画範囲を取得
+	/// </summary>
+	/// <param name="lodLevel">LODレベル</param>
+	/// <param name="indexCount">インデックス数</param>
+	/// <param name="startIndex">開始インデックス</param>
+	void GetIndexRange(uint32_t lodLevel, UINT& indexCount, UINT& startIndex) const;
+
 	/// <summary>
 	/// 描画
 	/// </summary>
-	/// <param name="commandList">命令発行先コマンドリスト</param>
+	/// <param name="renderContext">描画コマンドの発行先</param>
 	/// <param name="rooParameterIndexMaterial">マテリアルのルートパラメータ番号</param>
 	/// <param name="rooParameterIndexTexture">テクスチャのルートパラメータ番号</param>
 	void Draw(
-	  ID3D12GraphicsCommandList* commandList, UINT rooParameterIndexMaterial,
+	  RenderContext* renderContext, UINT rooParameterIndexMaterial,
 	  UINT rooParameterIndexTexture);
 
 	/// <summary>
 	/// 描画（テクスチャ差し替え版）
 	/// </summary>
-	/// <param name="commandList">命令発行先コマンドリスト</param>
+	/// <param name="renderContext">描画コマンドの発行先</param>
 	/// <param name="rooParameterIndexMaterial">マテリアルのルートパラメータ番号</param>
 	/// <param name="rooParameterIndexTexture">テクスチャのルートパラメータ番号</param>
 	/// <param name="textureHandle">差し替えるテクスチャハンドル</param>
 	void Draw(
-	  ID3D12GraphicsCommandList* commandList, UINT rooParameterIndexMaterial,
+	  RenderContext* renderContext, UINT rooParameterIndexMaterial,
 	  UINT rooParameterIndexTexture, uint32_t textureHandle);
 
+	/// <summary>
+	/// 描画（LODレベル指定版）
+	/// </summary>
+	/// <param name="renderContext">描画コマンドの発行先</param>
+	/// <param name="rooParameterIndexMaterial">マテリアルのルートパラメータ番号</param>
+	/// <param name="rooParameterIndexTexture">テクスチャのルートパラメータ番号</param>
+	/// <param name="textureHandle">テクスチャハンドル</param>
+	/// <param name="lodLevel">LODレベル</param>
+	/// <param name="instanceCount">インスタンス数</param>
+	void Draw(
+	  RenderContext* renderContext, UINT rooParameterIndexMaterial,
+	  UINT rooParameterIndexTexture, uint32_t textureHandle, uint32_t lodLevel,
+	  UINT instanceCount = 1);
+
 	/// <summary>
 	/// 頂点配列を取得
 	/// </summary>
@@ -133,7 +308,7 @@ class Mesh {
 	/// インデックス配列を取得
 	/// </summary>
 	/// <returns>インデックス配列</returns>
-	inline const std::vector<unsigned short>& GetIndices() { return indices_; }
+	inline const std::vector<uint32_t>& GetIndices() { return indices_; }
 
   private: // メンバ変数
 	// 名前
@@ -149,9 +324,25 @@ class Mesh {
 	// 頂点データ配列
 	std::vector<VertexPosNormalUv> vertices_;
 	// 頂点インデックス配列
-	std::vector<unsigned short> indices_;
-	// 頂点法線スムージング用データ
-	std::unordered_map<unsigned short, std::vector<unsigned short>> smoothData_;
+	std::vector<uint32_t> indices_;
+	// 接線配列（空なら接線なし）
+	std::vector<XMFLOAT4> tangents_;
+	// 頂点法線スムージング用データ（頂点ごとの座標インデックス、対象外はUINT32_MAX）
+	std::vector<uint32_t> smoothPositions_;
+	// LODレベル配列
+	std::vector<LodLevel> lods_;
+	// メッシュレット
+	MeshletBuilder::MeshletData meshlets_;
+	// 境界箱の中心
+	XMFLOAT3 boxCenter_ = {0, 0, 0};
+	// 境界箱の中心から各面までの距離
+	XMFLOAT3 boxExtents_ = {0, 0, 0};
+	// 境界球（xyzが中心、wが半径）
+	XMFLOAT4 boundingSphere_ = {0, 0, 0, 0};
 	// マテリアル
 	Material* material_ = nullptr;
+	// 最適化前の頂点キャッシュ統計
+	MeshOptimizer::VertexCacheStatistics cacheStatisticsBefore_;
+	// 最適化後の頂点キャッシュ統計
+	MeshOptimizer::VertexCacheStatistics cacheStatisticsAfter_;
 };
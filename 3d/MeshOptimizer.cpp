@@ -0,0 +1,298 @@
+﻿#include "MeshOptimizer.h"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+namespace {
+
+/// <summary>
+/// 頂点→三角形の隣接情報（CSR形式）
+/// </summary>
+struct TriangleAdjacency {
+	std::vector<uint32_t> offsets;   // 頂点ごとの先頭位置（vertexCount + 1個）
+	std::vector<uint32_t> triangles; // 三角形番号
+};
+
+// 隣接情報の構築
+void BuildTriangleAdjacency(
+  TriangleAdjacency& adjacency, const uint32_t* indices, size_t indexCount, size_t vertexCount) {
+	size_t triangleCount = indexCount / 3;
+
+	// 頂点ごとの三角形数を数えて累積和を取る
+	adjacency.offsets.assign(vertexCount + 1, 0);
+	for (size_t i = 0; i < triangleCount * 3; i++) {
+		adjacency.offsets[indices[i] + 1]++;
+	}
+	for (size_t v = 0; v < vertexCount; v++) {
+		adjacency.offsets[v + 1] += adjacency.offsets[v];
+	}
+
+	// 三角形番号を詰める
+	adjacency.triangles.resize(triangleCount * 3);
+	std::vector<uint32_t> cursor(adjacency.offsets.begin(), adjacency.offsets.end() - 1);
+	for (size_t i = 0; i < triangleCount * 3; i++) {
+		adjacency.triangles[cursor[indices[i]]++] = static_cast<uint32_t>(i / 3);
+	}
+}
+
+// float3の読み出し
+inline const float* GetPosition(const float* positions, size_t stride, uint32_t index) {
+	return reinterpret_cast<const float*>(
+	  reinterpret_cast<const char*>(positions) + stride * index);
+}
+
+} // namespace
+
+MeshOptimizer::VertexCacheStatistics MeshOptimizer::AnalyzeVertexCache(
+  const uint32_t* indices, size_t indexCount, size_t vertexCount, uint32_t cacheSize) {
+	VertexCacheStatistics statistics;
+	if (indexCount < 3 || vertexCount == 0) {
+		return statistics;
+	}
+
+	// 頂点ごとにキャッシュへ入った時刻を記録して、FIFOの残存を判定する
+	std::vector<uint32_t> cacheTimestamps(vertexCount, 0);
+	uint32_t timestamp = cacheSize + 1;
+	std::vector<bool> referenced(vertexCount, false);
+	size_t referencedCount = 0;
+
+	for (size_t i = 0; i < indexCount; i++) {
+		uint32_t index = indices[i];
+		assert(index < vertexCount);
+		if (timestamp - cacheTimestamps[index] > cacheSize) {
+			// キャッシュミス
+			cacheTimestamps[index] = timestamp++;
+			statistics.vertexTransforms++;
+		}
+		if (!referenced[index]) {
+			referenced[index] = true;
+			referencedCount++;
+		}
+	}
+
+	statistics.acmr = float(statistics.vertexTransforms) / float(indexCount / 3);
+	statistics.atvr = float(statistics.vertexTransforms) / float(referencedCount);
+	return statistics;
+}
+
+void MeshOptimizer::OptimizeVertexCache(
+  uint32_t* destination, const uint32_t* indices, size_t indexCount, size_t vertexCount,
+  uint32_t cacheSize, std::vector<uint32_t>* clusters) {
+	assert(destination != indices);
+	size_t triangleCount = indexCount / 3;
+	if (clusters) {
+		clusters->clear();
+	}
+	if (triangleCount == 0) {
+		return;
+	}
+
+	TriangleAdjacency adjacency;
+	BuildTriangleAdjacency(adjacency, indices, indexCount, vertexCount);
+
+	// 頂点ごとの未出力三角形数
+	std::vector<uint32_t> liveTriangles(vertexCount);
+	for (size_t v = 0; v < vertexCount; v++) {
+		liveTriangles[v] = adjacency.offsets[v + 1] - adjacency.offsets[v];
+	}
+
+	std::vector<uint32_t> cacheTimestamps(vertexCount, 0);
+	std::vector<bool> emitted(triangleCount, false);
+	// 行き止まり時に戻る候補のスタック
+	std::vector<uint32_t> deadEndStack;
+	// 候補頂点（直前のファンで出力した頂点）
+	std::vector<uint32_t> candidates;
+
+	uint32_t timestamp = cacheSize + 1;
+	size_t inputCursor = 0;
+	size_t outputCursor = 0;
+	int64_t fanningVertex = 0;
+
+	// 最初に三角形を持つ頂点から開始
+	while (fanningVertex < int64_t(vertexCount) && liveTriangles[size_t(fanningVertex)] == 0) {
+		fanningVertex++;
+	}
+	if (clusters) {
+		clusters->push_back(0);
+	}
+
+	while (fanningVertex >= 0 && fanningVertex < int64_t(vertexCount)) {
+		candidates.clear();
+
+		// ファン頂点を共有する未出力の三角形を全て出力
+		uint32_t f = uint32_t(fanningVertex);
+		for (uint32_t a = adjacency.offsets[f]; a < adjacency.offsets[f + 1]; a++) {
+			uint32_t triangle = adjacency.triangles[a];
+			if (emitted[triangle]) {
+				continue;
+			}
+			for (uint32_t k = 0; k < 3; k++) {
+				uint32_t v = indices[triangle * 3 + k];
+				destination[outputCursor++] = v;
+				deadEndStack.push_back(v);
+				candidates.push_back(v);
+				liveTriangles[v]--;
+				if (timestamp - cacheTimestamps[v] > cacheSize) {
+					cacheTimestamps[v] = timestamp++;
+				}
+			}
+			emitted[triangle] = true;
+		}
+
+		// 候補の中からキャッシュに残っていて、かつ三角形が残っている頂点を選ぶ
+		int64_t next = -1;
+		int64_t bestPriority = -1;
+		for (uint32_t v : candidates) {
+			if (liveTriangles[v] == 0) {
+				continue;
+			}
+			int64_t priority = 0;
+			// ファンを出力しても自身がキャッシュから追い出されないなら優先
+			if (int64_t(timestamp - cacheTimestamps[v]) + 2 * int64_t(liveTriangles[v]) <=
+			    int64_t(cacheSize)) {
+				priority = timestamp - cacheTimestamps[v];
+			}
+			if (priority > bestPriority) {
+				bestPriority = priority;
+				next = v;
+			}
+		}
+
+		// 行き止まり：スタックを遡り、それも尽きたら入力順で次を探す
+		if (next < 0) {
+			while (!deadEndStack.empty()) {
+				uint32_t d = deadEndStack.back();
+				deadEndStack.pop_back();
+				if (liveTriangles[d] > 0) {
+					next = d;
+					break;
+				}
+			}
+			while (next < 0 && inputCursor < vertexCount) {
+				if (liveTriangles[inputCursor] > 0) {
+					next = int64_t(inputCursor);
+				}
+				inputCursor++;
+			}
+			// 行き止まりからの再開をクラスタの境界とする
+			if (next >= 0 && clusters && outputCursor < triangleCount * 3) {
+				clusters->push_back(uint32_t(outputCursor / 3));
+			}
+		}
+
+		fanningVertex = next;
+	}
+
+	assert(outputCursor == triangleCount * 3);
+}
+
+void MeshOptimizer::OptimizeOverdraw(
+  uint32_t* indices, size_t indexCount, const float* positions, size_t positionStride,
+  size_t vertexCount, const std::vector<uint32_t>& clusters, float threshold,
+  uint32_t cacheSize) {
+	size_t triangleCount = indexCount / 3;
+	if (triangleCount == 0 || clusters.size() <= 1) {
+		return;
+	}
+
+	// メッシュ全体の中心（面積加重）とクラスタごとの中心・法線
+	struct ClusterInfo {
+		uint32_t begin;
+		uint32_t end;
+		float centroid[3];
+		float normal[3];
+		float sortKey;
+	};
+	std::vector<ClusterInfo> clusterInfos(clusters.size());
+	float meshCentroid[3] = {};
+	float meshArea = 0.0f;
+
+	for (size_t c = 0; c < clusters.size(); c++) {
+		ClusterInfo& info = clusterInfos[c];
+		info = {};
+		info.begin = clusters[c];
+		info.end = c + 1 < clusters.size() ? clusters[c + 1] : uint32_t(triangleCount);
+
+		float clusterArea = 0.0f;
+		for (uint32_t t = info.begin; t < info.end; t++) {
+			const float* p0 = GetPosition(positions, positionStride, indices[t * 3 + 0]);
+			const float* p1 = GetPosition(positions, positionStride, indices[t * 3 + 1]);
+			const float* p2 = GetPosition(positions, positionStride, indices[t * 3 + 2]);
+			float e1[3] = {p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2]};
+			float e2[3] = {p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2]};
+			// 外積（長さは面積の2倍）
+			float n[3] = {
+			  e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2],
+			  e1[0] * e2[1] - e1[1] * e2[0]};
+			float area = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+			for (int k = 0; k < 3; k++) {
+				info.centroid[k] += (p0[k] + p1[k] + p2[k]) / 3.0f * area;
+				info.normal[k] += n[k];
+			}
+			clusterArea += area;
+		}
+
+		for (int k = 0; k < 3; k++) {
+			meshCentroid[k] += info.centroid[k];
+			info.centroid[k] = clusterArea > 0.0f ? info.centroid[k] / clusterArea : 0.0f;
+		}
+		meshArea += clusterArea;
+	}
+	for (int k = 0; k < 3; k++) {
+		meshCentroid[k] = meshArea > 0.0f ? meshCentroid[k] / meshArea : 0.0f;
+	}
+
+	// 中心から外を向いているクラスタほど先に描く
+	for (ClusterInfo& info : clusterInfos) {
+		float length = std::sqrt(
+		  info.normal[0] * info.normal[0] + info.normal[1] * info.normal[1] +
+		  info.normal[2] * info.normal[2]);
+		info.sortKey = 0.0f;
+		if (length > 0.0f) {
+			for (int k = 0; k < 3; k++) {
+				info.sortKey += (info.centroid[k] - meshCentroid[k]) * info.normal[k] / length;
+			}
+		}
+	}
+	std::vector<uint32_t> order(clusterInfos.size());
+	for (uint32_t c = 0; c < order.size(); c++) {
+		order[c] = c;
+	}
+	std::stable_sort(order.begin(), order.end(), [&](uint32_t lhs, uint32_t rhs) {
+		return clusterInfos[lhs].sortKey > clusterInfos[rhs].sortKey;
+	});
+
+	std::vector<uint32_t> reordered;
+	reordered.reserve(triangleCount * 3);
+	for (uint32_t c : order) {
+		const ClusterInfo& info = clusterInfos[c];
+		reordered.insert(reordered.end(), indices + info.begin * 3, indices + info.end * 3);
+	}
+
+	// キャッシュ効率の悪化が許容範囲内なら採用
+	VertexCacheStatistics before =
+	  AnalyzeVertexCache(indices, triangleCount * 3, vertexCount, cacheSize);
+	VertexCacheStatistics after =
+	  AnalyzeVertexCache(reordered.data(), reordered.size(), vertexCount, cacheSize);
+	if (after.acmr <= before.acmr * threshold) {
+		std::copy(reordered.begin(), reordered.end(), indices);
+	}
+}
+
+size_t MeshOptimizer::OptimizeVertexFetchRemap(
+  uint32_t* remap, uint32_t* indices, size_t indexCount, size_t vertexCount) {
+	std::fill(remap, remap + vertexCount, UINT32_MAX);
+
+	// インデックスに現れた順に新しい番号を振る
+	uint32_t nextVertex = 0;
+	for (size_t i = 0; i < indexCount; i++) {
+		uint32_t& index = indices[i];
+		assert(index < vertexCount);
+		if (remap[index] == UINT32_MAX) {
+			remap[index] = nextVertex++;
+		}
+		index = remap[index];
+	}
+
+	return nextVertex;
+}
@@ -0,0 +1,96 @@
+﻿#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/// <summary>
+/// インデックス付き三角形リストの最適化
+/// GPUに依存せず、インデックス配列と頂点座標だけで処理する
+/// </summary>
+namespace MeshOptimizer {
+
+// 頂点キャッシュシミュレーションの標準サイズ（FIFO）
+const uint32_t kDefaultCacheSize = 16;
+
+/// <summary>
+/// 頂点キャッシュの統計
+/// </summary>
+struct VertexCacheStatistics {
+	uint32_t vertexTransforms = 0; // 頂点シェーダの実行回数
+	float acmr = 0.0f; // 三角形あたりの平均キャッシュミス数 (Average Cache Miss Ratio)
+	float atvr = 0.0f; // 頂点あたりの平均変換回数 (Average Transformed Vertex Ratio)
+};
+
+/// <summary>
+/// FIFO頂点キャッシュをシミュレーションして統計を求める
+/// </summary>
+/// <param name="indices">インデックス配列</param>
+/// <param name="indexCount">インデックス数</param>
+/// <param name="vertexCount">頂点数</param>
+/// <param name="cacheSize">キャッシュサイズ</param>
+/// <returns>統計</returns>
+VertexCacheStatistics AnalyzeVertexCache(
+  const uint32_t* indices, size_t indexCount, size_t vertexCount,
+  uint32_t cacheSize = kDefaultCacheSize);
+
+/// <summary>
+/// 頂点キャッシュ向けの三角形並べ替え（Tipsify）
+/// </summary>
+/// <param name="destination">出力インデックス配列（indicesと同じ長さ）</param>
+/// <param name="indices">入力インデックス配列</param>
+/// <param name="indexCount">インデックス数</param>
+/// <param name="vertexCount">頂点数</param>
+/// <param name="cacheSize">キャッシュサイズ</param>
+/// <param name="clusters">出力先の三角形クラスタ先頭番号（不要ならnullptr）</param>
+void OptimizeVertexCache(
+  uint32_t* destination, const uint32_t* indices, size_t indexCount, size_t vertexCount,
+  uint32_t cacheSize = kDefaultCacheSize, std::vector<uint32_t>* clusters = nullptr);
+
+/// <summary>
+/// オーバードロー削減のためのクラスタ並べ替え
+/// 外向きのクラスタを先に描くように並べ、ACMRの悪化が閾値以内の場合のみ採用する
+/// </summary>
+/// <param name="indices">インデックス配列（OptimizeVertexCacheの出力。書き換えられる）</param>
+/// <param name="indexCount">インデックス数</param>
+/// <param name="positions">頂点座標の先頭（float3）</param>
+/// <param name="positionStride">頂点座標のストライド（バイト）</param>
+/// <param name="vertexCount">頂点数</param>
+/// <param name="clusters">三角形クラスタ先頭番号</param>
+/// <param name="threshold">許容するACMRの悪化率</param>
+/// <param name="cacheSize">キャッシュサイズ</param>
+void OptimizeOverdraw(
+  uint32_t* indices, size_t indexCount, const float* positions, size_t positionStride,
+  size_t vertexCount, const std::vector<uint32_t>& clusters, float threshold = 1.05f,
+  uint32_t cacheSize = kDefaultCacheSize);
+
+/// <summary>
+/// 頂点フェッチ向けの頂点並べ替え表を作る（最初に参照された順）
+/// 参照されない頂点には UINT32_MAX が入る
+/// </summary>
+/// <param name="remap">出力先の並べ替え表（旧頂点番号→新頂点番号、vertexCount個）</param>
+/// <param name="indices">インデックス配列（新番号に書き換えられる）</param>
+/// <param name="indexCount">インデックス数</param>
+/// <param name="vertexCount">頂点数</param>
+/// <returns>並べ替え後の頂点数</returns>
+size_t OptimizeVertexFetchRemap(
+  uint32_t* remap, uint32_t* indices, size_t indexCount, size_t vertexCount);
+
+/// <summary>
+/// 並べ替え表に従って頂点配列を並べ替える
+/// </summary>
+/// <param name="vertices">頂点配列</param>
+/// <param name="remap">並べ替え表</param>
+/// <param name="newVertexCount">並べ替え後の頂点数</param>
+template<class T>
+void RemapVertices(std::vector<T>& vertices, const uint32_t* remap, size_t newVertexCount) {
+	std::vector<T> result(newVertexCount);
+	for (size_t i = 0; i < vertices.size(); i++) {
+		if (remap[i] != UINT32_MAX) {
+			result[remap[i]] = vertices[i];
+		}
+	}
+	vertices.swap(result);
+}
+
+} // namespace MeshOptimizer
@@ -0,0 +1,428 @@
+﻿#include "MeshSimplifier.h"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+/// <summary>
+/// 頂点の種類
+/// </summary>
+enum class VertexKind : uint8_t {
+	kManifold, // 内部の頂点（縮約できる）
+	kLocked,   // 継ぎ目・縁の頂点（動かさない）
+};
+
+/// <summary>
+/// 二次誤差（対称行列の上三角と重み）
+/// </summary>
+struct Quadric {
+	float a00, a11, a22;
+	float a10, a20, a21;
+	float b0, b1, b2;
+	float c;
+	float weight;
+};
+
+/// <summary>
+/// 縮約候補
+/// </summary>
+struct Collapse {
+	uint32_t from; // 消える頂点
+	uint32_t to;   // 残る頂点
+	float error;   // 誤差（距離の2乗）
+};
+
+// float3の読み出し
+inline const float* GetPosition(const float* positions, size_t stride, uint32_t index) {
+	return reinterpret_cast<const float*>(
+	  reinterpret_cast<const char*>(positions) + stride * index);
+}
+
+// 有向辺のキー
+inline uint64_t EdgeKey(uint32_t a, uint32_t b) { return (uint64_t(a) << 32) | b; }
+
+// 平面 ax + by + cz + d = 0 から二次誤差を作る
+Quadric MakePlaneQuadric(float a, float b, float c, float d, float weight) {
+	Quadric q;
+	q.a00 = a * a * weight;
+	q.a11 = b * b * weight;
+	q.a22 = c * c * weight;
+	q.a10 = a * b * weight;
+	q.a20 = a * c * weight;
+	q.a21 = b * c * weight;
+	q.b0 = a * d * weight;
+	q.b1 = b * d * weight;
+	q.b2 = c * d * weight;
+	q.c = d * d * weight;
+	q.weight = weight;
+	return q;
+}
+
+// 二次誤差の加算
+void AddQuadric(Quadric& q, const Quadric& r) {
+	q.a00 += r.a00;
+	q.a11 += r.a11;
+	q.a22 += r.a22;
+	q.a10 += r.a10;
+	q.a20 += r.a20;
+	q.a21 += r.a21;
+	q.b0 += r.b0;
+	q.b1 += r.b1;
+	q.b2 += r.b2;
+	q.c += r.c;
+	q.weight += r.weight;
+}
+
+// 点における誤差（重みで割った距離の2乗）
+float EvaluateQuadric(const Quadric& q, const float* p) {
+	float rx = q.b0 + q.a00 * p[0] + q.a10 * p[1] + q.a20 * p[2];
+	float ry = q.b1 + q.a10 * p[0] + q.a11 * p[1] + q.a21 * p[2];
+	float rz = q.b2 + q.a20 * p[0] + q.a21 * p[1] + q.a22 * p[2];
+	float r = q.c + 2.0f * (q.b0 * p[0] + q.b1 * p[1] + q.b2 * p[2]) +
+	          (rx - q.b0) * p[0] + (ry - q.b1) * p[1] + (rz - q.b2) * p[2];
+	return q.weight > 0.0f ? std::fabs(r) / q.weight : 0.0f;
+}
+
+// 三角形の法線（長さは面積の2倍）
+void TriangleNormal(const float* p0, const float* p1, const float* p2, float* n) {
+	float e1[3] = {p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2]};
+	float e2[3] = {p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2]};
+	n[0] = e1[1] * e2[2] - e1[2] * e2[1];
+	n[1] = e1[2] * e2[0] - e1[0] * e2[2];
+	n[2] = e1[0] * e2[1] - e1[1] * e2[0];
+}
+
+/// <summary>
+/// 座標が同じ頂点をまとめる表（頂点→代表頂点）
+/// </summary>
+std::vector<uint32_t> BuildPositionRemap(
+  const float* positions, size_t stride, size_t vertexCount) {
+	struct PositionHash {
+		const float* positions;
+		size_t stride;
+		size_t operator()(uint32_t index) const {
+			const float* p = GetPosition(positions, stride, index);
+			uint32_t bits[3];
+			memcpy(bits, p, sizeof(bits));
+			// -0.0と0.0を同じにする
+			for (uint32_t& b : bits) {
+				b = (b == 0x80000000u) ? 0u : b;
+			}
+			uint64_t hash = bits[0];
+			hash = hash * 0x9E3779B97F4A7C15ull ^ bits[1];
+			hash = hash * 0x9E3779B97F4A7C15ull ^ bits[2];
+			return static_cast<size_t>(hash ^ (hash >> 32));
+		}
+	};
+	struct PositionEqual {
+		const float* positions;
+		size_t stride;
+		bool operator()(uint32_t lhs, uint32_t rhs) const {
+			const float* a = GetPosition(positions, stride, lhs);
+			const float* b = GetPosition(positions, stride, rhs);
+			return a[0] == b[0] && a[1] == b[1] && a[2] == b[2];
+		}
+	};
+
+	std::unordered_map<uint32_t, uint32_t, PositionHash, PositionEqual> table(
+	  vertexCount, PositionHash{positions, stride}, PositionEqual{positions, stride});
+	std::vector<uint32_t> remap(vertexCount);
+	for (uint32_t v = 0; v < vertexCount; v++) {
+		remap[v] = table.emplace(v, v).first->second;
+	}
+	return remap;
+}
+
+} // namespace
+
+size_t MeshSimplifier::Simplify(
+  uint32_t* destination, const uint32_t* indices, size_t indexCount, const float* positions,
+  size_t positionStride, size_t vertexCount, size_t targetIndexCount, float targetError,
+  float* resultError) {
+	indexCount = indexCount / 3 * 3;
+	std::copy(indices, indices + indexCount, destination);
+	if (resultError) {
+		*resultError = 0.0f;
+	}
+	if (indexCount <= targetIndexCount || vertexCount == 0) {
+		return indexCount;
+	}
+
+	// 継ぎ目の検出（同じ座標に複数の頂点があれば継ぎ目）
+	std::vector<uint32_t> positionRemap =
+	  BuildPositionRemap(positions, positionStride, vertexCount);
+	std::vector<VertexKind> kinds(vertexCount, VertexKind::kManifold);
+	for (uint32_t v = 0; v < vertexCount; v++) {
+		if (positionRemap[v] != v) {
+			kinds[v] = VertexKind::kLocked;
+			kinds[positionRemap[v]] = VertexKind::kLocked;
+		}
+	}
+
+	// 縁の検出（逆向きの辺がない辺の両端は縁）
+	{
+		std::unordered_map<uint64_t, uint32_t> edgeCounts;
+		edgeCounts.reserve(indexCount);
+		for (size_t i = 0; i < indexCount; i += 3) {
+			for (int k = 0; k < 3; k++) {
+				uint32_t a = positionRemap[indices[i + k]];
+				uint32_t b = positionRemap[indices[i + (k + 1) % 3]];
+				edgeCounts[EdgeKey(a, b)]++;
+			}
+		}
+		for (size_t i = 0; i < indexCount; i += 3) {
+			for (int k = 0; k < 3; k++) {
+				uint32_t va = indices[i + k];
+				uint32_t vb = indices[i + (k + 1) % 3];
+				uint32_t a = positionRemap[va];
+				uint32_t b = positionRemap[vb];
+				auto reverse = edgeCounts.find(EdgeKey(b, a));
+				if (reverse == edgeCounts.end() || reverse->second != 1 ||
+				    edgeCounts[EdgeKey(a, b)] != 1) {
+					kinds[va] = VertexKind::kLocked;
+					kinds[vb] = VertexKind::kLocked;
+				}
+			}
+		}
+	}
+
+	// 頂点ごとの二次誤差（面積で重み付けした面の平面）
+	std::vector<Quadric> quadrics(vertexCount);
+	memset(quadrics.data(), 0, sizeof(Quadric) * vertexCount);
+	for (size_t i = 0; i < indexCount; i += 3) {
+		const float* p0 = GetPosition(positions, positionStride, indices[i + 0]);
+		const float* p1 = GetPosition(positions, positionStride, indices[i + 1]);
+		const float* p2 = GetPosition(positions, positionStride, indices[i + 2]);
+		float n[3];
+		TriangleNormal(p0, p1, p2, n);
+		float length = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+		if (length <= 0.0f) {
+			continue;
+		}
+		n[0] /= length;
+		n[1] /= length;
+		n[2] /= length;
+		float d = -(n[0] * p0[0] + n[1] * p0[1] + n[2] * p0[2]);
+		Quadric q = MakePlaneQuadric(n[0], n[1], n[2], d, length * 0.5f);
+		for (int k = 0; k < 3; k++) {
+			AddQuadric(quadrics[indices[i + k]], q);
+		}
+	}
+
+	std::vector<uint32_t> collapseTarget(vertexCount);
+	std::vector<bool> touched(vertexCount);
+	std::vector<uint32_t> offsets(vertexCount + 1);
+	std::vector<uint32_t> adjacency;
+	std::vector<Collapse> collapses;
+	// 座標で見た有向辺の数
+	std::unordered_map<uint64_t, uint32_t> positionEdges;
+	float maxError = 0.0f;
+	float targetErrorSq = targetError * targetError;
+
+	while (indexCount > targetIndexCount) {
+		size_t triangleCount = indexCount / 3;
+
+		// 頂点→三角形の隣接情報（CSR形式）
+		std::fill(offsets.begin(), offsets.end(), 0);
+		for (size_t i = 0; i < indexCount; i++) {
+			offsets[destination[i] + 1]++;
+		}
+		for (size_t v = 0; v < vertexCount; v++) {
+			offsets[v + 1] += offsets[v];
+		}
+		adjacency.resize(indexCount);
+		{
+			std::vector<uint32_t> cursor(offsets.begin(), offsets.end() - 1);
+			for (size_t i = 0; i < indexCount; i++) {
+				adjacency[cursor[destination[i]]++] = static_cast<uint32_t>(i / 3);
+			}
+		}
+
+		// 座標で見た有向辺
+		// 縫い目や極では同じ座標に複数の頂点があり、頂点番号の隣接情報だけでは辺の重なりが分からない
+		positionEdges.clear();
+		positionEdges.reserve(indexCount);
+		for (size_t i = 0; i < indexCount; i += 3) {
+			for (int k = 0; k < 3; k++) {
+				uint32_t a = positionRemap[destination[i + k]];
+				uint32_t b = positionRemap[destination[i + (k + 1) % 3]];
+				positionEdges[EdgeKey(a, b)]++;
+			}
+		}
+
+		// 縮約候補（内部の頂点から隣の頂点へ）
+		collapses.clear();
+		for (size_t i = 0; i < indexCount; i += 3) {
+			for (int k = 0; k < 3; k++) {
+				uint32_t a = destination[i + k];
+				uint32_t b = destination[i + (k + 1) % 3];
+				for (int dir = 0; dir < 2; dir++) {
+					uint32_t from = dir == 0 ? a : b;
+					uint32_t to = dir == 0 ? b : a;
+					if (kinds[from] != VertexKind::kManifold) {
+						continue;
+					}
+					Quadric q = quadrics[from];
+					AddQuadric(q, quadrics[to]);
+					float error = EvaluateQuadric(q, GetPosition(positions, positionStride, to));
+					if (error <= targetErrorSq) {
+						collapses.push_back({from, to, error});
+					}
+				}
+			}
+		}
+		if (collapses.empty()) {
+			break;
+		}
+		std::stable_sort(
+		  collapses.begin(), collapses.end(),
+		  [](const Collapse& lhs, const Collapse& rhs) { return lhs.error < rhs.error; });
+
+		// 誤差の小さい順に、互いに干渉しない縮約をまとめて適用
+		for (uint32_t v = 0; v < vertexCount; v++) {
+			collapseTarget[v] = v;
+		}
+		std::fill(touched.begin(), touched.end(), false);
+		size_t removedTriangles = 0;
+		size_t removableTriangles = (indexCount - targetIndexCount) / 3;
+		// 1回の走査で縮約しすぎると候補の誤差が古くなるので、残りの半分程度までにする
+		size_t passLimit = (std::max)(removableTriangles / 2, size_t(1));
+		size_t appliedCount = 0;
+
+		for (const Collapse& collapse : collapses) {
+			if (removedTriangles >= passLimit) {
+				break;
+			}
+			uint32_t from = collapse.from;
+			uint32_t to = collapse.to;
+			if (touched[from] || touched[to]) {
+				continue;
+			}
+
+			// 三角形の裏返りチェック
+			const float* target = GetPosition(positions, positionStride, to);
+			bool flipped = false;
+			size_t sharedTriangles = 0;
+			for (uint32_t a = offsets[from]; a < offsets[from + 1] && !flipped; a++) {
+				const uint32_t* tri = &destination[adjacency[a] * 3];
+				if (tri[0] == to || tri[1] == to || tri[2] == to) {
+					sharedTriangles++;
+					continue;
+				}
+				const float* p[3];
+				const float* q[3];
+				for (int k = 0; k < 3; k++) {
+					p[k] = GetPosition(positions, positionStride, tri[k]);
+					q[k] = tri[k] == from ? target : p[k];
+				}
+				float before[3];
+				float after[3];
+				TriangleNormal(p[0], p[1], p[2], before);
+				TriangleNormal(q[0], q[1], q[2], after);
+				float dot = before[0] * after[0] + before[1] * after[1] + before[2] * after[2];
+				float afterLengthSq =
+				  after[0] * after[0] + after[1] * after[1] + after[2] * after[2];
+				if (dot <= 0.0f || afterLengthSq <= 0.0f) {
+					flipped = true;
+				}
+			}
+			if (flipped || sharedTriangles == 0) {
+				continue;
+			}
+
+			// 縮約で作られる辺が消える三角形以外に既にあれば、面が重なって閉じなくなるので縮約しない
+			uint32_t toPosition = positionRemap[to];
+			auto countRemainingEdges = [&](uint32_t a, uint32_t b) {
+				auto edge = positionEdges.find(EdgeKey(a, b));
+				uint32_t count = edge == positionEdges.end() ? 0 : edge->second;
+				for (uint32_t t = offsets[from]; t < offsets[from + 1]; t++) {
+					const uint32_t* tri = &destination[adjacency[t] * 3];
+					if (tri[0] != to && tri[1] != to && tri[2] != to) {
+						continue;
+					}
+					for (int k = 0; k < 3; k++) {
+						if (positionRemap[tri[k]] == a && positionRemap[tri[(k + 1) % 3]] == b) {
+							count--;
+						}
+					}
+				}
+				return count;
+			};
+			bool overlapped = false;
+			for (uint32_t a = offsets[from]; a < offsets[from + 1] && !overlapped; a++) {
+				const uint32_t* tri = &destination[adjacency[a] * 3];
+				if (tri[0] == to || tri[1] == to || tri[2] == to) {
+					continue;
+				}
+				for (int k = 0; k < 3; k++) {
+					if (tri[k] != from) {
+						continue;
+					}
+					uint32_t next = positionRemap[tri[(k + 1) % 3]];
+					uint32_t previous = positionRemap[tri[(k + 2) % 3]];
+					if (
+					  countRemainingEdges(toPosition, next) > 0 ||
+					  countRemainingEdges(previous, toPosition) > 0) {
+						overlapped = true;
+					}
+				}
+			}
+			if (overlapped) {
+				continue;
+			}
+
+			// 縮約を適用（周囲の頂点はこの走査では動かさない）
+			collapseTarget[from] = to;
+			for (uint32_t a = offsets[from]; a < offsets[from + 1]; a++) {
+				const uint32_t* tri = &destination[adjacency[a] * 3];
+				touched[tri[0]] = true;
+				touched[tri[1]] = true;
+				touched[tri[2]] = true;
+
+				// 座標で見た有向辺を縮約後に合わせる
+				bool shared = tri[0] == to || tri[1] == to || tri[2] == to;
+				for (int k = 0; k < 3; k++) {
+					uint32_t va = tri[k];
+					uint32_t vb = tri[(k + 1) % 3];
+					positionEdges[EdgeKey(positionRemap[va], positionRemap[vb])]--;
+					if (!shared) {
+						va = va == from ? to : va;
+						vb = vb == from ? to : vb;
+						positionEdges[EdgeKey(positionRemap[va], positionRemap[vb])]++;
+					}
+				}
+			}
+			AddQuadric(quadrics[to], quadrics[from]);
+			maxError = (std::max)(maxError, collapse.error);
+			removedTriangles += sharedTriangles;
+			appliedCount++;
+		}
+		if (appliedCount == 0) {
+			break;
+		}
+
+		// インデックスの書き換えと縮退三角形の除去
+		size_t writeCursor = 0;
+		for (size_t t = 0; t < triangleCount; t++) {
+			uint32_t a = collapseTarget[destination[t * 3 + 0]];
+			uint32_t b = collapseTarget[destination[t * 3 + 1]];
+			uint32_t c = collapseTarget[destination[t * 3 + 2]];
+			if (a == b || b == c || c == a) {
+				continue;
+			}
+			destination[writeCursor++] = a;
+			destination[writeCursor++] = b;
+			destination[writeCursor++] = c;
+		}
+		indexCount = writeCursor;
+	}
+
+	if (resultError) {
+		*resultError = std::sqrt(maxError);
+	}
+	return indexCount;
+}
@@ -0,0 +1,32 @@
+﻿#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/// <summary>
+/// 二次誤差（Quadric Error Metric）による辺の縮約で三角形を減らす
+/// GPUに依存せず、インデックス配列と頂点座標だけで処理する
+/// </summary>
+namespace MeshSimplifier {
+
+/// <summary>
+/// インデックス配列の簡略化
+/// 頂点は移動せず、既存の頂点へ縮約する（頂点バッファを全レベルで共有できる）
+/// UVや法線の継ぎ目の頂点と、穴の縁の頂点は形状を保つため動かさない
+/// </summary>
+/// <param name="destination">出力インデックス配列（indexCount以上の領域）</param>
+/// <param name="indices">入力インデックス配列</param>
+/// <param name="indexCount">インデックス数</param>
+/// <param name="positions">頂点座標の先頭（float3）</param>
+/// <param name="positionStride">頂点座標のストライド（バイト）</param>
+/// <param name="vertexCount">頂点数</param>
+/// <param name="targetIndexCount">目標のインデックス数</param>
+/// <param name="targetError">許容する誤差（モデル空間の距離）</param>
+/// <param name="resultError">出力先の誤差（モデル空間の距離、不要ならnullptr）</param>
+/// <returns>出力したインデックス数</returns>
+size_t Simplify(
+  uint32_t* destination, const uint32_t* indices, size_t indexCount, const float* positions,
+  size_t positionStride, size_t vertexCount, size_t targetIndexCount, float targetError,
+  float* resultError = nullptr);
+
+} // namespace MeshSimplifier
@@ -0,0 +1,247 @@
+﻿#include "MeshletBuilder.h"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+namespace {
+
+// 組み立て中のメッシュレットに入っていない頂点の印
+const uint8_t kUnusedLocalIndex = 0xff;
+
+// float3の読み出し
+inline const float* GetPosition(const float* positions, size_t stride, uint32_t index) {
+	return reinterpret_cast<const float*>(
+	  reinterpret_cast<const char*>(positions) + stride * index);
+}
+
+// 組み立て中のメッシュレットを境界付きで確定する
+void ComputeBounds(
+  MeshletBuilder::MeshletBounds& bounds, const MeshletBuilder::MeshletData& data,
+  const MeshletBuilder::Meshlet& meshlet, const float* positions, size_t stride) {
+	bounds = {};
+
+	// 境界球（AABBの中心から最も遠い頂点まで）
+	float minimum[3] = {INFINITY, INFINITY, INFINITY};
+	float maximum[3] = {-INFINITY, -INFINITY, -INFINITY};
+	for (uint32_t i = 0; i < meshlet.vertexCount; i++) {
+		const float* p = GetPosition(positions, stride, data.vertices[meshlet.vertexOffset + i]);
+		for (int k = 0; k < 3; k++) {
+			minimum[k] = (std::min)(minimum[k], p[k]);
+			maximum[k] = (std::max)(maximum[k], p[k]);
+		}
+	}
+	for (int k = 0; k < 3; k++) {
+		bounds.center[k] = (minimum[k] + maximum[k]) * 0.5f;
+	}
+	float radiusSq = 0.0f;
+	for (uint32_t i = 0; i < meshlet.vertexCount; i++) {
+		const float* p = GetPosition(positions, stride, data.vertices[meshlet.vertexOffset + i]);
+		float d[3] = {p[0] - bounds.center[0], p[1] - bounds.center[1], p[2] - bounds.center[2]};
+		radiusSq = (std::max)(radiusSq, d[0] * d[0] + d[1] * d[1] + d[2] * d[2]);
+	}
+	bounds.radius = std::sqrt(radiusSq);
+
+	// 法線コーン（面の向きの平均を軸とし、最も離れた面との角度を広がりとする）
+	std::vector<float> normals(meshlet.triangleCount * 3);
+	float axis[3] = {};
+	for (uint32_t t = 0; t < meshlet.triangleCount; t++) {
+		const uint8_t* tri = &data.triangles[meshlet.triangleOffset + t * 3];
+		const float* p0 = GetPosition(positions, stride, data.vertices[meshlet.vertexOffset + tri[0]]);
+		const float* p1 = GetPosition(positions, stride, data.vertices[meshlet.vertexOffset + tri[1]]);
+		const float* p2 = GetPosition(positions, stride, data.vertices[meshlet.vertexOffset + tri[2]]);
+		float e1[3] = {p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2]};
+		float e2[3] = {p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2]};
+		float* n = &normals[t * 3];
+		n[0] = e1[1] * e2[2] - e1[2] * e2[1];
+		n[1] = e1[2] * e2[0] - e1[0] * e2[2];
+		n[2] = e1[0] * e2[1] - e1[1] * e2[0];
+		float length = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+		for (int k = 0; k < 3; k++) {
+			n[k] = length > 0.0f ? n[k] / length : 0.0f;
+			axis[k] += n[k];
+		}
+	}
+	float axisLength = std::sqrt(axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2]);
+	if (axisLength <= 0.0f) {
+		bounds.coneCutoff = 2.0f;
+		return;
+	}
+	float minDot = 1.0f;
+	for (int k = 0; k < 3; k++) {
+		bounds.coneAxis[k] = axis[k] / axisLength;
+	}
+	for (uint32_t t = 0; t < meshlet.triangleCount; t++) {
+		const float* n = &normals[t * 3];
+		float dot = n[0] * bounds.coneAxis[0] + n[1] * bounds.coneAxis[1] + n[2] * bounds.coneAxis[2];
+		minDot = (std::min)(minDot, dot);
+	}
+	// 半球を超えて広がっていれば裏面判定に使えない
+	bounds.coneCutoff = minDot <= 0.0f ? 2.0f : std::sqrt(1.0f - minDot * minDot);
+}
+
+} // namespace
+
+void MeshletBuilder::Build(
+  MeshletData& result, const uint32_t* indices, size_t indexCount, const float* positions,
+  size_t positionStride, size_t vertexCount, uint32_t maxVertices, uint32_t maxTriangles) {
+	assert(maxVertices >= 3 && maxVertices <= kVertexLimit);
+	assert(maxTriangles >= 1);
+	result = {};
+	size_t triangleCount = indexCount / 3;
+	if (triangleCount == 0) {
+		return;
+	}
+
+	// 頂点→三角形の隣接情報（CSR形式）
+	std::vector<uint32_t> offsets(vertexCount + 1, 0);
+	for (size_t i = 0; i < triangleCount * 3; i++) {
+		offsets[indices[i] + 1]++;
+	}
+	for (size_t v = 0; v < vertexCount; v++) {
+		offsets[v + 1] += offsets[v];
+	}
+	std::vector<uint32_t> adjacency(triangleCount * 3);
+	{
+		std::vector<uint32_t> cursor(offsets.begin(), offsets.end() - 1);
+		for (size_t i = 0; i < triangleCount * 3; i++) {
+			adjacency[cursor[indices[i]]++] = static_cast<uint32_t>(i / 3);
+		}
+	}
+
+	// 組み立て中のメッシュレット内での頂点番号
+	std::vector<uint8_t> localIndices(vertexCount, kUnusedLocalIndex);
+	std::vector<bool> emitted(triangleCount, false);
+	// 組み立て中のメッシュレットに隣接する三角形の候補
+	std::vector<uint32_t> candidates;
+
+	Meshlet meshlet = {};
+	// 組み立て中のメッシュレットの頂点座標の和
+	float centerSum[3] = {};
+	size_t seedCursor = 0;
+	size_t emittedCount = 0;
+
+	// 組み立て中のメッシュレットを確定
+	auto flush = [&]() {
+		if (meshlet.triangleCount == 0) {
+			return;
+		}
+		for (uint32_t i = 0; i < meshlet.vertexCount; i++) {
+			localIndices[result.vertices[meshlet.vertexOffset + i]] = kUnusedLocalIndex;
+		}
+		result.meshlets.push_back(meshlet);
+		meshlet = {};
+		centerSum[0] = centerSum[1] = centerSum[2] = 0.0f;
+		meshlet.vertexOffset = static_cast<uint32_t>(result.vertices.size());
+		meshlet.triangleOffset = static_cast<uint32_t>(result.triangles.size());
+		candidates.clear();
+	};
+
+	// 三角形を追加したときに増える頂点数
+	auto newVertexCount = [&](uint32_t triangle) {
+		uint32_t count = 0;
+		for (int k = 0; k < 3; k++) {
+			count += localIndices[indices[triangle * 3 + k]] == kUnusedLocalIndex ? 1 : 0;
+		}
+		return count;
+	};
+
+	while (emittedCount < triangleCount) {
+		// 候補の中から増える頂点が最も少ない三角形を選ぶ（同じならメッシュレットの中心に近いもの）
+		int64_t best = -1;
+		uint32_t bestCost = 4;
+		float bestDistance = INFINITY;
+		float center[3] = {};
+		if (meshlet.vertexCount > 0) {
+			for (int k = 0; k < 3; k++) {
+				center[k] = centerSum[k] / float(meshlet.vertexCount);
+			}
+		}
+		for (size_t c = 0; c < candidates.size();) {
+			uint32_t triangle = candidates[c];
+			if (emitted[triangle]) {
+				candidates[c] = candidates.back();
+				candidates.pop_back();
+				continue;
+			}
+			c++;
+			uint32_t cost = newVertexCount(triangle);
+			if (cost > bestCost) {
+				continue;
+			}
+			float distance = 0.0f;
+			for (int k = 0; k < 3; k++) {
+				const float* p = GetPosition(positions, positionStride, indices[triangle * 3 + k]);
+				float d[3] = {p[0] - center[0], p[1] - center[1], p[2] - center[2]};
+				distance += d[0] * d[0] + d[1] * d[1] + d[2] * d[2];
+			}
+			if (cost < bestCost || distance < bestDistance ||
+			    (distance == bestDistance && triangle < best)) {
+				bestCost = cost;
+				bestDistance = distance;
+				best = triangle;
+			}
+		}
+
+		// 候補がなければ入力順で次の未使用の三角形から始める
+		if (best < 0) {
+			while (emitted[seedCursor]) {
+				seedCursor++;
+			}
+			best = int64_t(seedCursor);
+			bestCost = newVertexCount(uint32_t(best));
+		}
+
+		// 上限を超えるなら確定して新しいメッシュレットにする
+		if (meshlet.vertexCount + bestCost > maxVertices || meshlet.triangleCount >= maxTriangles) {
+			flush();
+			continue;
+		}
+
+		// 三角形を追加
+		uint32_t triangle = uint32_t(best);
+		for (int k = 0; k < 3; k++) {
+			uint32_t v = indices[triangle * 3 + k];
+			if (localIndices[v] == kUnusedLocalIndex) {
+				localIndices[v] = static_cast<uint8_t>(meshlet.vertexCount++);
+				result.vertices.push_back(v);
+				const float* p = GetPosition(positions, positionStride, v);
+				centerSum[0] += p[0];
+				centerSum[1] += p[1];
+				centerSum[2] += p[2];
+				// 新しく入った頂点の三角形を候補に加える
+				for (uint32_t a = offsets[v]; a < offsets[v + 1]; a++) {
+					if (!emitted[adjacency[a]]) {
+						candidates.push_back(adjacency[a]);
+					}
+				}
+			}
+			result.triangles.push_back(localIndices[v]);
+		}
+		meshlet.triangleCount++;
+		emitted[triangle] = true;
+		emittedCount++;
+	}
+	flush();
+
+	// 境界の計算
+	result.bounds.resize(result.meshlets.size());
+	for (size_t m = 0; m < result.meshlets.size(); m++) {
+		ComputeBounds(result.bounds[m], result, result.meshlets[m], positions, positionStride);
+	}
+}
+
+bool MeshletBuilder::IsBackfacing(const MeshletBounds& bounds, const float cameraPosition[3]) {
+	if (bounds.coneCutoff > 1.0f) {
+		return false;
+	}
+
+	// 球の中心への向きとコーンの軸が、球の大きさを考慮しても同じ側を向いていれば裏面
+	float toCenter[3] = {
+	  bounds.center[0] - cameraPosition[0], bounds.center[1] - cameraPosition[1],
+	  bounds.center[2] - cameraPosition[2]};
+	float distance =
+	  std::sqrt(toCenter[0] * toCenter[0] + toCenter[1] * toCenter[1] + toCenter[2] * toCenter[2]);
+	float dot = toCenter[0] * bounds.coneAxis[0] + toCenter[1] * bounds.coneAxis[1] +
+	            toCenter[2] * bounds.coneAxis[2];
+	return dot >= bounds.coneCutoff * distance + bounds.radius;
+}
@@ -0,0 +1,75 @@
+﻿#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/// <summary>
+/// 三角形リストを小さなクラスタ（メッシュレット）に分割する
+/// GPUに依存せず、インデックス配列と頂点座標だけで処理する
+/// </summary>
+namespace MeshletBuilder {
+
+// メッシュレットあたりの最大頂点数
+const uint32_t kMaxVertices = 64;
+// メッシュレットあたりの最大三角形数
+const uint32_t kMaxTriangles = 124;
+// 指定できる最大頂点数の上限（メッシュレット内の頂点番号はuint8_tで、0xffは未使用の印に使う）
+const uint32_t kVertexLimit = 255;
+
+/// <summary>
+/// メッシュレット
+/// </summary>
+struct Meshlet {
+	uint32_t vertexOffset;   // MeshletData::verticesの先頭位置
+	uint32_t triangleOffset; // MeshletData::trianglesの先頭位置（3要素で1三角形）
+	uint32_t vertexCount;    // 頂点数
+	uint32_t triangleCount;  // 三角形数
+};
+
+/// <summary>
+/// メッシュレットの境界
+/// </summary>
+struct MeshletBounds {
+	float center[3];   // 境界球の中心
+	float radius;      // 境界球の半径
+	float coneAxis[3]; // 法線コーンの軸（面の向きの平均）
+	float coneCutoff;  // 法線コーンの広がり（sin）。1より大きければ裏面判定しない
+};
+
+/// <summary>
+/// メッシュレットの集合
+/// </summary>
+struct MeshletData {
+	std::vector<Meshlet> meshlets;      // メッシュレット
+	std::vector<MeshletBounds> bounds;  // メッシュレットごとの境界
+	std::vector<uint32_t> vertices;     // メッシュレット内の頂点番号 → メッシュの頂点番号
+	std::vector<uint8_t> triangles;     // メッシュレット内の頂点番号による三角形
+};
+
+/// <summary>
+/// メッシュレットの構築
+/// 頂点を共有する三角形から優先して詰め、1つの三角形は必ず1つのメッシュレットに入る
+/// </summary>
+/// <param name="result">出力先</param>
+/// <param name="indices">インデックス配列</param>
+/// <param name="indexCount">インデックス数</param>
+/// <param name="positions">頂点座標の先頭（float3）</param>
+/// <param name="positionStride">頂点座標のストライド（バイト）</param>
+/// <param name="vertexCount">頂点数</param>
+/// <param name="maxVertices">メッシュレットあたりの最大頂点数（kVertexLimit以下）</param>
+/// <param name="maxTriangles">メッシュレットあたりの最大三角形数</param>
+void Build(
+  MeshletData& result, const uint32_t* indices, size_t indexCount, const float* positions,
+  size_t positionStride, size_t vertexCount, uint32_t maxVertices = kMaxVertices,
+  uint32_t maxTriangles = kMaxTriangles);
+
+/// <summary>
+/// 法線コーンによる裏面判定
+/// </summary>
+/// <param name="bounds">メッシュレットの境界（カメラと同じ座標系）</param>
+/// <param name="cameraPosition">カメラ座標</param>
+/// <returns>全ての三角形が裏を向いていればtrue</returns>
+bool IsBackfacing(const MeshletBounds& bounds, const float cameraPosition[3]);
+
+} // namespace MeshletBuilder
@@ -1,26 +1,121 @@
-﻿#include "DirectXCommon.h"
+﻿#include "CookedModel.h"
+#include "D3D12RenderContext.h"
+#include "DirectXCommon.h"
+#include "Frustum.h"
+#include "JobSystem.h"
+#include "MappedFile.h"
 #include "Model.h"
+#include "ObjTokenizer.h"
+#include "TransformSystem.h"
+#include "WinApp.h"
 #include <algorithm>
 #include <cassert>
+#include <cstring>
 #include <d3dcompiler.h>
 #include <fstream>
-#include <sstream>
 
 #pragma comment(lib, "d3dcompiler.lib")
 
 using namespace std;
 using namespace Microsoft::WRL;
 
+namespace {
+
+/// <summary>
+/// 頂点溶接用のキー（座標・UV・法線番号の組み合わせ）
+/// </summary>
+struct FaceVertexKey {
+	int32_t position;
+	int32_t texcoord;
+	int32_t normal;
+
+	bool operator==(const FaceVertexKey& other) const {
+		return position == other.position && texcoord == other.texcoord &&
+		       normal == other.normal;
+	}
+};
+
+/// <summary>
+/// 頂点溶接用キーのハッシュ
+/// </summary>
+struct FaceVertexKeyHash {
+	size_t operator()(const FaceVertexKey& key) const {
+		uint64_t hash = static_cast<uint32_t>(key.position);
+		hash = hash * 0x9E3779B97F4A7C15ull ^ static_cast<uint32_t>(key.texcoord);
+		hash = hash * 0x9E3779B97F4A7C15ull ^ static_cast<uint32_t>(key.normal);
+		return static_cast<size_t>(hash ^ (hash >> 32));
+	}
+};
+
+/// <summary>
+/// 元ファイルのサイズと更新日時を取得
+/// </summary>
+bool GetSourceStamp(
+  const std::string& directoryPath, const std::string& fileName,
+  CookedModel::SourceEntry& entry) {
+	if (fileName.size() >= CookedModel::kPathLength) {
+		return false;
+	}
+	WIN32_FILE_ATTRIBUTE_DATA attributes{};
+	if (!GetFileAttributesExA(
+	      (directoryPath + fileName).c_str(), GetFileExInfoStandard, &attributes)) {
+		return false;
+	}
+	entry = {};
+	fileName.copy(entry.fileName, fileName.size());
+	entry.fileSize = (uint64_t(attributes.nFileSizeHigh) << 32) | attributes.nFileSizeLow;
+	entry.lastWriteTime = (uint64_t(attributes.ftLastWriteTime.dwHighDateTime) << 32) |
+	                      attributes.ftLastWriteTime.dwLowDateTime;
+	return true;
+}
+
+/// <summary>
+/// 固定長の文字列領域に書き込む（収まらない分は切り捨て）
+/// </summary>
+template<size_t N> void CopyFixedString(char (&dest)[N], const std::string& src) {
+	size_t length = (std::min)(src.size(), N - 1);
+	src.copy(dest, length);
+	dest[length] = '\0';
+}
+
+/// <summary>
+/// 固定長の文字列領域から読み込む
+/// </summary>
+template<size_t N> std::string ReadFixedString(const char (&src)[N]) {
+	return std::string(src, strnlen(src, N));
+}
+
+/// <summary>
+/// アライメントに合わせて切り上げ
+/// </summary>
+inline uint64_t AlignUp(uint64_t value, uint64_t alignment) {
+	return (value + alignment - 1) & ~(alignment - 1);
+}
+
+/// <summary>
+/// パイプラインでアルファブレンドするか（並べ替える時は奥から手前へ描く）
+/// </summary>
+const bool kBlendEnable = true;
+
+} // namespace
+
 /// <summary>
 /// 静的メンバ変数の実体
 /// </summary>
 const std::string Model::kBaseDirectory = "Resources/";
 const std::string Model::kDefaultModelName = "cube";
 UINT Model::sDescriptorHandleIncrementSize_ = 0;
-ID3D12GraphicsCommandList* Model::sCommandList_ = nullptr;
+RenderContext* Model::sRenderContext_ = nullptr;
 ComPtr<ID3D12RootSignature> Model::sRootSignature_;
 ComPtr<ID3D12PipelineState> Model::sPipelineState_;
+ComPtr<ID3D12PipelineState> Model::sInstancedPipelineState_;
 std::unique_ptr<LightGroup> Model::lightGroup;
+float Model::sLodErrorThreshold_ = 1.0f;
+bool Model::sFrustumCulling_ = true;
+bool Model::sSortDraws_ = true;
+RenderQueue Model::sRenderQueue_;
+uint32_t Model::sDrawnMeshCount_ = 0;
+uint32_t Model::sCulledMeshCount_ = 0;
 
 void Model::StaticInitialize() {
 
@@ -79,6 +174,28 @@ void Model::InitializeGraphicsPipeline() {
 		exit(1);
 	}
 
+	// インスタンス描画用頂点シェーダの読み込みとコンパイル
+	ComPtr<ID3DBlob> instancedVsBlob;
+	result = D3DCompileFromFile(
+	  L"Resources/shaders/ObjInstancedVS.hlsl", // シェーダファイル名
+	  nullptr,
+	  D3D_COMPILE_STANDARD_FILE_INCLUDE, // インクルード可能にする
+	  "main", "vs_5_0", // エントリーポイント名、シェーダーモデル指定
+	  D3DCOMPILE_DEBUG | D3DCOMPILE_SKIP_OPTIMIZATION, // デバッグ用設定
+	  0, &instancedVsBlob, &errorBlob);
+	if (FAILED(result)) {
+		// errorBlobからエラー内容をstring型にコピー
+		std::string errstr;
+		errstr.resize(errorBlob->GetBufferSize());
+
+		std::copy_n(
+		  (char*)errorBlob->GetBufferPointer(), errorBlob->GetBufferSize(), errstr.begin());
+		errstr += "\n";
+		// エラー内容を出力ウィンドウに表示
+		OutputDebugStringA(errstr.c_str());
+		exit(1);
+	}
+
 	// 頂点レイアウト
 	D3D12_INPUT_ELEMENT_DESC inputLayout[] = {
 	  {// xy座標(1行で書いたほうが見やすい)
@@ -109,7 +226,7 @@ void Model::InitializeGraphicsPipeline() {
 	// レンダーターゲットのブレンド設定
 	D3D12_RENDER_TARGET_BLEND_DESC blenddesc{};
 	blenddesc.RenderTargetWriteMask = D3D12_COLOR_WRITE_ENABLE_ALL; // RBGA全てのチャンネルを描画
-	blenddesc.BlendEnable = true;
+	blenddesc.BlendEnable = kBlendEnable;
 	blenddesc.BlendOp = D3D12_BLEND_OP_ADD;
 	blenddesc.SrcBlend = D3D12_BLEND_SRC_ALPHA;
 	blenddesc.DestBlend = D3D12_BLEND_INV_SRC_ALPHA;
@@ -140,12 +257,13 @@ void Model::InitializeGraphicsPipeline() {
 	descRangeSRV.Init(D3D12_DESCRIPTOR_RANGE_TYPE_SRV, 1, 0); // t0 レジスタ
 
 	// ルートパラメータ
-	CD3DX12_ROOT_PARAMETER rootparams[5];
+	CD3DX12_ROOT_PARAMETER rootparams[6];
 	rootparams[0].InitAsConstantBufferView(0, 0, D3D12_SHADER_VISIBILITY_ALL);
 	rootparams[1].InitAsConstantBufferView(1, 0, D3D12_SHADER_VISIBILITY_ALL);
 	rootparams[2].InitAsConstantBufferView(2, 0, D3D12_SHADER_VISIBILITY_ALL);
 	rootparams[3].InitAsDescriptorTable(1, &descRangeSRV, D3D12_SHADER_VISIBILITY_ALL);
 	rootparams[4].InitAsConstantBufferView(3, 0, D3D12_SHADER_VISIBILITY_ALL);
+	rootparams[5].InitAsShaderResourceView(1, 0, D3D12_SHADER_VISIBILITY_VERTEX);
 
 	// スタティックサンプラー
 	CD3DX12_STATIC_SAMPLER_DESC samplerDesc = CD3DX12_STATIC_SAMPLER_DESC(0);
@@ -172,6 +290,12 @@ void Model::InitializeGraphicsPipeline() {
 	result = DirectXCommon::GetInstance()->GetDevice()->CreateGraphicsPipelineState(
 	  &gpipeline, IID_PPV_ARGS(&sPipelineState_));
 	assert(SUCCEEDED(result));
+
+	// インスタンス描画用グラフィックスパイプラインの生成（頂点シェーダだけ違う）
+	gpipeline.VS = CD3DX12_SHADER_BYTECODE(instancedVsBlob.Get());
+	result = DirectXCommon::GetInstance()->GetDevice()->CreateGraphicsPipelineState(
+	  &gpipeline, IID_PPV_ARGS(&sInstancedPipelineState_));
+	assert(SUCCEEDED(result));
 }
 
 Model* Model::Create() { 
@@ -190,24 +314,53 @@ Model* Model::CreateFromOBJ(const std::string& modelname, bool smoothing) {
 	return instance;
 }
 
+Model* Model::CreateFromOBJ(const std::string& modelname, const ImportSettings& settings) {
+	// メモリ確保
+	Model* instance = new Model;
+	instance->Initialize(modelname, settings);
+
+	return instance;
+}
+
 void Model::PreDraw(ID3D12GraphicsCommandList* commandList) {
+	// DirectXCommonのコマンドリストに積む
+	D3D12RenderContext* renderContext = DirectXCommon::GetInstance()->GetRenderContext();
+	assert(renderContext->GetCommandList() == commandList);
+	PreDraw(renderContext);
+}
+
+void Model::PreDraw(RenderContext* renderContext) {
 	// PreDrawとPostDrawがペアで呼ばれていなければエラー
-	assert(Model::sCommandList_ == nullptr);
+	assert(Model::sRenderContext_ == nullptr);
+
+	// 描画コマンドの発行先をセット
+	sRenderContext_ = renderContext;
 
-	// コマンドリストをセット
-	sCommandList_ = commandList;
+	// カリングの統計をリセット
+	sDrawnMeshCount_ = 0;
+	sCulledMeshCount_ = 0;
 
 	// パイプラインステートの設定
-	commandList->SetPipelineState(sPipelineState_.Get());
+	renderContext->SetPipelineState(sPipelineState_.Get());
 	// ルートシグネチャの設定
-	commandList->SetGraphicsRootSignature(sRootSignature_.Get());
+	renderContext->SetGraphicsRootSignature(sRootSignature_.Get());
 	// プリミティブ形状を設定
-	commandList->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+	renderContext->SetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
 }
 
 void Model::PostDraw() {
-	// コマンドリストを解除
-	sCommandList_ = nullptr;
+	// 積んだ描画を並べ替えて描画
+	RenderQueue::RootParameterIndices indices;
+	indices.worldTransform = static_cast<UINT>(RoomParameter::kWorldTransform);
+	indices.viewProjection = static_cast<UINT>(RoomParameter::kViewProjection);
+	indices.material = static_cast<UINT>(RoomParameter::kMaterial);
+	indices.texture = static_cast<UINT>(RoomParameter::kTexture);
+	indices.light = static_cast<UINT>(RoomParameter::kLight);
+	indices.instances = static_cast<UINT>(RoomParameter::kInstances);
+	sRenderQueue_.Flush(sRenderContext_, indices, lightGroup->GetGPUVirtualAddress());
+
+	// 描画コマンドの発行先を解除
+	sRenderContext_ = nullptr;
 }
 
 Model::~Model() {
@@ -223,8 +376,93 @@ Model::~Model() {
 }
 
 void Model::Initialize(const std::string& modelname, bool smoothing) {
-	// モデル読み込み
-	LoadModel(modelname, smoothing);
+	ImportSettings settings;
+	settings.smoothing = smoothing;
+	Initialize(modelname, settings);
+}
+
+void Model::Initialize(const std::string& modelname, const ImportSettings& settings) {
+	// CPU側の読み込み
+	Import(modelname, settings, nullptr);
+	// GPUリソースの生成
+	FinalizeImport();
+}
+
+void Model::Import(
+  const std::string& modelname, const ImportSettings& settings, JobSystem* jobSystem) {
+	uint32_t importFlags = 0;
+	if (settings.smoothing) {
+		importFlags |= CookedModel::kImportSmoothing;
+	}
+	if (settings.optimize) {
+		importFlags |= CookedModel::kImportOptimize;
+	}
+	if (settings.tangents) {
+		importFlags |= CookedModel::kImportTangents;
+	}
+	uint32_t lodLevels = (std::min)(settings.lodLevels, Mesh::kMaxLodLevels - 1);
+	importFlags |= lodLevels << CookedModel::kImportLodShift;
+
+	// 有効なクック済みキャッシュがあればそれを使い、なければOBJから読み込んで書き出す
+	if (!LoadCooked(modelname, importFlags)) {
+		// モデル読み込み
+		LoadModel(modelname, settings.smoothing);
+
+		// メッシュ単位の後処理（メッシュ同士は独立しているので並列に行える）
+		auto postProcess = [&](size_t i) {
+			Mesh* mesh = meshes_[i];
+			// 頂点法線の平均によるエッジの平滑化
+			if (settings.smoothing) {
+				mesh->CalculateSmoothedVertexNormals();
+			}
+			// 接線の生成
+			if (settings.tangents) {
+				mesh->CalculateTangents(jobSystem);
+			}
+			// メッシュの最適化
+			if (settings.optimize) {
+				mesh->Optimize();
+			}
+			// LODの生成
+			if (lodLevels > 0) {
+				mesh->BuildLods(lodLevels);
+			}
+		};
+		if (jobSystem) {
+			jobSystem->ParallelFor(meshes_.size(), 1, [&](size_t begin, size_t end) {
+				for (size_t i = begin; i < end; i++) {
+					postProcess(i);
+				}
+			});
+		} else {
+			for (size_t i = 0; i < meshes_.size(); i++) {
+				postProcess(i);
+			}
+		}
+
+		// キャッシュ書き出し
+		SaveCooked(modelname, importFlags);
+	}
+
+	// 読み込みのたびに作る付加情報（カリング・LOD選択用の境界、メッシュレット）
+	auto buildBounds = [&](size_t i) {
+		Mesh* mesh = meshes_[i];
+		mesh->CalculateBounds();
+		if (settings.meshlets) {
+			mesh->BuildMeshlets();
+		}
+	};
+	if (jobSystem) {
+		jobSystem->ParallelFor(meshes_.size(), 1, [&](size_t begin, size_t end) {
+			for (size_t i = begin; i < end; i++) {
+				buildBounds(i);
+			}
+		});
+	} else {
+		for (size_t i = 0; i < meshes_.size(); i++) {
+			buildBounds(i);
+		}
+	}
 
 	// メッシュのマテリアルチェック
 	for (auto& m : meshes_) {
@@ -240,7 +478,9 @@ void Model::Initialize(const std::string& modelname, bool smoothing) {
 			m->SetMaterial(defaultMaterial_);
 		}
 	}
+}
 
+void Model::FinalizeImport() {
 	// メッシュのバッファ生成
 	for (auto& m : meshes_) {
 		m->CreateBuffers();
@@ -259,12 +499,10 @@ void Model::LoadModel(const std::string& modelname, bool smoothing) {
 	const string filename = modelname + ".obj";
 	const string directoryPath = kBaseDirectory + modelname + "/";
 
-	// ファイルストリーム
-	std::ifstream file;
-	// .objファイルを開く
-	file.open(directoryPath + filename);
+	// .objファイルをメモリにマッピング
+	MappedFile file;
 	// ファイルオープン失敗をチェック
-	if (file.fail()) {
+	if (!file.Open(directoryPath + filename)) {
 		assert(0);
 	}
 
@@ -273,206 +511,384 @@ void Model::LoadModel(const std::string& modelname, bool smoothing) {
 	// メッシュ生成
 	meshes_.emplace_back(new Mesh);
 	Mesh* mesh = meshes_.back();
-	int indexCountTex = 0;
-	int indexCountNoTex = 0;
+	// 頂点の溶接用テーブル（メッシュ単位）
+	unordered_map<FaceVertexKey, uint32_t, FaceVertexKeyHash> vertexIndices;
 
 	vector<XMFLOAT3> positions; // 頂点座標
 	vector<XMFLOAT3> normals;   // 法線ベクトル
 	vector<XMFLOAT2> texcoords; // テクスチャUV
-	// 1行ずつ読み込む
-	string line;
-	while (getline(file, line)) {
 
-		// 1行分の文字列をストリームに変換して解析しやすくする
-		std::istringstream line_stream(line);
-
-		// 半角スペース区切りで行の先頭文字列を取得
-		string key;
-		getline(line_stream, key, ' ');
-
-		//マテリアル
-		if (key == "mtllib") {
-			// マテリアルのファイル名読み込み
-			string filename;
-			line_stream >> filename;
-			// マテリアル読み込み
-			LoadMaterial(directoryPath, filename);
-		}
-		// 先頭文字列がgならグループの開始
-		if (key == "g") {
+	// 相対インデックス（負の値）を1始まりの絶対インデックスに変換
+	auto resolveIndex = [](int32_t index, size_t count) {
+		return index < 0 ? static_cast<int32_t>(count) + index + 1 : index;
+	};
 
-			// カレントメッシュの情報が揃っているなら
-			if (mesh->GetName().size() > 0 && mesh->GetVertexCount() > 0) {
-				// 頂点法線の平均によるエッジの平滑化
-				if (smoothing) {
-					mesh->CalculateSmoothedVertexNormals();
-				}
-				// 次のメッシュ生成
-				meshes_.emplace_back(new Mesh);
-				mesh = meshes_.back();
-				indexCountTex = 0;
-			}
+	// 1行ずつ読み込む
+	ObjTokenizer tokenizer(file.GetData(), file.GetData() + file.GetSize());
+	while (tokenizer.NextLine()) {
 
-			// グループ名読み込み
-			string groupName;
-			line_stream >> groupName;
+		// 半角スペース区切りで行の先頭文字列を取得
+		ObjTokenizer::Token key = tokenizer.ReadToken();
 
-			// メッシュに名前をセット
-			mesh->SetName(groupName);
-		}
 		// 先頭文字列がvなら頂点座標
 		if (key == "v") {
 			// X,Y,Z座標読み込み
 			XMFLOAT3 position{};
-			line_stream >> position.x;
-			line_stream >> position.y;
-			line_stream >> position.z;
+			tokenizer.ReadFloat(position.x);
+			tokenizer.ReadFloat(position.y);
+			tokenizer.ReadFloat(position.z);
 			positions.emplace_back(position);
 		}
 		// 先頭文字列がvtならテクスチャ
-		if (key == "vt") {
+		else if (key == "vt") {
 			// U,V成分読み込み
 			XMFLOAT2 texcoord{};
-			line_stream >> texcoord.x;
-			line_stream >> texcoord.y;
+			tokenizer.ReadFloat(texcoord.x);
+			tokenizer.ReadFloat(texcoord.y);
 			// V方向反転
 			texcoord.y = 1.0f - texcoord.y;
 			// テクスチャ座標データに追加
 			texcoords.emplace_back(texcoord);
 		}
 		// 先頭文字列がvnなら法線ベクトル
-		if (key == "vn") {
+		else if (key == "vn") {
 			// X,Y,Z成分読み込み
 			XMFLOAT3 normal{};
-			line_stream >> normal.x;
-			line_stream >> normal.y;
-			line_stream >> normal.z;
+			tokenizer.ReadFloat(normal.x);
+			tokenizer.ReadFloat(normal.y);
+			tokenizer.ReadFloat(normal.z);
 			// 法線ベクトルデータに追加
 			normals.emplace_back(normal);
 		}
-		// 先頭文字列がusemtlならマテリアルを割り当てる
-		if (key == "usemtl") {
-			if (mesh->GetMaterial() == nullptr) {
-				// マテリアルの名読み込み
-				string materialName;
-				line_stream >> materialName;
-
-				// マテリアル名で検索し、マテリアルを割り当てる
-				auto itr = materials_.find(materialName);
-				if (itr != materials_.end()) {
-					mesh->SetMaterial(itr->second);
-				}
-			}
-		}
 		// 先頭文字列がfならポリゴン（三角形）
-		if (key == "f") {
+		else if (key == "f") {
 			int faceIndexCount = 0;
+			uint32_t firstIndex = 0;
+			uint32_t prevIndex = 0;
+			Material* material = mesh->GetMaterial();
+			bool hasTexture = material && material->textureFilename_.size() > 0;
 			// 半角スペース区切りで行の続きを読み込む
-			string index_string;
-			while (getline(line_stream, index_string, ' ')) {
-				// 頂点インデックス1個分の文字列をストリームに変換して解析しやすくする
-				std::istringstream index_stream(index_string);
-				unsigned short indexPosition, indexNormal, indexTexcoord;
-				// 頂点番号
-				index_stream >> indexPosition;
-
-				Material* material = mesh->GetMaterial();
-				index_stream.seekg(1, ios_base::cur); // スラッシュを飛ばす
+			ObjTokenizer::FaceVertex faceVertex;
+			while (tokenizer.ReadFaceVertex(faceVertex)) {
+				FaceVertexKey vertexKey{};
+				vertexKey.position = resolveIndex(faceVertex.position, positions.size());
+				int32_t indexTexcoord = resolveIndex(faceVertex.texcoord, texcoords.size());
+				int32_t indexNormal = resolveIndex(faceVertex.normal, normals.size());
 				// マテリアル、テクスチャがある場合
-				if (material && material->textureFilename_.size() > 0) {
-					index_stream >> indexTexcoord;
-					index_stream.seekg(1, ios_base::cur); // スラッシュを飛ばす
-					index_stream >> indexNormal;
+				if (hasTexture) {
+					vertexKey.texcoord = indexTexcoord;
+					vertexKey.normal = indexNormal;
+				}
+				// スラッシュ2連続の場合、頂点番号のみ
+				else if (indexTexcoord > 0 && indexNormal > 0) {
+					vertexKey.normal = indexNormal;
+				}
+				bool smoothTarget = smoothing && (hasTexture || indexTexcoord > 0);
+
+				// 同じ組み合わせの頂点が既にあれば使い回す
+				auto inserted = vertexIndices.emplace(
+				  vertexKey, static_cast<uint32_t>(mesh->GetVertexCount()));
+				uint32_t index = inserted.first->second;
+				if (inserted.second) {
 					// 頂点データの追加
 					Mesh::VertexPosNormalUv vertex{};
-					vertex.pos = positions[indexPosition - 1];
-					vertex.normal = normals[indexNormal - 1];
-					vertex.uv = texcoords[indexTexcoord - 1];
+					vertex.pos = positions[vertexKey.position - 1];
+					vertex.normal = {0, 0, 1};
+					vertex.uv = {0, 0};
+					if (vertexKey.normal > 0) {
+						vertex.normal = normals[vertexKey.normal - 1];
+					}
+					if (vertexKey.texcoord > 0) {
+						vertex.uv = texcoords[vertexKey.texcoord - 1];
+					}
 					mesh->AddVertex(vertex);
+
 					// エッジ平滑化用のデータを追加
-					if (smoothing) {
-						mesh->AddSmoothData(
-						  indexPosition, (unsigned short)mesh->GetVertexCount() - 1);
-					}
-				} else {
-					char c;
-					index_stream >> c;
-					// スラッシュ2連続の場合、頂点番号のみ
-					if (c == '/') {
-						// 頂点データの追加
-						Mesh::VertexPosNormalUv vertex{};
-						vertex.pos = positions[indexPosition - 1];
-						vertex.normal = {0, 0, 1};
-						vertex.uv = {0, 0};
-						mesh->AddVertex(vertex);
-					} else {
-						index_stream.seekg(-1, ios_base::cur); // 1文字戻る
-						index_stream >> indexTexcoord;
-						index_stream.seekg(1, ios_base::cur); // スラッシュを飛ばす
-						index_stream >> indexNormal;
-						// 頂点データの追加
-						Mesh::VertexPosNormalUv vertex{};
-						vertex.pos = positions[indexPosition - 1];
-						vertex.normal = normals[indexNormal - 1];
-						vertex.uv = {0, 0};
-						mesh->AddVertex(vertex);
-						// エッジ平滑化用のデータを追加
-						if (smoothing) {
-							mesh->AddSmoothData(
-							  indexPosition, (unsigned short)mesh->GetVertexCount() - 1);
-						}
+					if (smoothTarget) {
+						mesh->AddSmoothData(vertexKey.position, index);
 					}
 				}
+
 				// インデックスデータの追加
 				if (faceIndexCount >= 3) {
-					// 四角形ポリゴンの4点目なので、
-					// 四角形の0,1,2,3の内 2,3,0で三角形を構築する
-					mesh->AddIndex(indexCountTex - 1);
-					mesh->AddIndex(indexCountTex);
-					mesh->AddIndex(indexCountTex - 3);
+					// 多角形の4点目以降なので、
+					// 直前の点と今の点と最初の点で三角形を構築する（四角形なら2,3,0）
+					mesh->AddIndex(prevIndex);
+					mesh->AddIndex(index);
+					mesh->AddIndex(firstIndex);
 				} else {
-					mesh->AddIndex(indexCountTex);
+					mesh->AddIndex(index);
 				}
-				indexCountTex++;
+				if (faceIndexCount == 0) {
+					firstIndex = index;
+				}
+				prevIndex = index;
 				faceIndexCount++;
 			}
 		}
+		// 先頭文字列がgならグループの開始
+		else if (key == "g") {
+
+			// カレントメッシュの情報が揃っているなら
+			if (mesh->GetName().size() > 0 && mesh->GetVertexCount() > 0) {
+				// 次のメッシュ生成
+				meshes_.emplace_back(new Mesh);
+				mesh = meshes_.back();
+				vertexIndices.clear();
+			}
+
+			// グループ名読み込み
+			// メッシュに名前をセット
+			mesh->SetName(tokenizer.ReadToken().ToString());
+		}
+		// 先頭文字列がusemtlならマテリアルを割り当てる
+		else if (key == "usemtl") {
+			if (mesh->GetMaterial() == nullptr) {
+				// マテリアルの名読み込み
+				string materialName = tokenizer.ReadToken().ToString();
+
+				// マテリアル名で検索し、マテリアルを割り当てる
+				auto itr = materials_.find(materialName);
+				if (itr != materials_.end()) {
+					mesh->SetMaterial(itr->second);
+				}
+			}
+		}
+		//マテリアル
+		else if (key == "mtllib") {
+			// マテリアルのファイル名読み込み
+			// マテリアル読み込み
+			LoadMaterial(directoryPath, tokenizer.ReadToken().ToString());
+		}
 	}
-	file.close();
+	file.Close();
+}
+
+bool Model::LoadCooked(const std::string& modelname, uint32_t importFlags) {
+	using namespace CookedModel;
 
-	// 頂点法線の平均によるエッジの平滑化
-	if (smoothing) {
-		mesh->CalculateSmoothedVertexNormals();
+	const string directoryPath = kBaseDirectory + modelname + "/";
+
+	// キャッシュファイルをメモリにマッピング
+	MappedFile file;
+	if (!file.Open(directoryPath + modelname + kExtension)) {
+		return false;
+	}
+	const char* data = file.GetData();
+	size_t size = file.GetSize();
+
+	// ヘッダのチェック
+	if (size < sizeof(FileHeader)) {
+		return false;
+	}
+	const FileHeader* header = reinterpret_cast<const FileHeader*>(data);
+	if (
+	  header->magic != kMagic || header->version != kVersion ||
+	  header->importFlags != importFlags || header->fileSize != size) {
+		return false;
+	}
+	size_t tableSize = sizeof(FileHeader) + sizeof(SourceEntry) * header->sourceCount +
+	                   sizeof(MaterialEntry) * header->materialCount +
+	                   sizeof(MeshEntry) * header->meshCount;
+	if (size < tableSize) {
+		return false;
+	}
+	const SourceEntry* sources = reinterpret_cast<const SourceEntry*>(header + 1);
+	const MaterialEntry* materialEntries =
+	  reinterpret_cast<const MaterialEntry*>(sources + header->sourceCount);
+	const MeshEntry* meshEntries =
+	  reinterpret_cast<const MeshEntry*>(materialEntries + header->materialCount);
+
+	// 元ファイルが更新されていればキャッシュは無効
+	for (uint32_t i = 0; i < header->sourceCount; i++) {
+		SourceEntry current{};
+		if (
+		  !GetSourceStamp(directoryPath, ReadFixedString(sources[i].fileName), current) ||
+		  current.fileSize != sources[i].fileSize ||
+		  current.lastWriteTime != sources[i].lastWriteTime) {
+			return false;
+		}
+	}
+
+	// データ領域の範囲チェック
+	for (uint32_t i = 0; i < header->meshCount; i++) {
+		const MeshEntry& entry = meshEntries[i];
+		if (
+		  entry.vertexOffset + uint64_t(entry.vertexCount) * sizeof(Mesh::VertexPosNormalUv) >
+		    size ||
+		  entry.indexOffset + uint64_t(entry.indexCount) * sizeof(uint32_t) > size ||
+		  (entry.tangentCount != 0 && entry.tangentCount != entry.vertexCount) ||
+		  entry.tangentOffset + uint64_t(entry.tangentCount) * sizeof(XMFLOAT4) > size ||
+		  entry.lodCount > Mesh::kMaxLodLevels ||
+		  entry.lodOffset + uint64_t(entry.lodCount) * sizeof(Mesh::LodLevel) > size ||
+		  entry.materialIndex >= int32_t(header->materialCount)) {
+			return false;
+		}
+	}
+
+	name_ = modelname;
+
+	// マテリアル生成
+	vector<Material*> materialTable;
+	materialTable.reserve(header->materialCount);
+	for (uint32_t i = 0; i < header->materialCount; i++) {
+		const MaterialEntry& entry = materialEntries[i];
+		Material* material = Material::Create();
+		material->name_ = ReadFixedString(entry.name);
+		material->textureFilename_ = ReadFixedString(entry.textureFilename);
+		material->ambient_ = entry.ambient;
+		material->diffuse_ = entry.diffuse;
+		material->specular_ = entry.specular;
+		material->alpha_ = entry.alpha;
+		AddMaterial(material);
+		materialTable.push_back(material);
+	}
+
+	// メッシュ生成（頂点・インデックスはそのままコピーできる配置）
+	for (uint32_t i = 0; i < header->meshCount; i++) {
+		const MeshEntry& entry = meshEntries[i];
+		Mesh* mesh = new Mesh;
+		mesh->SetName(ReadFixedString(entry.name));
+		if (entry.materialIndex >= 0) {
+			mesh->SetMaterial(materialTable[entry.materialIndex]);
+		}
+		mesh->SetGeometry(
+		  reinterpret_cast<const Mesh::VertexPosNormalUv*>(data + entry.vertexOffset),
+		  entry.vertexCount, reinterpret_cast<const uint32_t*>(data + entry.indexOffset),
+		  entry.indexCount);
+		if (entry.tangentCount > 0) {
+			mesh->SetTangents(
+			  reinterpret_cast<const XMFLOAT4*>(data + entry.tangentOffset), entry.tangentCount);
+		}
+		if (entry.lodCount > 0) {
+			mesh->SetLods(
+			  reinterpret_cast<const Mesh::LodLevel*>(data + entry.lodOffset), entry.lodCount);
+		}
+		meshes_.emplace_back(mesh);
+	}
+
+	return true;
+}
+
+void Model::SaveCooked(const std::string& modelname, uint32_t importFlags) {
+	using namespace CookedModel;
+
+	const string directoryPath = kBaseDirectory + modelname + "/";
+
+	// 元ファイル情報
+	vector<SourceEntry> sources(1 + materialLibraries_.size());
+	if (!GetSourceStamp(directoryPath, modelname + ".obj", sources[0])) {
+		return;
+	}
+	for (size_t i = 0; i < materialLibraries_.size(); i++) {
+		if (!GetSourceStamp(directoryPath, materialLibraries_[i], sources[i + 1])) {
+			return;
+		}
+	}
+
+	// マテリアル情報
+	vector<MaterialEntry> materialEntries;
+	unordered_map<Material*, int32_t> materialIndices;
+	for (auto& m : materials_) {
+		Material* material = m.second;
+		MaterialEntry entry{};
+		CopyFixedString(entry.name, material->name_);
+		CopyFixedString(entry.textureFilename, material->textureFilename_);
+		entry.ambient = material->ambient_;
+		entry.diffuse = material->diffuse_;
+		entry.specular = material->specular_;
+		entry.alpha = material->alpha_;
+		materialIndices.emplace(material, static_cast<int32_t>(materialEntries.size()));
+		materialEntries.push_back(entry);
+	}
+
+	// メッシュ情報とデータ領域の配置
+	uint64_t offset = sizeof(FileHeader) + sizeof(SourceEntry) * sources.size() +
+	                  sizeof(MaterialEntry) * materialEntries.size() +
+	                  sizeof(MeshEntry) * meshes_.size();
+	vector<MeshEntry> meshEntries;
+	for (Mesh* mesh : meshes_) {
+		MeshEntry entry{};
+		CopyFixedString(entry.name, mesh->GetName());
+		auto itr = materialIndices.find(mesh->GetMaterial());
+		entry.materialIndex = itr != materialIndices.end() ? itr->second : -1;
+		entry.vertexCount = static_cast<uint32_t>(mesh->GetVertices().size());
+		entry.indexCount = static_cast<uint32_t>(mesh->GetIndices().size());
+		offset = AlignUp(offset, kDataAlignment);
+		entry.vertexOffset = offset;
+		offset += sizeof(Mesh::VertexPosNormalUv) * entry.vertexCount;
+		offset = AlignUp(offset, kDataAlignment);
+		entry.indexOffset = offset;
+		offset += sizeof(uint32_t) * entry.indexCount;
+		entry.tangentCount = static_cast<uint32_t>(mesh->GetTangents().size());
+		offset = AlignUp(offset, kDataAlignment);
+		entry.tangentOffset = offset;
+		offset += sizeof(XMFLOAT4) * entry.tangentCount;
+		entry.lodCount = static_cast<uint32_t>(mesh->GetLods().size());
+		offset = AlignUp(offset, kDataAlignment);
+		entry.lodOffset = offset;
+		offset += sizeof(Mesh::LodLevel) * entry.lodCount;
+		meshEntries.push_back(entry);
+	}
+
+	FileHeader header{};
+	header.magic = kMagic;
+	header.version = kVersion;
+	header.importFlags = importFlags;
+	header.sourceCount = static_cast<uint32_t>(sources.size());
+	header.materialCount = static_cast<uint32_t>(materialEntries.size());
+	header.meshCount = static_cast<uint32_t>(meshEntries.size());
+	header.fileSize = offset;
+
+	// ファイルに書き出す
+	std::ofstream file(directoryPath + modelname + kExtension, ios::binary | ios::trunc);
+	if (file.fail()) {
+		return;
+	}
+	uint64_t position = 0;
+	auto write = [&](const void* src, size_t byteSize) {
+		file.write(static_cast<const char*>(src), byteSize);
+		position += byteSize;
+	};
+	auto padTo = [&](uint64_t target) {
+		static const char kZero[kDataAlignment] = {};
+		write(kZero, static_cast<size_t>(target - position));
+	};
+	write(&header, sizeof(header));
+	write(sources.data(), sizeof(SourceEntry) * sources.size());
+	write(materialEntries.data(), sizeof(MaterialEntry) * materialEntries.size());
+	write(meshEntries.data(), sizeof(MeshEntry) * meshEntries.size());
+	for (size_t i = 0; i < meshes_.size(); i++) {
+		padTo(meshEntries[i].vertexOffset);
+		write(meshes_[i]->GetVertices().data(),
+		      sizeof(Mesh::VertexPosNormalUv) * meshEntries[i].vertexCount);
+		padTo(meshEntries[i].indexOffset);
+		write(meshes_[i]->GetIndices().data(), sizeof(uint32_t) * meshEntries[i].indexCount);
+		padTo(meshEntries[i].tangentOffset);
+		write(meshes_[i]->GetTangents().data(), sizeof(XMFLOAT4) * meshEntries[i].tangentCount);
+		padTo(meshEntries[i].lodOffset);
+		write(meshes_[i]->GetLods().data(), sizeof(Mesh::LodLevel) * meshEntries[i].lodCount);
 	}
 }
 
 void Model::LoadMaterial(const std::string& directoryPath, const std::string& filename) {
-	// ファイルストリーム
-	std::ifstream file;
-	// マテリアルファイルを開く
-	file.open(directoryPath + filename);
+	// マテリアルファイルをメモリにマッピング
+	MappedFile file;
 	// ファイルオープン失敗をチェック
-	if (file.fail()) {
+	if (!file.Open(directoryPath + filename)) {
 		assert(0);
 	}
+	// キャッシュの更新検出用に記録
+	materialLibraries_.push_back(filename);
 
 	Material* material = nullptr;
 
 	// 1行ずつ読み込む
-	string line;
-	while (getline(file, line)) {
-
-		// 1行分の文字列をストリームに変換して解析しやすくする
-		std::istringstream line_stream(line);
-
-		// 半角スペース区切りで行の先頭文字列を取得
-		string key;
-		getline(line_stream, key, ' ');
+	ObjTokenizer tokenizer(file.GetData(), file.GetData() + file.GetSize());
+	while (tokenizer.NextLine()) {
 
-		// 先頭のタブ文字は無視する
-		if (key[0] == '\t') {
-			key.erase(key.begin()); // 先頭の文字を削除
-		}
+		// 空白区切りで行の先頭文字列を取得（先頭のタブ文字は無視される）
+		ObjTokenizer::Token key = tokenizer.ReadToken();
 
 		// 先頭文字列がnewmtlならマテリアル名
 		if (key == "newmtl") {
@@ -486,48 +902,45 @@ void Model::LoadMaterial(const std::string& directoryPath, const std::string& fi
 			// 新しいマテリアルを生成
 			material = Material::Create();
 			// マテリアル名読み込み
-			line_stream >> material->name_;
+			material->name_ = tokenizer.ReadToken().ToString();
+		}
+		// マテリアル定義前の行は無視する
+		else if (material == nullptr) {
+			continue;
 		}
 		// 先頭文字列がKaならアンビエント色
-		if (key == "Ka") {
-			line_stream >> material->ambient_.x;
-			line_stream >> material->ambient_.y;
-			line_stream >> material->ambient_.z;
+		else if (key == "Ka") {
+			tokenizer.ReadFloat(material->ambient_.x);
+			tokenizer.ReadFloat(material->ambient_.y);
+			tokenizer.ReadFloat(material->ambient_.z);
 		}
 		// 先頭文字列がKdならディフューズ色
-		if (key == "Kd") {
-			line_stream >> material->diffuse_.x;
-			line_stream >> material->diffuse_.y;
-			line_stream >> material->diffuse_.z;
+		else if (key == "Kd") {
+			tokenizer.ReadFloat(material->diffuse_.x);
+			tokenizer.ReadFloat(material->diffuse_.y);
+			tokenizer.ReadFloat(material->diffuse_.z);
 		}
 		// 先頭文字列がKsならスペキュラー色
-		if (key == "Ks") {
-			line_stream >> material->specular_.x;
-			line_stream >> material->specular_.y;
-			line_stream >> material->specular_.z;
+		else if (key == "Ks") {
+			tokenizer.ReadFloat(material->specular_.x);
+			tokenizer.ReadFloat(material->specular_.y);
+			tokenizer.ReadFloat(material->specular_.z);
 		}
 		// 先頭文字列がmap_Kdならテクスチャファイル名
-		if (key == "map_Kd") {
+		else if (key == "map_Kd") {
 			// テクスチャのファイル名読み込み
-			line_stream >> material->textureFilename_;
+			ObjTokenizer::Token path = tokenizer.ReadToken();
 
 			// フルパスからファイル名を取り出す
-			size_t pos1;
-			pos1 = material->textureFilename_.rfind('\\');
-			if (pos1 != string::npos) {
-				material->textureFilename_ = material->textureFilename_.substr(
-				  pos1 + 1, material->textureFilename_.size() - pos1 - 1);
-			}
-
-			pos1 = material->textureFilename_.rfind('/');
-			if (pos1 != string::npos) {
-				material->textureFilename_ = material->textureFilename_.substr(
-				  pos1 + 1, material->textureFilename_.size() - pos1 - 1);
+			const char* fileBegin = path.end;
+			while (fileBegin != path.begin && fileBegin[-1] != '\\' && fileBegin[-1] != '/') {
+				--fileBegin;
 			}
+			material->textureFilename_.assign(fileBegin, path.end);
 		}
 	}
 	// ファイルを閉じる
-	file.close();
+	file.Close();
 
 	if (material) {
 		// マテリアルを登録
@@ -564,47 +977,294 @@ void Model::LoadTextures() {
 
 void Model::Draw(
   const WorldTransform& worldTransform, const ViewProjection& viewProjection) {
+	DrawMeshes(
+	  worldTransform.matWorld_, worldTransform.GetGPUVirtualAddress(), viewProjection, UINT32_MAX);
+}
 
-	// ライトの描画
-	lightGroup->Draw(sCommandList_, static_cast<UINT>(RoomParameter::kLight));
+void Model::Draw(
+  const WorldTransform& worldTransform, const ViewProjection& viewProjection,
+  uint32_t textureHadle) {
+	DrawMeshes(
+	  worldTransform.matWorld_, worldTransform.GetGPUVirtualAddress(), viewProjection, textureHadle);
+}
 
-	// CBVをセット（ワールド行列）
-	sCommandList_->SetGraphicsRootConstantBufferView(
-	  static_cast<UINT>(RoomParameter::kWorldTransform),
-	  worldTransform.constBuff_->GetGPUVirtualAddress());
+void Model::Draw(
+  const TransformSystem& transformSystem, uint32_t node,
+  const ViewProjection& viewProjection) {
+	DrawMeshes(
+	  transformSystem.GetWorldMatrix(node), transformSystem.GetGPUVirtualAddress(node),
+	  viewProjection, UINT32_MAX);
+}
+
+void Model::Draw(
+  const TransformSystem& transformSystem, uint32_t node,
+  const ViewProjection& viewProjection, uint32_t textureHadle) {
+	DrawMeshes(
+	  transformSystem.GetWorldMatrix(node), transformSystem.GetGPUVirtualAddress(node),
+	  viewProjection, textureHadle);
+}
+
+void Model::DrawInstanced(
+  const WorldTransform* worldTransforms, size_t count, const ViewProjection& viewProjection,
+  uint32_t textureHadle) {
+	using namespace DirectX;
+
+	// PreDrawが呼ばれていなければエラー
+	assert(sRenderContext_);
+	if (count == 0 || meshes_.empty()) {
+		return;
+	}
+
+	// ワールド座標の視錐台（インスタンスごとに行列を掛けずに済む）
+	Frustum frustum;
+	frustum.Extract(viewProjection.matView * viewProjection.matProjection);
+
+	// メッシュごとに全インスタンスの境界球をワールド座標へ移してまとめて判定し、
+	// 見えているインスタンスの最も詳細なLODと深度の合計を求める
+	instanceVisibleCounts_.assign(meshes_.size(), 0);
+	instanceLods_.assign(meshes_.size(), UINT32_MAX);
+	instanceDepths_.assign(meshes_.size(), 0.0f);
+	instanceSpheres_.resize(count);
+	instanceVisibleFlags_.resize(meshes_.size() * count);
+	for (size_t j = 0; j < meshes_.size(); j++) {
+		const Mesh& mesh = *meshes_[j];
+		uint8_t* visibleFlags = &instanceVisibleFlags_[j * count];
+		for (size_t i = 0; i < count; i++) {
+			instanceSpheres_[i] =
+			  Frustum::TransformSphere(mesh.GetBoundingSphere(), worldTransforms[i].matWorld_);
+		}
+		if (sFrustumCulling_) {
+			frustum.CullSpheres(instanceSpheres_.data(), count, visibleFlags);
+		} else {
+			std::fill(visibleFlags, visibleFlags + count, uint8_t(1));
+		}
+		for (size_t i = 0; i < count; i++) {
+			if (!visibleFlags[i]) {
+				continue;
+			}
+			const XMFLOAT4& sphere = instanceSpheres_[i];
+			instanceVisibleCounts_[j]++;
+			instanceLods_[j] = (std::min)(
+			  instanceLods_[j], SelectLod(mesh, worldTransforms[i].matWorld_, viewProjection));
+			instanceDepths_[j] += XMVectorGetZ(XMVector3Transform(
+			  XMVectorSet(sphere.x, sphere.y, sphere.z, 1.0f), viewProjection.matView));
+		}
+	}
+
+	// 描画数とカリング数はDrawと同じくメッシュとインスタンスの組ごとに数える
+	// （ほかのメッシュが見えているために一緒に描かれる、見えていない組は描画数に含めない）
+	for (size_t j = 0; j < meshes_.size(); j++) {
+		sDrawnMeshCount_ += instanceVisibleCounts_[j];
+		sCulledMeshCount_ += static_cast<uint32_t>(count) - instanceVisibleCounts_[j];
+	}
+
+	// どれかのメッシュが見えているインスタンスの行列を集める
+	instanceMatrices_.clear();
+	for (size_t i = 0; i < count; i++) {
+		bool visible = false;
+		for (size_t j = 0; j < meshes_.size() && !visible; j++) {
+			visible = instanceVisibleFlags_[j * count + i] != 0;
+		}
+		if (!visible) {
+			continue;
+		}
+		instanceMatrices_.emplace_back();
+		XMStoreFloat4x4(&instanceMatrices_.back(), worldTransforms[i].matWorld_);
+	}
+	if (instanceMatrices_.empty()) {
+		return;
+	}
+
+	// インスタンスごとのワールド行列をまとめて転送
+	UINT instanceCount = static_cast<UINT>(instanceMatrices_.size());
+	void* instanceMap = nullptr;
+	D3D12_GPU_VIRTUAL_ADDRESS instanceAddress = ConstantBufferAllocator::GetInstance()->Allocate(
+	  sizeof(XMFLOAT4X4) * instanceCount, &instanceMap);
+	memcpy(instanceMap, instanceMatrices_.data(), sizeof(XMFLOAT4X4) * instanceCount);
+
+	// 並べ替えが有効なら、通常の描画と同じキューに積む
+	// （ブレンドの順を揃えるため、深度は見えているインスタンスの平均）
+	if (sSortDraws_) {
+		float depthRange = viewProjection.farZ - viewProjection.nearZ;
+		for (size_t i = 0; i < meshes_.size(); i++) {
+			if (instanceVisibleCounts_[i] == 0) {
+				continue;
+			}
+			Mesh* mesh = meshes_[i];
+			float depth = instanceDepths_[i] / instanceVisibleCounts_[i];
+
+			RenderQueue::Item item;
+			item.pipelineState = sInstancedPipelineState_.Get();
+			item.mesh = mesh;
+			item.textureHandle =
+			  textureHadle != UINT32_MAX ? textureHadle : mesh->GetMaterial()->GetTextureHadle();
+			item.lodLevel = instanceLods_[i];
+			item.viewProjectionAddress = viewProjection.GetGPUVirtualAddress();
+			item.depth = (depth - viewProjection.nearZ) / depthRange;
+			item.blended = kBlendEnable;
+			item.instanceAddress = instanceAddress;
+			item.instanceCount = instanceCount;
+			sRenderQueue_.Push(item);
+		}
+		return;
+	}
+
+	// インスタンス描画用パイプラインに切り替え
+	sRenderContext_->SetPipelineState(sInstancedPipelineState_.Get());
+
+	// ライトの描画
+	lightGroup->Draw(sRenderContext_, static_cast<UINT>(RoomParameter::kLight));
 
 	// CBVをセット（ビュープロジェクション行列）
-	sCommandList_->SetGraphicsRootConstantBufferView(
+	sRenderContext_->SetGraphicsRootConstantBufferView(
 	  static_cast<UINT>(RoomParameter::kViewProjection),
-	  viewProjection.constBuff_->GetGPUVirtualAddress());
+	  viewProjection.GetGPUVirtualAddress());
 
-	// 全メッシュを描画
-	for (auto& mesh : meshes_) {
-		mesh->Draw(sCommandList_, (UINT)RoomParameter::kMaterial, (UINT)RoomParameter::kTexture);
+	// SRVをセット（インスタンスごとのワールド行列）
+	sRenderContext_->SetGraphicsRootShaderResourceView(
+	  static_cast<UINT>(RoomParameter::kInstances), instanceAddress);
+
+	// 見えているメッシュをインスタンス数分まとめて描画
+	for (size_t i = 0; i < meshes_.size(); i++) {
+		if (instanceVisibleCounts_[i] == 0) {
+			continue;
+		}
+		Mesh* mesh = meshes_[i];
+		uint32_t texture =
+		  textureHadle != UINT32_MAX ? textureHadle : mesh->GetMaterial()->GetTextureHadle();
+		mesh->Draw(
+		  sRenderContext_, (UINT)RoomParameter::kMaterial, (UINT)RoomParameter::kTexture, texture,
+		  instanceLods_[i], instanceCount);
 	}
+
+	// 通常のパイプラインに戻す
+	sRenderContext_->SetPipelineState(sPipelineState_.Get());
 }
 
-void Model::Draw(
-  const WorldTransform& worldTransform, const ViewProjection& viewProjection,
-  uint32_t textureHadle) {
+void Model::DrawMeshes(
+  const XMMATRIX& matWorld, D3D12_GPU_VIRTUAL_ADDRESS worldAddress,
+  const ViewProjection& viewProjection, uint32_t textureHadle) {
+
+	// 視錐台の外のメッシュを除外（全て見えなければコマンドを積まない）
+	if (!CullMeshes(matWorld, viewProjection)) {
+		return;
+	}
+
+	// 並べ替えが有効ならキューに積むだけ
+	if (sSortDraws_) {
+		using namespace DirectX;
+
+		XMMATRIX matWorldView = matWorld * viewProjection.matView;
+		float depthRange = viewProjection.farZ - viewProjection.nearZ;
+		for (size_t i = 0; i < meshes_.size(); i++) {
+			if (!visibleMeshes_[i]) {
+				continue;
+			}
+			Mesh* mesh = meshes_[i];
+			// 境界球の中心のビュー空間での深度
+			const XMFLOAT4& sphere = mesh->GetBoundingSphere();
+			XMVECTOR center =
+			  XMVector3Transform(XMVectorSet(sphere.x, sphere.y, sphere.z, 1.0f), matWorldView);
+
+			RenderQueue::Item item;
+			item.pipelineState = sPipelineState_.Get();
+			item.mesh = mesh;
+			item.textureHandle =
+			  textureHadle != UINT32_MAX ? textureHadle : mesh->GetMaterial()->GetTextureHadle();
+			item.lodLevel = SelectLod(*mesh, matWorld, viewProjection);
+			item.worldAddress = worldAddress;
+			item.viewProjectionAddress = viewProjection.GetGPUVirtualAddress();
+			item.depth = (XMVectorGetZ(center) - viewProjection.nearZ) / depthRange;
+			item.blended = kBlendEnable;
+			sRenderQueue_.Push(item);
+		}
+		return;
+	}
 
 	// ライトの描画
-	lightGroup->Draw(sCommandList_, static_cast<UINT>(RoomParameter::kLight));
+	lightGroup->Draw(sRenderContext_, static_cast<UINT>(RoomParameter::kLight));
 
 	// CBVをセット（ワールド行列）
-	sCommandList_->SetGraphicsRootConstantBufferView(
-	  static_cast<UINT>(RoomParameter::kWorldTransform),
-	  worldTransform.constBuff_->GetGPUVirtualAddress());
+	sRenderContext_->SetGraphicsRootConstantBufferView(
+	  static_cast<UINT>(RoomParameter::kWorldTransform), worldAddress);
 
 	// CBVをセット（ビュープロジェクション行列）
-	sCommandList_->SetGraphicsRootConstantBufferView(
+	sRenderContext_->SetGraphicsRootConstantBufferView(
 	  static_cast<UINT>(RoomParameter::kViewProjection),
-	  viewProjection.constBuff_->GetGPUVirtualAddress());
+	  viewProjection.GetGPUVirtualAddress());
 
-	// 全メッシュを描画
-	for (auto& mesh : meshes_) {
+	// 見えているメッシュを描画
+	for (size_t i = 0; i < meshes_.size(); i++) {
+		if (!visibleMeshes_[i]) {
+			continue;
+		}
+		Mesh* mesh = meshes_[i];
+		uint32_t texture =
+		  textureHadle != UINT32_MAX ? textureHadle : mesh->GetMaterial()->GetTextureHadle();
 		mesh->Draw(
-		  sCommandList_, (UINT)RoomParameter::kMaterial, (UINT)RoomParameter::kTexture,
-		  textureHadle);
+		  sRenderContext_, (UINT)RoomParameter::kMaterial, (UINT)RoomParameter::kTexture, texture,
+		  SelectLod(*mesh, matWorld, viewProjection));
+	}
+}
+
+bool Model::CullMeshes(const XMMATRIX& matWorld, const ViewProjection& viewProjection) {
+	visibleMeshes_.assign(meshes_.size(), 1);
+	if (!sFrustumCulling_) {
+		sDrawnMeshCount_ += static_cast<uint32_t>(meshes_.size());
+		return !meshes_.empty();
+	}
+
+	// ローカル座標の視錐台で、メッシュの境界箱をそのまま判定する
+	Frustum frustum;
+	frustum.Extract(
+	  matWorld * viewProjection.matView * viewProjection.matProjection);
+
+	bool anyVisible = false;
+	for (size_t i = 0; i < meshes_.size(); i++) {
+		const Mesh* mesh = meshes_[i];
+		if (frustum.IntersectsBox(mesh->GetBoxCenter(), mesh->GetBoxExtents())) {
+			anyVisible = true;
+			sDrawnMeshCount_++;
+		} else {
+			visibleMeshes_[i] = 0;
+			sCulledMeshCount_++;
+		}
+	}
+	return anyVisible;
+}
+
+uint32_t Model::SelectLod(
+  const Mesh& mesh, const XMMATRIX& matWorld, const ViewProjection& viewProjection) {
+	using namespace DirectX;
+
+	const std::vector<Mesh::LodLevel>& lods = mesh.GetLods();
+	if (lods.size() <= 1) {
+		return 0;
+	}
+
+	// 境界球をワールド座標へ
+	const XMFLOAT4& localSphere = mesh.GetBoundingSphere();
+	XMFLOAT4 sphere = Frustum::TransformSphere(localSphere, matWorld);
+	float scale = localSphere.w > 0.0f ? sphere.w / localSphere.w : 1.0f;
+
+	// カメラから球の表面までの距離（近すぎる場合は最も詳細なレベル）
+	XMVECTOR center = XMVectorSet(sphere.x, sphere.y, sphere.z, 0.0f);
+	float distance =
+	  XMVectorGetX(XMVector3Length(XMVectorSubtract(center, XMLoadFloat3(&viewProjection.eye)))) -
+	  sphere.w;
+	if (distance <= viewProjection.nearZ) {
+		return 0;
+	}
+
+	// ワールド空間の1単位が画面上で何ピクセルになるか
+	float pixelsPerUnit = XMVectorGetY(viewProjection.matProjection.r[1]) *
+	                      (WinApp::kWindowHeight * 0.5f) / distance;
+
+	// 誤差が許容範囲に収まる最も粗いレベル
+	for (size_t level = lods.size() - 1; level > 0; level--) {
+		if (lods[level].error * scale * pixelsPerUnit <= sLodErrorThreshold_) {
+			return static_cast<uint32_t>(level);
+		}
 	}
+	return 0;
 }
@@ -5,14 +5,23 @@
 #include "WorldTransform.h"
 #include "Mesh.h"
 #include "LightGroup.h"
+#include "RenderQueue.h"
 #include <string>
 #include <unordered_map>
 #include <vector>
 
+class JobSystem;
+class TransformSystem;
+
 /// <summary>
 /// モデルデータ
 /// </summary>
 class Model {
+	// 非同期読み込みはワーカーでImportし、メインスレッドでFinalizeImportする
+	friend class ModelLoader;
+	// テストはGPUリソースを作らずにImportの結果を調べる
+	friend class ModelImportAccess;
+
   private: // エイリアス
 	// Microsoft::WRL::を省略
 	template<class T> using ComPtr = Microsoft::WRL::ComPtr<T>;
@@ -32,6 +41,18 @@ class Model {
 		kMaterial,       // マテリアル
 		kTexture,        // テクスチャ
 		kLight,          // ライト
+		kInstances,      // インスタンスごとのワールド行列（インスタンス描画用）
+	};
+
+	/// <summary>
+	/// インポート設定
+	/// </summary>
+	struct ImportSettings {
+		bool smoothing = false; // エッジ平滑化
+		bool optimize = false;  // 頂点キャッシュ・オーバードロー・頂点フェッチ最適化
+		bool tangents = false;  // 接線の生成（接線ありの頂点レイアウトになる）
+		uint32_t lodLevels = 0; // 追加で生成するLODレベル数
+		bool meshlets = false;  // メッシュレットの構築（カリング用、読み込みのたびに構築）
 	};
 
   private:
@@ -41,14 +62,28 @@ class Model {
   private: // 静的メンバ変数
 	// デスクリプタサイズ
 	static UINT sDescriptorHandleIncrementSize_;
-	// コマンドリスト
-	static ID3D12GraphicsCommandList* sCommandList_;
+	// 描画コマンドの発行先
+	static RenderContext* sRenderContext_;
 	// ルートシグネチャ
 	static Microsoft::WRL::ComPtr<ID3D12RootSignature> sRootSignature_;
 	// パイプラインステートオブジェクト
 	static Microsoft::WRL::ComPtr<ID3D12PipelineState> sPipelineState_;
+	// インスタンス描画用パイプラインステートオブジェクト
+	static Microsoft::WRL::ComPtr<ID3D12PipelineState> sInstancedPipelineState_;
 	// ライト
 	static std::unique_ptr<LightGroup> lightGroup;
+	// LOD切り替えの許容誤差（画面上のピクセル数）
+	static float sLodErrorThreshold_;
+	// 視錐台カリングの有効フラグ
+	static bool sFrustumCulling_;
+	// PreDrawからの描画メッシュ数
+	static uint32_t sDrawnMeshCount_;
+	// PreDrawからのカリングされたメッシュ数
+	static uint32_t sCulledMeshCount_;
+	// 描画の並べ替えの有効フラグ
+	static bool sSortDraws_;
+	// 描画キュー（PreDraw～PostDrawの描画を並べ替える）
+	static RenderQueue sRenderQueue_;
 
   public: // 静的メンバ関数
 	/// <summary>
@@ -75,17 +110,68 @@ class Model {
 	/// <returns>生成されたモデル</returns>
 	static Model* CreateFromOBJ(const std::string& modelname, bool smoothing = false);
 
+	/// <summary>
+	/// OBJファイルからメッシュ生成
+	/// </summary>
+	/// <param name="modelname">モデル名</param>
+	/// <param name="settings">インポート設定</param>
+	/// <returns>生成されたモデル</returns>
+	static Model* CreateFromOBJ(const std::string& modelname, const ImportSettings& settings);
+
 		/// <summary>
 	/// 描画前処理
 	/// </summary>
 	/// <param name="commandList">描画コマンドリスト</param>
 	static void PreDraw(ID3D12GraphicsCommandList* commandList);
 
+	/// <summary>
+	/// 描画前処理
+	/// </summary>
+	/// <param name="renderContext">描画コマンドの発行先</param>
+	static void PreDraw(RenderContext* renderContext);
+
 	/// <summary>
 	/// 描画後処理
 	/// </summary>
 	static void PostDraw();
 
+	/// <summary>
+	/// LOD切り替えの許容誤差をセット
+	/// </summary>
+	/// <param name="pixels">画面上の誤差がこのピクセル数以下になる最も粗いLODを使う</param>
+	static void SetLodErrorThreshold(float pixels) { sLodErrorThreshold_ = pixels; }
+
+	/// <summary>
+	/// 視錐台カリングの有効・無効を切り替える
+	/// </summary>
+	/// <param name="enable">有効フラグ</param>
+	static void SetFrustumCulling(bool enable) { sFrustumCulling_ = enable; }
+
+	/// <summary>
+	/// PreDrawからの描画メッシュ数を取得（インスタンス描画ではメッシュとインスタンスの組の数）
+	/// </summary>
+	/// <returns>描画メッシュ数</returns>
+	static uint32_t GetDrawnMeshCount() { return sDrawnMeshCount_; }
+
+	/// <summary>
+	/// PreDrawからのカリングされたメッシュ数を取得（インスタンス描画ではメッシュとインスタンスの組の数）
+	/// </summary>
+	/// <returns>カリングされたメッシュ数</returns>
+	static uint32_t GetCulledMeshCount() { return sCulledMeshCount_; }
+
+	/// <summary>
+	/// 描画の並べ替えの有効・無効を切り替える
+	/// 有効ならDrawはキューに積むだけで、PostDrawで並べ替えてまとめて描画する
+	/// </summary>
+	/// <param name="enable">有効フラグ</param>
+	static void SetSortDraws(bool enable) { sSortDraws_ = enable; }
+
+	/// <summary>
+	/// 直前のPostDrawでの描画キューの統計を取得（省いた状態設定の数など）
+	/// </summary>
+	/// <returns>統計</returns>
+	static const RenderQueue::Stats& GetRenderQueueStats() { return sRenderQueue_.GetStats(); }
+
   public: // メンバ関数
 	/// <summary>
 	/// デストラクタ
@@ -99,6 +185,13 @@ class Model {
 	/// <param name="modelname">エッジ平滑化フラグ</param>
 	void Initialize(const std::string& modelname, bool smoothing = false);
 
+	/// <summary>
+	/// 初期化
+	/// </summary>
+	/// <param name="modelname">モデル名</param>
+	/// <param name="settings">インポート設定</param>
+	void Initialize(const std::string& modelname, const ImportSettings& settings);
+
 	/// <summary>
 	/// 描画
 	/// </summary>
@@ -117,6 +210,50 @@ class Model {
 	  const WorldTransform& worldTransform, const ViewProjection& viewProjection,
 	  uint32_t textureHadle);
 
+	/// <summary>
+	/// 描画（TransformSystemのノード）
+	/// </summary>
+	/// <param name="transformSystem">トランスフォームシステム（Update済み）</param>
+	/// <param name="node">ノード番号</param>
+	/// <param name="viewProjection">ビュープロジェクション</param>
+	void Draw(
+	  const TransformSystem& transformSystem, uint32_t node,
+	  const ViewProjection& viewProjection);
+
+	/// <summary>
+	/// 描画（TransformSystemのノード、テクスチャ差し替え）
+	/// </summary>
+	/// <param name="transformSystem">トランスフォームシステム（Update済み）</param>
+	/// <param name="node">ノード番号</param>
+	/// <param name="viewProjection">ビュープロジェクション</param>
+	/// <param name="textureHadle">テクスチャハンドル</param>
+	void Draw(
+	  const TransformSystem& transformSystem, uint32_t node,
+	  const ViewProjection& viewProjection, uint32_t textureHadle);
+
+	/// <summary>
+	/// インスタンス描画（全てのインスタンスをメッシュごとに1回の描画で描く）
+	/// </summary>
+	/// <param name="worldTransforms">ワールドトランスフォームの配列（行列は更新済み）</param>
+	/// <param name="count">インスタンス数</param>
+	/// <param name="viewProjection">ビュープロジェクション</param>
+	/// <param name="textureHadle">テクスチャハンドル（UINT32_MAXならマテリアルのテクスチャ）</param>
+	void DrawInstanced(
+	  const WorldTransform* worldTransforms, size_t count, const ViewProjection& viewProjection,
+	  uint32_t textureHadle = UINT32_MAX);
+
+	/// <summary>
+	/// インスタンス描画
+	/// </summary>
+	/// <param name="worldTransforms">ワールドトランスフォームの配列（行列は更新済み）</param>
+	/// <param name="viewProjection">ビュープロジェクション</param>
+	/// <param name="textureHadle">テクスチャハンドル（UINT32_MAXならマテリアルのテクスチャ）</param>
+	void DrawInstanced(
+	  const std::vector<WorldTransform>& worldTransforms, const ViewProjection& viewProjection,
+	  uint32_t textureHadle = UINT32_MAX) {
+		DrawInstanced(worldTransforms.data(), worldTransforms.size(), viewProjection, textureHadle);
+	}
+
 	/// <summary>
 	/// メッシュコンテナを取得
 	/// </summary>
@@ -132,8 +269,38 @@ class Model {
 	std::unordered_map<std::string, Material*> materials_;
 	// デフォルトマテリアル
 	Material* defaultMaterial_ = nullptr;
+	// 読み込んだマテリアルファイル名（キャッシュの更新検出用）
+	std::vector<std::string> materialLibraries_;
+	// 描画時の可視判定結果（メッシュごと）
+	std::vector<uint8_t> visibleMeshes_;
+	// インスタンス描画時の見えているインスタンスのワールド行列
+	std::vector<DirectX::XMFLOAT4X4> instanceMatrices_;
+	// インスタンス描画時のメッシュごとのLODレベル
+	std::vector<uint32_t> instanceLods_;
+	// インスタンス描画時のメッシュごとの見えているインスタンス数
+	std::vector<uint32_t> instanceVisibleCounts_;
+	// インスタンス描画時のメッシュごとの見えているインスタンスのビュー空間の深度の合計
+	std::vector<float> instanceDepths_;
+	// インスタンス描画時の判定中のメッシュのインスタンスごとの境界球（ワールド座標）
+	std::vector<DirectX::XMFLOAT4> instanceSpheres_;
+	// インスタンス描画時の可視判定結果（メッシュごとにインスタンス数ずつ並べる）
+	std::vector<uint8_t> instanceVisibleFlags_;
 
   private: // メンバ関数
+	/// <summary>
+	/// CPU側の読み込み（GPUリソースを作らないため、ワーカースレッドから呼べる）
+	/// </summary>
+	/// <param name="modelname">モデル名</param>
+	/// <param name="settings">インポート設定</param>
+	/// <param name="jobSystem">メッシュ単位の並列処理に使うジョブシステム（nullptrなら逐次）</param>
+	void Import(
+	  const std::string& modelname, const ImportSettings& settings, JobSystem* jobSystem);
+
+	/// <summary>
+	/// GPUリソースの生成とテクスチャ読み込み（メインスレッドで呼ぶ）
+	/// </summary>
+	void FinalizeImport();
+
 	/// <summary>
 	/// モデル読み込み
 	/// </summary>
@@ -141,6 +308,21 @@ class Model {
 	/// <param name="modelname">エッジ平滑化フラグ</param>
 	void LoadModel(const std::string& modelname, bool smoothing);
 
+	/// <summary>
+	/// クック済みキャッシュからの読み込み
+	/// </summary>
+	/// <param name="modelname">モデル名</param>
+	/// <param name="importFlags">インポート設定フラグ</param>
+	/// <returns>キャッシュが有効で読み込めたらtrue</returns>
+	bool LoadCooked(const std::string& modelname, uint32_t importFlags);
+
+	/// <summary>
+	/// クック済みキャッシュの書き出し
+	/// </summary>
+	/// <param name="modelname">モデル名</param>
+	/// <param name="importFlags">インポート設定フラグ</param>
+	void SaveCooked(const std::string& modelname, uint32_t importFlags);
+
 	/// <summary>
 	/// マテリアル読み込み
 	/// </summary>
@@ -155,4 +337,33 @@ class Model {
 	/// テクスチャ読み込み
 	/// </summary>
 	void LoadTextures();
+
+	/// <summary>
+	/// 描画コマンドの積み込み
+	/// </summary>
+	/// <param name="matWorld">ワールド行列</param>
+	/// <param name="worldAddress">ワールド行列の定数バッファのGPUアドレス</param>
+	/// <param name="viewProjection">ビュープロジェクション</param>
+	/// <param name="textureHadle">テクスチャハンドル（UINT32_MAXならマテリアルのテクスチャ）</param>
+	void DrawMeshes(
+	  const XMMATRIX& matWorld, D3D12_GPU_VIRTUAL_ADDRESS worldAddress,
+	  const ViewProjection& viewProjection, uint32_t textureHadle);
+
+	/// <summary>
+	/// 視錐台カリング
+	/// </summary>
+	/// <param name="matWorld">ワールド行列</param>
+	/// <param name="viewProjection">ビュープロジェクション</param>
+	/// <returns>見えるメッシュがあればtrue</returns>
+	bool CullMeshes(const XMMATRIX& matWorld, const ViewProjection& viewProjection);
+
+	/// <summary>
+	/// 画面上の大きさからLODレベルを選ぶ
+	/// </summary>
+	/// <param name="mesh">メッシュ</param>
+	/// <param name="matWorld">ワールド行列</param>
+	/// <param name="viewProjection">ビュープロジェクション</param>
+	/// <returns>LODレベル</returns>
+	static uint32_t SelectLod(
+	  const Mesh& mesh, const XMMATRIX& matWorld, const ViewProjection& viewProjection);
 };
@@ -0,0 +1,66 @@
+﻿#include "ModelLoader.h"
+#include <cassert>
+
+bool ModelLoader::Handle::IsReady() const {
+	assert(IsValid());
+	return future_.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+}
+
+Model* ModelLoader::Handle::Get() {
+	// CPU側の読み込みを待つ
+	Model* model = GetImported();
+
+	// GPUリソースの生成
+	model->FinalizeImport();
+
+	return model;
+}
+
+Model* ModelLoader::Handle::GetImported() {
+	assert(IsValid());
+	return future_.get();
+}
+
+ModelLoader* ModelLoader::GetInstance() {
+	static ModelLoader instance;
+	return &instance;
+}
+
+void ModelLoader::Finalize() {
+	// 読み込み中の要求が終わるのを待つ
+	JobSystem::GetInstance()->Wait(loadCounter_);
+	modelMutexes_.clear();
+}
+
+ModelLoader::Handle
+  ModelLoader::LoadAsync(const std::string& modelname, const Model::ImportSettings& settings) {
+	JobSystem* jobSystem = JobSystem::GetInstance();
+	std::shared_ptr<std::mutex> modelMutex = GetModelMutex(modelname);
+
+	// std::functionはコピーできる必要があるので共有ポインタで持つ
+	auto task = std::make_shared<std::packaged_task<Model*()>>(
+	  [modelname, settings, jobSystem, modelMutex]() {
+		  // 同じモデルの読み込みは直列にする（後の要求は書き出されたキャッシュを使う）
+		  std::lock_guard<std::mutex> lock(*modelMutex);
+
+		  // CPU側の読み込み（メッシュ単位の後処理は細かいジョブに分けて並列に行う）
+		  Model* model = new Model;
+		  model->Import(modelname, settings, jobSystem);
+		  return model;
+	  });
+
+	Handle handle;
+	handle.future_ = task->get_future();
+	jobSystem->RunBackground(loadCounter_, [task]() { (*task)(); });
+	return handle;
+}
+
+std::shared_ptr<std::mutex> ModelLoader::GetModelMutex(const std::string& modelname) {
+	std::lock_guard<std::mutex> lock(mutex_);
+
+	std::shared_ptr<std::mutex>& modelMutex = modelMutexes_[modelname];
+	if (!modelMutex) {
+		modelMutex = std::make_shared<std::mutex>();
+	}
+	return modelMutex;
+}
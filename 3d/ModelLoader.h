@@ -0,0 +1,94 @@
+﻿#pragma once
+
+#include "JobSystem.h"
+#include "Model.h"
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+/// <summary>
+/// モデルの非同期読み込み
+/// OBJ/MTLの解析や法線の平滑化はJobSystemのワーカーで行い、GPUリソースの生成だけを呼び出し側で行う
+/// </summary>
+class ModelLoader {
+  public: // サブクラス
+	/// <summary>
+	/// 読み込み要求のハンドル
+	/// </summary>
+	class Handle {
+	  public:
+		/// <summary>
+		/// 有効なハンドルか
+		/// </summary>
+		bool IsValid() const { return future_.valid(); }
+
+		/// <summary>
+		/// CPU側の読み込みが終わっているか（待たずに調べる）
+		/// </summary>
+		bool IsReady() const;
+
+		/// <summary>
+		/// 読み込みの完了を待ち、GPUリソースを生成してモデルを受け取る
+		/// 呼び出したスレッドでGPUリソースを生成するため、メインスレッドから呼ぶ
+		/// 受け取ったモデルの解放は呼び出し側が行う
+		/// </summary>
+		/// <returns>生成されたモデル</returns>
+		Model* Get();
+
+		/// <summary>
+		/// CPU側の読み込みの完了を待ってモデルを受け取る（GPUリソースは生成しない）
+		/// 描画には使えない（読み込みを取りやめる時の解放用）。受け取ったモデルの解放は呼び出し側が行う
+		/// </summary>
+		/// <returns>読み込まれたモデル</returns>
+		Model* GetImported();
+
+	  private:
+		friend class ModelLoader;
+		// CPU側の読み込み結果
+		std::future<Model*> future_;
+	};
+
+  public: // 静的メンバ関数
+	/// <summary>
+	/// シングルトンインスタンスの取得
+	/// </summary>
+	/// <returns>シングルトンインスタンス</returns>
+	static ModelLoader* GetInstance();
+
+  public: // メンバ関数
+	/// <summary>
+	/// 終了処理（読み込み中の要求が終わるのを待つ、JobSystemの終了処理より前に呼ぶ）
+	/// </summary>
+	void Finalize();
+
+	/// <summary>
+	/// OBJファイルからの非同期読み込み
+	/// </summary>
+	/// <param name="modelname">モデル名</param>
+	/// <param name="settings">インポート設定</param>
+	/// <returns>読み込み要求のハンドル</returns>
+	Handle LoadAsync(const std::string& modelname, const Model::ImportSettings& settings = {});
+
+  private: // メンバ関数
+	ModelLoader() = default;
+	~ModelLoader() = default;
+	ModelLoader(const ModelLoader&) = delete;
+	const ModelLoader& operator=(const ModelLoader&) = delete;
+
+	/// <summary>
+	/// モデル名ごとの排他を取得（同じキャッシュファイルへの同時書き込みを防ぐ）
+	/// </summary>
+	/// <param name="modelname">モデル名</param>
+	/// <returns>排他オブジェクト</returns>
+	std::shared_ptr<std::mutex> GetModelMutex(const std::string& modelname);
+
+  private: // メンバ変数
+	// 読み込みジョブの完了待ち
+	JobSystem::Counter loadCounter_;
+	// モデル名ごとの排他
+	std::unordered_map<std::string, std::shared_ptr<std::mutex>> modelMutexes_;
+	// modelMutexes_の排他
+	std::mutex mutex_;
+};
@@ -0,0 +1,196 @@
+﻿#include "ObjTokenizer.h"
+#include <cstring>
+
+namespace {
+
+// 行内の区切り文字か
+inline bool IsSpace(char c) { return c == ' ' || c == '\t' || c == '\r'; }
+
+// 数字か
+inline bool IsDigit(char c) { return '0' <= c && c <= '9'; }
+
+// 10の累乗テーブル
+const double kPow10[] = {1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,
+                         1e8,  1e9,  1e10, 1e11, 1e12, 1e13, 1e14, 1e15,
+                         1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+// 10の累乗を掛ける
+double ScalePow10(double value, int exponent) {
+	const int kMaxTable = static_cast<int>(sizeof(kPow10) / sizeof(kPow10[0])) - 1;
+	while (exponent > kMaxTable) {
+		value *= kPow10[kMaxTable];
+		exponent -= kMaxTable;
+	}
+	while (exponent < -kMaxTable) {
+		value /= kPow10[kMaxTable];
+		exponent += kMaxTable;
+	}
+	return exponent >= 0 ? value * kPow10[exponent] : value / kPow10[-exponent];
+}
+
+} // namespace
+
+bool ObjTokenizer::Token::operator==(const char* str) const {
+	size_t length = std::strlen(str);
+	return Size() == length && std::memcmp(begin, str, length) == 0;
+}
+
+ObjTokenizer::ObjTokenizer(const char* begin, const char* end)
+    : end_(end), next_(begin), cursor_(begin), lineEnd_(begin) {
+	// UTF-8のBOMを飛ばす
+	if (end_ - next_ >= 3 && std::memcmp(next_, "\xEF\xBB\xBF", 3) == 0) {
+		next_ += 3;
+	}
+}
+
+bool ObjTokenizer::NextLine() {
+	if (next_ == nullptr || next_ >= end_) {
+		return false;
+	}
+
+	// 改行を検索して行の範囲を決める
+	cursor_ = next_;
+	const char* newLine =
+	  static_cast<const char*>(std::memchr(cursor_, '\n', static_cast<size_t>(end_ - cursor_)));
+	lineEnd_ = newLine ? newLine : end_;
+	next_ = newLine ? newLine + 1 : end_;
+	return true;
+}
+
+ObjTokenizer::Token ObjTokenizer::ReadToken() {
+	SkipSpaces();
+
+	Token token;
+	token.begin = cursor_;
+	while (cursor_ < lineEnd_ && !IsSpace(*cursor_)) {
+		++cursor_;
+	}
+	token.end = cursor_;
+	return token;
+}
+
+bool ObjTokenizer::ReadFloat(float& value) {
+	SkipSpaces();
+	return ParseFloat(cursor_, lineEnd_, value);
+}
+
+bool ObjTokenizer::ReadFaceVertex(FaceVertex& faceVertex) {
+	SkipSpaces();
+
+	faceVertex = FaceVertex{};
+	// 頂点番号
+	if (!ParseInt(cursor_, lineEnd_, faceVertex.position)) {
+		return false;
+	}
+	if (cursor_ < lineEnd_ && *cursor_ == '/') {
+		++cursor_; // スラッシュを飛ばす
+		// スラッシュ2連続でなければテクスチャ座標番号
+		if (cursor_ < lineEnd_ && *cursor_ != '/') {
+			ParseInt(cursor_, lineEnd_, faceVertex.texcoord);
+		}
+		if (cursor_ < lineEnd_ && *cursor_ == '/') {
+			++cursor_; // スラッシュを飛ばす
+			// 法線番号
+			ParseInt(cursor_, lineEnd_, faceVertex.normal);
+		}
+	}
+
+	// 解析できなかった残りは次の区切りまで飛ばす
+	while (cursor_ < lineEnd_ && !IsSpace(*cursor_)) {
+		++cursor_;
+	}
+	return true;
+}
+
+bool ObjTokenizer::ParseFloat(const char*& cursor, const char* end, float& value) {
+	const char* p = cursor;
+
+	// 符号
+	bool negative = false;
+	if (p < end && (*p == '-' || *p == '+')) {
+		negative = (*p == '-');
+		++p;
+	}
+
+	// 仮数部（19桁を超える分は指数に回す）
+	uint64_t mantissa = 0;
+	int exponent = 0;
+	int digitCount = 0;
+	bool hasDigits = false;
+	for (; p < end && IsDigit(*p); ++p) {
+		hasDigits = true;
+		if (digitCount < 19) {
+			mantissa = mantissa * 10 + static_cast<uint64_t>(*p - '0');
+			if (mantissa != 0) {
+				++digitCount;
+			}
+		} else {
+			++exponent;
+		}
+	}
+	if (p < end && *p == '.') {
+		++p;
+		for (; p < end && IsDigit(*p); ++p) {
+			hasDigits = true;
+			if (digitCount < 19) {
+				mantissa = mantissa * 10 + static_cast<uint64_t>(*p - '0');
+				if (mantissa != 0) {
+					++digitCount;
+				}
+				--exponent;
+			}
+		}
+	}
+	if (!hasDigits) {
+		return false;
+	}
+
+	// 指数部
+	if (p < end && (*p == 'e' || *p == 'E')) {
+		const char* expCursor = p + 1;
+		int32_t expValue = 0;
+		if (ParseInt(expCursor, end, expValue)) {
+			exponent += expValue;
+			p = expCursor;
+		}
+	}
+
+	double result = ScalePow10(static_cast<double>(mantissa), exponent);
+	value = static_cast<float>(negative ? -result : result);
+	cursor = p;
+	return true;
+}
+
+bool ObjTokenizer::ParseInt(const char*& cursor, const char* end, int32_t& value) {
+	const char* p = cursor;
+
+	// 符号
+	bool negative = false;
+	if (p < end && (*p == '-' || *p == '+')) {
+		negative = (*p == '-');
+		++p;
+	}
+
+	if (p >= end || !IsDigit(*p)) {
+		return false;
+	}
+	int64_t result = 0;
+	for (; p < end && IsDigit(*p); ++p) {
+		if (result < INT32_MAX) {
+			result = result * 10 + (*p - '0');
+		}
+	}
+	if (result > INT32_MAX) {
+		result = INT32_MAX;
+	}
+
+	value = static_cast<int32_t>(negative ? -result : result);
+	cursor = p;
+	return true;
+}
+
+void ObjTokenizer::SkipSpaces() {
+	while (cursor_ < lineEnd_ && IsSpace(*cursor_)) {
+		++cursor_;
+	}
+}
@@ -0,0 +1,104 @@
+﻿#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/// <summary>
+/// OBJ/MTL字句解析
+/// メモリ上のテキストを行単位で走査し、行ごとのヒープ確保を行わない
+/// </summary>
+class ObjTokenizer {
+  public: // サブクラス
+	/// <summary>
+	/// トークン（元バッファ内の範囲）
+	/// </summary>
+	struct Token {
+		const char* begin = nullptr; // 先頭
+		const char* end = nullptr;   // 終端（含まない）
+
+		// 空トークンか
+		bool Empty() const { return begin == end; }
+		// 文字数
+		size_t Size() const { return static_cast<size_t>(end - begin); }
+		// 文字列との比較
+		bool operator==(const char* str) const;
+		// 文字列に変換
+		std::string ToString() const { return std::string(begin, end); }
+	};
+
+	/// <summary>
+	/// 面の頂点インデックス（1始まり、0は省略）
+	/// </summary>
+	struct FaceVertex {
+		int32_t position = 0; // 頂点座標番号
+		int32_t texcoord = 0; // テクスチャ座標番号
+		int32_t normal = 0;   // 法線番号
+	};
+
+  public: // メンバ関数
+	/// <summary>
+	/// コンストラクタ
+	/// </summary>
+	/// <param name="begin">バッファ先頭</param>
+	/// <param name="end">バッファ終端</param>
+	ObjTokenizer(const char* begin, const char* end);
+
+	/// <summary>
+	/// 次の行へ進む
+	/// </summary>
+	/// <returns>行があればtrue</returns>
+	bool NextLine();
+
+	/// <summary>
+	/// 行内の次のトークンを読む（空白区切り）
+	/// </summary>
+	/// <returns>トークン（行末なら空）</returns>
+	Token ReadToken();
+
+	/// <summary>
+	/// 行内の次の実数を読む
+	/// </summary>
+	/// <param name="value">読み込み先</param>
+	/// <returns>成否</returns>
+	bool ReadFloat(float& value);
+
+	/// <summary>
+	/// 行内の次の面頂点（v, v/vt, v//vn, v/vt/vn）を読む
+	/// </summary>
+	/// <param name="faceVertex">読み込み先</param>
+	/// <returns>成否</returns>
+	bool ReadFaceVertex(FaceVertex& faceVertex);
+
+	/// <summary>
+	/// 実数の解析
+	/// </summary>
+	/// <param name="cursor">読み込み位置（解析後に進む）</param>
+	/// <param name="end">終端</param>
+	/// <param name="value">解析結果</param>
+	/// <returns>成否</returns>
+	static bool ParseFloat(const char*& cursor, const char* end, float& value);
+
+	/// <summary>
+	/// 整数の解析
+	/// </summary>
+	/// <param name="cursor">読み込み位置（解析後に進む）</param>
+	/// <param name="end">終端</param>
+	/// <param name="value">解析結果</param>
+	/// <returns>成否</returns>
+	static bool ParseInt(const char*& cursor, const char* end, int32_t& value);
+
+  private: // メンバ関数
+	// 行内の空白を飛ばす
+	void SkipSpaces();
+
+  private: // メンバ変数
+	// バッファ終端
+	const char* end_ = nullptr;
+	// 次の行の先頭
+	const char* next_ = nullptr;
+	// 読み込み位置
+	const char* cursor_ = nullptr;
+	// 現在の行の終端
+	const char* lineEnd_ = nullptr;
+};
@@ -0,0 +1,205 @@
+﻿#include "Mesh.h"
+#include "RenderQueue.h"
+#include "TextureManager.h"
+#include <algorithm>
+#include <cassert>
+
+uint32_t RenderQueue::Stats::GetElidedCount() const {
+	uint32_t count = 0;
+	for (uint32_t elided : elidedCounts) {
+		count += elided;
+	}
+	return count;
+}
+
+uint64_t RenderQueue::MakeSortKey(
+  uint32_t pipelineId, uint32_t materialId, uint32_t textureHandle, float depth, bool blended) {
+	static_assert(
+	  kBlendBits + kPipelineBits + kMaterialBits + kTextureBits + kDepthBits == 64,
+	  "sort key must be 64 bits");
+
+	// 深度は0～1をkDepthBitsに量子化する（手前から奥へ）
+	const uint32_t depthMax = (1u << kDepthBits) - 1;
+	float clamped = (std::min)((std::max)(depth, 0.0f), 1.0f);
+	uint64_t depthBits = static_cast<uint64_t>(clamped * depthMax);
+
+	// 範囲を超えた番号は下位ビットだけ使う（まとまりが崩れるだけで描画結果は変わらない）
+	uint64_t state = pipelineId & ((1u << kPipelineBits) - 1);
+	state = (state << kMaterialBits) | (materialId & ((1u << kMaterialBits) - 1));
+	state = (state << kTextureBits) | (textureHandle & ((1u << kTextureBits) - 1));
+
+	const uint32_t stateBits = kPipelineBits + kMaterialBits + kTextureBits;
+	if (blended) {
+		// 奥から手前へ描くことを優先し、同じ深度の中だけ状態でまとめる
+		uint64_t key = 1;
+		key = (key << kDepthBits) | (depthMax - depthBits);
+		key = (key << stateBits) | state;
+		return key;
+	}
+
+	// 不透明は状態でまとめ、同じ状態の中は手前から奥へ
+	return (state << kDepthBits) | depthBits;
+}
+
+void RenderQueue::RadixSort(std::vector<SortEntry>& entries, std::vector<SortEntry>& temp) {
+	const size_t count = entries.size();
+	if (count <= 1) {
+		return;
+	}
+	temp.resize(count);
+
+	// 8bitずつ8回の安定な分布数え上げソート（下位の桁から）
+	SortEntry* src = entries.data();
+	SortEntry* dst = temp.data();
+	for (uint32_t shift = 0; shift < 64; shift += 8) {
+		size_t offsets[256] = {};
+		for (size_t i = 0; i < count; i++) {
+			offsets[(src[i].key >> shift) & 0xff]++;
+		}
+		// 全て同じ桁なら並びは変わらないので飛ばす
+		if (offsets[(src[0].key >> shift) & 0xff] == count) {
+			continue;
+		}
+		size_t sum = 0;
+		for (size_t& offset : offsets) {
+			size_t n = offset;
+			offset = sum;
+			sum += n;
+		}
+		for (size_t i = 0; i < count; i++) {
+			dst[offsets[(src[i].key >> shift) & 0xff]++] = src[i];
+		}
+		std::swap(src, dst);
+	}
+
+	// 結果が作業領域側にあれば書き戻す
+	if (src != entries.data()) {
+		std::copy(src, src + count, entries.data());
+	}
+}
+
+void RenderQueue::Push(const Item& item) {
+	assert(item.pipelineState);
+	assert(item.mesh);
+
+	SortEntry entry;
+	entry.key = MakeSortKey(
+	  GetPipelineId(item.pipelineState), item.mesh->GetMaterial()->GetSortId(), item.textureHandle,
+	  item.depth, item.blended);
+	entry.index = static_cast<uint32_t>(items_.size());
+	sortEntries_.push_back(entry);
+	items_.push_back(item);
+}
+
+void RenderQueue::Flush(
+  RenderContext* renderContext, const RootParameterIndices& indices,
+  D3D12_GPU_VIRTUAL_ADDRESS lightAddress) {
+	stats_ = Stats();
+	if (items_.empty()) {
+		return;
+	}
+
+	assert(renderContext);
+	assert(indices.worldTransform < kMaxRootParameterCount);
+	assert(indices.viewProjection < kMaxRootParameterCount);
+	assert(indices.material < kMaxRootParameterCount);
+	assert(indices.light < kMaxRootParameterCount);
+	assert(indices.instances < kMaxRootParameterCount);
+
+	RadixSort(sortEntries_, sortTemp_);
+
+	// 直前に設定した状態（Flushの前に積まれた命令は分からないので、最初は全て設定する）
+	ID3D12PipelineState* boundPipeline = nullptr;
+	bool heapsBound = false;
+	D3D12_GPU_VIRTUAL_ADDRESS boundCBVs[kMaxRootParameterCount] = {};
+	D3D12_GPU_VIRTUAL_ADDRESS boundInstances = 0;
+	uint32_t boundTexture = UINT32_MAX;
+	D3D12_GPU_VIRTUAL_ADDRESS boundVB = 0;
+	D3D12_GPU_VIRTUAL_ADDRESS boundIB = 0;
+
+	// 状態が変わった時だけ設定し、数を数える
+	auto count = [this](StateType type, bool issue) {
+		if (issue) {
+			stats_.issuedCounts[size_t(type)]++;
+		} else {
+			stats_.elidedCounts[size_t(type)]++;
+		}
+		return issue;
+	};
+	auto setCBV = [&](UINT index, D3D12_GPU_VIRTUAL_ADDRESS address) {
+		if (count(StateType::kConstantBufferView, boundCBVs[index] != address)) {
+			boundCBVs[index] = address;
+			renderContext->SetGraphicsRootConstantBufferView(index, address);
+		}
+	};
+
+	TextureManager* textureManager = TextureManager::GetInstance();
+	for (const SortEntry& entry : sortEntries_) {
+		const Item& item = items_[entry.index];
+		Mesh* mesh = item.mesh;
+
+		// パイプラインステート
+		if (count(StateType::kPipelineState, boundPipeline != item.pipelineState)) {
+			boundPipeline = item.pipelineState;
+			renderContext->SetPipelineState(boundPipeline);
+		}
+
+		// ライト、ワールド行列、ビュープロジェクション行列、マテリアル
+		// （インスタンス描画はワールド行列の代わりにインスタンスごとのデータを使う）
+		setCBV(indices.light, lightAddress);
+		if (item.worldAddress != 0) {
+			setCBV(indices.worldTransform, item.worldAddress);
+		}
+		setCBV(indices.viewProjection, item.viewProjectionAddress);
+		setCBV(indices.material, mesh->GetMaterial()->GetGPUVirtualAddress());
+		if (item.instanceAddress != 0 &&
+		    count(StateType::kShaderResourceView, boundInstances != item.instanceAddress)) {
+			boundInstances = item.instanceAddress;
+			renderContext->SetGraphicsRootShaderResourceView(indices.instances, boundInstances);
+		}
+
+		// デスクリプタヒープとテクスチャ
+		if (count(StateType::kDescriptorHeaps, !heapsBound)) {
+			heapsBound = true;
+			ID3D12DescriptorHeap* ppHeaps[] = {textureManager->GetDescriptorHeap()};
+			renderContext->SetDescriptorHeaps(_countof(ppHeaps), ppHeaps);
+		}
+		if (count(StateType::kDescriptorTable, boundTexture != item.textureHandle)) {
+			boundTexture = item.textureHandle;
+			renderContext->SetGraphicsRootDescriptorTable(
+			  indices.texture, textureManager->GetGpuDescHandleSRV(boundTexture));
+		}
+
+		// 頂点バッファとインデックスバッファ
+		const D3D12_VERTEX_BUFFER_VIEW& vbView = mesh->GetVBView();
+		if (count(StateType::kVertexBuffer, boundVB != vbView.BufferLocation)) {
+			boundVB = vbView.BufferLocation;
+			renderContext->SetVertexBuffers(0, 1, &vbView);
+		}
+		const D3D12_INDEX_BUFFER_VIEW& ibView = mesh->GetIBView();
+		if (count(StateType::kIndexBuffer, boundIB != ibView.BufferLocation)) {
+			boundIB = ibView.BufferLocation;
+			renderContext->SetIndexBuffer(&ibView);
+		}
+
+		// 描画コマンド
+		UINT indexCount = 0;
+		UINT startIndex = 0;
+		mesh->GetIndexRange(item.lodLevel, indexCount, startIndex);
+		renderContext->DrawIndexedInstanced(indexCount, item.instanceCount, startIndex, 0, 0);
+		stats_.drawCount++;
+	}
+
+	items_.clear();
+	sortEntries_.clear();
+}
+
+uint32_t RenderQueue::GetPipelineId(ID3D12PipelineState* pipelineState) {
+	for (size_t i = 0; i < pipelines_.size(); i++) {
+		if (pipelines_[i] == pipelineState) {
+			return static_cast<uint32_t>(i);
+		}
+	}
+	pipelines_.push_back(pipelineState);
+	return static_cast<uint32_t>(pipelines_.size() - 1);
+}
@@ -0,0 +1,166 @@
+﻿#pragma once
+
+#include "RenderContext.h"
+#include <cstdint>
+#include <d3d12.h>
+#include <vector>
+
+class Mesh;
+
+/// <summary>
+/// 描画キュー
+/// メッシュの描画を64bitの並べ替えキー（パイプライン、マテリアル、テクスチャ、深度）で集め、
+/// 基数ソートしてから、直前と同じ状態の設定を省いて描画コマンドを積む
+/// 不透明な描画を先に状態順で、アルファブレンドする描画を後から奥から手前の順で描く
+/// </summary>
+class RenderQueue {
+  public: // 定数
+	// 並べ替えキーの各部分のビット数
+	// 不透明:           ブレンド(0) パイプライン マテリアル テクスチャ 深度（上位から）
+	// アルファブレンド: ブレンド(1) 深度（反転） パイプライン マテリアル テクスチャ
+	static const uint32_t kBlendBits = 1;
+	static const uint32_t kPipelineBits = 4;
+	static const uint32_t kMaterialBits = 19;
+	static const uint32_t kTextureBits = 16;
+	static const uint32_t kDepthBits = 24;
+	// ルートパラメータの最大数
+	static const uint32_t kMaxRootParameterCount = 8;
+
+  public: // 列挙子
+	/// <summary>
+	/// 状態設定の種類
+	/// </summary>
+	enum class StateType {
+		kPipelineState,     // パイプラインステート
+		kDescriptorHeaps,   // デスクリプタヒープ
+		kConstantBufferView, // 定数バッファビュー
+		kShaderResourceView, // シェーダリソースビュー
+		kDescriptorTable,   // デスクリプタテーブル
+		kVertexBuffer,      // 頂点バッファ
+		kIndexBuffer,       // インデックスバッファ
+
+		kCountOfStateType, // 種類数
+	};
+
+  public: // サブクラス
+	/// <summary>
+	/// 描画1回分
+	/// </summary>
+	struct Item {
+		ID3D12PipelineState* pipelineState = nullptr;
+		Mesh* mesh = nullptr;
+		uint32_t textureHandle = 0;
+		uint32_t lodLevel = 0;
+		D3D12_GPU_VIRTUAL_ADDRESS worldAddress = 0;
+		D3D12_GPU_VIRTUAL_ADDRESS viewProjectionAddress = 0;
+		// カメラからの深度（0が手前、1が奥）
+		float depth = 0.0f;
+		// アルファブレンドする（奥から手前へ描く）
+		bool blended = false;
+		// インスタンスごとのデータのGPUアドレス（インスタンス描画でなければ0）
+		D3D12_GPU_VIRTUAL_ADDRESS instanceAddress = 0;
+		// インスタンス数
+		uint32_t instanceCount = 1;
+	};
+
+	/// <summary>
+	/// ルートパラメータ番号
+	/// </summary>
+	struct RootParameterIndices {
+		UINT worldTransform;
+		UINT viewProjection;
+		UINT material;
+		UINT texture;
+		UINT light;
+		UINT instances;
+	};
+
+	/// <summary>
+	/// 直前のFlushの統計
+	/// </summary>
+	struct Stats {
+		// 描画数
+		uint32_t drawCount = 0;
+		// 種類ごとの発行した設定数
+		uint32_t issuedCounts[size_t(StateType::kCountOfStateType)] = {};
+		// 種類ごとの省いた設定数
+		uint32_t elidedCounts[size_t(StateType::kCountOfStateType)] = {};
+
+		/// <summary>
+		/// 省いた設定数の合計を取得
+		/// </summary>
+		uint32_t GetElidedCount() const;
+	};
+
+	/// <summary>
+	/// 並べ替えの要素
+	/// </summary>
+	struct SortEntry {
+		uint64_t key;
+		uint32_t index;
+	};
+
+  public: // 静的メンバ関数
+	/// <summary>
+	/// 並べ替えキーを作る
+	/// </summary>
+	/// <param name="pipelineId">パイプラインの番号</param>
+	/// <param name="materialId">マテリアルの番号</param>
+	/// <param name="textureHandle">テクスチャハンドル</param>
+	/// <param name="depth">深度（0～1、範囲外は丸める）</param>
+	/// <param name="blended">アルファブレンドする</param>
+	/// <returns>並べ替えキー</returns>
+	static uint64_t MakeSortKey(
+	  uint32_t pipelineId, uint32_t materialId, uint32_t textureHandle, float depth,
+	  bool blended = false);
+
+	/// <summary>
+	/// キーの昇順に基数ソートする（同じキーは元の順を保つ）
+	/// </summary>
+	/// <param name="entries">並べ替える要素</param>
+	/// <param name="temp">作業領域</param>
+	static void RadixSort(std::vector<SortEntry>& entries, std::vector<SortEntry>& temp);
+
+  public: // メンバ関数
+	/// <summary>
+	/// 描画を積む
+	/// </summary>
+	/// <param name="item">描画1回分</param>
+	void Push(const Item& item);
+
+	/// <summary>
+	/// 並べ替えて描画コマンドを積み、キューを空にする
+	/// </summary>
+	/// <param name="renderContext">描画コマンドの発行先</param>
+	/// <param name="indices">ルートパラメータ番号</param>
+	/// <param name="lightAddress">ライトの定数バッファのGPUアドレス</param>
+	void Flush(
+	  RenderContext* renderContext, const RootParameterIndices& indices,
+	  D3D12_GPU_VIRTUAL_ADDRESS lightAddress);
+
+	/// <summary>
+	/// 積まれている描画数を取得
+	/// </summary>
+	size_t GetItemCount() const { return items_.size(); }
+
+	/// <summary>
+	/// 直前のFlushの統計を取得
+	/// </summary>
+	const Stats& GetStats() const { return stats_; }
+
+  private: // メンバ関数
+	// パイプラインの番号を取得（初めて見たものには番号を振る）
+	uint32_t GetPipelineId(ID3D12PipelineState* pipelineState);
+
+  private: // メンバ変数
+	// 積まれた描画
+	std::vector<Item> items_;
+	// 並べ替えの要素
+	std::vector<SortEntry> sortEntries_;
+	// 並べ替えの作業領域
+	std::vector<SortEntry> sortTemp_;
+	// 番号を振ったパイプライン
+	std::vector<ID3D12PipelineState*> pipelines_;
+	// 直前のFlushの統計
+	Stats stats_;
+};
@@ -0,0 +1,284 @@
+﻿#include "TransformSystem.h"
+#include "DirectXCommon.h"
+#include "JobSystem.h"
+#include <atomic>
+#include <cassert>
+#include <cstring>
+#include <d3dx12.h>
+
+using namespace DirectX;
+
+namespace {
+
+// 1つのジョブで更新するノード数の目安（部分木の途中では分けない）
+const uint32_t kBatchNodeCount = 1024;
+
+} // namespace
+
+void TransformSystem::Initialize(uint32_t capacity, bool createConstBuffer) {
+	assert(capacity > 0);
+	capacity_ = capacity;
+	nodeCount_ = 0;
+
+	scales_.clear();
+	rotations_.clear();
+	translations_.clear();
+	parents_.clear();
+	alive_.clear();
+	localDirty_.clear();
+	generations_.clear();
+	parentGenerations_.clear();
+	freeNodes_.clear();
+	worldMatrices_.clear();
+	updateOrder_.clear();
+	batchEnds_.clear();
+	scales_.reserve(capacity);
+	rotations_.reserve(capacity);
+	translations_.reserve(capacity);
+	parents_.reserve(capacity);
+	alive_.reserve(capacity);
+	localDirty_.reserve(capacity);
+	generations_.reserve(capacity);
+	parentGenerations_.reserve(capacity);
+	worldMatrices_.reserve(capacity);
+	updateOrder_.reserve(capacity);
+	hierarchyDirty_ = false;
+	recomputedCount_ = 0;
+
+	constBuff_.Reset();
+	constMap_ = nullptr;
+	frameIndex_ = 0;
+	uploadedGenerations_.clear();
+	if (!createConstBuffer) {
+		return;
+	}
+
+	HRESULT result;
+
+	// ヒーププロパティ
+	CD3DX12_HEAP_PROPERTIES heapProps = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD);
+	// リソース設定（全ノード分をフレーム数分、1つのバッファにまとめる）
+	CD3DX12_RESOURCE_DESC resourceDesc = CD3DX12_RESOURCE_DESC::Buffer(
+	  static_cast<UINT64>(kConstantBufferStride) * capacity * DirectXCommon::kFrameCount);
+
+	// 定数バッファの生成
+	result = DirectXCommon::GetInstance()->GetDevice()->CreateCommittedResource(
+	  &heapProps, // アップロード可能
+	  D3D12_HEAP_FLAG_NONE, &resourceDesc, D3D12_RESOURCE_STATE_GENERIC_READ, nullptr,
+	  IID_PPV_ARGS(&constBuff_));
+	assert(SUCCEEDED(result));
+
+	// 定数バッファとのデータリンク
+	result = constBuff_->Map(0, nullptr, (void**)&constMap_);
+	assert(SUCCEEDED(result));
+
+	// 世代は1から始まるので、0なら未転送
+	uploadedGenerations_.assign(static_cast<size_t>(capacity) * DirectXCommon::kFrameCount, 0);
+}
+
+uint32_t TransformSystem::CreateNode(uint32_t parent) {
+	assert(parent == kInvalidNode || (parent < alive_.size() && alive_[parent]));
+
+	uint32_t node;
+	if (!freeNodes_.empty()) {
+		// 空き番号を再利用
+		node = freeNodes_.back();
+		freeNodes_.pop_back();
+	} else {
+		assert(alive_.size() < capacity_);
+		node = static_cast<uint32_t>(alive_.size());
+		scales_.emplace_back();
+		rotations_.emplace_back();
+		translations_.emplace_back();
+		parents_.emplace_back();
+		alive_.emplace_back();
+		localDirty_.emplace_back();
+		generations_.emplace_back();
+		parentGenerations_.emplace_back();
+		worldMatrices_.emplace_back();
+	}
+
+	scales_[node] = {1, 1, 1};
+	rotations_[node] = {0, 0, 0};
+	translations_[node] = {0, 0, 0};
+	parents_[node] = parent;
+	alive_[node] = 1;
+	// 世代は戻さない（再利用された番号でも変更として検出できる）
+	localDirty_[node] = 1;
+	XMStoreFloat4x4(&worldMatrices_[node], XMMatrixIdentity());
+	nodeCount_++;
+	hierarchyDirty_ = true;
+	return node;
+}
+
+void TransformSystem::DestroyNode(uint32_t node) {
+	assert(node < alive_.size() && alive_[node]);
+
+	// 子はルートに付け替える
+	for (uint32_t i = 0; i < parents_.size(); i++) {
+		if (alive_[i] && parents_[i] == node) {
+			parents_[i] = kInvalidNode;
+			localDirty_[i] = 1;
+		}
+	}
+
+	alive_[node] = 0;
+	parents_[node] = kInvalidNode;
+	freeNodes_.push_back(node);
+	nodeCount_--;
+	hierarchyDirty_ = true;
+}
+
+void TransformSystem::SetParent(uint32_t node, uint32_t parent) {
+	assert(node < alive_.size() && alive_[node]);
+	assert(parent == kInvalidNode || (parent < alive_.size() && alive_[parent]));
+
+	// 自分の子孫を親にすると循環する
+	for (uint32_t ancestor = parent; ancestor != kInvalidNode; ancestor = parents_[ancestor]) {
+		assert(ancestor != node);
+	}
+
+	if (parents_[node] != parent) {
+		parents_[node] = parent;
+		localDirty_[node] = 1;
+		hierarchyDirty_ = true;
+	}
+}
+
+void TransformSystem::SortHierarchy() {
+	const uint32_t nodeCapacity = static_cast<uint32_t>(alive_.size());
+
+	// 子リストを親ごとに連続した配列へ（CSR形式）
+	std::vector<uint32_t> childStart(nodeCapacity + 1, 0);
+	for (uint32_t i = 0; i < nodeCapacity; i++) {
+		if (alive_[i] && parents_[i] != kInvalidNode) {
+			childStart[parents_[i] + 1]++;
+		}
+	}
+	for (uint32_t i = 0; i < nodeCapacity; i++) {
+		childStart[i + 1] += childStart[i];
+	}
+	std::vector<uint32_t> children(childStart[nodeCapacity]);
+	std::vector<uint32_t> cursor(childStart.begin(), childStart.end() - 1);
+	for (uint32_t i = 0; i < nodeCapacity; i++) {
+		if (alive_[i] && parents_[i] != kInvalidNode) {
+			children[cursor[parents_[i]]++] = i;
+		}
+	}
+
+	// ルートから深さ優先で並べる（部分木が連続し、親は必ず子より前）
+	updateOrder_.clear();
+	batchEnds_.clear();
+	uint32_t batchBegin = 0;
+	std::vector<uint32_t> stack;
+	for (uint32_t root = 0; root < nodeCapacity; root++) {
+		if (!alive_[root] || parents_[root] != kInvalidNode) {
+			continue;
+		}
+
+		// 別のルートの部分木は互いに依存しないので、ある程度の大きさで区切って並列の単位にする
+		uint32_t orderSize = static_cast<uint32_t>(updateOrder_.size());
+		if (orderSize - batchBegin >= kBatchNodeCount) {
+			batchEnds_.push_back(orderSize);
+			batchBegin = orderSize;
+		}
+
+		stack.push_back(root);
+		while (!stack.empty()) {
+			uint32_t node = stack.back();
+			stack.pop_back();
+			updateOrder_.push_back(node);
+			// 番号順に取り出せるよう逆順に積む
+			for (uint32_t c = childStart[node + 1]; c > childStart[node]; c--) {
+				stack.push_back(children[c - 1]);
+			}
+		}
+	}
+	assert(updateOrder_.size() == nodeCount_);
+	if (updateOrder_.size() > batchBegin) {
+		batchEnds_.push_back(static_cast<uint32_t>(updateOrder_.size()));
+	}
+
+	hierarchyDirty_ = false;
+}
+
+void TransformSystem::Update(JobSystem* jobSystem) {
+	if (hierarchyDirty_) {
+		SortHierarchy();
+	}
+	if (constMap_) {
+		frameIndex_ = DirectXCommon::GetInstance()->GetFrameIndex();
+	}
+
+	if (!jobSystem || batchEnds_.size() <= 1) {
+		recomputedCount_ = UpdateRange(0, updateOrder_.size());
+		return;
+	}
+
+	// ルートの部分木のまとまりごとに並列に計算する
+	std::atomic<uint32_t> recomputedCount{0};
+	jobSystem->ParallelFor(
+	  batchEnds_.size(), 1, [this, &recomputedCount](size_t begin, size_t end) {
+		  uint32_t count = 0;
+		  for (size_t batch = begin; batch < end; batch++) {
+			  count += UpdateRange(batch > 0 ? batchEnds_[batch - 1] : 0, batchEnds_[batch]);
+		  }
+		  recomputedCount += count;
+	  });
+	recomputedCount_ = recomputedCount;
+}
+
+uint32_t TransformSystem::UpdateRange(size_t begin, size_t end) {
+	uint32_t recomputedCount = 0;
+	for (size_t i = begin; i < end; i++) {
+		uint32_t node = updateOrder_[i];
+
+		// 自分か親が変わった時だけ計算し直す
+		uint32_t parent = parents_[node];
+		bool parentChanged =
+		  parent != kInvalidNode && parentGenerations_[node] != generations_[parent];
+		if (localDirty_[node] || parentChanged) {
+			const XMFLOAT3& scale = scales_[node];
+			const XMFLOAT3& rotation = rotations_[node];
+			const XMFLOAT3& translation = translations_[node];
+
+			// Z→X→Yの順の回転（WorldTransform::UpdateMatrixと同じ）
+			XMMATRIX matWorld = XMMatrixRotationRollPitchYaw(rotation.x, rotation.y, rotation.z);
+			// スケールは行ごとの乗算、平行移動は4行目の差し替えで済ませる
+			matWorld.r[0] = XMVectorScale(matWorld.r[0], scale.x);
+			matWorld.r[1] = XMVectorScale(matWorld.r[1], scale.y);
+			matWorld.r[2] = XMVectorScale(matWorld.r[2], scale.z);
+			matWorld.r[3] = XMVectorSet(translation.x, translation.y, translation.z, 1.0f);
+
+			// 親は先に計算済み
+			if (parent != kInvalidNode) {
+				matWorld = XMMatrixMultiply(matWorld, XMLoadFloat4x4(&worldMatrices_[parent]));
+				parentGenerations_[node] = generations_[parent];
+			}
+			XMStoreFloat4x4(&worldMatrices_[node], matWorld);
+			localDirty_[node] = 0;
+			generations_[node]++;
+			recomputedCount++;
+		}
+
+		// このフレームの領域が古ければ書き込む（各フレームの領域に変更が1回ずつ届く）
+		if (constMap_) {
+			size_t slot = static_cast<size_t>(frameIndex_) * capacity_ + node;
+			if (uploadedGenerations_[slot] != generations_[node]) {
+				memcpy(
+				  constMap_ + static_cast<size_t>(kConstantBufferStride) * slot,
+				  &worldMatrices_[node], sizeof(XMFLOAT4X4));
+				uploadedGenerations_[slot] = generations_[node];
+			}
+		}
+	}
+	return recomputedCount;
+}
+
+D3D12_GPU_VIRTUAL_ADDRESS TransformSystem::GetGPUVirtualAddress(uint32_t node) const {
+	assert(constBuff_);
+	assert(node < alive_.size() && alive_[node]);
+	size_t slot = static_cast<size_t>(frameIndex_) * capacity_ + node;
+	return constBuff_->GetGPUVirtualAddress() +
+	       static_cast<D3D12_GPU_VIRTUAL_ADDRESS>(kConstantBufferStride) * slot;
+}
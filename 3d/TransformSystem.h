@@ -0,0 +1,196 @@
+﻿#pragma once
+
+#include "WorldTransform.h"
+#include <DirectXMath.h>
+#include <cstdint>
+#include <d3d12.h>
+#include <vector>
+#include <wrl.h>
+
+class JobSystem;
+
+/// <summary>
+/// ワールド変換の階層をまとめて更新するシステム
+/// スケール・回転・座標を属性ごとの配列で持ち、親→子の順に並べてから一括で行列を計算する
+/// 値が変わったノードと、親の世代が進んだノードだけを再計算する
+/// </summary>
+class TransformSystem {
+  private: // エイリアス
+	// Microsoft::WRL::を省略
+	template<class T> using ComPtr = Microsoft::WRL::ComPtr<T>;
+	// DirectX::を省略
+	using XMFLOAT3 = DirectX::XMFLOAT3;
+	using XMFLOAT4X4 = DirectX::XMFLOAT4X4;
+	using XMMATRIX = DirectX::XMMATRIX;
+
+  public: // 定数
+	// 無効なノード
+	static const uint32_t kInvalidNode = UINT32_MAX;
+	// 定数バッファ1つ分の間隔（CBVのアライメント）
+	static const uint32_t kConstantBufferStride =
+	  (sizeof(ConstBufferDataWorldTransform) + 0xff) & ~0xff;
+
+  public: // メンバ関数
+	/// <summary>
+	/// 初期化
+	/// </summary>
+	/// <param name="capacity">最大ノード数</param>
+	/// <param name="createConstBuffer">定数バッファを生成するか（CPUだけで使う場合はfalse）</param>
+	void Initialize(uint32_t capacity, bool createConstBuffer = true);
+
+	/// <summary>
+	/// ノード生成
+	/// </summary>
+	/// <param name="parent">親ノード（kInvalidNodeならルート）</param>
+	/// <returns>ノード番号</returns>
+	uint32_t CreateNode(uint32_t parent = kInvalidNode);
+
+	/// <summary>
+	/// ノード破棄（子はルートになる）
+	/// </summary>
+	/// <param name="node">ノード番号</param>
+	void DestroyNode(uint32_t node);
+
+	/// <summary>
+	/// 毎フレーム更新（親→子の順に変更のあったノードのワールド行列を計算して定数バッファへ書き込む）
+	/// </summary>
+	/// <param name="jobSystem">ルートの部分木ごとの並列処理に使うジョブシステム（nullptrなら逐次）</param>
+	void Update(JobSystem* jobSystem = nullptr);
+
+	/// <summary>
+	/// 親の設定
+	/// </summary>
+	/// <param name="node">ノード番号</param>
+	/// <param name="parent">親ノード（kInvalidNodeならルート）</param>
+	void SetParent(uint32_t node, uint32_t parent);
+
+	/// <summary>
+	/// ローカルスケールの設定
+	/// </summary>
+	void SetScale(uint32_t node, const XMFLOAT3& scale) {
+		scales_[node] = scale;
+		localDirty_[node] = 1;
+	}
+
+	/// <summary>
+	/// X,Y,Z軸回りのローカル回転角の設定
+	/// </summary>
+	void SetRotation(uint32_t node, const XMFLOAT3& rotation) {
+		rotations_[node] = rotation;
+		localDirty_[node] = 1;
+	}
+
+	/// <summary>
+	/// ローカル座標の設定
+	/// </summary>
+	void SetTranslation(uint32_t node, const XMFLOAT3& translation) {
+		translations_[node] = translation;
+		localDirty_[node] = 1;
+	}
+
+	/// <summary>
+	/// 親ノードの取得
+	/// </summary>
+	uint32_t GetParent(uint32_t node) const { return parents_[node]; }
+
+	/// <summary>
+	/// ローカルスケールの取得
+	/// </summary>
+	const XMFLOAT3& GetScale(uint32_t node) const { return scales_[node]; }
+
+	/// <summary>
+	/// ローカル回転角の取得
+	/// </summary>
+	const XMFLOAT3& GetRotation(uint32_t node) const { return rotations_[node]; }
+
+	/// <summary>
+	/// ローカル座標の取得
+	/// </summary>
+	const XMFLOAT3& GetTranslation(uint32_t node) const { return translations_[node]; }
+
+	/// <summary>
+	/// ワールド行列の取得（最後のUpdate時点）
+	/// </summary>
+	XMMATRIX GetWorldMatrix(uint32_t node) const {
+		return DirectX::XMLoadFloat4x4(&worldMatrices_[node]);
+	}
+
+	/// <summary>
+	/// ワールド行列の配列を取得（ノード番号順に連続）
+	/// </summary>
+	const std::vector<XMFLOAT4X4>& GetWorldMatrices() const { return worldMatrices_; }
+
+	/// <summary>
+	/// ワールド行列の世代を取得（再計算されるたびに進む）
+	/// </summary>
+	uint32_t GetGeneration(uint32_t node) const { return generations_[node]; }
+
+	/// <summary>
+	/// 直前のUpdateで再計算したワールド行列の数を取得
+	/// </summary>
+	uint32_t GetRecomputedCount() const { return recomputedCount_; }
+
+	/// <summary>
+	/// ノードの定数バッファのGPUアドレスを取得（現在のフレームの領域）
+	/// </summary>
+	D3D12_GPU_VIRTUAL_ADDRESS GetGPUVirtualAddress(uint32_t node) const;
+
+	/// <summary>
+	/// 生存しているノード数を取得
+	/// </summary>
+	uint32_t GetNodeCount() const { return nodeCount_; }
+
+  private: // メンバ関数
+	/// <summary>
+	/// 親が子より前に来るように更新順を並べ直す
+	/// </summary>
+	void SortHierarchy();
+
+	/// <summary>
+	/// 更新順の [begin, end) のワールド行列を計算する
+	/// </summary>
+	/// <returns>再計算した数</returns>
+	uint32_t UpdateRange(size_t begin, size_t end);
+
+  private: // メンバ変数
+	// 最大ノード数
+	uint32_t capacity_ = 0;
+	// 生存しているノード数
+	uint32_t nodeCount_ = 0;
+	// ローカルスケール
+	std::vector<XMFLOAT3> scales_;
+	// X,Y,Z軸回りのローカル回転角
+	std::vector<XMFLOAT3> rotations_;
+	// ローカル座標
+	std::vector<XMFLOAT3> translations_;
+	// 親ノード
+	std::vector<uint32_t> parents_;
+	// 生存フラグ
+	std::vector<uint8_t> alive_;
+	// ローカルの値が変わったか
+	std::vector<uint8_t> localDirty_;
+	// ワールド行列の世代
+	std::vector<uint32_t> generations_;
+	// 計算時に参照した親の世代
+	std::vector<uint32_t> parentGenerations_;
+	// 空きノード番号
+	std::vector<uint32_t> freeNodes_;
+	// ローカル → ワールド変換行列（ノード番号順）
+	std::vector<XMFLOAT4X4> worldMatrices_;
+	// 更新順（親が必ず子より前）
+	std::vector<uint32_t> updateOrder_;
+	// 並列処理の単位（ルートの部分木をまとめた更新順の範囲の終端）
+	std::vector<uint32_t> batchEnds_;
+	// 階層が変わって並べ直しが必要か
+	bool hierarchyDirty_ = false;
+	// 直前のUpdateで再計算した数
+	uint32_t recomputedCount_ = 0;
+	// 定数バッファ（同時に処理するフレームごとに、ノードごとに256バイト間隔）
+	ComPtr<ID3D12Resource> constBuff_;
+	// マッピング済みアドレス
+	uint8_t* constMap_ = nullptr;
+	// 書き込み先のフレーム番号（GPUが読んでいる他のフレームの領域には書かない）
+	uint32_t frameIndex_ = 0;
+	// フレームごとの、各ノードを最後に書き込んだ時の世代
+	std::vector<uint32_t> uploadedGenerations_;
+};
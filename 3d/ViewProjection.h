@@ -1,5 +1,6 @@
 ﻿#pragma once
 
+#include "ConstantBufferAllocator.h"
 #include <DirectXMath.h>
 #include <d3d12.h>
 #include <wrl.h>
@@ -15,10 +16,8 @@ struct ConstBufferDataViewProjection {
 /// ビュープロジェクション変換データ
 /// </summary>
 struct ViewProjection {
-	// 定数バッファ
-	Microsoft::WRL::ComPtr<ID3D12Resource> constBuff_;
-	// マッピング済みアドレス
-	ConstBufferDataViewProjection* constMap = nullptr;
+	// 定数バッファ（フレームごとの確保から転送する）
+	mutable ConstantBufferAllocator::FrameCache constCache_;
 
 #pragma region ビュー行列の設定
 	// 視点座標
@@ -50,15 +49,11 @@ struct ViewProjection {
 	/// </summary>
 	void Initialize();
 	/// <summary>
-	/// 定数バッファ生成
-	/// </summary>
-	void CreateConstBuffer();
-	/// <summary>
-	/// マッピングする
-	/// </summary>
-	void Map();
-	/// <summary>
 	/// 行列を更新する
 	/// </summary>
 	void UpdateMatrix();
+	/// <summary>
+	/// 定数バッファのGPUアドレスを取得（フレームで最初の呼び出し時に転送する）
+	/// </summary>
+	D3D12_GPU_VIRTUAL_ADDRESS GetGPUVirtualAddress() const;
 };
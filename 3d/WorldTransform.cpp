@@ -1,40 +1,30 @@
-﻿#include "DirectXCommon.h"
-#include "WorldTransform.h"
-#include <cassert>
-#include <d3dx12.h>
+﻿#include "WorldTransform.h"
 
 using namespace DirectX;
 
-void WorldTransform::Initialize() {
-	CreateConstBuffer();
-	Map();
-	UpdateMatrix();
-}
+uint32_t WorldTransform::sRecomputedCount_ = 0;
 
-void WorldTransform::CreateConstBuffer() {
-	HRESULT result;
-
-	// ヒーププロパティ
-	CD3DX12_HEAP_PROPERTIES heapProps = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD);
-	// リソース設定
-	CD3DX12_RESOURCE_DESC resourceDesc =
-	  CD3DX12_RESOURCE_DESC::Buffer((sizeof(ConstBufferDataWorldTransform) + 0xff) & ~0xff);
-
-	// 定数バッファの生成
-	result = DirectXCommon::GetInstance()->GetDevice()->CreateCommittedResource(
-	  &heapProps, // アップロード可能
-	  D3D12_HEAP_FLAG_NONE, &resourceDesc, D3D12_RESOURCE_STATE_GENERIC_READ, nullptr,
-	  IID_PPV_ARGS(&constBuff_));
-	assert(SUCCEEDED(result));
+namespace {
+
+bool Equal(const XMFLOAT3& a, const XMFLOAT3& b) {
+	return a.x == b.x && a.y == b.y && a.z == b.z;
 }
 
-void WorldTransform::Map() {
-	// 定数バッファとのデータリンク
-	HRESULT result = constBuff_->Map(0, nullptr, (void**)&constMap);
-	assert(SUCCEEDED(result));
+} // namespace
+
+void WorldTransform::Initialize() {
+	UpdateMatrix();
 }
 
 void WorldTransform::UpdateMatrix() {
+	// 自分の値も親の行列も前回から変わっていなければ再計算しない
+	if (
+	  matrixValid_ && parent_ == prevParent_ &&
+	  (!parent_ || parent_->generation_ == prevParentGeneration_) && Equal(scale_, prevScale_) &&
+	  Equal(rotation_, prevRotation_) && Equal(translation_, prevTranslation_)) {
+		return;
+	}
+
 	XMMATRIX matScale, matRot, matTrans;
 
 	// スケール、回転、平行移動行列の計算
@@ -56,6 +46,22 @@ void WorldTransform::UpdateMatrix() {
 		matWorld_ *= parent_->matWorld_;
 	}
 
-	// 定数バッファに書き込み
-	constMap->matWorld = matWorld_;
+	// 定数バッファは次の描画で転送し直す
+	constCache_.Invalidate();
+
+	// 今回の値を記録して世代を進める
+	prevScale_ = scale_;
+	prevRotation_ = rotation_;
+	prevTranslation_ = translation_;
+	prevParent_ = parent_;
+	prevParentGeneration_ = parent_ ? parent_->generation_ : 0;
+	matrixValid_ = true;
+	generation_++;
+	sRecomputedCount_++;
+}
+
+D3D12_GPU_VIRTUAL_ADDRESS WorldTransform::GetGPUVirtualAddress() const {
+	ConstBufferDataWorldTransform data;
+	data.matWorld = matWorld_;
+	return ConstantBufferAllocator::GetInstance()->Upload(data, constCache_);
 }
@@ -1,6 +1,8 @@
 ﻿#pragma once
 
+#include "ConstantBufferAllocator.h"
 #include <DirectXMath.h>
+#include <cstdint>
 #include <d3d12.h>
 #include <wrl.h>
 
@@ -13,10 +15,8 @@ struct ConstBufferDataWorldTransform {
 /// ワールド変換データ
 /// </summary>
 struct WorldTransform {
-	// 定数バッファ
-	Microsoft::WRL::ComPtr<ID3D12Resource> constBuff_;
-	// マッピング済みアドレス
-	ConstBufferDataWorldTransform* constMap = nullptr;
+	// 定数バッファ（フレームごとの確保から転送する）
+	mutable ConstantBufferAllocator::FrameCache constCache_;
 	// ローカルスケール
 	DirectX::XMFLOAT3 scale_ = {1, 1, 1};
 	// X,Y,Z軸回りのローカル回転角
@@ -27,21 +27,43 @@ struct WorldTransform {
 	DirectX::XMMATRIX matWorld_;
 	// 親となるワールド変換へのポインタ
 	WorldTransform* parent_ = nullptr;
+	// ワールド行列の世代（再計算されるたびに進む）
+	uint32_t generation_ = 0;
+
+	// 前回計算時の値（変更検出用）
+	DirectX::XMFLOAT3 prevScale_ = {};
+	DirectX::XMFLOAT3 prevRotation_ = {};
+	DirectX::XMFLOAT3 prevTranslation_ = {};
+	const WorldTransform* prevParent_ = nullptr;
+	uint32_t prevParentGeneration_ = 0;
+	bool matrixValid_ = false;
+
+	// 前回のリセットから再計算した行列の数
+	static uint32_t sRecomputedCount_;
+
+	/// <summary>
+	/// 再計算した行列の数を取得
+	/// </summary>
+	static uint32_t GetRecomputedCount() { return sRecomputedCount_; }
+	/// <summary>
+	/// 再計算した行列の数をリセット（フレームの最初に呼ぶ）
+	/// </summary>
+	static void ResetRecomputedCount() { sRecomputedCount_ = 0; }
 
 	/// <summary>
 	/// 初期化
 	/// </summary>
 	void Initialize();
 	/// <summary>
-	/// 定数バッファ生成
+	/// 行列を更新する（自分も親も変わっていなければ何もしない）
 	/// </summary>
-	void CreateConstBuffer();
+	void UpdateMatrix();
 	/// <summary>
-	/// マッピングする
+	/// 次のUpdateMatrixで必ず再計算させる
 	/// </summary>
-	void Map();
+	void SetDirty() { matrixValid_ = false; }
 	/// <summary>
-	/// 行列を更新する
+	/// 定数バッファのGPUアドレスを取得（フレームで最初の呼び出し時に転送する）
 	/// </summary>
-	void UpdateMatrix();
+	D3D12_GPU_VIRTUAL_ADDRESS GetGPUVirtualAddress() const;
 };
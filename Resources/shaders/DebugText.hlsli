@@ -0,0 +1,18 @@
+cbuffer cbuff0 : register(b0) {
+	matrix mat; // 射影行列
+};
+
+// 1文字分のインスタンスデータ
+struct VSInput {
+	float2 pos : POSITION;    // 左上のスクリーン座標
+	float2 size : SIZE;       // 表示サイズ
+	float4 uvRect : TEXCOORD; // uv矩形（左上uv、右下uv）
+	float4 color : COLOR;     // 色(RGBA)
+};
+
+// 頂点シェーダーからピクセルシェーダーへのやり取りに使用する構造体
+struct VSOutput {
+	float4 svpos : SV_POSITION; // システム用頂点座標
+	float2 uv : TEXCOORD;       // uv値
+	float4 color : COLOR;       // 色(RGBA)
+};
\ No newline at end of file
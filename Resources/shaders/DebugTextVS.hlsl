@@ -0,0 +1,12 @@
+#include "DebugText.hlsli"
+
+VSOutput main(VSInput input, uint vertexId : SV_VertexID) {
+	// 頂点番号から矩形の角を決める（左上、右上、左下、右下の順のストリップ）
+	float2 corner = float2(vertexId & 1, vertexId >> 1);
+
+	VSOutput output; // ピクセルシェーダーに渡す値
+	output.svpos = mul(mat, float4(input.pos + corner * input.size, 0, 1));
+	output.uv = lerp(input.uvRect.xy, input.uvRect.zw, corner);
+	output.color = input.color;
+	return output;
+}
\ No newline at end of file
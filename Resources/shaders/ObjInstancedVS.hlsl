@@ -0,0 +1,27 @@
+#include "Obj.hlsli"
+
+// インスタンスごとのデータ
+struct InstanceData {
+	matrix world; // ワールド行列
+};
+
+StructuredBuffer<InstanceData> instances : register(t1); // 1番スロットに設定されたインスタンスデータ
+
+VSOutput main(float4 pos : POSITION, float3 normal : NORMAL, float2 uv : TEXCOORD, uint instanceId : SV_InstanceID)
+{
+	matrix instanceWorld = instances[instanceId].world;
+
+	// 法線にワールド行列によるスケーリング・回転を適用
+	// ※スケーリングが一様な場合のみ正しい
+	float4 worldNormal = normalize(mul(instanceWorld, float4(normal, 0)));
+	float4 worldPos = mul(instanceWorld, pos);
+
+	VSOutput output; // ピクセルシェーダーに渡す値
+	output.svpos = mul(mul(projection, view), worldPos);
+
+	output.worldpos = worldPos;
+	output.normal = worldNormal.xyz;
+	output.uv = uv;
+
+	return output;
+}
\ No newline at end of file
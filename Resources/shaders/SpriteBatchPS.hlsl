@@ -0,0 +1,6 @@
+#include "SpriteBatch.hlsli"
+
+Texture2D<float4> tex : register(t0); // 0番スロットに設定されたテクスチャ
+SamplerState smp : register(s0);      // 0番スロットに設定されたサンプラー
+
+float4 main(VSOutput input) : SV_TARGET { return tex.Sample(smp, input.uv) * input.color; }
\ No newline at end of file
@@ -37,6 +37,11 @@ void Audio::Initialize(const std::string& directoryPath) {
 	indexVoice_ = 0u;
 }
 
+void Audio::InitializeHeadless(const std::string& directoryPath) {
+	directoryPath_ = directoryPath;
+	xAudio2_.Reset();
+}
+
 void Audio::Finalize() {
 	// XAudio2解放
 	xAudio2_.Reset();
@@ -151,6 +156,12 @@ uint32_t Audio::PlayWave(uint32_t soundDataHandle, bool loopFlag, float volume)
 
 	uint32_t handle = indexVoice_;
 
+	// 音声出力なしの時はハンドルだけ返す（再生中リストに載らないので停止等は何もしない）
+	if (!xAudio2_) {
+		indexVoice_++;
+		return handle;
+	}
+
 	// 波形フォーマットを元にSourceVoiceの生成
 	IXAudio2SourceVoice* pSourceVoice = nullptr;
 	result = xAudio2_->CreateSourceVoice(&pSourceVoice, &soundData.wfex, 0, 2.0f, &voiceCallback_);
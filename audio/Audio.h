@@ -80,6 +80,11 @@ class Audio {
 	/// </summary>
 	void Initialize(const std::string& directoryPath = "Resources/");
 
+	/// <summary>
+	/// 音声出力なしの初期化（テスト用。読み込みは行い、再生は何もしない）
+	/// </summary>
+	void InitializeHeadless(const std::string& directoryPath = "Resources/");
+
 	/// <summary>
 	/// 終了処理
 	/// </summary>
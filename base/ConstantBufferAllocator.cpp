@@ -0,0 +1,90 @@
+﻿#include "ConstantBufferAllocator.h"
+#include <algorithm>
+#include <cassert>
+#include <d3dx12.h>
+
+ConstantBufferAllocator* ConstantBufferAllocator::GetInstance() {
+	static ConstantBufferAllocator instance;
+	return &instance;
+}
+
+void ConstantBufferAllocator::Initialize(ID3D12Device* device, uint32_t capacity) {
+	assert(device);
+	assert(!buffer_);
+
+	device_ = device;
+	CreateBuffer(capacity);
+	frameIndex_ = 0;
+}
+
+D3D12_GPU_VIRTUAL_ADDRESS ConstantBufferAllocator::Allocate(size_t size, void** cpuAddress) {
+	assert(mapped_);
+
+	uint64_t alignedSize = (size + kAlignment - 1) & ~(uint64_t(kAlignment) - 1);
+	uint64_t offset = ring_.Allocate(alignedSize, kAlignment);
+	if (offset == RingAllocator::kInvalidOffset) {
+		// 足りなければバッファを大きくして、新しいバッファの先頭から確保する
+		Grow(alignedSize);
+		offset = ring_.Allocate(alignedSize, kAlignment);
+	}
+	assert(offset != RingAllocator::kInvalidOffset);
+
+	*cpuAddress = mapped_ + offset;
+	return gpuAddress_ + offset;
+}
+
+void ConstantBufferAllocator::FinishFrame(uint64_t fenceValue) {
+	ring_.FinishFrame(fenceValue);
+	frameIndex_++;
+
+	// このフレームで作り直したバッファは、このフレームの完了まで使われる
+	for (RetiredBuffer& retired : retiredBuffers_) {
+		if (retired.fenceValue == UINT64_MAX) {
+			retired.fenceValue = fenceValue;
+		}
+	}
+}
+
+void ConstantBufferAllocator::Reclaim(uint64_t completedFenceValue) {
+	ring_.Reclaim(completedFenceValue);
+
+	while (!retiredBuffers_.empty() && retiredBuffers_.front().fenceValue <= completedFenceValue) {
+		retiredBuffers_.pop_front();
+	}
+}
+
+void ConstantBufferAllocator::CreateBuffer(uint64_t capacity) {
+	HRESULT result;
+
+	// ヒーププロパティ
+	CD3DX12_HEAP_PROPERTIES heapProps = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD);
+	// リソース設定
+	CD3DX12_RESOURCE_DESC resourceDesc = CD3DX12_RESOURCE_DESC::Buffer(capacity);
+
+	// アップロードバッファの生成
+	result = device_->CreateCommittedResource(
+	  &heapProps, // アップロード可能
+	  D3D12_HEAP_FLAG_NONE, &resourceDesc, D3D12_RESOURCE_STATE_GENERIC_READ, nullptr,
+	  IID_PPV_ARGS(buffer_.ReleaseAndGetAddressOf()));
+	assert(SUCCEEDED(result));
+
+	// 永続的にマップしておく
+	result = buffer_->Map(0, nullptr, (void**)&mapped_);
+	assert(SUCCEEDED(result));
+	gpuAddress_ = buffer_->GetGPUVirtualAddress();
+
+	ring_.Initialize(capacity);
+}
+
+void ConstantBufferAllocator::Grow(uint64_t size) {
+	// 転送待ちのフレームがまだ使っているので、GPUが使い終わるまで残す
+	RetiredBuffer retired;
+	retired.fenceValue = UINT64_MAX;
+	retired.buffer = buffer_;
+	retiredBuffers_.push_back(retired);
+
+	// 倍にしても入らなければ、確保する大きさの倍にする
+	uint64_t capacity = (std::max)(ring_.GetCapacity() * 2, size * 2);
+	mapped_ = nullptr;
+	CreateBuffer(capacity);
+}
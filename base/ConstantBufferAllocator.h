@@ -0,0 +1,157 @@
+﻿#pragma once
+
+#include "RenderContext.h"
+#include "RingAllocator.h"
+#include <cstdint>
+#include <cstring>
+#include <d3d12.h>
+#include <deque>
+#include <wrl.h>
+
+/// <summary>
+/// フレームごとの定数バッファ確保
+/// 永続的にマップした1つのアップロードバッファから256バイト単位で切り出し、
+/// GPUがそのフレームを使い終わったら再利用する（メインスレッドからのみ使う）
+/// 毎フレーム書き換える頂点データの転送にも使う
+/// 空きが足りなくなったら大きいバッファに作り直す（古いバッファはGPUが使い終わってから解放する）
+/// </summary>
+class ConstantBufferAllocator {
+  public: // 定数
+	// 定数バッファのアライメント
+	static const uint32_t kAlignment = D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT;
+	// 既定のバッファサイズ
+	static const uint32_t kDefaultCapacity = 4 * 1024 * 1024;
+
+  public: // サブクラス
+	/// <summary>
+	/// 同じフレームで同じデータを何度も転送しないためのキャッシュ
+	/// </summary>
+	struct FrameCache {
+		// 転送したフレーム
+		uint64_t frame = UINT64_MAX;
+		// 転送先のGPUアドレス
+		D3D12_GPU_VIRTUAL_ADDRESS address = 0;
+
+		/// <summary>
+		/// データが変わったので次回は転送し直す
+		/// </summary>
+		void Invalidate() { frame = UINT64_MAX; }
+	};
+
+  public: // 静的メンバ関数
+	/// <summary>
+	/// シングルトンインスタンスの取得
+	/// </summary>
+	/// <returns>シングルトンインスタンス</returns>
+	static ConstantBufferAllocator* GetInstance();
+
+  public: // メンバ関数
+	/// <summary>
+	/// 初期化
+	/// </summary>
+	/// <param name="device">デバイス</param>
+	/// <param name="capacity">最初のバッファサイズ（転送待ちの全フレーム分）</param>
+	void Initialize(ID3D12Device* device, uint32_t capacity = kDefaultCapacity);
+
+	/// <summary>
+	/// 領域の確保（足りなければバッファを大きくする）
+	/// </summary>
+	/// <param name="size">大きさ</param>
+	/// <param name="cpuAddress">書き込み先のCPUアドレス</param>
+	/// <returns>GPUアドレス</returns>
+	D3D12_GPU_VIRTUAL_ADDRESS Allocate(size_t size, void** cpuAddress);
+
+	/// <summary>
+	/// データを転送する
+	/// </summary>
+	/// <param name="data">データ</param>
+	/// <returns>GPUアドレス</returns>
+	template<class T> D3D12_GPU_VIRTUAL_ADDRESS Upload(const T& data) {
+		void* cpuAddress = nullptr;
+		D3D12_GPU_VIRTUAL_ADDRESS address = Allocate(sizeof(T), &cpuAddress);
+		memcpy(cpuAddress, &data, sizeof(T));
+		if (uploadRecorder_) {
+			uploadRecorder_->RecordUpload(address, &data, sizeof(T));
+		}
+		return address;
+	}
+
+	/// <summary>
+	/// データを転送する（このフレームで転送済みならそのアドレスを返す）
+	/// </summary>
+	/// <param name="data">データ</param>
+	/// <param name="cache">キャッシュ</param>
+	/// <returns>GPUアドレス</returns>
+	template<class T> D3D12_GPU_VIRTUAL_ADDRESS Upload(const T& data, FrameCache& cache) {
+		if (cache.frame != frameIndex_) {
+			cache.address = Upload(data);
+			cache.frame = frameIndex_;
+		}
+		return cache.address;
+	}
+
+	/// <summary>
+	/// フレームの終了
+	/// </summary>
+	/// <param name="fenceValue">このフレームの完了時にシグナルされるフェンス値</param>
+	void FinishFrame(uint64_t fenceValue);
+
+	/// <summary>
+	/// GPUが使い終わった領域を解放する
+	/// </summary>
+	/// <param name="completedFenceValue">GPUが到達済みのフェンス値</param>
+	void Reclaim(uint64_t completedFenceValue);
+
+	/// <summary>
+	/// 転送の通知先をセット（記録用、nullptrで解除）
+	/// </summary>
+	/// <param name="recorder">通知先</param>
+	void SetUploadRecorder(RenderContext* recorder) { uploadRecorder_ = recorder; }
+
+	/// <summary>
+	/// 使用中の大きさを取得
+	/// </summary>
+	uint64_t GetUsedSize() const { return ring_.GetUsedSize(); }
+
+	/// <summary>
+	/// バッファサイズを取得
+	/// </summary>
+	uint64_t GetCapacity() const { return ring_.GetCapacity(); }
+
+  private: // メンバ関数
+	ConstantBufferAllocator() = default;
+	~ConstantBufferAllocator() = default;
+	ConstantBufferAllocator(const ConstantBufferAllocator&) = delete;
+	const ConstantBufferAllocator& operator=(const ConstantBufferAllocator&) = delete;
+
+	// アップロードバッファの生成
+	void CreateBuffer(uint64_t capacity);
+
+	// バッファを大きくする（今のバッファは使い終わるまで残す）
+	void Grow(uint64_t size);
+
+  private: // サブクラス
+	// GPUが使い終わるのを待っている古いバッファ
+	struct RetiredBuffer {
+		uint64_t fenceValue; // 最後に使ったフレームの完了時のフェンス値
+		Microsoft::WRL::ComPtr<ID3D12Resource> buffer;
+	};
+
+  private: // メンバ変数
+	// デバイス
+	ID3D12Device* device_ = nullptr;
+	// アップロードバッファ
+	Microsoft::WRL::ComPtr<ID3D12Resource> buffer_;
+	// マッピング済みアドレス
+	uint8_t* mapped_ = nullptr;
+	// 先頭のGPUアドレス
+	D3D12_GPU_VIRTUAL_ADDRESS gpuAddress_ = 0;
+	// 領域管理
+	RingAllocator ring_;
+	// 現在のフレーム番号
+	uint64_t frameIndex_ = 0;
+	// 転送の通知先
+	RenderContext* uploadRecorder_ = nullptr;
+	// 作り直す前のバッファ（古い順。フェンス値がUINT64_MAXなら現在のフレームで使用中）
+	std::deque<RetiredBuffer> retiredBuffers_;
+};
@@ -0,0 +1,90 @@
+﻿#include "D3D12RenderContext.h"
+#include <cassert>
+
+void D3D12RenderContext::SetGraphicsRootSignature(ID3D12RootSignature* rootSignature) {
+	assert(commandList_);
+	if (stateCache_.SetRootSignature(rootSignature)) {
+		commandList_->SetGraphicsRootSignature(rootSignature);
+	}
+}
+
+void D3D12RenderContext::SetPipelineState(ID3D12PipelineState* pipelineState) {
+	assert(commandList_);
+	if (stateCache_.SetPipelineState(pipelineState)) {
+		commandList_->SetPipelineState(pipelineState);
+	}
+}
+
+void D3D12RenderContext::SetPrimitiveTopology(D3D12_PRIMITIVE_TOPOLOGY topology) {
+	assert(commandList_);
+	if (stateCache_.SetPrimitiveTopology(topology)) {
+		commandList_->IASetPrimitiveTopology(topology);
+	}
+}
+
+void D3D12RenderContext::SetDescriptorHeaps(UINT count, ID3D12DescriptorHeap* const* heaps) {
+	assert(commandList_);
+	if (stateCache_.SetDescriptorHeaps(count, heaps)) {
+		commandList_->SetDescriptorHeaps(count, heaps);
+	}
+}
+
+void D3D12RenderContext::SetGraphicsRootConstantBufferView(
+  UINT rootParameterIndex, D3D12_GPU_VIRTUAL_ADDRESS address) {
+	assert(commandList_);
+	if (stateCache_.SetRootConstantBufferView(rootParameterIndex, address)) {
+		commandList_->SetGraphicsRootConstantBufferView(rootParameterIndex, address);
+	}
+}
+
+void D3D12RenderContext::SetGraphicsRootShaderResourceView(
+  UINT rootParameterIndex, D3D12_GPU_VIRTUAL_ADDRESS address) {
+	assert(commandList_);
+	if (stateCache_.SetRootShaderResourceView(rootParameterIndex, address)) {
+		commandList_->SetGraphicsRootShaderResourceView(rootParameterIndex, address);
+	}
+}
+
+void D3D12RenderContext::SetGraphicsRootDescriptorTable(
+  UINT rootParameterIndex, D3D12_GPU_DESCRIPTOR_HANDLE descriptor) {
+	assert(commandList_);
+	if (stateCache_.SetRootDescriptorTable(rootParameterIndex, descriptor)) {
+		commandList_->SetGraphicsRootDescriptorTable(rootParameterIndex, descriptor);
+	}
+}
+
+void D3D12RenderContext::SetVertexBuffers(
+  UINT startSlot, UINT count, const D3D12_VERTEX_BUFFER_VIEW* views) {
+	assert(commandList_);
+	if (stateCache_.SetVertexBuffers(startSlot, count, views)) {
+		commandList_->IASetVertexBuffers(startSlot, count, views);
+	}
+}
+
+void D3D12RenderContext::SetIndexBuffer(const D3D12_INDEX_BUFFER_VIEW* view) {
+	assert(commandList_);
+	if (stateCache_.SetIndexBuffer(view)) {
+		commandList_->IASetIndexBuffer(view);
+	}
+}
+
+void D3D12RenderContext::DrawInstanced(
+  UINT vertexCountPerInstance, UINT instanceCount, UINT startVertexLocation,
+  UINT startInstanceLocation) {
+	assert(commandList_);
+	commandList_->DrawInstanced(
+	  vertexCountPerInstance, instanceCount, startVertexLocation, startInstanceLocation);
+}
+
+void D3D12RenderContext::DrawIndexedInstanced(
+  UINT indexCountPerInstance, UINT instanceCount, UINT startIndexLocation, INT baseVertexLocation,
+  UINT startInstanceLocation) {
+	assert(commandList_);
+	commandList_->DrawIndexedInstanced(
+	  indexCountPerInstance, instanceCount, startIndexLocation, baseVertexLocation,
+	  startInstanceLocation);
+}
+
+void D3D12RenderContext::Invalidate() {
+	stateCache_.Invalidate();
+}
@@ -0,0 +1,66 @@
+﻿#pragma once
+
+#include "RenderContext.h"
+#include "RenderStateCache.h"
+
+/// <summary>
+/// D3D12のコマンドリストに命令を積む描画コマンドの発行先
+/// 設定済みの状態を記憶し、同じ状態を設定し直す命令は積まない
+/// </summary>
+class D3D12RenderContext : public RenderContext {
+  public: // メンバ関数
+	/// <summary>
+	/// コンストラクタ
+	/// </summary>
+	/// <param name="commandList">命令発行先コマンドリスト</param>
+	explicit D3D12RenderContext(ID3D12GraphicsCommandList* commandList = nullptr)
+	    : commandList_(commandList) {}
+
+	/// <summary>
+	/// 命令発行先コマンドリストの設定
+	/// </summary>
+	void SetCommandList(ID3D12GraphicsCommandList* commandList) {
+		commandList_ = commandList;
+		Invalidate();
+	}
+
+	/// <summary>
+	/// 命令発行先コマンドリストの取得
+	/// </summary>
+	ID3D12GraphicsCommandList* GetCommandList() const { return commandList_; }
+
+	/// <summary>
+	/// 設定済みの状態を忘れる（コマンドリストのリセット時や、直接命令を積んだ後に呼ぶ）
+	/// </summary>
+	void Invalidate();
+
+	/// <summary>
+	/// 設定済みの状態の記憶を取得（省いた命令数の統計など）
+	/// </summary>
+	RenderStateCache& GetStateCache() { return stateCache_; }
+
+	void SetGraphicsRootSignature(ID3D12RootSignature* rootSignature) override;
+	void SetPipelineState(ID3D12PipelineState* pipelineState) override;
+	void SetPrimitiveTopology(D3D12_PRIMITIVE_TOPOLOGY topology) override;
+	void SetDescriptorHeaps(UINT count, ID3D12DescriptorHeap* const* heaps) override;
+	void SetGraphicsRootConstantBufferView(
+	  UINT rootParameterIndex, D3D12_GPU_VIRTUAL_ADDRESS address) override;
+	void SetGraphicsRootShaderResourceView(
+	  UINT rootParameterIndex, D3D12_GPU_VIRTUAL_ADDRESS address) override;
+	void SetGraphicsRootDescriptorTable(
+	  UINT rootParameterIndex, D3D12_GPU_DESCRIPTOR_HANDLE descriptor) override;
+	void SetVertexBuffers(UINT startSlot, UINT count, const D3D12_VERTEX_BUFFER_VIEW* views) override;
+	void SetIndexBuffer(const D3D12_INDEX_BUFFER_VIEW* view) override;
+	void DrawInstanced(
+	  UINT vertexCountPerInstance, UINT instanceCount, UINT startVertexLocation,
+	  UINT startInstanceLocation) override;
+	void DrawIndexedInstanced(
+	  UINT indexCountPerInstance, UINT instanceCount, UINT startIndexLocation,
+	  INT baseVertexLocation, UINT startInstanceLocation) override;
+
+  private: // メンバ変数
+	// 命令発行先コマンドリスト
+	ID3D12GraphicsCommandList* commandList_;
+	// 設定済みの状態
+	RenderStateCache stateCache_;
+};
@@ -0,0 +1,57 @@
+﻿#include "DescriptorSlotAllocator.h"
+#include <algorithm>
+#include <cassert>
+
+// (std::min)が参照で受け取るので定義しておく
+const uint32_t DescriptorSlotAllocator::kMaxCapacity;
+
+void DescriptorSlotAllocator::Initialize(uint32_t capacity, uint32_t releaseDelay) {
+	assert(capacity > 0 && capacity <= kMaxCapacity);
+
+	capacity_ = capacity;
+	next_ = 0;
+	allocatedCount_ = 0;
+	releaseDelay_ = releaseDelay;
+	frame_ = 0;
+	freeSlots_.clear();
+	retired_.clear();
+}
+
+uint32_t DescriptorSlotAllocator::Allocate() {
+	uint32_t slot = 0;
+	if (!freeSlots_.empty()) {
+		// 解放済みの番号を再利用
+		slot = freeSlots_.back();
+		freeSlots_.pop_back();
+	} else {
+		// 足りなければ容量を倍にする
+		if (next_ == capacity_) {
+			assert(capacity_ < kMaxCapacity);
+			capacity_ = (std::min)(capacity_ * 2, kMaxCapacity);
+		}
+		slot = next_++;
+	}
+	allocatedCount_++;
+	return slot;
+}
+
+void DescriptorSlotAllocator::Free(uint32_t slot) {
+	assert(slot < next_);
+	assert(allocatedCount_ > 0);
+
+	allocatedCount_--;
+	RetiredSlot retired;
+	retired.frame = frame_;
+	retired.slot = slot;
+	retired_.push_back(retired);
+}
+
+void DescriptorSlotAllocator::FinishFrame() {
+	frame_++;
+
+	// releaseDelayフレーム前までに解放した番号を再利用できるようにする
+	while (!retired_.empty() && retired_.front().frame + releaseDelay_ <= frame_) {
+		freeSlots_.push_back(retired_.front().slot);
+		retired_.pop_front();
+	}
+}
@@ -0,0 +1,80 @@
+﻿#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+/// <summary>
+/// デスクリプタの番号の割り当て（GPUのAPIには依存しない）
+/// 解放した番号はGPUが使い終わるまでの数フレーム待ってから再利用し、
+/// 番号が足りなくなったら容量を倍にする（呼び出し側はヒープを作り直す）
+/// </summary>
+class DescriptorSlotAllocator {
+  public: // 定数
+	// 容量の上限（シェーダから見えるCBV/SRV/UAVヒープの上限）
+	static const uint32_t kMaxCapacity = 1000000;
+
+  public: // メンバ関数
+	/// <summary>
+	/// 初期化
+	/// </summary>
+	/// <param name="capacity">最初の容量</param>
+	/// <param name="releaseDelay">解放した番号を再利用するまでのフレーム数</param>
+	void Initialize(uint32_t capacity, uint32_t releaseDelay);
+
+	/// <summary>
+	/// 番号の割り当て（空きが無ければ容量を倍にする）
+	/// </summary>
+	/// <returns>番号</returns>
+	uint32_t Allocate();
+
+	/// <summary>
+	/// 番号の解放（releaseDelayフレーム後に再利用できる）
+	/// </summary>
+	/// <param name="slot">番号</param>
+	void Free(uint32_t slot);
+
+	/// <summary>
+	/// フレームの終了（待ち終わった番号を再利用できるようにする）
+	/// </summary>
+	void FinishFrame();
+
+	/// <summary>
+	/// 容量の取得
+	/// </summary>
+	uint32_t GetCapacity() const { return capacity_; }
+
+	/// <summary>
+	/// 使用中の番号数の取得
+	/// </summary>
+	uint32_t GetAllocatedCount() const { return allocatedCount_; }
+
+	/// <summary>
+	/// 再利用を待っている番号数の取得
+	/// </summary>
+	size_t GetRetiredCount() const { return retired_.size(); }
+
+  private: // サブクラス
+	// 再利用を待っている番号
+	struct RetiredSlot {
+		uint64_t frame; // 解放したフレーム
+		uint32_t slot;  // 番号
+	};
+
+  private: // メンバ変数
+	// 容量
+	uint32_t capacity_ = 0;
+	// まだ一度も使っていない先頭の番号
+	uint32_t next_ = 0;
+	// 使用中の番号数
+	uint32_t allocatedCount_ = 0;
+	// 再利用までのフレーム数
+	uint32_t releaseDelay_ = 0;
+	// 現在のフレーム
+	uint64_t frame_ = 0;
+	// 再利用できる番号
+	std::vector<uint32_t> freeSlots_;
+	// 再利用を待っている番号（解放した順）
+	std::deque<RetiredSlot> retired_;
+};
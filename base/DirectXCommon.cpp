@@ -1,4 +1,5 @@
-﻿#include "DirectXCommon.h"
+﻿#include "ConstantBufferAllocator.h"
+#include "DirectXCommon.h"
 #include "SafeDelete.h"
 #include <algorithm>
 #include <cassert>
@@ -10,6 +11,37 @@
 
 using namespace Microsoft::WRL;
 
+namespace {
+
+/// <summary>
+/// コマンドキューとフェンスによるフレーム同期
+/// </summary>
+class QueueFence : public FrameSync::Fence {
+  public:
+	QueueFence(ID3D12CommandQueue* commandQueue, ID3D12Fence* fence)
+	    : commandQueue_(commandQueue), fence_(fence) {
+		event_ = CreateEvent(nullptr, false, false, nullptr);
+		assert(event_);
+	}
+	~QueueFence() override { CloseHandle(event_); }
+
+	void Signal(uint64_t value) override { commandQueue_->Signal(fence_, value); }
+
+	uint64_t GetCompletedValue() override { return fence_->GetCompletedValue(); }
+
+	void WaitForValue(uint64_t value) override {
+		fence_->SetEventOnCompletion(value, event_);
+		WaitForSingleObject(event_, INFINITE);
+	}
+
+  private:
+	ID3D12CommandQueue* commandQueue_;
+	ID3D12Fence* fence_;
+	HANDLE event_;
+};
+
+} // namespace
+
 DirectXCommon* DirectXCommon::GetInstance() {
 	static DirectXCommon instance;
 	return &instance;
@@ -42,11 +74,42 @@ void DirectXCommon::Initialize(WinApp* winApp, int32_t backBufferWidth, int32_t
 
 	// フェンス生成
 	CreateFence();
+
+	// フレームごとの定数バッファ確保の初期化
+	ConstantBufferAllocator::GetInstance()->Initialize(device_.Get());
+}
+
+void DirectXCommon::InitializeHeadless(
+  ID3D12Device* device, int32_t backBufferWidth, int32_t backBufferHeight) {
+	// nullptrチェック
+	assert(device);
+	assert(4 <= backBufferWidth && backBufferWidth <= 4096);
+	assert(4 <= backBufferHeight && backBufferHeight <= 4096);
+
+	winApp_ = nullptr;
+	device_ = device;
+	backBufferWidth_ = backBufferWidth;
+	backBufferHeight_ = backBufferHeight;
+
+	// コマンド関連初期化
+	InitializeCommand();
+
+	// スワップチェーンの代わりのレンダーターゲット生成
+	CreateHeadlessRenderTargets();
+
+	// 深度バッファ生成
+	CreateDepthBuffer();
+
+	// フェンス生成
+	CreateFence();
+
+	// フレームごとの定数バッファ確保の初期化
+	ConstantBufferAllocator::GetInstance()->Initialize(device_.Get());
 }
 
 void DirectXCommon::PreDraw() {
 	// バックバッファの番号を取得（2つなので0番か1番）
-	UINT bbIndex = swapChain_->GetCurrentBackBufferIndex();
+	UINT bbIndex = GetBackBufferIndex();
 
 	// リソースバリアを変更（表示状態→描画対象）
 	CD3DX12_RESOURCE_BARRIER barrier = CD3DX12_RESOURCE_BARRIER::Transition(
@@ -82,7 +145,7 @@ void DirectXCommon::PostDraw() {
 	HRESULT result;
 
 	// リソースバリアを変更（描画対象→表示状態）
-	UINT bbIndex = swapChain_->GetCurrentBackBufferIndex();
+	UINT bbIndex = GetBackBufferIndex();
 	CD3DX12_RESOURCE_BARRIER barrier = CD3DX12_RESOURCE_BARRIER::Transition(
 	  backBuffers_[bbIndex].Get(), D3D12_RESOURCE_STATE_RENDER_TARGET,
 	  D3D12_RESOURCE_STATE_PRESENT);
@@ -95,8 +158,14 @@ void DirectXCommon::PostDraw() {
 	ID3D12CommandList* cmdLists[] = {commandList_.Get()}; // コマンドリストの配列
 	commandQueue_->ExecuteCommandLists(1, cmdLists);
 
-	// バッファをフリップ
-	result = swapChain_->Present(1, 0);
+	// バッファをフリップ（ウィンドウなしは描く先を入れ替えるだけ）
+	if (!swapChain_) {
+		headlessBackBufferIndex_ =
+		  (headlessBackBufferIndex_ + 1) % static_cast<UINT>(backBuffers_.size());
+		result = S_OK;
+	} else {
+		result = swapChain_->Present(1, 0);
+	}
 #ifdef _DEBUG
 	if (FAILED(result)) {
 		ComPtr<ID3D12DeviceRemovedExtendedData> dred;
@@ -111,22 +180,29 @@ void DirectXCommon::PostDraw() {
 	}
 #endif
 
-	// コマンドリストの実行完了を待つ
-	commandQueue_->Signal(fence_.Get(), ++fenceVal_);
-	if (fence_->GetCompletedValue() != fenceVal_) {
-		HANDLE event = CreateEvent(nullptr, false, false, nullptr);
-		fence_->SetEventOnCompletion(fenceVal_, event);
-		WaitForSingleObject(event, INFINITE);
-		CloseHandle(event);
-	}
+	// このフレームの完了時のフェンス値を積む
+	uint64_t fenceValue = frameSync_.EndFrame();
+	ConstantBufferAllocator::GetInstance()->FinishFrame(fenceValue);
+
+	// 次に使うアロケータについて、前回それを使ったフレームの完了だけを待つ（直前のフレームはGPUで実行中のまま）
+	uint32_t frameIndex = frameSync_.BeginFrame();
+
+	// GPUが使い終わった定数バッファを再利用可能にする
+	ConstantBufferAllocator::GetInstance()->Reclaim(frameSync_.GetCompletedValue());
 
-	commandAllocator_->Reset(); // キューをクリア
-	commandList_->Reset(commandAllocator_.Get(),
+	// コマンドリストをリセットすると設定済みの状態は消える
+	renderContext_->GetStateCache().FinishFrame();
+	renderContext_->Invalidate();
+
+	commandAllocators_[frameIndex]->Reset(); // キューをクリア
+	commandList_->Reset(commandAllocators_[frameIndex].Get(),
 	                    nullptr); // 再びコマンドリストを貯める準備
 }
 
+void DirectXCommon::WaitForGpu() { frameSync_.WaitIdle(); }
+
 void DirectXCommon::ClearRenderTarget() {
-	UINT bbIndex = swapChain_->GetCurrentBackBufferIndex();
+	UINT bbIndex = GetBackBufferIndex();
 
 	// レンダーターゲットビュー用ディスクリプタヒープのハンドルを取得
 	CD3DX12_CPU_DESCRIPTOR_HANDLE rtvH = CD3DX12_CPU_DESCRIPTOR_HANDLE(
@@ -150,6 +226,13 @@ int32_t DirectXCommon::GetBackBufferWidth() const { return backBufferWidth_; }
 
 int32_t DirectXCommon::GetBackBufferHeight() const { return backBufferHeight_; }
 
+UINT DirectXCommon::GetBackBufferIndex() const {
+	if (!swapChain_) {
+		return headlessBackBufferIndex_;
+	}
+	return swapChain_->GetCurrentBackBufferIndex();
+}
+
 void DirectXCommon::InitializeDXGIDevice() {
 	HRESULT result = S_FALSE;
 
@@ -283,17 +366,22 @@ void DirectXCommon::CreateSwapChain() {
 void DirectXCommon::InitializeCommand() {
 	HRESULT result = S_FALSE;
 
-	// コマンドアロケータを生成
-	result = device_->CreateCommandAllocator(
-	  D3D12_COMMAND_LIST_TYPE_DIRECT, IID_PPV_ARGS(&commandAllocator_));
-	assert(SUCCEEDED(result));
+	// コマンドアロケータをフレーム数分生成
+	for (uint32_t i = 0; i < kFrameCount; i++) {
+		result = device_->CreateCommandAllocator(
+		  D3D12_COMMAND_LIST_TYPE_DIRECT, IID_PPV_ARGS(&commandAllocators_[i]));
+		assert(SUCCEEDED(result));
+	}
 
-	// コマンドリストを生成
+	// コマンドリストを生成（最初のフレームは0番のアロケータに積む）
 	result = device_->CreateCommandList(
-	  0, D3D12_COMMAND_LIST_TYPE_DIRECT, commandAllocator_.Get(), nullptr,
+	  0, D3D12_COMMAND_LIST_TYPE_DIRECT, commandAllocators_[0].Get(), nullptr,
 	  IID_PPV_ARGS(&commandList_));
 	assert(SUCCEEDED(result));
 
+	// コマンドリストに命令を積む描画コマンドの発行先を生成
+	renderContext_ = std::make_unique<D3D12RenderContext>(commandList_.Get());
+
 	// 標準設定でコマンドキューを生成
 	D3D12_COMMAND_QUEUE_DESC cmdQueueDesc{};
 	result = device_->CreateCommandQueue(&cmdQueueDesc, IID_PPV_ARGS(&commandQueue_));
@@ -307,20 +395,54 @@ void DirectXCommon::CreateFinalRenderTargets() {
 	result = swapChain_->GetDesc(&swcDesc);
 	assert(SUCCEEDED(result));
 
-	// 各種設定をしてディスクリプタヒープを生成
-	D3D12_DESCRIPTOR_HEAP_DESC heapDesc{};
-	heapDesc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_RTV; // レンダーターゲットビュー
-	heapDesc.NumDescriptors = swcDesc.BufferCount;
-	result = device_->CreateDescriptorHeap(&heapDesc, IID_PPV_ARGS(&rtvHeap_));
-	assert(SUCCEEDED(result));
-
 	// 裏表の２つ分について
 	backBuffers_.resize(swcDesc.BufferCount);
 	for (int i = 0; i < backBuffers_.size(); i++) {
 		// スワップチェーンからバッファを取得
 		result = swapChain_->GetBuffer(i, IID_PPV_ARGS(&backBuffers_[i]));
 		assert(SUCCEEDED(result));
+	}
+
+	// レンダーターゲットビューの生成
+	CreateRenderTargetViews();
+}
+
+void DirectXCommon::CreateHeadlessRenderTargets() {
+	HRESULT result = S_FALSE;
+
+	// ヒーププロパティ
+	CD3DX12_HEAP_PROPERTIES heapProps = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT);
+	// リソース設定（スワップチェーンのバッファと同じ形式）
+	CD3DX12_RESOURCE_DESC resDesc = CD3DX12_RESOURCE_DESC::Tex2D(
+	  DXGI_FORMAT_R8G8B8A8_UNORM, backBufferWidth_, backBufferHeight_, 1, 1, 1, 0,
+	  D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET);
+
+	// 裏表の２つ分について
+	backBuffers_.resize(2);
+	for (int i = 0; i < backBuffers_.size(); i++) {
+		// 表示状態から始まるのはスワップチェーンのバッファと同じ
+		result = device_->CreateCommittedResource(
+		  &heapProps, D3D12_HEAP_FLAG_NONE, &resDesc, D3D12_RESOURCE_STATE_PRESENT, nullptr,
+		  IID_PPV_ARGS(&backBuffers_[i]));
+		assert(SUCCEEDED(result));
+	}
+	headlessBackBufferIndex_ = 0;
+
+	// レンダーターゲットビューの生成
+	CreateRenderTargetViews();
+}
+
+void DirectXCommon::CreateRenderTargetViews() {
+	HRESULT result = S_FALSE;
 
+	// 各種設定をしてディスクリプタヒープを生成
+	D3D12_DESCRIPTOR_HEAP_DESC heapDesc{};
+	heapDesc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_RTV; // レンダーターゲットビュー
+	heapDesc.NumDescriptors = static_cast<UINT>(backBuffers_.size());
+	result = device_->CreateDescriptorHeap(&heapDesc, IID_PPV_ARGS(&rtvHeap_));
+	assert(SUCCEEDED(result));
+
+	for (int i = 0; i < backBuffers_.size(); i++) {
 		// ディスクリプタヒープのハンドルを取得
 		CD3DX12_CPU_DESCRIPTOR_HANDLE handle = CD3DX12_CPU_DESCRIPTOR_HANDLE(
 		  rtvHeap_->GetCPUDescriptorHandleForHeapStart(), i,
@@ -371,6 +493,10 @@ void DirectXCommon::CreateFence() {
 	HRESULT result = S_FALSE;
 
 	// フェンスの生成
-	result = device_->CreateFence(fenceVal_, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&fence_));
+	result = device_->CreateFence(0, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&fence_));
 	assert(SUCCEEDED(result));
+
+	// フレーム同期の初期化
+	frameFence_ = std::make_unique<QueueFence>(commandQueue_.Get(), fence_.Get());
+	frameSync_.Initialize(frameFence_.get(), kFrameCount);
 }
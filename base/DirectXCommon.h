@@ -5,14 +5,21 @@
 #include <d3d12.h>
 #include <d3dx12.h>
 #include <dxgi1_6.h>
+#include <memory>
 #include <wrl.h>
 
+#include "D3D12RenderContext.h"
+#include "FrameSync.h"
 #include "WinApp.h"
 
 /// <summary>
 /// DirectX汎用
 /// </summary>
 class DirectXCommon {
+  public: // 定数
+	// 同時に処理するフレーム数（CPUが次のフレームを積む間にGPUが前のフレームを描く）
+	static const uint32_t kFrameCount = 2;
+
   public: // メンバ関数
 
 	/// <summary>
@@ -28,6 +35,14 @@ class DirectXCommon {
 	  WinApp* win, int32_t backBufferWidth = WinApp::kWindowWidth,
 	  int32_t backBufferHeight = WinApp::kWindowHeight);
 
+	/// <summary>
+	/// ウィンドウなしの初期化（テスト用。スワップチェーンの代わりに画面外のレンダーターゲットに描く）
+	/// </summary>
+	/// <param name="device">使用するデバイス（WARP等）</param>
+	void InitializeHeadless(
+	  ID3D12Device* device, int32_t backBufferWidth = WinApp::kWindowWidth,
+	  int32_t backBufferHeight = WinApp::kWindowHeight);
+
 	/// <summary>
 	/// 描画前処理
 	/// </summary>
@@ -38,6 +53,11 @@ class DirectXCommon {
 	/// </summary>
 	void PostDraw();
 
+	/// <summary>
+	/// GPUの処理が全て終わるまで待つ（資源を解放する前に呼ぶ）
+	/// </summary>
+	void WaitForGpu();
+
 	/// <summary>
 	/// レンダーターゲットのクリア
 	/// </summary>
@@ -60,6 +80,18 @@ class DirectXCommon {
 	/// <returns>描画コマンドリスト</returns>
 	ID3D12GraphicsCommandList* GetCommandList() { return commandList_.Get(); }
 
+	/// <summary>
+	/// 描画コマンドリストに命令を積む描画コマンドの発行先の取得
+	/// </summary>
+	/// <returns>描画コマンドの発行先</returns>
+	D3D12RenderContext* GetRenderContext() { return renderContext_.get(); }
+
+	/// <summary>
+	/// 現在のフレーム番号を取得（0～kFrameCount-1）
+	/// </summary>
+	/// <returns>フレーム番号</returns>
+	uint32_t GetFrameIndex() const { return frameSync_.GetFrameIndex(); }
+
 	/// <summary>
 	/// バックバッファの幅取得
 	/// </summary>
@@ -80,17 +112,21 @@ class DirectXCommon {
 	Microsoft::WRL::ComPtr<IDXGIFactory7> dxgiFactory_;
 	Microsoft::WRL::ComPtr<ID3D12Device> device_;
 	Microsoft::WRL::ComPtr<ID3D12GraphicsCommandList> commandList_;
-	Microsoft::WRL::ComPtr<ID3D12CommandAllocator> commandAllocator_;
+	Microsoft::WRL::ComPtr<ID3D12CommandAllocator> commandAllocators_[kFrameCount];
 	Microsoft::WRL::ComPtr<ID3D12CommandQueue> commandQueue_;
+	std::unique_ptr<D3D12RenderContext> renderContext_;
 	Microsoft::WRL::ComPtr<IDXGISwapChain4> swapChain_;
 	std::vector<Microsoft::WRL::ComPtr<ID3D12Resource>> backBuffers_;
 	Microsoft::WRL::ComPtr<ID3D12Resource> depthBuffer_;
 	Microsoft::WRL::ComPtr<ID3D12DescriptorHeap> rtvHeap_;
 	Microsoft::WRL::ComPtr<ID3D12DescriptorHeap> dsvHeap_;
 	Microsoft::WRL::ComPtr<ID3D12Fence> fence_;
-	UINT64 fenceVal_ = 0;
+	std::unique_ptr<FrameSync::Fence> frameFence_;
+	FrameSync frameSync_;
 	int32_t backBufferWidth_ = 0;
 	int32_t backBufferHeight_ = 0;
+	// ウィンドウなしの時に描画するバックバッファの番号
+	UINT headlessBackBufferIndex_ = 0;
 
   private: // メンバ関数
 	DirectXCommon() = default;
@@ -118,6 +154,22 @@ class DirectXCommon {
 	/// </summary>
 	void CreateFinalRenderTargets();
 
+	/// <summary>
+	/// ウィンドウなしのレンダーターゲット生成
+	/// </summary>
+	void CreateHeadlessRenderTargets();
+
+	/// <summary>
+	/// レンダーターゲットビューの生成
+	/// </summary>
+	void CreateRenderTargetViews();
+
+	/// <summary>
+	/// 描画するバックバッファの番号を取得
+	/// </summary>
+	/// <returns>バックバッファの番号</returns>
+	UINT GetBackBufferIndex() const;
+
 	/// <summary>
 	/// 深度バッファ生成
 	/// </summary>
@@ -0,0 +1,43 @@
+﻿#include "FrameSync.h"
+#include <cassert>
+
+void FrameSync::Initialize(Fence* fence, uint32_t frameCount, uint64_t initialFenceValue) {
+	assert(fence);
+	assert(1 <= frameCount && frameCount <= kMaxFrameCount);
+
+	fence_ = fence;
+	frameCount_ = frameCount;
+	frameIndex_ = 0;
+	for (uint32_t i = 0; i < kMaxFrameCount; i++) {
+		frameFenceValues_[i] = initialFenceValue;
+	}
+	lastSignaledValue_ = initialFenceValue;
+	waitCount_ = 0;
+}
+
+uint32_t FrameSync::BeginFrame() {
+	// このフレーム番号を前回使った時の命令が終わるまで待つ
+	uint64_t value = frameFenceValues_[frameIndex_];
+	if (fence_->GetCompletedValue() < value) {
+		fence_->WaitForValue(value);
+		waitCount_++;
+	}
+	return frameIndex_;
+}
+
+uint64_t FrameSync::EndFrame() {
+	// このフレームの命令の後にシグナルを積む
+	uint64_t value = ++lastSignaledValue_;
+	fence_->Signal(value);
+	frameFenceValues_[frameIndex_] = value;
+
+	// 次のフレーム番号へ
+	frameIndex_ = (frameIndex_ + 1) % frameCount_;
+	return value;
+}
+
+void FrameSync::WaitIdle() {
+	if (fence_->GetCompletedValue() < lastSignaledValue_) {
+		fence_->WaitForValue(lastSignaledValue_);
+	}
+}
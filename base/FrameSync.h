@@ -0,0 +1,104 @@
+﻿#pragma once
+
+#include <cstdint>
+
+/// <summary>
+/// 複数フレームを同時に処理するためのフレーム同期（GPUのAPIには依存しない）
+/// フレームごとにフェンス値を記録し、そのフレームの資源を再利用する時だけ完了を待つ
+/// </summary>
+class FrameSync {
+  public: // サブクラス
+	/// <summary>
+	/// フェンスの操作
+	/// </summary>
+	class Fence {
+	  public:
+		virtual ~Fence() = default;
+
+		/// <summary>
+		/// 積んだ命令の後にシグナルを積む
+		/// </summary>
+		/// <param name="value">フェンス値</param>
+		virtual void Signal(uint64_t value) = 0;
+
+		/// <summary>
+		/// GPUが到達済みのフェンス値を取得
+		/// </summary>
+		virtual uint64_t GetCompletedValue() = 0;
+
+		/// <summary>
+		/// フェンス値に到達するまで待つ
+		/// </summary>
+		/// <param name="value">フェンス値</param>
+		virtual void WaitForValue(uint64_t value) = 0;
+	};
+
+  public: // 定数
+	// 同時に処理できる最大フレーム数
+	static const uint32_t kMaxFrameCount = 4;
+
+  public: // メンバ関数
+	/// <summary>
+	/// 初期化
+	/// </summary>
+	/// <param name="fence">フェンス</param>
+	/// <param name="frameCount">同時に処理するフレーム数</param>
+	/// <param name="initialFenceValue">フェンスの初期値</param>
+	void Initialize(Fence* fence, uint32_t frameCount, uint64_t initialFenceValue = 0);
+
+	/// <summary>
+	/// フレームの開始（これから使うフレームの前回分がGPUで終わっていなければ待つ）
+	/// </summary>
+	/// <returns>フレーム番号</returns>
+	uint32_t BeginFrame();
+
+	/// <summary>
+	/// フレームの終了（シグナルを積んで次のフレームへ進む）
+	/// </summary>
+	/// <returns>このフレームのフェンス値</returns>
+	uint64_t EndFrame();
+
+	/// <summary>
+	/// 積んだ全てのフレームの完了を待つ
+	/// </summary>
+	void WaitIdle();
+
+	/// <summary>
+	/// GPUが到達済みのフェンス値を取得
+	/// </summary>
+	uint64_t GetCompletedValue() { return fence_->GetCompletedValue(); }
+
+	/// <summary>
+	/// 現在のフレーム番号を取得
+	/// </summary>
+	uint32_t GetFrameIndex() const { return frameIndex_; }
+
+	/// <summary>
+	/// 同時に処理するフレーム数を取得
+	/// </summary>
+	uint32_t GetFrameCount() const { return frameCount_; }
+
+	/// <summary>
+	/// 最後に積んだフェンス値を取得
+	/// </summary>
+	uint64_t GetLastSignaledValue() const { return lastSignaledValue_; }
+
+	/// <summary>
+	/// BeginFrameでGPUを待った回数を取得
+	/// </summary>
+	uint64_t GetWaitCount() const { return waitCount_; }
+
+  private: // メンバ変数
+	// フェンス
+	Fence* fence_ = nullptr;
+	// 同時に処理するフレーム数
+	uint32_t frameCount_ = 0;
+	// 現在のフレーム番号
+	uint32_t frameIndex_ = 0;
+	// フレームごとの最後のフェンス値
+	uint64_t frameFenceValues_[kMaxFrameCount] = {};
+	// 最後に積んだフェンス値
+	uint64_t lastSignaledValue_ = 0;
+	// GPUを待った回数
+	uint64_t waitCount_ = 0;
+};
@@ -0,0 +1,219 @@
+﻿#include "JobSystem.h"
+#include <cassert>
+
+namespace {
+
+// 登録されていないスレッドの番号
+const uint32_t kUnregistered = UINT32_MAX;
+
+// 呼び出しスレッドのキュー番号
+thread_local uint32_t tQueueIndex = kUnregistered;
+
+} // namespace
+
+JobSystem* JobSystem::GetInstance() {
+	static JobSystem instance;
+	return &instance;
+}
+
+void JobSystem::Initialize(uint32_t threadCount) {
+	assert(queues_.empty());
+
+	if (threadCount == 0) {
+		uint32_t hardwareThreads = std::thread::hardware_concurrency();
+		threadCount = hardwareThreads > 1 ? hardwareThreads - 1 : 0;
+	}
+
+	stop_ = false;
+	queues_.reserve(threadCount + 1);
+	for (uint32_t i = 0; i < threadCount + 1; i++) {
+		queues_.push_back(std::make_unique<WorkQueue>());
+	}
+
+	// 呼び出したスレッドは0番
+	tQueueIndex = 0;
+
+	workers_.reserve(threadCount);
+	for (uint32_t i = 0; i < threadCount; i++) {
+		workers_.emplace_back(&JobSystem::WorkerMain, this, i + 1);
+	}
+}
+
+void JobSystem::Finalize() {
+	{
+		std::lock_guard<std::mutex> lock(sleepMutex_);
+		stop_ = true;
+	}
+	sleepCondition_.notify_all();
+	for (std::thread& worker : workers_) {
+		worker.join();
+	}
+	workers_.clear();
+	queues_.clear();
+	backgroundQueue_.jobs.clear();
+	tQueueIndex = kUnregistered;
+}
+
+void JobSystem::Run(Counter& counter, std::function<void()> job) {
+	// ワーカーがいなければその場で実行
+	if (workers_.empty()) {
+		job();
+		return;
+	}
+
+	counter.pending_.fetch_add(1, std::memory_order_relaxed);
+
+	// 自分のキューの後ろに積む
+	// 数は積む前に同じ排他の中で増やす（取り出した側が先に減らして0を下回ることがない）
+	WorkQueue& queue = *queues_[GetQueueIndex()];
+	{
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		queuedJobCount_++;
+		queue.jobs.push_back({std::move(job), &counter});
+	}
+
+	WakeWorker();
+}
+
+void JobSystem::RunBackground(Counter& counter, std::function<void()> job) {
+	// ワーカーがいなければその場で実行
+	if (workers_.empty()) {
+		job();
+		return;
+	}
+
+	counter.pending_.fetch_add(1, std::memory_order_relaxed);
+
+	// 積んだ順に処理する
+	{
+		std::lock_guard<std::mutex> lock(backgroundQueue_.mutex);
+		queuedJobCount_++;
+		backgroundQueue_.jobs.push_back({std::move(job), &counter});
+	}
+
+	WakeWorker();
+}
+
+void JobSystem::Wait(Counter& counter) {
+	if (queues_.empty()) {
+		return;
+	}
+
+	// 待つ間も仕事を処理する（入れ子のジョブからWaitしても止まらない）
+	uint32_t queueIndex = GetQueueIndex();
+	while (!counter.IsDone()) {
+		if (!TryRunJob(queueIndex)) {
+			std::this_thread::yield();
+		}
+	}
+}
+
+void JobSystem::ParallelFor(
+  size_t count, size_t grainSize, const std::function<void(size_t, size_t)>& function) {
+	if (count == 0) {
+		return;
+	}
+	if (grainSize == 0) {
+		grainSize = 1;
+	}
+	if (count <= grainSize || workers_.empty()) {
+		function(0, count);
+		return;
+	}
+
+	Counter counter;
+	SplitRange(counter, 0, count, grainSize, function);
+	Wait(counter);
+}
+
+void JobSystem::SplitRange(
+  Counter& counter, size_t begin, size_t end, size_t grainSize,
+  const std::function<void(size_t, size_t)>& function) {
+	// 後半を積み、前半を自分で処理する（積んだ後半は他のスレッドが盗んでさらに分割する）
+	while (end - begin > grainSize) {
+		size_t middle = begin + (end - begin) / 2;
+		Run(counter, [this, &counter, middle, end, grainSize, &function]() {
+			SplitRange(counter, middle, end, grainSize, function);
+		});
+		end = middle;
+	}
+	function(begin, end);
+}
+
+void JobSystem::WorkerMain(uint32_t queueIndex) {
+	tQueueIndex = queueIndex;
+
+	while (true) {
+		// 細かいジョブを優先し、なければ時間のかかるジョブを処理する
+		if (TryRunJob(queueIndex) || TryRunBackgroundJob()) {
+			continue;
+		}
+
+		// 仕事がなければ到着まで眠る
+		std::unique_lock<std::mutex> lock(sleepMutex_);
+		sleepCondition_.wait(lock, [this]() { return stop_ || queuedJobCount_ > 0; });
+		if (stop_) {
+			return;
+		}
+	}
+}
+
+bool JobSystem::TryRunJob(uint32_t queueIndex) {
+	Job job;
+
+	// 自分のキューの後ろから（最後に積んだ小さい仕事を優先）
+	bool found = PopJob(*queues_[queueIndex], true, job);
+
+	// 他のスレッドのキューの前から盗む（先に積まれた大きい仕事）
+	const uint32_t queueCount = static_cast<uint32_t>(queues_.size());
+	for (uint32_t i = 1; !found && i < queueCount; i++) {
+		found = PopJob(*queues_[(queueIndex + i) % queueCount], false, job);
+	}
+
+	if (!found) {
+		return false;
+	}
+	ExecuteJob(job);
+	return true;
+}
+
+bool JobSystem::TryRunBackgroundJob() {
+	Job job;
+	if (!PopJob(backgroundQueue_, false, job)) {
+		return false;
+	}
+	ExecuteJob(job);
+	return true;
+}
+
+bool JobSystem::PopJob(WorkQueue& queue, bool fromBack, Job& job) {
+	std::lock_guard<std::mutex> lock(queue.mutex);
+	if (queue.jobs.empty()) {
+		return false;
+	}
+	if (fromBack) {
+		job = std::move(queue.jobs.back());
+		queue.jobs.pop_back();
+	} else {
+		job = std::move(queue.jobs.front());
+		queue.jobs.pop_front();
+	}
+	queuedJobCount_--;
+	return true;
+}
+
+void JobSystem::ExecuteJob(Job& job) {
+	job.function();
+	job.counter->pending_.fetch_sub(1, std::memory_order_release);
+}
+
+void JobSystem::WakeWorker() {
+	// 眠る直前の判定と通知が入れ違わないよう、待機の排他を一度取ってから起こす
+	{ std::lock_guard<std::mutex> lock(sleepMutex_); }
+	sleepCondition_.notify_one();
+}
+
+uint32_t JobSystem::GetQueueIndex() const {
+	// 登録されていないスレッドは0番のキューを共有する（キューは排他されている）
+	return tQueueIndex != kUnregistered ? tQueueIndex : 0;
+}
@@ -0,0 +1,150 @@
+﻿#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/// <summary>
+/// ワークスティーリング型のジョブシステム
+/// スレッドごとに仕事の両端キューを持ち、自分のキューは後ろから、他のキューは前から取り出す
+/// モデルやテクスチャの非同期読み込みも同じワーカーで処理する（ワーカーはこのクラスだけが持つ）
+/// </summary>
+class JobSystem {
+  public: // サブクラス
+	/// <summary>
+	/// 完了待ち用のカウンタ（Runで増え、ジョブの完了で減る）
+	/// </summary>
+	class Counter {
+	  public:
+		/// <summary>
+		/// 全てのジョブが終わったか
+		/// </summary>
+		bool IsDone() const { return pending_.load(std::memory_order_acquire) == 0; }
+
+	  private:
+		friend class JobSystem;
+		// 未完了のジョブ数
+		std::atomic<uint32_t> pending_{0};
+	};
+
+  public: // 静的メンバ関数
+	/// <summary>
+	/// シングルトンインスタンスの取得
+	/// </summary>
+	/// <returns>シングルトンインスタンス</returns>
+	static JobSystem* GetInstance();
+
+  public: // メンバ関数
+	/// <summary>
+	/// 初期化（呼び出したスレッドもキュー0番として参加する）
+	/// </summary>
+	/// <param name="threadCount">ワーカー数（0ならハードウェアスレッド数 - 1）</param>
+	void Initialize(uint32_t threadCount = 0);
+
+	/// <summary>
+	/// 終了処理（全てのジョブをWaitしてから呼ぶ）
+	/// </summary>
+	void Finalize();
+
+	/// <summary>
+	/// ジョブを積む（初期化前やワーカーがいなければその場で実行）
+	/// </summary>
+	/// <param name="counter">完了待ち用のカウンタ</param>
+	/// <param name="job">ジョブ</param>
+	void Run(Counter& counter, std::function<void()> job);
+
+	/// <summary>
+	/// 時間のかかるジョブを積む（ファイルの読み込みなど、初期化前やワーカーがいなければその場で実行）
+	/// ワーカーが手すきの時だけ処理し、Waitで待っているスレッドは拾わない
+	/// </summary>
+	/// <param name="counter">完了待ち用のカウンタ</param>
+	/// <param name="job">ジョブ</param>
+	void RunBackground(Counter& counter, std::function<void()> job);
+
+	/// <summary>
+	/// カウンタの完了を待つ（待っている間も他のジョブを処理する）
+	/// </summary>
+	/// <param name="counter">完了待ち用のカウンタ</param>
+	void Wait(Counter& counter);
+
+	/// <summary>
+	/// [0, count) を範囲を二分しながら並列に処理する
+	/// </summary>
+	/// <param name="count">要素数</param>
+	/// <param name="grainSize">1つのジョブで処理する最大要素数</param>
+	/// <param name="function">範囲 [begin, end) ごとの処理</param>
+	void ParallelFor(
+	  size_t count, size_t grainSize, const std::function<void(size_t, size_t)>& function);
+
+	/// <summary>
+	/// 処理に参加するスレッド数を取得（ワーカー + 初期化したスレッド）
+	/// </summary>
+	size_t GetThreadCount() const { return workers_.size() + 1; }
+
+  private: // サブクラス
+	// ジョブ
+	struct Job {
+		std::function<void()> function;
+		Counter* counter = nullptr;
+	};
+
+	// スレッドごとのキュー
+	struct WorkQueue {
+		std::mutex mutex;
+		std::deque<Job> jobs;
+	};
+
+  private: // メンバ関数
+	JobSystem() = default;
+	~JobSystem() = default;
+	JobSystem(const JobSystem&) = delete;
+	const JobSystem& operator=(const JobSystem&) = delete;
+
+	// ワーカーの処理
+	void WorkerMain(uint32_t queueIndex);
+
+	// ジョブを1つ取り出して実行する（なければfalse）
+	bool TryRunJob(uint32_t queueIndex);
+
+	// 時間のかかるジョブを1つ取り出して実行する（なければfalse）
+	bool TryRunBackgroundJob();
+
+	// キューから1つ取り出す（fromBackなら後ろから）
+	bool PopJob(WorkQueue& queue, bool fromBack, Job& job);
+
+	// 取り出したジョブを実行してカウンタを減らす
+	static void ExecuteJob(Job& job);
+
+	// 寝ているワーカーを1つ起こす
+	void WakeWorker();
+
+	// 呼び出しスレッドのキュー番号を取得
+	uint32_t GetQueueIndex() const;
+
+	// 範囲を二分して片方をジョブに積み、残りを自分で処理する
+	void SplitRange(
+	  Counter& counter, size_t begin, size_t end, size_t grainSize,
+	  const std::function<void(size_t, size_t)>& function);
+
+  private: // メンバ変数
+	// スレッドごとのキュー（0番は初期化したスレッド）
+	std::vector<std::unique_ptr<WorkQueue>> queues_;
+	// 時間のかかるジョブのキュー（ワーカーだけが先頭から取り出す）
+	WorkQueue backgroundQueue_;
+	// ワーカースレッド
+	std::vector<std::thread> workers_;
+	// キューに残っているジョブ数（積む時と取り出す時にキューの排他の中で増減する）
+	std::atomic<uint32_t> queuedJobCount_{0};
+	// 待機の排他
+	std::mutex sleepMutex_;
+	// ジョブの到着通知
+	std::condition_variable sleepCondition_;
+	// 終了要求
+	bool stop_ = false;
+};
@@ -0,0 +1,49 @@
+﻿#pragma once
+
+#include <Windows.h>
+#include <string>
+
+/// <summary>
+/// 読み込み専用メモリマップドファイル
+/// </summary>
+class MappedFile {
+  public: // メンバ関数
+	MappedFile() = default;
+	~MappedFile();
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	/// <summary>
+	/// ファイルを開いてメモリにマッピングする
+	/// </summary>
+	/// <param name="filePath">ファイルパス</param>
+	/// <returns>成否</returns>
+	bool Open(const std::string& filePath);
+
+	/// <summary>
+	/// マッピングを解除してファイルを閉じる
+	/// </summary>
+	void Close();
+
+	/// <summary>
+	/// 先頭アドレスを取得
+	/// </summary>
+	/// <returns>先頭アドレス（空ファイルならnullptr）</returns>
+	const char* GetData() const { return data_; }
+
+	/// <summary>
+	/// ファイルサイズを取得
+	/// </summary>
+	/// <returns>ファイルサイズ（バイト）</returns>
+	size_t GetSize() const { return size_; }
+
+  private: // メンバ変数
+	// ファイルハンドル
+	HANDLE file_ = INVALID_HANDLE_VALUE;
+	// ファイルマッピングハンドル
+	HANDLE mapping_ = nullptr;
+	// マッピング先アドレス
+	const char* data_ = nullptr;
+	// ファイルサイズ
+	size_t size_ = 0;
+};
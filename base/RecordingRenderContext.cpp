@@ -0,0 +1,219 @@
+﻿#include "RecordingRenderContext.h"
+#include <cassert>
+#include <cinttypes>
+#include <cstdio>
+
+namespace {
+
+// 命令の名前
+const char* const kCommandNames[] = {
+  "SetRootSignature",
+  "SetPipelineState",
+  "SetPrimitiveTopology",
+  "SetDescriptorHeaps",
+  "SetConstantBufferView",
+  "SetShaderResourceView",
+  "SetDescriptorTable",
+  "SetVertexBuffers",
+  "SetIndexBuffer",
+  "Draw",
+  "DrawIndexed",
+  "Upload",
+};
+static_assert(
+  sizeof(kCommandNames) / sizeof(kCommandNames[0]) ==
+    size_t(RecordingRenderContext::CommandType::kCountOfCommandType),
+  "命令の名前が足りない");
+
+} // namespace
+
+void RecordingRenderContext::SetGraphicsRootSignature(ID3D12RootSignature* rootSignature) {
+	Push(CommandType::kSetRootSignature, GetObjectId(rootSignature));
+}
+
+void RecordingRenderContext::SetPipelineState(ID3D12PipelineState* pipelineState) {
+	Push(CommandType::kSetPipelineState, GetObjectId(pipelineState));
+}
+
+void RecordingRenderContext::SetPrimitiveTopology(D3D12_PRIMITIVE_TOPOLOGY topology) {
+	Push(CommandType::kSetPrimitiveTopology, static_cast<uint64_t>(topology));
+}
+
+void RecordingRenderContext::SetDescriptorHeaps(UINT count, ID3D12DescriptorHeap* const* heaps) {
+	// CBV/SRV/UAVとサンプラーの最大2つ
+	Push(
+	  CommandType::kSetDescriptorHeaps, count, count > 0 ? GetObjectId(heaps[0]) : 0,
+	  count > 1 ? GetObjectId(heaps[1]) : 0);
+}
+
+void RecordingRenderContext::SetGraphicsRootConstantBufferView(
+  UINT rootParameterIndex, D3D12_GPU_VIRTUAL_ADDRESS address) {
+	Push(CommandType::kSetConstantBufferView, rootParameterIndex, address);
+}
+
+void RecordingRenderContext::SetGraphicsRootShaderResourceView(
+  UINT rootParameterIndex, D3D12_GPU_VIRTUAL_ADDRESS address) {
+	Push(CommandType::kSetShaderResourceView, rootParameterIndex, address);
+}
+
+void RecordingRenderContext::SetGraphicsRootDescriptorTable(
+  UINT rootParameterIndex, D3D12_GPU_DESCRIPTOR_HANDLE descriptor) {
+	Push(CommandType::kSetDescriptorTable, rootParameterIndex, descriptor.ptr);
+}
+
+void RecordingRenderContext::SetVertexBuffers(
+  UINT startSlot, UINT count, const D3D12_VERTEX_BUFFER_VIEW* views) {
+	// 先頭の頂点バッファだけを記録する
+	Push(
+	  CommandType::kSetVertexBuffers, startSlot, count, count > 0 ? views[0].BufferLocation : 0,
+	  count > 0 ? views[0].SizeInBytes : 0, count > 0 ? views[0].StrideInBytes : 0);
+}
+
+void RecordingRenderContext::SetIndexBuffer(const D3D12_INDEX_BUFFER_VIEW* view) {
+	if (!view) {
+		Push(CommandType::kSetIndexBuffer);
+		return;
+	}
+	Push(
+	  CommandType::kSetIndexBuffer, view->BufferLocation, view->SizeInBytes,
+	  static_cast<uint64_t>(view->Format));
+}
+
+void RecordingRenderContext::DrawInstanced(
+  UINT vertexCountPerInstance, UINT instanceCount, UINT startVertexLocation,
+  UINT startInstanceLocation) {
+	Push(
+	  CommandType::kDraw, vertexCountPerInstance, instanceCount, startVertexLocation,
+	  startInstanceLocation);
+}
+
+void RecordingRenderContext::DrawIndexedInstanced(
+  UINT indexCountPerInstance, UINT instanceCount, UINT startIndexLocation, INT baseVertexLocation,
+  UINT startInstanceLocation) {
+	Push(
+	  CommandType::kDrawIndexed, indexCountPerInstance, instanceCount, startIndexLocation,
+	  static_cast<uint64_t>(static_cast<int64_t>(baseVertexLocation)), startInstanceLocation);
+}
+
+void RecordingRenderContext::RecordUpload(
+  D3D12_GPU_VIRTUAL_ADDRESS address, const void* data, size_t size) {
+	(void)data;
+	Push(CommandType::kUpload, address, size);
+	uploadedBytes_ += size;
+}
+
+void RecordingRenderContext::Clear() {
+	commands_.clear();
+	for (size_t& count : counts_) {
+		count = 0;
+	}
+	uploadedBytes_ = 0;
+	objectIds_.clear();
+	objects_.clear();
+}
+
+std::string RecordingRenderContext::ToString() const {
+	std::string text;
+	char line[256];
+	for (const Command& command : commands_) {
+		snprintf(
+		  line, sizeof(line), "%s %" PRIu64 " %" PRIu64 " %" PRIu64 " %" PRIu64 " %" PRIu64 "\n",
+		  kCommandNames[size_t(command.type)], command.args[0], command.args[1], command.args[2],
+		  command.args[3], command.args[4]);
+		text += line;
+	}
+	return text;
+}
+
+void RecordingRenderContext::Replay(RenderContext& target) const {
+	for (const Command& command : commands_) {
+		const uint64_t* args = command.args;
+		switch (command.type) {
+		case CommandType::kSetRootSignature:
+			target.SetGraphicsRootSignature(static_cast<ID3D12RootSignature*>(GetObjectPointer(args[0])));
+			break;
+		case CommandType::kSetPipelineState:
+			target.SetPipelineState(static_cast<ID3D12PipelineState*>(GetObjectPointer(args[0])));
+			break;
+		case CommandType::kSetPrimitiveTopology:
+			target.SetPrimitiveTopology(static_cast<D3D12_PRIMITIVE_TOPOLOGY>(args[0]));
+			break;
+		case CommandType::kSetDescriptorHeaps: {
+			ID3D12DescriptorHeap* heaps[2] = {
+			  static_cast<ID3D12DescriptorHeap*>(GetObjectPointer(args[1])),
+			  static_cast<ID3D12DescriptorHeap*>(GetObjectPointer(args[2]))};
+			target.SetDescriptorHeaps(static_cast<UINT>(args[0]), heaps);
+			break;
+		}
+		case CommandType::kSetConstantBufferView:
+			target.SetGraphicsRootConstantBufferView(static_cast<UINT>(args[0]), args[1]);
+			break;
+		case CommandType::kSetShaderResourceView:
+			target.SetGraphicsRootShaderResourceView(static_cast<UINT>(args[0]), args[1]);
+			break;
+		case CommandType::kSetDescriptorTable: {
+			D3D12_GPU_DESCRIPTOR_HANDLE descriptor;
+			descriptor.ptr = args[1];
+			target.SetGraphicsRootDescriptorTable(static_cast<UINT>(args[0]), descriptor);
+			break;
+		}
+		case CommandType::kSetVertexBuffers: {
+			// 記録しているのは先頭の頂点バッファだけ
+			assert(args[1] <= 1);
+			D3D12_VERTEX_BUFFER_VIEW view;
+			view.BufferLocation = args[2];
+			view.SizeInBytes = static_cast<UINT>(args[3]);
+			view.StrideInBytes = static_cast<UINT>(args[4]);
+			target.SetVertexBuffers(static_cast<UINT>(args[0]), static_cast<UINT>(args[1]), &view);
+			break;
+		}
+		case CommandType::kSetIndexBuffer: {
+			// 引数が全て0なら解除
+			if (args[0] == 0 && args[1] == 0) {
+				target.SetIndexBuffer(nullptr);
+				break;
+			}
+			D3D12_INDEX_BUFFER_VIEW view;
+			view.BufferLocation = args[0];
+			view.SizeInBytes = static_cast<UINT>(args[1]);
+			view.Format = static_cast<DXGI_FORMAT>(args[2]);
+			target.SetIndexBuffer(&view);
+			break;
+		}
+		case CommandType::kDraw:
+			target.DrawInstanced(
+			  static_cast<UINT>(args[0]), static_cast<UINT>(args[1]), static_cast<UINT>(args[2]),
+			  static_cast<UINT>(args[3]));
+			break;
+		case CommandType::kDrawIndexed:
+			target.DrawIndexedInstanced(
+			  static_cast<UINT>(args[0]), static_cast<UINT>(args[1]), static_cast<UINT>(args[2]),
+			  static_cast<INT>(static_cast<int64_t>(args[3])), static_cast<UINT>(args[4]));
+			break;
+		case CommandType::kUpload:
+			target.RecordUpload(args[0], nullptr, static_cast<size_t>(args[1]));
+			break;
+		default:
+			assert(0);
+			break;
+		}
+	}
+}
+
+void RecordingRenderContext::Push(
+  CommandType type, uint64_t arg0, uint64_t arg1, uint64_t arg2, uint64_t arg3, uint64_t arg4) {
+	commands_.push_back({type, {arg0, arg1, arg2, arg3, arg4}});
+	counts_[size_t(type)]++;
+}
+
+uint64_t RecordingRenderContext::GetObjectId(void* object) {
+	if (!object) {
+		return 0;
+	}
+	// 初めて見たポインタには1から順に番号を振る
+	auto result = objectIds_.emplace(object, objectIds_.size() + 1);
+	if (result.second) {
+		objects_.push_back(object);
+	}
+	return result.first->second;
+}
@@ -0,0 +1,129 @@
+﻿#pragma once
+
+#include "RenderContext.h"
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/// <summary>
+/// 命令をGPUに送らずに記録するだけの描画コマンドの発行先
+/// 描画数や状態変更数の計測、命令列の比較（ゴールデンテスト）に使う
+/// 対象はフレームごとの命令列だけで、デバイス・PSO・テクスチャなどのリソースの生成はD3D12で行う
+/// </summary>
+class RecordingRenderContext : public RenderContext {
+  public: // 列挙子
+	/// <summary>
+	/// 命令の種類
+	/// </summary>
+	enum class CommandType {
+		kSetRootSignature,       // ルートシグネチャ
+		kSetPipelineState,       // パイプラインステート
+		kSetPrimitiveTopology,   // プリミティブ形状
+		kSetDescriptorHeaps,     // デスクリプタヒープ
+		kSetConstantBufferView,  // 定数バッファビュー
+		kSetShaderResourceView,  // シェーダリソースビュー
+		kSetDescriptorTable,     // デスクリプタテーブル
+		kSetVertexBuffers,       // 頂点バッファ
+		kSetIndexBuffer,         // インデックスバッファ
+		kDraw,                   // 描画
+		kDrawIndexed,            // インデックス付き描画
+		kUpload,                 // アップロードバッファへの書き込み
+
+		kCountOfCommandType, // 種類数
+	};
+
+  public: // サブクラス
+	/// <summary>
+	/// 記録した命令
+	/// </summary>
+	struct Command {
+		CommandType type;
+		// 引数（ポインタは記録順に振った番号、GPUアドレスはそのままの値）
+		uint64_t args[5];
+	};
+
+  public: // メンバ関数
+	void SetGraphicsRootSignature(ID3D12RootSignature* rootSignature) override;
+	void SetPipelineState(ID3D12PipelineState* pipelineState) override;
+	void SetPrimitiveTopology(D3D12_PRIMITIVE_TOPOLOGY topology) override;
+	void SetDescriptorHeaps(UINT count, ID3D12DescriptorHeap* const* heaps) override;
+	void SetGraphicsRootConstantBufferView(
+	  UINT rootParameterIndex, D3D12_GPU_VIRTUAL_ADDRESS address) override;
+	void SetGraphicsRootShaderResourceView(
+	  UINT rootParameterIndex, D3D12_GPU_VIRTUAL_ADDRESS address) override;
+	void SetGraphicsRootDescriptorTable(
+	  UINT rootParameterIndex, D3D12_GPU_DESCRIPTOR_HANDLE descriptor) override;
+	void SetVertexBuffers(UINT startSlot, UINT count, const D3D12_VERTEX_BUFFER_VIEW* views) override;
+	void SetIndexBuffer(const D3D12_INDEX_BUFFER_VIEW* view) override;
+	void DrawInstanced(
+	  UINT vertexCountPerInstance, UINT instanceCount, UINT startVertexLocation,
+	  UINT startInstanceLocation) override;
+	void DrawIndexedInstanced(
+	  UINT indexCountPerInstance, UINT instanceCount, UINT startIndexLocation,
+	  INT baseVertexLocation, UINT startInstanceLocation) override;
+	void RecordUpload(D3D12_GPU_VIRTUAL_ADDRESS address, const void* data, size_t size) override;
+
+	/// <summary>
+	/// 記録した命令を取得
+	/// </summary>
+	const std::vector<Command>& GetCommands() const { return commands_; }
+
+	/// <summary>
+	/// 種類ごとの命令数を取得
+	/// </summary>
+	size_t GetCommandCount(CommandType type) const { return counts_[size_t(type)]; }
+
+	/// <summary>
+	/// 描画命令の数を取得
+	/// </summary>
+	size_t GetDrawCount() const {
+		return GetCommandCount(CommandType::kDraw) + GetCommandCount(CommandType::kDrawIndexed);
+	}
+
+	/// <summary>
+	/// 書き込んだ合計バイト数を取得
+	/// </summary>
+	uint64_t GetUploadedBytes() const { return uploadedBytes_; }
+
+	/// <summary>
+	/// 記録を消去する（ポインタの番号も振り直す）
+	/// </summary>
+	void Clear();
+
+	/// <summary>
+	/// 記録した命令列を1行1命令の文字列にする（比較用）
+	/// </summary>
+	std::string ToString() const;
+
+	/// <summary>
+	/// 記録した命令を別の発行先で順に実行し直す（記録したポインタの指すオブジェクトが生きている間だけ呼べる）
+	/// 書き込みの中身は記録していないので、RecordUploadにはnullptrを渡す
+	/// </summary>
+	/// <param name="target">発行先</param>
+	void Replay(RenderContext& target) const;
+
+  private: // メンバ関数
+	// 命令の追加
+	void Push(
+	  CommandType type, uint64_t arg0 = 0, uint64_t arg1 = 0, uint64_t arg2 = 0,
+	  uint64_t arg3 = 0, uint64_t arg4 = 0);
+
+	// ポインタを記録順の番号にする（実行ごとに値が変わるため）
+	uint64_t GetObjectId(void* object);
+
+	// 番号からポインタに戻す
+	void* GetObjectPointer(uint64_t id) const { return id > 0 ? objects_[id - 1] : nullptr; }
+
+  private: // メンバ変数
+	// 記録した命令
+	std::vector<Command> commands_;
+	// 種類ごとの命令数
+	size_t counts_[size_t(CommandType::kCountOfCommandType)] = {};
+	// 書き込んだ合計バイト数
+	uint64_t uploadedBytes_ = 0;
+	// ポインタと番号の対応
+	std::unordered_map<const void*, uint64_t> objectIds_;
+	// 番号順のポインタ（再生用）
+	std::vector<void*> objects_;
+};
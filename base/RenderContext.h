@@ -0,0 +1,89 @@
+﻿#pragma once
+
+#include <cstddef>
+#include <d3d12.h>
+
+/// <summary>
+/// 描画コマンドの発行先
+/// Model・Sprite・TextureManagerなどはコマンドリストではなくこのインターフェースに命令を積む
+/// （D3D12のコマンドリストに流すもの、記録するだけのものを差し替えられる）
+/// </summary>
+class RenderContext {
+  public: // メンバ関数
+	virtual ~RenderContext() = default;
+
+	/// <summary>
+	/// ルートシグネチャの設定
+	/// </summary>
+	virtual void SetGraphicsRootSignature(ID3D12RootSignature* rootSignature) = 0;
+
+	/// <summary>
+	/// パイプラインステートの設定
+	/// </summary>
+	virtual void SetPipelineState(ID3D12PipelineState* pipelineState) = 0;
+
+	/// <summary>
+	/// プリミティブ形状の設定
+	/// </summary>
+	virtual void SetPrimitiveTopology(D3D12_PRIMITIVE_TOPOLOGY topology) = 0;
+
+	/// <summary>
+	/// デスクリプタヒープの設定
+	/// </summary>
+	virtual void SetDescriptorHeaps(UINT count, ID3D12DescriptorHeap* const* heaps) = 0;
+
+	/// <summary>
+	/// ルートパラメータに定数バッファビューを設定
+	/// </summary>
+	virtual void
+	  SetGraphicsRootConstantBufferView(UINT rootParameterIndex, D3D12_GPU_VIRTUAL_ADDRESS address) = 0;
+
+	/// <summary>
+	/// ルートパラメータにシェーダリソースビューを設定（バッファのみ）
+	/// </summary>
+	virtual void
+	  SetGraphicsRootShaderResourceView(UINT rootParameterIndex, D3D12_GPU_VIRTUAL_ADDRESS address) = 0;
+
+	/// <summary>
+	/// ルートパラメータにデスクリプタテーブルを設定
+	/// </summary>
+	virtual void SetGraphicsRootDescriptorTable(
+	  UINT rootParameterIndex, D3D12_GPU_DESCRIPTOR_HANDLE descriptor) = 0;
+
+	/// <summary>
+	/// 頂点バッファの設定
+	/// </summary>
+	virtual void
+	  SetVertexBuffers(UINT startSlot, UINT count, const D3D12_VERTEX_BUFFER_VIEW* views) = 0;
+
+	/// <summary>
+	/// インデックスバッファの設定
+	/// </summary>
+	virtual void SetIndexBuffer(const D3D12_INDEX_BUFFER_VIEW* view) = 0;
+
+	/// <summary>
+	/// 描画
+	/// </summary>
+	virtual void DrawInstanced(
+	  UINT vertexCountPerInstance, UINT instanceCount, UINT startVertexLocation,
+	  UINT startInstanceLocation) = 0;
+
+	/// <summary>
+	/// インデックス付き描画
+	/// </summary>
+	virtual void DrawIndexedInstanced(
+	  UINT indexCountPerInstance, UINT instanceCount, UINT startIndexLocation,
+	  INT baseVertexLocation, UINT startInstanceLocation) = 0;
+
+	/// <summary>
+	/// アップロードバッファへの書き込みの通知（記録用、既定では何もしない）
+	/// </summary>
+	/// <param name="address">書き込み先のGPUアドレス</param>
+	/// <param name="data">データ</param>
+	/// <param name="size">大きさ</param>
+	virtual void RecordUpload(D3D12_GPU_VIRTUAL_ADDRESS address, const void* data, size_t size) {
+		(void)address;
+		(void)data;
+		(void)size;
+	}
+};
@@ -0,0 +1,166 @@
+﻿#include "RenderStateCache.h"
+
+uint32_t RenderStateCache::Stats::GetIssuedCount() const {
+	uint32_t count = 0;
+	for (uint32_t issued : issuedCounts) {
+		count += issued;
+	}
+	return count;
+}
+
+uint32_t RenderStateCache::Stats::GetSkippedCount() const {
+	uint32_t count = 0;
+	for (uint32_t skipped : skippedCounts) {
+		count += skipped;
+	}
+	return count;
+}
+
+bool RenderStateCache::SetRootSignature(ID3D12RootSignature* rootSignature) {
+	if (!Count(StateType::kRootSignature, rootSignature_ != rootSignature)) {
+		return false;
+	}
+	rootSignature_ = rootSignature;
+	// ルートシグネチャが変わるとルートパラメータは引き継がれない
+	for (RootParameter& rootParameter : rootParameters_) {
+		rootParameter = RootParameter();
+	}
+	return true;
+}
+
+bool RenderStateCache::SetPipelineState(ID3D12PipelineState* pipelineState) {
+	if (!Count(StateType::kPipelineState, pipelineState_ != pipelineState)) {
+		return false;
+	}
+	pipelineState_ = pipelineState;
+	return true;
+}
+
+bool RenderStateCache::SetPrimitiveTopology(D3D12_PRIMITIVE_TOPOLOGY topology) {
+	if (!Count(StateType::kPrimitiveTopology, topology_ != topology)) {
+		return false;
+	}
+	topology_ = topology;
+	return true;
+}
+
+bool RenderStateCache::SetDescriptorHeaps(UINT count, ID3D12DescriptorHeap* const* heaps) {
+	bool same = count == descriptorHeapCount_;
+	for (UINT i = 0; same && i < count; i++) {
+		same = descriptorHeaps_[i] == heaps[i];
+	}
+	if (!Count(StateType::kDescriptorHeaps, !same)) {
+		return false;
+	}
+
+	// 記憶できない数なら次は必ず設定し直す
+	descriptorHeapCount_ = count <= kMaxDescriptorHeapCount ? count : UINT32_MAX;
+	for (UINT i = 0; i < count && i < kMaxDescriptorHeapCount; i++) {
+		descriptorHeaps_[i] = heaps[i];
+	}
+	// ヒープが変わると設定済みのデスクリプタテーブルは使えない
+	for (RootParameter& rootParameter : rootParameters_) {
+		if (rootParameter.type == RootParameterType::kDescriptorTable) {
+			rootParameter = RootParameter();
+		}
+	}
+	return true;
+}
+
+bool RenderStateCache::SetRootConstantBufferView(
+  UINT rootParameterIndex, D3D12_GPU_VIRTUAL_ADDRESS address) {
+	return SetRootParameter(rootParameterIndex, RootParameterType::kConstantBufferView, address);
+}
+
+bool RenderStateCache::SetRootShaderResourceView(
+  UINT rootParameterIndex, D3D12_GPU_VIRTUAL_ADDRESS address) {
+	return SetRootParameter(rootParameterIndex, RootParameterType::kShaderResourceView, address);
+}
+
+bool RenderStateCache::SetRootDescriptorTable(
+  UINT rootParameterIndex, D3D12_GPU_DESCRIPTOR_HANDLE descriptor) {
+	return SetRootParameter(
+	  rootParameterIndex, RootParameterType::kDescriptorTable, descriptor.ptr);
+}
+
+bool RenderStateCache::SetVertexBuffers(
+  UINT startSlot, UINT count, const D3D12_VERTEX_BUFFER_VIEW* views) {
+	// 0番スロット1つ以外は記憶せず、必ず設定する
+	if (startSlot != 0 || count != 1 || !views) {
+		vertexBufferValid_ = false;
+		return Count(StateType::kVertexBuffer, true);
+	}
+
+	bool same = vertexBufferValid_ && vertexBuffer_.BufferLocation == views->BufferLocation &&
+	            vertexBuffer_.SizeInBytes == views->SizeInBytes &&
+	            vertexBuffer_.StrideInBytes == views->StrideInBytes;
+	if (!Count(StateType::kVertexBuffer, !same)) {
+		return false;
+	}
+	vertexBufferValid_ = true;
+	vertexBuffer_ = *views;
+	return true;
+}
+
+bool RenderStateCache::SetIndexBuffer(const D3D12_INDEX_BUFFER_VIEW* view) {
+	if (!view) {
+		indexBufferValid_ = false;
+		return Count(StateType::kIndexBuffer, true);
+	}
+
+	bool same = indexBufferValid_ && indexBuffer_.BufferLocation == view->BufferLocation &&
+	            indexBuffer_.SizeInBytes == view->SizeInBytes &&
+	            indexBuffer_.Format == view->Format;
+	if (!Count(StateType::kIndexBuffer, !same)) {
+		return false;
+	}
+	indexBufferValid_ = true;
+	indexBuffer_ = *view;
+	return true;
+}
+
+void RenderStateCache::Invalidate() {
+	rootSignature_ = nullptr;
+	pipelineState_ = nullptr;
+	topology_ = D3D_PRIMITIVE_TOPOLOGY_UNDEFINED;
+	descriptorHeapCount_ = 0;
+	for (ID3D12DescriptorHeap*& heap : descriptorHeaps_) {
+		heap = nullptr;
+	}
+	for (RootParameter& rootParameter : rootParameters_) {
+		rootParameter = RootParameter();
+	}
+	vertexBufferValid_ = false;
+	indexBufferValid_ = false;
+}
+
+void RenderStateCache::FinishFrame() {
+	frameStats_ = stats_;
+	stats_ = Stats();
+}
+
+bool RenderStateCache::SetRootParameter(
+  UINT rootParameterIndex, RootParameterType type, uint64_t value) {
+	// 記憶できない番号は必ず設定する
+	if (rootParameterIndex >= kMaxRootParameterCount) {
+		return Count(StateType::kRootParameter, true);
+	}
+
+	RootParameter& rootParameter = rootParameters_[rootParameterIndex];
+	bool same = rootParameter.type == type && rootParameter.value == value;
+	if (!Count(StateType::kRootParameter, !same)) {
+		return false;
+	}
+	rootParameter.type = type;
+	rootParameter.value = value;
+	return true;
+}
+
+bool RenderStateCache::Count(StateType type, bool issue) {
+	if (issue) {
+		stats_.issuedCounts[size_t(type)]++;
+	} else {
+		stats_.skippedCounts[size_t(type)]++;
+	}
+	return issue;
+}
@@ -0,0 +1,167 @@
+﻿#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <d3d12.h>
+
+/// <summary>
+/// コマンドリストに設定済みの状態の記憶
+/// 同じ状態を設定し直す命令を見つけて省くために使う（Set～がfalseを返したら命令は不要）
+/// </summary>
+class RenderStateCache {
+  public: // 定数
+	// 記憶するルートパラメータの最大数
+	static const uint32_t kMaxRootParameterCount = 16;
+	// 記憶するデスクリプタヒープの最大数（CBV/SRV/UAVとサンプラー）
+	static const uint32_t kMaxDescriptorHeapCount = 2;
+
+  public: // 列挙子
+	/// <summary>
+	/// 状態の種類
+	/// </summary>
+	enum class StateType {
+		kRootSignature,     // ルートシグネチャ
+		kPipelineState,     // パイプラインステート
+		kPrimitiveTopology, // プリミティブ形状
+		kDescriptorHeaps,   // デスクリプタヒープ
+		kRootParameter,     // ルートパラメータ
+		kVertexBuffer,      // 頂点バッファ
+		kIndexBuffer,       // インデックスバッファ
+
+		kCountOfStateType, // 種類数
+	};
+
+  public: // サブクラス
+	/// <summary>
+	/// 設定命令の統計
+	/// </summary>
+	struct Stats {
+		// 種類ごとの発行した命令数
+		uint32_t issuedCounts[size_t(StateType::kCountOfStateType)] = {};
+		// 種類ごとの省いた命令数
+		uint32_t skippedCounts[size_t(StateType::kCountOfStateType)] = {};
+
+		/// <summary>
+		/// 発行した命令数の合計を取得
+		/// </summary>
+		uint32_t GetIssuedCount() const;
+
+		/// <summary>
+		/// 省いた命令数の合計を取得
+		/// </summary>
+		uint32_t GetSkippedCount() const;
+	};
+
+  public: // メンバ関数
+	/// <summary>
+	/// ルートシグネチャの設定（変わるとルートパラメータは全て未設定になる）
+	/// </summary>
+	/// <returns>命令が必要ならtrue</returns>
+	bool SetRootSignature(ID3D12RootSignature* rootSignature);
+
+	/// <summary>
+	/// パイプラインステートの設定
+	/// </summary>
+	/// <returns>命令が必要ならtrue</returns>
+	bool SetPipelineState(ID3D12PipelineState* pipelineState);
+
+	/// <summary>
+	/// プリミティブ形状の設定
+	/// </summary>
+	/// <returns>命令が必要ならtrue</returns>
+	bool SetPrimitiveTopology(D3D12_PRIMITIVE_TOPOLOGY topology);
+
+	/// <summary>
+	/// デスクリプタヒープの設定（変わるとデスクリプタテーブルは全て未設定になる）
+	/// </summary>
+	/// <returns>命令が必要ならtrue</returns>
+	bool SetDescriptorHeaps(UINT count, ID3D12DescriptorHeap* const* heaps);
+
+	/// <summary>
+	/// ルートパラメータに定数バッファビューを設定
+	/// </summary>
+	/// <returns>命令が必要ならtrue</returns>
+	bool SetRootConstantBufferView(UINT rootParameterIndex, D3D12_GPU_VIRTUAL_ADDRESS address);
+
+	/// <summary>
+	/// ルートパラメータにシェーダリソースビューを設定
+	/// </summary>
+	/// <returns>命令が必要ならtrue</returns>
+	bool SetRootShaderResourceView(UINT rootParameterIndex, D3D12_GPU_VIRTUAL_ADDRESS address);
+
+	/// <summary>
+	/// ルートパラメータにデスクリプタテーブルを設定
+	/// </summary>
+	/// <returns>命令が必要ならtrue</returns>
+	bool SetRootDescriptorTable(UINT rootParameterIndex, D3D12_GPU_DESCRIPTOR_HANDLE descriptor);
+
+	/// <summary>
+	/// 頂点バッファの設定（0番スロット1つだけを記憶する）
+	/// </summary>
+	/// <returns>命令が必要ならtrue</returns>
+	bool SetVertexBuffers(UINT startSlot, UINT count, const D3D12_VERTEX_BUFFER_VIEW* views);
+
+	/// <summary>
+	/// インデックスバッファの設定
+	/// </summary>
+	/// <returns>命令が必要ならtrue</returns>
+	bool SetIndexBuffer(const D3D12_INDEX_BUFFER_VIEW* view);
+
+	/// <summary>
+	/// 記憶した状態を全て忘れる（コマンドリストのリセット時）
+	/// </summary>
+	void Invalidate();
+
+	/// <summary>
+	/// フレームの終了（統計を前のフレームの統計に移す）
+	/// </summary>
+	void FinishFrame();
+
+	/// <summary>
+	/// 現在のフレームの統計を取得
+	/// </summary>
+	const Stats& GetStats() const { return stats_; }
+
+	/// <summary>
+	/// 前のフレームの統計を取得
+	/// </summary>
+	const Stats& GetFrameStats() const { return frameStats_; }
+
+  private: // サブクラス
+	// ルートパラメータの種類
+	enum class RootParameterType : uint8_t {
+		kNone,
+		kConstantBufferView,
+		kShaderResourceView,
+		kDescriptorTable,
+	};
+
+	// ルートパラメータの記憶
+	struct RootParameter {
+		RootParameterType type = RootParameterType::kNone;
+		uint64_t value = 0;
+	};
+
+  private: // メンバ関数
+	// ルートパラメータの設定
+	bool SetRootParameter(UINT rootParameterIndex, RootParameterType type, uint64_t value);
+
+	// 命令数を数える
+	bool Count(StateType type, bool issue);
+
+  private: // メンバ変数
+	ID3D12RootSignature* rootSignature_ = nullptr;
+	ID3D12PipelineState* pipelineState_ = nullptr;
+	D3D12_PRIMITIVE_TOPOLOGY topology_ = D3D_PRIMITIVE_TOPOLOGY_UNDEFINED;
+	UINT descriptorHeapCount_ = 0;
+	ID3D12DescriptorHeap* descriptorHeaps_[kMaxDescriptorHeapCount] = {};
+	RootParameter rootParameters_[kMaxRootParameterCount];
+	bool vertexBufferValid_ = false;
+	D3D12_VERTEX_BUFFER_VIEW vertexBuffer_{};
+	bool indexBufferValid_ = false;
+	D3D12_INDEX_BUFFER_VIEW indexBuffer_{};
+	// 現在のフレームの統計
+	Stats stats_;
+	// 前のフレームの統計
+	Stats frameStats_;
+};
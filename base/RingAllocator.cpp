@@ -0,0 +1,70 @@
+﻿#include "RingAllocator.h"
+#include <cassert>
+
+void RingAllocator::Initialize(uint64_t capacity) {
+	assert(capacity > 0);
+	capacity_ = capacity;
+	head_ = 0;
+	tail_ = 0;
+	usedSize_ = 0;
+	frameSize_ = 0;
+	frames_.clear();
+}
+
+uint64_t RingAllocator::Allocate(uint64_t size, uint64_t alignment) {
+	assert(alignment > 0 && (alignment & (alignment - 1)) == 0);
+
+	// 全て解放済みなら先頭から使い直す
+	if (usedSize_ == 0) {
+		head_ = 0;
+		tail_ = 0;
+	}
+
+	uint64_t offset = (tail_ + alignment - 1) & ~(alignment - 1);
+	uint64_t consumed;
+
+	if (tail_ > head_ || usedSize_ == 0) {
+		// 使用中の領域が [head_, tail_) の場合、末尾側の空きを使う
+		if (offset + size <= capacity_) {
+			consumed = offset + size - tail_;
+		} else if (size <= head_) {
+			// 入らなければ末尾の残りを捨てて先頭へ折り返す
+			offset = 0;
+			consumed = capacity_ - tail_ + size;
+		} else {
+			return kInvalidOffset;
+		}
+	} else {
+		// 折り返し済み（[tail_, head_) が空き）
+		if (offset + size <= head_) {
+			consumed = offset + size - tail_;
+		} else {
+			return kInvalidOffset;
+		}
+	}
+
+	tail_ = offset + size;
+	usedSize_ += consumed;
+	frameSize_ += consumed;
+	return offset;
+}
+
+void RingAllocator::FinishFrame(uint64_t fenceValue) {
+	assert(frames_.empty() || frames_.back().fenceValue <= fenceValue);
+
+	frames_.push_back({fenceValue, tail_, frameSize_});
+	frameSize_ = 0;
+}
+
+void RingAllocator::Reclaim(uint64_t completedFenceValue) {
+	// 古いフレームから、GPUが完了したものを解放する
+	while (!frames_.empty() && frames_.front().fenceValue <= completedFenceValue) {
+		const Frame& frame = frames_.front();
+		// 何も確保しなかったフレームの末尾は、先頭から使い直した後では古い値なので使わない
+		if (frame.size > 0) {
+			head_ = frame.end;
+			usedSize_ -= frame.size;
+		}
+		frames_.pop_front();
+	}
+}
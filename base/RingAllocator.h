@@ -0,0 +1,80 @@
+﻿#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+
+/// <summary>
+/// フレーム単位で解放するリングバッファの領域管理（GPUのAPIには依存しない）
+/// 確保は末尾を進めるだけで、フレームの終わりにフェンス値を記録し、
+/// GPUがそのフェンス値に到達したらそのフレームの領域をまとめて解放する
+/// </summary>
+class RingAllocator {
+  public: // 定数
+	// 確保に失敗した時のオフセット
+	static const uint64_t kInvalidOffset = UINT64_MAX;
+
+  public: // メンバ関数
+	/// <summary>
+	/// 初期化
+	/// </summary>
+	/// <param name="capacity">バッファの大きさ</param>
+	void Initialize(uint64_t capacity);
+
+	/// <summary>
+	/// 領域の確保（領域は末尾をまたがない）
+	/// </summary>
+	/// <param name="size">大きさ</param>
+	/// <param name="alignment">アライメント（2のべき乗）</param>
+	/// <returns>先頭のオフセット（空きがなければkInvalidOffset）</returns>
+	uint64_t Allocate(uint64_t size, uint64_t alignment);
+
+	/// <summary>
+	/// フレームの終了（ここまでの確保をフェンス値に結びつける）
+	/// </summary>
+	/// <param name="fenceValue">このフレームの完了時にGPUが到達するフェンス値</param>
+	void FinishFrame(uint64_t fenceValue);
+
+	/// <summary>
+	/// 完了したフレームの領域を解放する
+	/// </summary>
+	/// <param name="completedFenceValue">GPUが到達済みのフェンス値</param>
+	void Reclaim(uint64_t completedFenceValue);
+
+	/// <summary>
+	/// バッファの大きさを取得
+	/// </summary>
+	uint64_t GetCapacity() const { return capacity_; }
+
+	/// <summary>
+	/// 使用中の大きさを取得（アライメントや折り返しで捨てた分を含む）
+	/// </summary>
+	uint64_t GetUsedSize() const { return usedSize_; }
+
+	/// <summary>
+	/// 解放待ちのフレーム数を取得
+	/// </summary>
+	size_t GetPendingFrameCount() const { return frames_.size(); }
+
+  private: // サブクラス
+	// 解放待ちのフレーム
+	struct Frame {
+		uint64_t fenceValue; // 完了時のフェンス値
+		uint64_t end;        // フレーム終了時の末尾
+		uint64_t size;       // フレームで使った大きさ
+	};
+
+  private: // メンバ変数
+	// バッファの大きさ
+	uint64_t capacity_ = 0;
+	// 使用中の領域の先頭
+	uint64_t head_ = 0;
+	// 次に確保する位置
+	uint64_t tail_ = 0;
+	// 使用中の大きさ
+	uint64_t usedSize_ = 0;
+	// 現在のフレームで使った大きさ
+	uint64_t frameSize_ = 0;
+	// 解放待ちのフレーム（古い順）
+	std::deque<Frame> frames_;
+};
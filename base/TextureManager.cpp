@@ -1,13 +1,37 @@
-﻿#include "TextureManager.h"
+﻿#include "FrameSync.h"
+#include "TextureManager.h"
 #include <DirectXTex.h>
+#include <algorithm>
 #include <cassert>
+#include <iterator>
 
 using namespace DirectX;
 
+const std::string TextureManager::kPlaceholderFileName = "white1x1.png";
+
+namespace {
+
+// 解放したリソースとハンドルを再利用するまでのフレーム数（同時に処理するフレーム数より多く待つ）
+const uint32_t kReleaseDelayFrames = FrameSync::kMaxFrameCount;
+
+} // namespace
+
 uint32_t TextureManager::Load(const std::string& fileName) {
 	return TextureManager::GetInstance()->LoadInternal(fileName);
 }
 
+void TextureManager::Release(uint32_t textureHandle) {
+	TextureManager::GetInstance()->ReleaseInternal(textureHandle);
+}
+
+uint32_t TextureManager::Create(const std::string& name, const Image& image, size_t mipLevels) {
+	return TextureManager::GetInstance()->CreateInternal(name, image, mipLevels);
+}
+
+uint32_t TextureManager::LoadAsync(const std::string& fileName, uint32_t requestedMip) {
+	return TextureManager::GetInstance()->LoadAsyncInternal(fileName, requestedMip);
+}
+
 TextureManager* TextureManager::GetInstance() {
 	static TextureManager instance;
 	return &instance;
@@ -27,118 +51,434 @@ void TextureManager::Initialize(ID3D12Device* device, std::string directoryPath)
 	ResetAll();
 }
 
-void TextureManager::ResetAll() {
-	HRESULT result = S_FALSE;
+void TextureManager::Finalize() {
+	// 読み込み待ちの要求を捨ててから、読み込み中のものが終わるのを待つ
+	streamQueue_.Clear();
+	JobSystem::GetInstance()->Wait(streamCounter_);
 
-	// デスクリプタヒープを生成
-	D3D12_DESCRIPTOR_HEAP_DESC descHeapDesc = {};
-	descHeapDesc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV;
-	descHeapDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE; // シェーダから見えるように
-	descHeapDesc.NumDescriptors = kNumDescriptors; // シェーダーリソースビュー1つ
-	result = device_->CreateDescriptorHeap(&descHeapDesc, IID_PPV_ARGS(&descriptorHeap_)); // 生成
-	assert(SUCCEEDED(result));
+	std::lock_guard<std::mutex> lock(streamMutex_);
+	streamPaths_.clear();
+	streamResults_.clear();
+}
+
+void TextureManager::Update() {
+	// GPUが使い終わった解放済みのリソースとハンドルを再利用できるようにする
+	frame_++;
+	while (!retiredObjects_.empty() && retiredObjects_.front().frame + kReleaseDelayFrames <= frame_) {
+		retiredObjects_.pop_front();
+	}
+	slotAllocator_.FinishFrame();
 
-	indexNextDescriptorHeap_ = 0;
+	// 読み込みの終わった結果を受け取る
+	std::vector<StreamResult> results;
+	{
+		std::lock_guard<std::mutex> lock(streamMutex_);
+		results.swap(streamResults_);
+	}
+	if (results.empty()) {
+		return;
+	}
+
+	// 細かいミップを要求されたものから差し替える
+	std::stable_sort(results.begin(), results.end(), [this](const auto& a, const auto& b) {
+		return textures_[a.handle].requestedMip < textures_[b.handle].requestedMip;
+	});
+
+	std::vector<StreamResult> deferred;
+	for (StreamResult& result : results) {
+		// リセットされた後に届いた結果は捨てる
+		{
+			std::lock_guard<std::mutex> lock(streamMutex_);
+			auto it = streamPaths_.find(result.handle);
+			if (it == streamPaths_.end() || it->second != result.filePath) {
+				continue;
+			}
+		}
+
+		// 予算に収まるまで細かいミップを削る
+		const TexMetadata& metadata = result.image->GetMetadata();
+		uint32_t bytesPerPixel = static_cast<uint32_t>(BitsPerPixel(metadata.format) / 8);
+		uint32_t firstMip = streamQueue_.FitMip(
+		  static_cast<uint32_t>(metadata.width), static_cast<uint32_t>(metadata.height),
+		  bytesPerPixel, static_cast<uint32_t>(metadata.mipLevels),
+		  textures_[result.handle].requestedMip);
+		if (firstMip == UINT32_MAX) {
+			// 予算が空くまで仮のテクスチャのまま待つ
+			deferred.push_back(std::move(result));
+			continue;
+		}
+		uint64_t bytes = TextureStreamQueue::CalcMipChainBytes(
+		  static_cast<uint32_t>(metadata.width), static_cast<uint32_t>(metadata.height),
+		  bytesPerPixel, static_cast<uint32_t>(metadata.mipLevels), firstMip);
+		bool reserved = streamQueue_.Reserve(bytes);
+		assert(reserved);
+		(void)reserved;
+
+		// 本来のテクスチャに差し替える
+		// 仮のテクスチャのデスクリプタはGPUが使っている可能性があるので書き換えず、
+		// このハンドル用のデスクリプタに作ってからそちらを指す
+		CreateTextureResource(result.handle, *result.image, firstMip);
+		Texture& texture = textures_[result.handle];
+		texture.isPending = false;
+		texture.streamedBytes = bytes;
+		ReleaseInternal(Find(kPlaceholderFileName));
+
+		std::lock_guard<std::mutex> lock(streamMutex_);
+		streamPaths_.erase(result.handle);
+	}
+
+	// 差し替えられなかったものは次のフレームで再び試す
+	if (!deferred.empty()) {
+		std::lock_guard<std::mutex> lock(streamMutex_);
+		streamResults_.insert(
+		  streamResults_.end(), std::make_move_iterator(deferred.begin()),
+		  std::make_move_iterator(deferred.end()));
+	}
+}
+
+bool TextureManager::IsLoaded(uint32_t textureHandle) {
+	assert(textureHandle < textures_.size());
+	return !textures_[textureHandle].isPending;
+}
+
+void TextureManager::ResetAll() {
+	// デスクリプタヒープを作り直す（今までのヒープはGPUが使い終わってから解放する）
+	cpuDescriptorHeap_.Reset();
+	CreateDescriptorHeaps(static_cast<uint32_t>(kNumDescriptors));
+
+	// ハンドルの割り当てを最初から
+	slotAllocator_.Initialize(static_cast<uint32_t>(kNumDescriptors), kReleaseDelayFrames);
+	nameToHandle_.clear();
+
+	// 読み込み待ちの要求と結果を捨てる
+	streamQueue_.Clear();
+	{
+		std::lock_guard<std::mutex> lock(streamMutex_);
+		streamPaths_.clear();
+		streamResults_.clear();
+	}
 
 	// 全テクスチャを初期化
-	for (size_t i = 0; i < kNumDescriptors; i++) {
-		textures_[i].resource.Reset();
-		textures_[i].cpuDescHandleSRV.ptr = 0;
-		textures_[i].gpuDescHandleSRV.ptr = 0;
-		textures_[i].name.clear();
+	for (Texture& texture : textures_) {
+		if (texture.streamedBytes > 0) {
+			streamQueue_.Release(texture.streamedBytes);
+		}
+		Retire(texture.resource.Get());
 	}
+	textures_.clear();
+	textures_.resize(kNumDescriptors);
 }
 
 const D3D12_RESOURCE_DESC TextureManager::GetResoureDesc(uint32_t textureHandle) {
 
 	assert(textureHandle < textures_.size());
 	Texture& texture = textures_.at(textureHandle);
+	assert(texture.resource);
 	return texture.resource->GetDesc();
 }
 
+D3D12_GPU_DESCRIPTOR_HANDLE TextureManager::GetGpuDescHandleSRV(uint32_t textureHandle) {
+	assert(textureHandle < textures_.size());
+	return CD3DX12_GPU_DESCRIPTOR_HANDLE(
+	  descriptorHeap_->GetGPUDescriptorHandleForHeapStart(),
+	  textures_[textureHandle].descriptorIndex, sDescriptorHandleIncrementSize_);
+}
+
 void TextureManager::SetGraphicsRootDescriptorTable(
-  ID3D12GraphicsCommandList* commandList, UINT rootParamIndex,
+  RenderContext* renderContext, UINT rootParamIndex,
   uint32_t textureHandle) { // デスクリプタヒープの配列
 	assert(textureHandle < textures_.size());
 	ID3D12DescriptorHeap* ppHeaps[] = {descriptorHeap_.Get()};
-	commandList->SetDescriptorHeaps(_countof(ppHeaps), ppHeaps);
+	renderContext->SetDescriptorHeaps(_countof(ppHeaps), ppHeaps);
 
 	// シェーダリソースビューをセット
-	commandList->SetGraphicsRootDescriptorTable(
-	  rootParamIndex, textures_[textureHandle].gpuDescHandleSRV);
+	renderContext->SetGraphicsRootDescriptorTable(rootParamIndex, GetGpuDescHandleSRV(textureHandle));
 }
 
 uint32_t TextureManager::LoadInternal(const std::string& fileName) {
 
-	assert(indexNextDescriptorHeap_ < kNumDescriptors);
-	uint32_t handle = indexNextDescriptorHeap_;
-
 	// 読み込み済みテクスチャを検索
-	auto it = std::find_if(textures_.begin(), textures_.end(), [&](const auto& texture) {
-		return texture.name == fileName;
-	});
-	if (it != textures_.end()) {
-		// 読み込み済みテクスチャの要素番号を取得
-		handle = static_cast<uint32_t>(std::distance(textures_.begin(), it));
+	uint32_t handle = Find(fileName);
+	if (handle != UINT32_MAX) {
+		textures_[handle].refCount++;
 		return handle;
 	}
 
-	// 書き込むテクスチャの参照
-	Texture& texture = textures_.at(handle);
-	texture.name = fileName;
-
-	// ディレクトリパスとファイル名を連結してフルパスを得る
-	bool currentRelative = false;
-	if (2 < fileName.size()) {
-		currentRelative = (fileName[0] == '.') && (fileName[1] == '/');
-	}
-	std::string fullPath = currentRelative ? fileName : directoryPath_ + fileName;
-
-	// ユニコード文字列に変換
-	wchar_t wfilePath[256];
-	MultiByteToWideChar(CP_ACP, 0, fullPath.c_str(), -1, wfilePath, _countof(wfilePath));
-
 	HRESULT result;
 
 	TexMetadata metadata{};
 	ScratchImage scratchImg{};
 
 	// WICテクスチャのロード
-	result = LoadFromWICFile(wfilePath, WIC_FLAGS_NONE, &metadata, scratchImg);
+	result = LoadFromWICFile(GetFullPath(fileName).c_str(), WIC_FLAGS_NONE, &metadata, scratchImg);
 	assert(SUCCEEDED(result));
 
+	return CreateInternal(fileName, *scratchImg.GetImage(0, 0, 0));
+}
+
+uint32_t
+  TextureManager::CreateInternal(const std::string& name, const Image& image, size_t mipLevels) {
+
+	// 生成済みテクスチャを検索
+	uint32_t handle = Find(name);
+	if (handle != UINT32_MAX) {
+		textures_[handle].refCount++;
+		return handle;
+	}
+
+	handle = AllocateHandle(name);
+
+	HRESULT result;
+
+	ScratchImage scratchImg{};
 	ScratchImage mipChain{};
-	// ミップマップ生成
-	result = GenerateMipMaps(
-	  scratchImg.GetImages(), scratchImg.GetImageCount(), scratchImg.GetMetadata(),
-	  TEX_FILTER_DEFAULT, 0, mipChain);
+	// ミップマップ生成（1レベルだけなら元の画像をそのまま使う）
+	result = E_FAIL;
+	if (mipLevels != 1) {
+		result = GenerateMipMaps(image, TEX_FILTER_DEFAULT, mipLevels, mipChain);
+	}
 	if (SUCCEEDED(result)) {
 		scratchImg = std::move(mipChain);
-		metadata = scratchImg.GetMetadata();
+	} else {
+		result = scratchImg.InitializeFromImage(image);
+		assert(SUCCEEDED(result));
+	}
+
+	CreateTextureResource(handle, scratchImg, 0);
+
+	return handle;
+}
+
+uint32_t TextureManager::LoadAsyncInternal(const std::string& fileName, uint32_t requestedMip) {
+
+	// 読み込み済み（読み込み中を含む）テクスチャを検索
+	uint32_t handle = Find(fileName);
+	if (handle != UINT32_MAX) {
+		// 読み込み中なら、より細かいミップの要求で優先度を上げる
+		Texture& texture = textures_[handle];
+		texture.refCount++;
+		if (texture.isPending && requestedMip < texture.requestedMip) {
+			texture.requestedMip = requestedMip;
+			streamQueue_.Raise(handle, requestedMip);
+		}
+		return handle;
+	}
+
+	// 仮のテクスチャ（差し替えるか解放するまで参照を持つ）
+	uint32_t placeholder = LoadInternal(kPlaceholderFileName);
+
+	// 仮のテクスチャのリソースとデスクリプタを指しておく
+	handle = AllocateHandle(fileName);
+	Texture& texture = textures_[handle];
+	texture.resource = textures_[placeholder].resource;
+	texture.descriptorIndex = textures_[placeholder].descriptorIndex;
+	texture.isPending = true;
+	texture.requestedMip = requestedMip;
+
+	{
+		std::lock_guard<std::mutex> lock(streamMutex_);
+		streamPaths_[handle] = GetFullPath(fileName);
+	}
+	streamQueue_.Push(handle, requestedMip);
+
+	// ワーカーは実行時に最も優先度の高い要求を取り出すので、要求1つにつき1回積む
+	JobSystem::GetInstance()->RunBackground(streamCounter_, [this]() { StreamOne(); });
+
+	return handle;
+}
+
+void TextureManager::StreamOne() {
+	TextureStreamQueue::Request request;
+	if (!streamQueue_.Pop(request)) {
+		return;
+	}
+
+	std::wstring filePath;
+	{
+		std::lock_guard<std::mutex> lock(streamMutex_);
+		auto it = streamPaths_.find(request.handle);
+		if (it == streamPaths_.end()) {
+			return;
+		}
+		filePath = it->second;
+	}
+
+	// WICはスレッドごとにCOMの初期化が必要
+	HRESULT comResult = CoInitializeEx(nullptr, COINIT_MULTITHREADED);
+
+	HRESULT result;
+	ScratchImage scratchImg{};
+
+	// WICテクスチャのロード
+	result = LoadFromWICFile(filePath.c_str(), WIC_FLAGS_NONE, nullptr, scratchImg);
+	if (FAILED(result)) {
+		if (SUCCEEDED(comResult)) {
+			CoUninitialize();
+		}
+		// 読み込めなければ出力ウィンドウに表示し、仮のテクスチャのままにする
+		std::wstring errstr = L"TextureManager: failed to load " + filePath + L"\n";
+		OutputDebugStringW(errstr.c_str());
+		return;
+	}
+
+	// ミップマップ生成
+	auto image = std::make_shared<ScratchImage>();
+	result = GenerateMipMaps(*scratchImg.GetImage(0, 0, 0), TEX_FILTER_DEFAULT, 0, *image);
+	if (FAILED(result)) {
+		*image = std::move(scratchImg);
+	}
+
+	if (SUCCEEDED(comResult)) {
+		CoUninitialize();
+	}
+
+	// 差し替えはGPUリソースを扱うのでUpdateで行う
+	StreamResult streamResult;
+	streamResult.handle = request.handle;
+	streamResult.filePath = filePath;
+	streamResult.image = image;
+
+	std::lock_guard<std::mutex> lock(streamMutex_);
+	streamResults_.push_back(std::move(streamResult));
+}
+
+void TextureManager::ReleaseInternal(uint32_t textureHandle) {
+	assert(textureHandle < textures_.size());
+	Texture& texture = textures_[textureHandle];
+	assert(texture.refCount > 0);
+
+	texture.refCount--;
+	if (texture.refCount > 0) {
+		return;
+	}
+
+	// 読み込み中なら結果を捨てる（待ち行列に残った要求はワーカーが読み飛ばす）
+	if (texture.isPending) {
+		{
+			std::lock_guard<std::mutex> lock(streamMutex_);
+			streamPaths_.erase(textureHandle);
+		}
+		ReleaseInternal(Find(kPlaceholderFileName));
+	}
+	// 予算に返す
+	if (texture.streamedBytes > 0) {
+		streamQueue_.Release(texture.streamedBytes);
+	}
+
+	// リソースとハンドルはGPUが使い終わってから再利用する
+	Retire(texture.resource.Get());
+	nameToHandle_.erase(texture.name);
+	texture = Texture();
+	slotAllocator_.Free(textureHandle);
+}
+
+void TextureManager::CreateDescriptorHeaps(uint32_t capacity) {
+	HRESULT result = S_FALSE;
+
+	// 今までのヒープ（容量を増やす時だけある）
+	UINT oldCapacity = 0;
+	Microsoft::WRL::ComPtr<ID3D12DescriptorHeap> oldCpuHeap = cpuDescriptorHeap_;
+	if (oldCpuHeap) {
+		oldCapacity = oldCpuHeap->GetDesc().NumDescriptors;
 	}
 
+	// デスクリプタヒープを生成
+	D3D12_DESCRIPTOR_HEAP_DESC descHeapDesc = {};
+	descHeapDesc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV;
+	descHeapDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_NONE; // 作成用なのでシェーダからは見えない
+	descHeapDesc.NumDescriptors = capacity;
+	result = device_->CreateDescriptorHeap(
+	  &descHeapDesc, IID_PPV_ARGS(cpuDescriptorHeap_.ReleaseAndGetAddressOf())); // 生成
+	assert(SUCCEEDED(result));
+
+	// 描画中のコマンドが古いヒープを使っているかもしれないので、すぐには解放しない
+	if (descriptorHeap_) {
+		Retire(descriptorHeap_.Get());
+	}
+	descHeapDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE; // シェーダから見えるように
+	result = device_->CreateDescriptorHeap(
+	  &descHeapDesc, IID_PPV_ARGS(descriptorHeap_.ReleaseAndGetAddressOf())); // 生成
+	assert(SUCCEEDED(result));
+
+	// 作成済みのデスクリプタを新しいヒープにコピー
+	if (oldCapacity > 0) {
+		device_->CopyDescriptorsSimple(
+		  oldCapacity, cpuDescriptorHeap_->GetCPUDescriptorHandleForHeapStart(),
+		  oldCpuHeap->GetCPUDescriptorHandleForHeapStart(), D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+		device_->CopyDescriptorsSimple(
+		  oldCapacity, descriptorHeap_->GetCPUDescriptorHandleForHeapStart(),
+		  cpuDescriptorHeap_->GetCPUDescriptorHandleForHeapStart(),
+		  D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+	}
+}
+
+void TextureManager::Retire(ID3D12Pageable* object) {
+	if (object == nullptr) {
+		return;
+	}
+	RetiredObject retired;
+	retired.frame = frame_;
+	retired.object = object;
+	retiredObjects_.push_back(retired);
+}
+
+uint32_t TextureManager::AllocateHandle(const std::string& name) {
+	uint32_t handle = slotAllocator_.Allocate();
+
+	// 足りなくなったらヒープとコンテナの容量を増やす
+	if (slotAllocator_.GetCapacity() > textures_.size()) {
+		CreateDescriptorHeaps(slotAllocator_.GetCapacity());
+		textures_.resize(slotAllocator_.GetCapacity());
+	}
+
+	// 書き込むテクスチャの参照
+	Texture& texture = textures_.at(handle);
+	texture = Texture();
+	texture.name = name;
+	texture.refCount = 1;
+	texture.descriptorIndex = handle;
+	nameToHandle_[name] = handle;
+
+	return handle;
+}
+
+void TextureManager::CreateTextureResource(
+  uint32_t handle, const ScratchImage& scratchImg, size_t firstMip) {
+	HRESULT result;
+
+	Texture& texture = textures_.at(handle);
+	TexMetadata metadata = scratchImg.GetMetadata();
+	assert(firstMip < metadata.mipLevels);
+
+	// 先頭のミップの大きさをリソースの大きさにする
+	const Image* firstImage = scratchImg.GetImage(firstMip, 0, 0);
+	size_t mipLevels = metadata.mipLevels - firstMip;
+
 	// 読み込んだディフューズテクスチャをSRGBとして扱う
 	metadata.format = MakeSRGB(metadata.format);
 
 	// リソース設定
 	CD3DX12_RESOURCE_DESC texresDesc = CD3DX12_RESOURCE_DESC::Tex2D(
-	  metadata.format, metadata.width, (UINT)metadata.height, (UINT16)metadata.arraySize,
-	  (UINT16)metadata.mipLevels);
+	  metadata.format, firstImage->width, (UINT)firstImage->height, (UINT16)metadata.arraySize,
+	  (UINT16)mipLevels);
 
 	// ヒーププロパティ
 	CD3DX12_HEAP_PROPERTIES heapProps =
 	  CD3DX12_HEAP_PROPERTIES(D3D12_CPU_PAGE_PROPERTY_WRITE_BACK, D3D12_MEMORY_POOL_L0);
 
+	// 今までのリソース（差し替え前の仮のテクスチャなど）はGPUが使い終わってから解放する
+	Retire(texture.resource.Get());
+
 	// テクスチャ用バッファの生成
 	result = device_->CreateCommittedResource(
 	  &heapProps, D3D12_HEAP_FLAG_NONE, &texresDesc,
 	  D3D12_RESOURCE_STATE_GENERIC_READ, // テクスチャ用指定
-	  nullptr, IID_PPV_ARGS(&texture.resource));
+	  nullptr, IID_PPV_ARGS(texture.resource.ReleaseAndGetAddressOf()));
 	assert(SUCCEEDED(result));
 
 	// テクスチャバッファにデータ転送
-	for (size_t i = 0; i < metadata.mipLevels; i++) {
-		const Image* img = scratchImg.GetImage(i, 0, 0); // 生データ抽出
+	for (size_t i = 0; i < mipLevels; i++) {
+		const Image* img = scratchImg.GetImage(firstMip + i, 0, 0); // 生データ抽出
 		result = texture.resource->WriteToSubresource(
 		  (UINT)i,
 		  nullptr,              // 全領域へコピー
@@ -149,11 +489,10 @@ uint32_t TextureManager::LoadInternal(const std::string& fileName) {
 		assert(SUCCEEDED(result));
 	}
 
-	// シェーダリソースビュー作成
-	texture.cpuDescHandleSRV = CD3DX12_CPU_DESCRIPTOR_HANDLE(
-	  descriptorHeap_->GetCPUDescriptorHandleForHeapStart(), handle, sDescriptorHandleIncrementSize_);
-	texture.gpuDescHandleSRV = CD3DX12_GPU_DESCRIPTOR_HANDLE(
-	  descriptorHeap_->GetGPUDescriptorHandleForHeapStart(), handle, sDescriptorHandleIncrementSize_);
+	// シェーダリソースビュー作成（このハンドル用のデスクリプタに作る）
+	CD3DX12_CPU_DESCRIPTOR_HANDLE cpuDescHandleSRV(
+	  cpuDescriptorHeap_->GetCPUDescriptorHandleForHeapStart(), handle,
+	  sDescriptorHandleIncrementSize_);
 
 	D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc{}; // 設定構造体
 	D3D12_RESOURCE_DESC resDesc = texture.resource->GetDesc();
@@ -161,14 +500,41 @@ uint32_t TextureManager::LoadInternal(const std::string& fileName) {
 	srvDesc.Format = resDesc.Format;
 	srvDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
 	srvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D; // 2Dテクスチャ
-	srvDesc.Texture2D.MipLevels = (UINT)metadata.mipLevels;
+	srvDesc.Texture2D.MipLevels = (UINT)mipLevels;
 
 	device_->CreateShaderResourceView(
 	  texture.resource.Get(), //ビューと関連付けるバッファ
 	  &srvDesc,               //テクスチャ設定情報
-	  texture.cpuDescHandleSRV);
+	  cpuDescHandleSRV);
+
+	// シェーダから見えるヒープにコピー
+	device_->CopyDescriptorsSimple(
+	  1,
+	  CD3DX12_CPU_DESCRIPTOR_HANDLE(
+	    descriptorHeap_->GetCPUDescriptorHandleForHeapStart(), handle,
+	    sDescriptorHandleIncrementSize_),
+	  cpuDescHandleSRV, D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+	texture.descriptorIndex = handle;
+}
 
-	indexNextDescriptorHeap_++;
+std::wstring TextureManager::GetFullPath(const std::string& fileName) const {
+	// ディレクトリパスとファイル名を連結してフルパスを得る
+	bool currentRelative = false;
+	if (2 < fileName.size()) {
+		currentRelative = (fileName[0] == '.') && (fileName[1] == '/');
+	}
+	std::string fullPath = currentRelative ? fileName : directoryPath_ + fileName;
 
-	return handle;
+	// ユニコード文字列に変換
+	wchar_t wfilePath[256];
+	MultiByteToWideChar(CP_ACP, 0, fullPath.c_str(), -1, wfilePath, _countof(wfilePath));
+	return wfilePath;
+}
+
+uint32_t TextureManager::Find(const std::string& name) {
+	auto it = nameToHandle_.find(name);
+	if (it == nameToHandle_.end()) {
+		return UINT32_MAX;
+	}
+	return it->second;
 }
@@ -1,18 +1,32 @@
 ﻿#pragma once
 
-#include <array>
+#include "DescriptorSlotAllocator.h"
+#include "JobSystem.h"
+#include "RenderContext.h"
+#include "TextureStreamQueue.h"
 #include <d3dx12.h>
+#include <deque>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <unordered_map>
+#include <vector>
 #include <wrl.h>
 
+namespace DirectX {
+struct Image;
+class ScratchImage;
+}
+
 /// <summary>
 /// テクスチャマネージャ
 /// </summary>
 class TextureManager {
   public:
-	// デスクリプターの数
+	// 最初のデスクリプターの数（足りなくなったら倍にする）
 	static const size_t kNumDescriptors = 256;
+	// 非同期読み込み中に使う仮のテクスチャ
+	static const std::string kPlaceholderFileName;
 
 	/// <summary>
 	/// テクスチャ
@@ -20,21 +34,54 @@ class TextureManager {
 	struct Texture {
 		// テクスチャリソース
 		Microsoft::WRL::ComPtr<ID3D12Resource> resource;
-		// シェーダリソースビューのハンドル(CPU)
-		CD3DX12_CPU_DESCRIPTOR_HANDLE cpuDescHandleSRV;
-		// シェーダリソースビューのハンドル(CPU)
-		CD3DX12_GPU_DESCRIPTOR_HANDLE gpuDescHandleSRV;
+		// 参照するデスクリプタの番号（読み込み待ちの間は仮のテクスチャのもの）
+		uint32_t descriptorIndex = 0;
+		// 参照数（0になったら解放する）
+		uint32_t refCount = 0;
 		// 名前
 		std::string name;
+		// 非同期読み込みの完了待ち（仮のテクスチャを指している）
+		bool isPending = false;
+		// 非同期読み込みで要求された最も細かいミップ
+		uint32_t requestedMip = 0;
+		// 非同期読み込みで予算から確保したバイト数
+		uint64_t streamedBytes = 0;
 	};
 
 	/// <summary>
-	/// 読み込み
+	/// 読み込み（読み込み済みならそのハンドルを返す。どちらも参照数を1増やす）
 	/// </summary>
 	/// <param name="fileName">ファイル名</param>
 	/// <returns>テクスチャハンドル</returns>
 	static uint32_t Load(const std::string& fileName);
 
+	/// <summary>
+	/// 参照の解放（参照数が0になると、GPUが使い終わるのを待ってリソースとハンドルを解放する）
+	/// </summary>
+	/// <param name="textureHandle">テクスチャハンドル</param>
+	static void Release(uint32_t textureHandle);
+
+	/// <summary>
+	/// メモリ上の画像から生成（同じ名前が生成済みならそのハンドルを返す。参照数を1増やす）
+	/// </summary>
+	/// <param name="name">名前</param>
+	/// <param name="image">画像</param>
+	/// <param name="mipLevels">ミップレベル数（0なら1x1まで全て）</param>
+	/// <returns>テクスチャハンドル</returns>
+	static uint32_t
+	  Create(const std::string& name, const DirectX::Image& image, size_t mipLevels = 0);
+
+	/// <summary>
+	/// 非同期読み込み
+	/// すぐに仮のテクスチャ（白1x1）を指すハンドルを返し、デコードとミップマップ生成はワーカーで行う
+	/// 読み込みが終わるとUpdateで本来のテクスチャに差し替える（それまでのリソース情報は仮のもの）
+	/// 読み込めなかった場合は出力ウィンドウに表示し、仮のテクスチャのままにする
+	/// </summary>
+	/// <param name="fileName">ファイル名</param>
+	/// <param name="requestedMip">必要な最も細かいミップ（小さいほど優先して読み込む）</param>
+	/// <returns>テクスチャハンドル</returns>
+	static uint32_t LoadAsync(const std::string& fileName, uint32_t requestedMip = 0);
+
 	/// <summary>
 	/// シングルトンインスタンスの取得
 	/// </summary>
@@ -47,6 +94,30 @@ class TextureManager {
 	/// <param name="device">デバイス</param>
 	void Initialize(ID3D12Device* device, std::string directoryPath = "Resources/");
 
+	/// <summary>
+	/// 終了処理（読み込み待ちの要求を捨て、ワーカーを止める）
+	/// </summary>
+	void Finalize();
+
+	/// <summary>
+	/// 毎フレーム処理（読み込みの終わったテクスチャを予算の範囲で差し替え、
+	/// GPUが使い終わった解放済みのリソースとハンドルを再利用できるようにする）
+	/// </summary>
+	void Update();
+
+	/// <summary>
+	/// 非同期読み込みのメモリ予算の設定
+	/// </summary>
+	/// <param name="budgetBytes">読み込んだテクスチャに使ってよいバイト数</param>
+	void SetStreamingBudget(uint64_t budgetBytes) { streamQueue_.SetBudget(budgetBytes); }
+
+	/// <summary>
+	/// 読み込みが終わっているか
+	/// </summary>
+	/// <param name="textureHandle">テクスチャハンドル</param>
+	/// <returns>仮のテクスチャを指していればfalse</returns>
+	bool IsLoaded(uint32_t textureHandle);
+
 	/// <summary>
 	/// 全テクスチャリセット
 	/// </summary>
@@ -62,11 +133,29 @@ class TextureManager {
 	/// <summary>
 	/// デスクリプタテーブルをセット
 	/// </summary>
-	/// <param name="commandList">コマンドリスト</param>
+	/// <param name="renderContext">描画コマンドの発行先</param>
 	/// <param name="rootParamIndex">ルートパラメータ番号</param>
 	/// <param name="textureHandle">テクスチャハンドル</param>
 	void SetGraphicsRootDescriptorTable(
-	  ID3D12GraphicsCommandList* commandList, UINT rootParamIndex, uint32_t textureHandle);
+	  RenderContext* renderContext, UINT rootParamIndex, uint32_t textureHandle);
+
+	/// <summary>
+	/// デスクリプタヒープの取得（容量が増えると別のヒープになる）
+	/// </summary>
+	/// <returns>デスクリプタヒープ</returns>
+	ID3D12DescriptorHeap* GetDescriptorHeap() { return descriptorHeap_.Get(); }
+
+	/// <summary>
+	/// 使用中のテクスチャ数の取得
+	/// </summary>
+	uint32_t GetTextureCount() const { return slotAllocator_.GetAllocatedCount(); }
+
+	/// <summary>
+	/// シェーダリソースビューのハンドル(GPU)の取得
+	/// </summary>
+	/// <param name="textureHandle">テクスチャハンドル</param>
+	/// <returns>シェーダリソースビューのハンドル</returns>
+	D3D12_GPU_DESCRIPTOR_HANDLE GetGpuDescHandleSRV(uint32_t textureHandle);
 
   private:
 	TextureManager() = default;
@@ -80,16 +169,114 @@ class TextureManager {
 	UINT sDescriptorHandleIncrementSize_ = 0u;
 	// ディレクトリパス
 	std::string directoryPath_;
-	// デスクリプタヒープ
+	// デスクリプタヒープ（シェーダから見える）
 	Microsoft::WRL::ComPtr<ID3D12DescriptorHeap> descriptorHeap_;
-	// 次に使うデスクリプタヒープの番号
-	uint32_t indexNextDescriptorHeap_ = 0u;
+	// デスクリプタの作成用ヒープ（シェーダから見えない。容量を増やす時のコピー元）
+	Microsoft::WRL::ComPtr<ID3D12DescriptorHeap> cpuDescriptorHeap_;
+	// デスクリプタの番号（テクスチャハンドルと同じ）の割り当て
+	DescriptorSlotAllocator slotAllocator_;
 	// テクスチャコンテナ
-	std::array<Texture, kNumDescriptors> textures_;
+	std::vector<Texture> textures_;
+	// 名前→テクスチャハンドル
+	std::unordered_map<std::string, uint32_t> nameToHandle_;
+
+	// GPUが使い終わるのを待っている解放済みのリソースとヒープ
+	struct RetiredObject {
+		uint64_t frame;
+		Microsoft::WRL::ComPtr<ID3D12Pageable> object;
+	};
+	std::deque<RetiredObject> retiredObjects_;
+	// Updateを呼んだ回数
+	uint64_t frame_ = 0;
+
+	// 非同期読み込みの結果
+	struct StreamResult {
+		uint32_t handle;
+		std::wstring filePath;
+		std::shared_ptr<DirectX::ScratchImage> image;
+	};
+	// 非同期読み込みの待ち行列とメモリ予算
+	TextureStreamQueue streamQueue_;
+	// 非同期読み込みのジョブの完了待ち（ワーカーはJobSystemのものを使う）
+	JobSystem::Counter streamCounter_;
+	// 読み込み待ちのハンドル→ファイルのフルパス
+	std::unordered_map<uint32_t, std::wstring> streamPaths_;
+	// 読み込みの終わった結果
+	std::vector<StreamResult> streamResults_;
+	// streamPaths_とstreamResults_の排他
+	std::mutex streamMutex_;
 
 	/// <summary>
 	/// 読み込み
 	/// </summary>
 	/// <param name="fileName">ファイル名</param>
 	uint32_t LoadInternal(const std::string& fileName);
+
+	/// <summary>
+	/// 生成
+	/// </summary>
+	/// <param name="name">名前</param>
+	/// <param name="image">画像</param>
+	/// <param name="mipLevels">ミップレベル数（0なら1x1まで全て）</param>
+	uint32_t
+	  CreateInternal(const std::string& name, const DirectX::Image& image, size_t mipLevels = 0);
+
+	/// <summary>
+	/// 参照の解放
+	/// </summary>
+	/// <param name="textureHandle">テクスチャハンドル</param>
+	void ReleaseInternal(uint32_t textureHandle);
+
+	/// <summary>
+	/// 非同期読み込み
+	/// </summary>
+	/// <param name="fileName">ファイル名</param>
+	/// <param name="requestedMip">必要な最も細かいミップ</param>
+	uint32_t LoadAsyncInternal(const std::string& fileName, uint32_t requestedMip);
+
+	/// <summary>
+	/// 最も優先度の高い要求を1つ読み込む（ワーカーで実行）
+	/// </summary>
+	void StreamOne();
+
+	/// <summary>
+	/// デスクリプタヒープの生成（容量が増えた時は既存のデスクリプタをコピーする）
+	/// </summary>
+	/// <param name="capacity">容量</param>
+	void CreateDescriptorHeaps(uint32_t capacity);
+
+	/// <summary>
+	/// GPUが使い終わるまで解放を遅らせる
+	/// </summary>
+	/// <param name="object">リソースまたはヒープ</param>
+	void Retire(ID3D12Pageable* object);
+
+	/// <summary>
+	/// 新しいハンドルの確保
+	/// </summary>
+	/// <param name="name">名前</param>
+	/// <returns>テクスチャハンドル</returns>
+	uint32_t AllocateHandle(const std::string& name);
+
+	/// <summary>
+	/// テクスチャリソースとシェーダリソースビューの生成
+	/// </summary>
+	/// <param name="handle">テクスチャハンドル</param>
+	/// <param name="scratchImg">ミップマップを含む画像</param>
+	/// <param name="firstMip">先頭のミップ（これより細かいミップは捨てる）</param>
+	void CreateTextureResource(
+	  uint32_t handle, const DirectX::ScratchImage& scratchImg, size_t firstMip);
+
+	/// <summary>
+	/// ディレクトリパスとファイル名を連結したフルパス（ユニコード）
+	/// </summary>
+	/// <param name="fileName">ファイル名</param>
+	std::wstring GetFullPath(const std::string& fileName) const;
+
+	/// <summary>
+	/// 名前で生成済みテクスチャを検索
+	/// </summary>
+	/// <param name="name">名前</param>
+	/// <returns>見つからなければUINT32_MAX</returns>
+	uint32_t Find(const std::string& name);
 };
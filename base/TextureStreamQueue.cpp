@@ -0,0 +1,119 @@
+﻿#include "TextureStreamQueue.h"
+#include <algorithm>
+#include <cassert>
+
+uint64_t TextureStreamQueue::CalcMipChainBytes(
+  uint32_t width, uint32_t height, uint32_t bytesPerPixel, uint32_t mipLevels,
+  uint32_t firstMip) {
+	uint64_t bytes = 0;
+	for (uint32_t mip = 0; mip < mipLevels; mip++) {
+		if (mip >= firstMip) {
+			bytes += uint64_t(width) * height * bytesPerPixel;
+		}
+		width = (std::max)(width / 2, 1u);
+		height = (std::max)(height / 2, 1u);
+	}
+	return bytes;
+}
+
+void TextureStreamQueue::Push(uint32_t handle, uint32_t requestedMip) {
+	std::lock_guard<std::mutex> lock(mutex_);
+
+	if (RaiseLocked(handle, requestedMip)) {
+		return;
+	}
+
+	Request request;
+	request.handle = handle;
+	request.requestedMip = requestedMip;
+	request.sequence = nextSequence_++;
+	handleToRequest_[handle] = requests_.insert(request).first;
+}
+
+bool TextureStreamQueue::Raise(uint32_t handle, uint32_t requestedMip) {
+	std::lock_guard<std::mutex> lock(mutex_);
+	return RaiseLocked(handle, requestedMip);
+}
+
+bool TextureStreamQueue::Pop(Request& request) {
+	std::lock_guard<std::mutex> lock(mutex_);
+
+	if (requests_.empty()) {
+		return false;
+	}
+	request = *requests_.begin();
+	requests_.erase(requests_.begin());
+	handleToRequest_.erase(request.handle);
+	return true;
+}
+
+void TextureStreamQueue::Clear() {
+	std::lock_guard<std::mutex> lock(mutex_);
+
+	requests_.clear();
+	handleToRequest_.clear();
+}
+
+size_t TextureStreamQueue::GetPendingCount() {
+	std::lock_guard<std::mutex> lock(mutex_);
+	return requests_.size();
+}
+
+void TextureStreamQueue::SetBudget(uint64_t budgetBytes) {
+	std::lock_guard<std::mutex> lock(mutex_);
+	budgetBytes_ = budgetBytes;
+}
+
+uint32_t TextureStreamQueue::FitMip(
+  uint32_t width, uint32_t height, uint32_t bytesPerPixel, uint32_t mipLevels,
+  uint32_t requestedMip) {
+	std::lock_guard<std::mutex> lock(mutex_);
+
+	assert(mipLevels > 0);
+	uint64_t available = budgetBytes_ > residentBytes_ ? budgetBytes_ - residentBytes_ : 0;
+	for (uint32_t mip = (std::min)(requestedMip, mipLevels - 1); mip < mipLevels; mip++) {
+		if (CalcMipChainBytes(width, height, bytesPerPixel, mipLevels, mip) <= available) {
+			return mip;
+		}
+	}
+	return UINT32_MAX;
+}
+
+bool TextureStreamQueue::Reserve(uint64_t bytes) {
+	std::lock_guard<std::mutex> lock(mutex_);
+
+	if (residentBytes_ + bytes > budgetBytes_ || residentBytes_ + bytes < residentBytes_) {
+		return false;
+	}
+	residentBytes_ += bytes;
+	return true;
+}
+
+void TextureStreamQueue::Release(uint64_t bytes) {
+	std::lock_guard<std::mutex> lock(mutex_);
+
+	assert(bytes <= residentBytes_);
+	residentBytes_ -= bytes;
+}
+
+uint64_t TextureStreamQueue::GetResidentBytes() {
+	std::lock_guard<std::mutex> lock(mutex_);
+	return residentBytes_;
+}
+
+bool TextureStreamQueue::RaiseLocked(uint32_t handle, uint32_t requestedMip) {
+	auto it = handleToRequest_.find(handle);
+	if (it == handleToRequest_.end()) {
+		return false;
+	}
+	// 積まれている要求の方が細かければそのまま
+	if (it->second->requestedMip <= requestedMip) {
+		return true;
+	}
+	// 順番は最初に積んだ時のものを引き継ぐ
+	Request request = *it->second;
+	request.requestedMip = requestedMip;
+	requests_.erase(it->second);
+	it->second = requests_.insert(request).first;
+	return true;
+}
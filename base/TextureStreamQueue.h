@@ -0,0 +1,141 @@
+﻿#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <set>
+#include <unordered_map>
+
+/// <summary>
+/// テクスチャの非同期読み込みの待ち行列とメモリ予算（GPUのAPIには依存しない）
+/// 要求されたミップが細かいほど先に取り出し、同じなら積んだ順に取り出す
+/// 待ち行列はワーカースレッドから取り出せるように排他する
+/// </summary>
+class TextureStreamQueue {
+  public: // サブクラス
+	/// <summary>
+	/// 読み込み要求
+	/// </summary>
+	struct Request {
+		// テクスチャハンドル
+		uint32_t handle = 0;
+		// 必要な最も細かいミップ（0が原寸）
+		uint32_t requestedMip = 0;
+		// 積んだ順番
+		uint64_t sequence = 0;
+	};
+
+  public: // 静的メンバ関数
+	/// <summary>
+	/// ミップチェーンの大きさを計算
+	/// </summary>
+	/// <param name="width">原寸の幅</param>
+	/// <param name="height">原寸の高さ</param>
+	/// <param name="bytesPerPixel">1画素のバイト数</param>
+	/// <param name="mipLevels">ミップ数</param>
+	/// <param name="firstMip">先頭のミップ（これより細かいミップは含めない）</param>
+	/// <returns>バイト数</returns>
+	static uint64_t CalcMipChainBytes(
+	  uint32_t width, uint32_t height, uint32_t bytesPerPixel, uint32_t mipLevels,
+	  uint32_t firstMip);
+
+  public: // メンバ関数
+	/// <summary>
+	/// 要求を積む（同じハンドルが積まれていれば、より細かいミップの要求で優先度を上げる）
+	/// </summary>
+	/// <param name="handle">テクスチャハンドル</param>
+	/// <param name="requestedMip">必要な最も細かいミップ</param>
+	void Push(uint32_t handle, uint32_t requestedMip);
+
+	/// <summary>
+	/// 積まれている要求の優先度を上げる（取り出し済みなら何もしない）
+	/// </summary>
+	/// <param name="handle">テクスチャハンドル</param>
+	/// <param name="requestedMip">必要な最も細かいミップ</param>
+	/// <returns>積まれていればtrue</returns>
+	bool Raise(uint32_t handle, uint32_t requestedMip);
+
+	/// <summary>
+	/// 最も優先度の高い要求を取り出す
+	/// </summary>
+	/// <param name="request">取り出した要求</param>
+	/// <returns>空ならfalse</returns>
+	bool Pop(Request& request);
+
+	/// <summary>
+	/// 全ての要求を捨てる（差し替え済みのテクスチャの使用量はそのまま）
+	/// </summary>
+	void Clear();
+
+	/// <summary>
+	/// 積まれている要求数の取得
+	/// </summary>
+	size_t GetPendingCount();
+
+	/// <summary>
+	/// メモリ予算の設定
+	/// </summary>
+	/// <param name="budgetBytes">読み込んだテクスチャに使ってよいバイト数</param>
+	void SetBudget(uint64_t budgetBytes);
+
+	/// <summary>
+	/// 予算内に収まる先頭のミップを求める
+	/// 要求されたミップから始め、収まらなければ細かいミップを削る（最後の1枚は削らない）
+	/// </summary>
+	/// <param name="width">原寸の幅</param>
+	/// <param name="height">原寸の高さ</param>
+	/// <param name="bytesPerPixel">1画素のバイト数</param>
+	/// <param name="mipLevels">ミップ数</param>
+	/// <param name="requestedMip">必要な最も細かいミップ</param>
+	/// <returns>先頭のミップ（最も粗いミップでも収まらなければUINT32_MAX）</returns>
+	uint32_t FitMip(
+	  uint32_t width, uint32_t height, uint32_t bytesPerPixel, uint32_t mipLevels,
+	  uint32_t requestedMip);
+
+	/// <summary>
+	/// 予算から確保する
+	/// </summary>
+	/// <param name="bytes">バイト数</param>
+	/// <returns>予算を超えるならfalse（確保しない）</returns>
+	bool Reserve(uint64_t bytes);
+
+	/// <summary>
+	/// 予算に返す
+	/// </summary>
+	/// <param name="bytes">バイト数</param>
+	void Release(uint64_t bytes);
+
+	/// <summary>
+	/// 確保済みのバイト数の取得
+	/// </summary>
+	uint64_t GetResidentBytes();
+
+  private: // サブクラス
+	// 優先度の比較（ミップが細かい順、同じなら積んだ順）
+	struct Compare {
+		bool operator()(const Request& a, const Request& b) const {
+			if (a.requestedMip != b.requestedMip) {
+				return a.requestedMip < b.requestedMip;
+			}
+			return a.sequence < b.sequence;
+		}
+	};
+
+  private: // メンバ関数
+	// 積まれている要求の優先度を上げる（排他済みで呼ぶ）
+	bool RaiseLocked(uint32_t handle, uint32_t requestedMip);
+
+  private: // メンバ変数
+	// 優先度順の要求
+	std::set<Request, Compare> requests_;
+	// ハンドル→要求
+	std::unordered_map<uint32_t, std::set<Request, Compare>::iterator> handleToRequest_;
+	// 次の順番
+	uint64_t nextSequence_ = 0;
+	// メモリ予算
+	uint64_t budgetBytes_ = UINT64_MAX;
+	// 確保済みのバイト数
+	uint64_t residentBytes_ = 0;
+	// 排他
+	std::mutex mutex_;
+};
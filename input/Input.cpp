@@ -271,7 +271,21 @@ void Input::Initialize() {
 	  WH_CALLWNDPROC, (HOOKPROC)&SubWndProc, GetModuleHandleW(NULL), GetCurrentThreadId());
 }
 
+void Input::InitializeHeadless() {
+	hwnd_ = nullptr;
+	key_.fill(0);
+	keyPre_.fill(0);
+	std::memset(&mouse_, 0, sizeof(mouse_));
+	std::memset(&mousePre_, 0, sizeof(mousePre_));
+}
+
 void Input::Update() {
+	// デバイスなしの時は入力なしのまま
+	if (!dInput_) {
+		keyPre_ = key_;
+		mousePre_ = mouse_;
+		return;
+	}
 
 	if (sRefreshInputDevices) {
 		SetupForIsXInputDevice();
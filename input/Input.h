@@ -52,6 +52,11 @@ class Input {
 	/// </summary>
 	void Initialize();
 
+	/// <summary>
+	/// デバイスなしの初期化（テスト用。全てのキーとボタンは離されたまま）
+	/// </summary>
+	void InitializeHeadless();
+
 	/// <summary>
 	/// 毎フレーム処理
 	/// </summary>
@@ -1,6 +1,9 @@
 ﻿#include "Audio.h"
 #include "DirectXCommon.h"
 #include "GameScene.h"
+#include "JobSystem.h"
+#include "ModelLoader.h"
+#include "SpriteBatch.h"
 #include "TextureManager.h"
 #include "WinApp.h"
 #include "AxisIndicator.h"
@@ -25,6 +28,9 @@ int WINAPI WinMain(HINSTANCE, HINSTANCE, LPSTR, int) {
 	dxCommon->Initialize(win);
 
 #pragma region 汎用機能初期化
+	// ジョブシステムの初期化（テクスチャやモデルの非同期読み込みもこのワーカーを使う）
+	JobSystem::GetInstance()->Initialize();
+
 	// 入力の初期化
 	input = Input::GetInstance();
 	input->Initialize();
@@ -39,6 +45,8 @@ int WINAPI WinMain(HINSTANCE, HINSTANCE, LPSTR, int) {
 
 	// スプライト静的初期化
 	Sprite::StaticInitialize(dxCommon->GetDevice(), WinApp::kWindowWidth, WinApp::kWindowHeight);
+	SpriteBatch::StaticInitialize(
+	  dxCommon->GetDevice(), WinApp::kWindowWidth, WinApp::kWindowHeight);
 
 	// デバッグテキスト初期化
 	debugText = DebugText::GetInstance();
@@ -63,6 +71,11 @@ int WINAPI WinMain(HINSTANCE, HINSTANCE, LPSTR, int) {
 			break;
 		}
 
+		// 行列の再計算数をリセット
+		WorldTransform::ResetRecomputedCount();
+
+		// 読み込みの終わったテクスチャの差し替え
+		TextureManager::GetInstance()->Update();
 		// 入力関連の毎フレーム処理
 		input->Update();
 		// ゲームシーンの毎フレーム処理
@@ -80,8 +93,12 @@ int WINAPI WinMain(HINSTANCE, HINSTANCE, LPSTR, int) {
 		dxCommon->PostDraw();
 	}
 
-	// 各種解放
+	// 各種解放（GPUが資源を使い終わるのを待ってから）
+	dxCommon->WaitForGpu();
 	SafeDelete(gameScene);
+	ModelLoader::GetInstance()->Finalize();
+	TextureManager::GetInstance()->Finalize();
+	JobSystem::GetInstance()->Finalize();
 	audio->Finalize();
 
 	// ゲームウィンドウの破棄
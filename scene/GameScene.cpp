@@ -8,7 +8,13 @@ GameScene::GameScene() {}
 
 GameScene::~GameScene() { 
 	delete sprite_;
+	//読み込み中に終わった場合は読み込みを待ってから解放する
+	if (modelHandle_.IsValid()) {
+		delete modelHandle_.GetImported();
+	}
 	delete model_;
+	TextureManager::Release(modelTextureHandle_);
+	TextureManager::Release(textureHandle_);
 }
 
 void GameScene::Initialize() {
@@ -20,12 +26,14 @@ void GameScene::Initialize() {
 
 	//ファイル名を指定してテクスチャを読み込む
 	textureHandle_ = TextureManager::Load("mario.jpg");
+	//3Dモデルのテクスチャはワーカーで読み込み、終わったらTextureManager::Updateで差し替わる
+	modelTextureHandle_ = TextureManager::LoadAsync("uvChecker.png");
 
 	//スプライトの生成
 	sprite_ = Sprite::Create(textureHandle_, {100, 50});
 
-	//3Dモデルの生成
-	model_ = Model::Create();
+	//3Dモデルの読み込み（ワーカーで読み込み、終わったらUpdateで受け取る）
+	modelHandle_ = ModelLoader::GetInstance()->LoadAsync("cube");
 
 	//サウンドデータの読み込み
 	soundDataHandle_ = audio_->LoadWave("se_sad03.wav");
@@ -43,6 +51,11 @@ void GameScene::Initialize() {
 }
 
 void GameScene::Update() { 
+	//読み込みの終わった3Dモデルを受け取る
+	if (modelHandle_.IsValid() && modelHandle_.IsReady()) {
+		model_ = modelHandle_.Get();
+	}
+
 	//スプライトの今の座標を所得
 	XMFLOAT2 position = sprite_->GetPosition();
 
@@ -72,6 +85,14 @@ void GameScene::Update() {
 
 	//デバッグテキストの表示
 	debugText_->Print(strDebug, 50, 50, 1.0f);
+
+	//描画状態の設定命令数（前のフレーム、省いた数は同じ状態の設定し直し）
+	const RenderStateCache::Stats& stateStats =
+	  dxCommon_->GetRenderContext()->GetStateCache().GetFrameStats();
+	debugText_->SetPos(50, 70);
+	debugText_->Printf(
+	  "StateCalls issued:%u skipped:%u", stateStats.GetIssuedCount(),
+	  stateStats.GetSkippedCount());
 }
 
 void GameScene::Draw() {
@@ -101,7 +122,9 @@ void GameScene::Draw() {
 	/// <summary>
 	/// ここに3Dオブジェクトの描画処理を追加できる
 	/// </summary>
-	model_->Draw(worldTransfrom_, viewProjection_, textureHandle_);
+	if (model_) {
+		model_->Draw(worldTransfrom_, viewProjection_, modelTextureHandle_);
+	}
 
 	// 3Dオブジェクト描画後処理
 	Model::PostDraw();
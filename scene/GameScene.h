@@ -5,6 +5,7 @@
 #include "DebugText.h"
 #include "Input.h"
 #include "Model.h"
+#include "ModelLoader.h"
 #include "SafeDelete.h"
 #include "Sprite.h"
 #include "ViewProjection.h"
@@ -55,12 +56,16 @@ class GameScene {
 
 	//テクスチャハンドル
 	uint32_t textureHandle_ = 0;
+	//3Dモデルのテクスチャハンドル（非同期読み込み、終わるまでは白1x1）
+	uint32_t modelTextureHandle_ = 0;
 
 	//スプライト
 	Sprite* sprite_ = nullptr;
 
-	//3Dモデル
+	//3Dモデル（読み込みが終わるまではnullptr）
 	Model* model_ = nullptr;
+	//3Dモデルの非同期読み込み
+	ModelLoader::Handle modelHandle_;
 
 	//サウンドデータハンドル
 	uint32_t soundDataHandle_ = 0;
@@ -0,0 +1,285 @@
+﻿// クック済みモデルのテスト（書き出しと読み込みの一致、ヘッダ・バージョン・元ファイルの更新による無効化、OBJとの読み込み時間の比較）
+#include "CookedModel.h"
+#include "Model.h"
+#include "ModelImportAccess.h"
+#include "TestGeometry.h"
+#include "TestUtil.h"
+#include <Windows.h>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// 球をOBJとMTLに書き出す（三角形の面、半分ずつ2つのグループ）
+void WriteSphereObj(
+  const std::string& directoryPath, const std::string& name, uint32_t ringCount,
+  uint32_t segmentCount) {
+	std::FILE* file = std::fopen((directoryPath + name + ".mtl").c_str(), "w");
+	TEST_CHECK(file);
+	std::fprintf(file, "newmtl Material\nKd 0.8 0.8 0.8\nmap_Kd white1x1.png\n");
+	std::fclose(file);
+
+	TestGeometry sphere = CreateTestSphere(ringCount, segmentCount);
+	file = std::fopen((directoryPath + name + ".obj").c_str(), "w");
+	TEST_CHECK(file);
+	std::fprintf(file, "mtllib %s.mtl\n", name.c_str());
+	for (const Mesh::VertexPosNormalUv& v : sphere.vertices) {
+		std::fprintf(file, "v %.9g %.9g %.9g\n", v.pos.x, v.pos.y, v.pos.z);
+		std::fprintf(file, "vt %.9g %.9g\n", v.uv.x, v.uv.y);
+		std::fprintf(file, "vn %.9g %.9g %.9g\n", v.normal.x, v.normal.y, v.normal.z);
+	}
+	const size_t triangleCount = sphere.indices.size() / 3;
+	for (size_t t = 0; t < triangleCount; t++) {
+		if (t == 0 || t == triangleCount / 2) {
+			std::fprintf(file, "g half%zu\nusemtl Material\n", t == 0 ? size_t(0) : size_t(1));
+		}
+		uint32_t i0 = sphere.indices[t * 3] + 1;
+		uint32_t i1 = sphere.indices[t * 3 + 1] + 1;
+		uint32_t i2 = sphere.indices[t * 3 + 2] + 1;
+		std::fprintf(file, "f %u/%u/%u %u/%u/%u %u/%u/%u\n", i0, i0, i0, i1, i1, i1, i2, i2, i2);
+	}
+	std::fclose(file);
+}
+
+// ファイルの中身を読む
+std::vector<char> ReadFileBytes(const std::string& path) {
+	std::ifstream file(path, std::ios::binary);
+	return std::vector<char>(
+	  (std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+}
+
+// ファイルを書き換える
+void WriteFileBytes(const std::string& path, const std::vector<char>& bytes) {
+	std::ofstream file(path, std::ios::binary | std::ios::trunc);
+	TEST_CHECK(file);
+	file.write(bytes.data(), bytes.size());
+}
+
+// 配列の中身がバイト単位で一致するか
+template<class T> bool SameBytes(const std::vector<T>& a, const std::vector<T>& b) {
+	return a.size() == b.size() &&
+	       (a.empty() || std::memcmp(a.data(), b.data(), sizeof(T) * a.size()) == 0);
+}
+
+// 2つのモデルのCPU側のデータが一致するか確かめる
+void CheckSameModel(Model& a, Model& b) {
+	TEST_CHECK(a.GetMeshes().size() == b.GetMeshes().size());
+	for (size_t i = 0; i < a.GetMeshes().size(); i++) {
+		Mesh& meshA = *a.GetMeshes()[i];
+		Mesh& meshB = *b.GetMeshes()[i];
+		TEST_CHECK(meshA.GetName() == meshB.GetName());
+		TEST_CHECK(SameBytes(meshA.GetVertices(), meshB.GetVertices()));
+		TEST_CHECK(SameBytes(meshA.GetIndices(), meshB.GetIndices()));
+		TEST_CHECK(SameBytes(meshA.GetTangents(), meshB.GetTangents()));
+		TEST_CHECK(SameBytes(meshA.GetLods(), meshB.GetLods()));
+		TEST_CHECK(meshA.GetMaterial()->name_ == meshB.GetMaterial()->name_);
+		TEST_CHECK(meshA.GetMaterial()->textureFilename_ == meshB.GetMaterial()->textureFilename_);
+		TEST_CHECK(std::memcmp(
+		             &meshA.GetMaterial()->diffuse_, &meshB.GetMaterial()->diffuse_,
+		             sizeof(DirectX::XMFLOAT3)) == 0);
+	}
+}
+
+// キャッシュの中の目印にする値（OBJからは出てこない）
+const float kMarker = 1234.5f;
+
+// 最初のメッシュの最初の頂点のx座標を目印に書き換える（ヘッダが正しければこの値が読み込まれる）
+std::vector<char> MarkCooked(std::vector<char> bytes) {
+	using namespace CookedModel;
+	const FileHeader* header = reinterpret_cast<const FileHeader*>(bytes.data());
+	size_t meshOffset = sizeof(FileHeader) + sizeof(SourceEntry) * header->sourceCount +
+	                    sizeof(MaterialEntry) * header->materialCount;
+	MeshEntry mesh;
+	std::memcpy(&mesh, bytes.data() + meshOffset, sizeof(mesh));
+	std::memcpy(bytes.data() + mesh.vertexOffset, &kMarker, sizeof(kMarker));
+	return bytes;
+}
+
+// 読み込んだモデルがキャッシュから読まれたか（目印の値を持つか）
+bool IsFromCooked(Model& model) {
+	return model.GetMeshes()[0]->GetVertices()[0].pos.x == kMarker;
+}
+
+// インポート設定（後処理を全て有効にする）
+Model::ImportSettings GetFullSettings() {
+	Model::ImportSettings settings;
+	settings.smoothing = true;
+	settings.optimize = true;
+	settings.tangents = true;
+	settings.lodLevels = 2;
+	return settings;
+}
+
+TEST_CASE(CookedModelRoundTrip) {
+	const char* const name = "test_cooked";
+	const std::string directoryPath = std::string("Resources/") + name + "/";
+	const std::string objPath = directoryPath + name + ".obj";
+	const std::string mtlPath = directoryPath + name + ".mtl";
+	const std::string cookedPath = directoryPath + name + CookedModel::kExtension;
+	CreateDirectoryA(directoryPath.c_str(), nullptr);
+	WriteSphereObj(directoryPath, name, 24, 48);
+	std::remove(cookedPath.c_str());
+	const Model::ImportSettings settings = GetFullSettings();
+
+	// OBJから読み込むとキャッシュが書き出される
+	Model* source = new Model;
+	ModelImportAccess::Import(*source, name, settings, nullptr);
+	TEST_CHECK(source->GetMeshes().size() == 2);
+	std::vector<char> cooked = ReadFileBytes(cookedPath);
+	TEST_CHECK(cooked.size() > sizeof(CookedModel::FileHeader));
+	const CookedModel::FileHeader* header =
+	  reinterpret_cast<const CookedModel::FileHeader*>(cooked.data());
+	TEST_CHECK(header->magic == CookedModel::kMagic);
+	TEST_CHECK(header->version == CookedModel::kVersion);
+	TEST_CHECK(header->fileSize == cooked.size());
+	TEST_CHECK(header->sourceCount == 2);
+	TEST_CHECK(header->meshCount == 2);
+	TEST_CHECK(
+	  header->importFlags == (CookedModel::kImportSmoothing | CookedModel::kImportOptimize |
+	                          CookedModel::kImportTangents | 2 << CookedModel::kImportLodShift));
+
+	// キャッシュから読み込んだ結果はOBJからの結果と一致し、キャッシュは書き換えない
+	Model* roundTrip = new Model;
+	ModelImportAccess::Import(*roundTrip, name, settings, nullptr);
+	CheckSameModel(*source, *roundTrip);
+	TEST_CHECK(ReadFileBytes(cookedPath) == cooked);
+	delete roundTrip;
+
+	// 目印を入れたキャッシュは（ヘッダが正しいので）そのまま読まれる
+	const std::vector<char> marked = MarkCooked(cooked);
+	WriteFileBytes(cookedPath, marked);
+	Model* markedModel = new Model;
+	ModelImportAccess::Import(*markedModel, name, settings, nullptr);
+	TEST_CHECK(IsFromCooked(*markedModel));
+	TEST_CHECK(ReadFileBytes(cookedPath) == marked);
+	delete markedModel;
+
+	// 無効なキャッシュはOBJから読み直し、正しいキャッシュを書き直す
+	auto checkRejected = [&](const std::vector<char>& bytes, const Model::ImportSettings& s) {
+		WriteFileBytes(cookedPath, bytes);
+		Model* model = new Model;
+		ModelImportAccess::Import(*model, name, s, nullptr);
+		TEST_CHECK(!IsFromCooked(*model));
+		std::vector<char> rewritten = ReadFileBytes(cookedPath);
+		const CookedModel::FileHeader* rewrittenHeader =
+		  reinterpret_cast<const CookedModel::FileHeader*>(rewritten.data());
+		TEST_CHECK(rewrittenHeader->magic == CookedModel::kMagic);
+		TEST_CHECK(rewrittenHeader->version == CookedModel::kVersion);
+		// 同じ設定なら最初の読み込みと同じ結果
+		if (&s == &settings) {
+			TEST_CHECK(rewritten.size() == cooked.size());
+			CheckSameModel(*source, *model);
+		}
+		delete model;
+	};
+
+	// 識別子・バージョン・記録したファイルサイズの不一致、途中で切れたファイル
+	std::vector<char> bytes = marked;
+	reinterpret_cast<CookedModel::FileHeader*>(bytes.data())->magic ^= 1;
+	checkRejected(bytes, settings);
+	bytes = marked;
+	reinterpret_cast<CookedModel::FileHeader*>(bytes.data())->version = CookedModel::kVersion - 1;
+	checkRejected(bytes, settings);
+	bytes = marked;
+	reinterpret_cast<CookedModel::FileHeader*>(bytes.data())->version = CookedModel::kVersion + 1;
+	checkRejected(bytes, settings);
+	bytes = marked;
+	reinterpret_cast<CookedModel::FileHeader*>(bytes.data())->fileSize += 16;
+	checkRejected(bytes, settings);
+	bytes = marked;
+	bytes.resize(bytes.size() - 16);
+	checkRejected(bytes, settings);
+	bytes = marked;
+	bytes.resize(sizeof(CookedModel::FileHeader) - 1);
+	checkRejected(bytes, settings);
+
+	// OBJのサイズが変わった（内容は同じ形状）
+	std::vector<char> obj = ReadFileBytes(objPath);
+	std::vector<char> changedObj = obj;
+	const char comment[] = "# touched\n";
+	changedObj.insert(changedObj.end(), comment, comment + sizeof(comment) - 1);
+	WriteFileBytes(objPath, changedObj);
+	checkRejected(marked, settings);
+
+	// OBJのサイズは同じで更新日時だけが変わった
+	std::vector<char> stamped = MarkCooked(ReadFileBytes(cookedPath));
+	std::this_thread::sleep_for(std::chrono::milliseconds(50));
+	WriteFileBytes(objPath, changedObj);
+	checkRejected(stamped, settings);
+
+	// MTLが変わった
+	stamped = MarkCooked(ReadFileBytes(cookedPath));
+	std::vector<char> mtl = ReadFileBytes(mtlPath);
+	mtl.insert(mtl.end(), comment, comment + sizeof(comment) - 1);
+	WriteFileBytes(mtlPath, mtl);
+	checkRejected(stamped, settings);
+
+	// インポート設定が違う
+	stamped = MarkCooked(ReadFileBytes(cookedPath));
+	Model::ImportSettings otherSettings = settings;
+	otherSettings.lodLevels = 1;
+	checkRejected(stamped, otherSettings);
+
+	delete source;
+	std::remove(cookedPath.c_str());
+	std::remove(objPath.c_str());
+	std::remove(mtlPath.c_str());
+	RemoveDirectoryA(directoryPath.c_str());
+}
+
+TEST_CASE(CookedModelBenchmark) {
+	// 128x256の球（約3万3千頂点、6万5千三角形）
+	const char* const name = "test_cooked_benchmark";
+	const std::string directoryPath = std::string("Resources/") + name + "/";
+	const std::string objPath = directoryPath + name + ".obj";
+	const std::string cookedPath = directoryPath + name + CookedModel::kExtension;
+	const int kRepeatCount = 3;
+	CreateDirectoryA(directoryPath.c_str(), nullptr);
+	WriteSphereObj(directoryPath, name, 128, 256);
+	size_t objSize = ReadFileBytes(objPath).size();
+
+	// 1回の読み込み時間（ミリ秒）
+	auto measure = [&](const Model::ImportSettings& settings, bool cooked) {
+		double best = INFINITY;
+		for (int i = 0; i < kRepeatCount; i++) {
+			if (!cooked) {
+				std::remove(cookedPath.c_str());
+			}
+			Model* model = new Model;
+			auto start = std::chrono::steady_clock::now();
+			ModelImportAccess::Import(*model, name, settings, nullptr);
+			std::chrono::duration<double, std::milli> elapsed =
+			  std::chrono::steady_clock::now() - start;
+			best = (std::min)(best, elapsed.count());
+			delete model;
+		}
+		return best;
+	};
+
+	const char* const labels[] = {"no post-process", "smoothing+optimize+tangents+2 LODs"};
+	const Model::ImportSettings settingsList[] = {Model::ImportSettings(), GetFullSettings()};
+	for (int i = 0; i < 2; i++) {
+		double objTime = measure(settingsList[i], false);
+		double cookedTime = measure(settingsList[i], true);
+		size_t cookedSize = ReadFileBytes(cookedPath).size();
+		// キャッシュの方が速い
+		TEST_CHECK(cookedTime < objTime);
+		std::printf(
+		  "  %s: OBJ %.1f ms (%.1f MB), cooked %.1f ms (%.1f MB), %.1fx\n", labels[i], objTime,
+		  objSize / (1024.0 * 1024.0), cookedTime, cookedSize / (1024.0 * 1024.0),
+		  objTime / cookedTime);
+	}
+
+	std::remove(cookedPath.c_str());
+	std::remove(objPath.c_str());
+	std::remove((directoryPath + name + ".mtl").c_str());
+	RemoveDirectoryA(directoryPath.c_str());
+}
+
+} // namespace
@@ -0,0 +1,60 @@
+﻿// DebugTextの1フレーム1万文字のベンチマーク（描画命令はRecordingRenderContextに記録する）
+#include "DebugText.h"
+#include "RecordingRenderContext.h"
+#include "TestGraphics.h"
+#include "TestUtil.h"
+#include <chrono>
+#include <cstdio>
+
+namespace {
+
+// 1行の文字数と行数（1フレームに1万文字）
+const uint32_t kLineLength = 50;
+const uint32_t kLineCount = 200;
+// 時間を測るフレーム数
+const uint32_t kFrameCount = 100;
+
+} // namespace
+
+TEST_CASE(DebugText10kCharsBenchmark) {
+	InitializeTestRenderers();
+	DebugText* debugText = DebugText::GetInstance();
+
+	RecordingRenderContext context;
+	double printMilliseconds = 0.0;
+	double drawMilliseconds = 0.0;
+	for (uint32_t frame = 0; frame < kFrameCount; frame++) {
+		context.Clear();
+
+		// 書式付きで50文字ずつ積む
+		auto start = std::chrono::steady_clock::now();
+		for (uint32_t line = 0; line < kLineCount; line++) {
+			debugText->SetPos(0.0f, float(line % 40) * DebugText::kFontHeight);
+			debugText->Printf(
+			  "line:%4u frame:%4u value:%9.4f count:%7u", line, frame, line * 0.125f + frame,
+			  line * frame);
+		}
+		auto printed = std::chrono::steady_clock::now();
+		TEST_CHECK(debugText->GetGlyphCount() == kLineLength * kLineCount);
+
+		// 全ての文字を1回のインスタンシング描画で描く
+		debugText->DrawAll(&context);
+		auto end = std::chrono::steady_clock::now();
+		printMilliseconds += std::chrono::duration<double, std::milli>(printed - start).count();
+		drawMilliseconds += std::chrono::duration<double, std::milli>(end - printed).count();
+
+		TEST_CHECK(debugText->GetGlyphCount() == 0);
+		TEST_CHECK(context.GetDrawCount() == 1);
+		const RecordingRenderContext::Command& draw = context.GetCommands().back();
+		TEST_CHECK(draw.type == RecordingRenderContext::CommandType::kDraw);
+		TEST_CHECK(draw.args[0] == 4);
+		TEST_CHECK(draw.args[1] == kLineLength * kLineCount);
+
+		FinishTestFrame();
+	}
+
+	std::printf(
+	  "  %u chars/frame: Printf %.3f ms, DrawAll %.3f ms, %zu commands, %zu bytes of glyphs\n",
+	  kLineLength * kLineCount, printMilliseconds / kFrameCount, drawMilliseconds / kFrameCount,
+	  context.GetCommands().size(), sizeof(DebugText::Glyph) * kLineLength * kLineCount);
+}
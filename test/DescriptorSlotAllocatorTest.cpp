@@ -0,0 +1,121 @@
+﻿// DescriptorSlotAllocatorのテスト（解放の遅延、容量の倍増、繰り返しの生成と解放）
+#include "DescriptorSlotAllocator.h"
+#include "TestUtil.h"
+#include <algorithm>
+#include <vector>
+
+namespace {
+
+// 解放した番号を再利用するまでのフレーム数
+const uint32_t kReleaseDelay = 3;
+
+TEST_CASE(DescriptorSlotAllocatorDelayedReuse) {
+	DescriptorSlotAllocator allocator;
+	allocator.Initialize(4, kReleaseDelay);
+
+	TEST_CHECK(allocator.Allocate() == 0);
+	TEST_CHECK(allocator.Allocate() == 1);
+	allocator.Free(0);
+	TEST_CHECK(allocator.GetAllocatedCount() == 1);
+	TEST_CHECK(allocator.GetRetiredCount() == 1);
+
+	// 待っている間は解放した番号を使わず、新しい番号を割り当てる
+	for (uint32_t frame = 1; frame < kReleaseDelay; frame++) {
+		allocator.FinishFrame();
+		TEST_CHECK(allocator.GetRetiredCount() == 1);
+	}
+	TEST_CHECK(allocator.Allocate() == 2);
+
+	// releaseDelayフレーム後に再利用できる
+	allocator.FinishFrame();
+	TEST_CHECK(allocator.GetRetiredCount() == 0);
+	TEST_CHECK(allocator.Allocate() == 0);
+	TEST_CHECK(allocator.GetAllocatedCount() == 3);
+	TEST_CHECK(allocator.GetCapacity() == 4);
+}
+
+TEST_CASE(DescriptorSlotAllocatorCapacityDoubling) {
+	DescriptorSlotAllocator allocator;
+	allocator.Initialize(4, kReleaseDelay);
+
+	// 容量を超えるたびに倍になり、番号は重複しない
+	std::vector<uint32_t> slots;
+	for (uint32_t i = 0; i < 4; i++) {
+		slots.push_back(allocator.Allocate());
+	}
+	TEST_CHECK(allocator.GetCapacity() == 4);
+	slots.push_back(allocator.Allocate());
+	TEST_CHECK(allocator.GetCapacity() == 8);
+	for (uint32_t i = 0; i < 4; i++) {
+		slots.push_back(allocator.Allocate());
+	}
+	TEST_CHECK(allocator.GetCapacity() == 16);
+	std::sort(slots.begin(), slots.end());
+	TEST_CHECK(std::adjacent_find(slots.begin(), slots.end()) == slots.end());
+	TEST_CHECK(slots.back() < allocator.GetCapacity());
+
+	// 解放を待っている番号があっても、再利用できるまでは容量を増やして割り当てる
+	for (uint32_t slot : slots) {
+		allocator.Free(slot);
+	}
+	for (uint32_t i = 0; i < 8; i++) {
+		TEST_CHECK(allocator.Allocate() >= 9);
+	}
+	TEST_CHECK(allocator.GetCapacity() == 32);
+
+	// 再利用できるようになれば容量は増えない
+	for (uint32_t frame = 0; frame < kReleaseDelay; frame++) {
+		allocator.FinishFrame();
+	}
+	for (uint32_t i = 0; i < 9; i++) {
+		TEST_CHECK(allocator.Allocate() < 9);
+	}
+	TEST_CHECK(allocator.GetCapacity() == 32);
+}
+
+TEST_CASE(DescriptorSlotAllocatorStress) {
+	// 毎フレーム生成と解放を繰り返しても、容量は同時に使う数と待ちの分で頭打ちになる
+	const uint32_t kLiveCount = 256;
+	const uint32_t kCyclesPerFrame = 64;
+	const uint32_t kFrameCount = 1000;
+
+	DescriptorSlotAllocator allocator;
+	allocator.Initialize(16, kReleaseDelay);
+
+	std::vector<uint32_t> live;
+	std::vector<bool> used;
+	uint32_t seed = 1;
+	for (uint32_t frame = 0; frame < kFrameCount; frame++) {
+		uint32_t allocateCount = frame == 0 ? kLiveCount + kCyclesPerFrame : kCyclesPerFrame;
+		for (uint32_t i = 0; i < allocateCount; i++) {
+			uint32_t slot = allocator.Allocate();
+			TEST_CHECK(slot < allocator.GetCapacity());
+			if (slot >= used.size()) {
+				used.resize(slot + 1, false);
+			}
+			// 使用中の番号は割り当てない
+			TEST_CHECK(!used[slot]);
+			used[slot] = true;
+			live.push_back(slot);
+		}
+		// 同じ数をばらばらの順で解放する
+		for (uint32_t i = 0; i < kCyclesPerFrame; i++) {
+			seed = seed * 1664525u + 1013904223u;
+			size_t index = (seed >> 8) % live.size();
+			uint32_t slot = live[index];
+			live[index] = live.back();
+			live.pop_back();
+			used[slot] = false;
+			allocator.Free(slot);
+		}
+		allocator.FinishFrame();
+		TEST_CHECK(allocator.GetAllocatedCount() == live.size());
+	}
+
+	// 使用中と待ちの番号は最大で kLiveCount + kCyclesPerFrame * (kReleaseDelay + 1)
+	TEST_CHECK(allocator.GetAllocatedCount() == kLiveCount);
+	TEST_CHECK(
+	  allocator.GetCapacity() <= 2 * (kLiveCount + kCyclesPerFrame * (kReleaseDelay + 1)));
+}
+
+} // namespace
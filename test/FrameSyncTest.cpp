@@ -0,0 +1,150 @@
+﻿// FrameSyncのテスト（偽のフェンスで、同時に処理するフレーム数、再利用するフレームだけの待ち、全体の完了待ち）
+#include "FrameSync.h"
+#include "TestUtil.h"
+#include <vector>
+
+namespace {
+
+// GPUの代わりのフェンス（積まれたシグナルはCompleteか待たれた時にだけ進む）
+class FakeFence : public FrameSync::Fence {
+  public:
+	void Signal(uint64_t value) override {
+		// フェンス値は積んだ順に増える
+		TEST_CHECK(value > signaledValue_);
+		signaledValue_ = value;
+	}
+	uint64_t GetCompletedValue() override { return completedValue_; }
+	void WaitForValue(uint64_t value) override {
+		// 積んでいない値は待てない
+		TEST_CHECK(value <= signaledValue_);
+		TEST_CHECK(value > completedValue_);
+		waitedValues_.push_back(value);
+		completedValue_ = value;
+	}
+
+	// GPUがvalueまで処理を終える
+	void Complete(uint64_t value) {
+		TEST_CHECK(value <= signaledValue_);
+		if (value > completedValue_) {
+			completedValue_ = value;
+		}
+	}
+
+	uint64_t GetSignaledValue() const { return signaledValue_; }
+	const std::vector<uint64_t>& GetWaitedValues() const { return waitedValues_; }
+
+  private:
+	uint64_t signaledValue_ = 0;
+	uint64_t completedValue_ = 0;
+	std::vector<uint64_t> waitedValues_;
+};
+
+TEST_CASE(FrameSyncLimitsFramesInFlight) {
+	const uint32_t kFrames = 100;
+
+	for (uint32_t frameCount = 1; frameCount <= FrameSync::kMaxFrameCount; frameCount++) {
+		// GPUが全く進まなければ、frameCountフレーム先に進んだところで毎回待つ
+		FakeFence fence;
+		FrameSync frameSync;
+		frameSync.Initialize(&fence, frameCount);
+		for (uint32_t frame = 0; frame < kFrames; frame++) {
+			uint32_t frameIndex = frameSync.BeginFrame();
+			TEST_CHECK(frameIndex == frame % frameCount);
+			// 記録中のフレームを含めて、終わっていないフレームはframeCount以下
+			uint64_t inFlight = fence.GetSignaledValue() - fence.GetCompletedValue();
+			TEST_CHECK(inFlight + 1 <= frameCount);
+			TEST_CHECK(frameSync.EndFrame() == frame + 1);
+		}
+		TEST_CHECK(frameSync.GetWaitCount() == kFrames - frameCount);
+
+		// 待つのは、これから使うフレーム番号が前回積んだフェンス値だけ
+		const std::vector<uint64_t>& waitedValues = fence.GetWaitedValues();
+		TEST_CHECK(waitedValues.size() == kFrames - frameCount);
+		for (size_t i = 0; i < waitedValues.size(); i++) {
+			TEST_CHECK(waitedValues[i] == i + 1);
+		}
+	}
+}
+
+TEST_CASE(FrameSyncWaitsOnlyForReusedFrame) {
+	const uint32_t kFrameCount = 3;
+	const uint32_t kFrames = 100;
+
+	FakeFence fence;
+	FrameSync frameSync;
+	frameSync.Initialize(&fence, kFrameCount);
+
+	// GPUが1フレーム遅れで追いついていれば待たない
+	for (uint32_t frame = 0; frame < kFrames; frame++) {
+		frameSync.BeginFrame();
+		uint64_t value = frameSync.EndFrame();
+		if (value > 1) {
+			fence.Complete(value - 1);
+		}
+	}
+	TEST_CHECK(frameSync.GetWaitCount() == 0);
+	TEST_CHECK(fence.GetWaitedValues().empty());
+
+	// GPUが進まないままframeCountフレーム積む
+	FakeFence slowFence;
+	frameSync.Initialize(&slowFence, kFrameCount);
+	for (uint32_t frame = 0; frame < kFrameCount; frame++) {
+		frameSync.BeginFrame();
+		frameSync.EndFrame();
+	}
+
+	// 新しいフレームが終わっていなくても、再利用するフレームが終わっていれば待たない
+	slowFence.Complete(1);
+	TEST_CHECK(frameSync.BeginFrame() == 0);
+	TEST_CHECK(frameSync.GetWaitCount() == 0);
+	frameSync.EndFrame();
+
+	// 再利用するフレームが終わっていなければ、そのフェンス値まで待つ（最新の値までは待たない）
+	TEST_CHECK(frameSync.BeginFrame() == 1);
+	TEST_CHECK(frameSync.GetWaitCount() == 1);
+	TEST_CHECK(slowFence.GetWaitedValues().size() == 1);
+	TEST_CHECK(slowFence.GetWaitedValues().back() == 2);
+	TEST_CHECK(slowFence.GetCompletedValue() < slowFence.GetSignaledValue());
+	frameSync.EndFrame();
+}
+
+TEST_CASE(FrameSyncWaitIdleDrains) {
+	FakeFence fence;
+	FrameSync frameSync;
+	frameSync.Initialize(&fence, FrameSync::kMaxFrameCount);
+
+	// 何も積んでいなければ待たない
+	frameSync.WaitIdle();
+	TEST_CHECK(fence.GetWaitedValues().empty());
+
+	for (uint32_t frame = 0; frame < FrameSync::kMaxFrameCount; frame++) {
+		frameSync.BeginFrame();
+		frameSync.EndFrame();
+	}
+	TEST_CHECK(fence.GetCompletedValue() == 0);
+
+	// 積んだ全てのフレームが終わるまで待つ
+	frameSync.WaitIdle();
+	TEST_CHECK(fence.GetWaitedValues().size() == 1);
+	TEST_CHECK(fence.GetWaitedValues().back() == frameSync.GetLastSignaledValue());
+	TEST_CHECK(fence.GetCompletedValue() == fence.GetSignaledValue());
+
+	// 終わった後は待たない
+	frameSync.WaitIdle();
+	TEST_CHECK(fence.GetWaitedValues().size() == 1);
+
+	// 初期値から始めても、その値は待たずに済む
+	FakeFence offsetFence;
+	offsetFence.Signal(10);
+	offsetFence.Complete(10);
+	frameSync.Initialize(&offsetFence, 2, 10);
+	frameSync.BeginFrame();
+	TEST_CHECK(frameSync.EndFrame() == 11);
+	frameSync.BeginFrame();
+	TEST_CHECK(frameSync.GetWaitCount() == 0);
+	frameSync.EndFrame();
+	frameSync.WaitIdle();
+	TEST_CHECK(offsetFence.GetCompletedValue() == 12);
+}
+
+} // namespace
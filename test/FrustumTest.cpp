@@ -0,0 +1,132 @@
+﻿// Frustumのテストとベンチマーク（まとめた球の判定が1つずつの判定と一致する、10万物体のカリング時間）
+#include "Frustum.h"
+#include "TestUtil.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+using namespace DirectX;
+
+namespace {
+
+// 乱数（線形合同法、実行ごとに同じ列にする）
+struct Random {
+	uint32_t seed;
+	float Range(float low, float high) {
+		seed = seed * 1664525u + 1013904223u;
+		return low + (high - low) * float(seed >> 8) / float(1u << 24);
+	}
+};
+
+// カメラ（原点から+zを向く）
+XMMATRIX GetViewProjection() {
+	XMMATRIX matView = XMMatrixLookAtLH(
+	  XMVectorSet(0.0f, 0.0f, 0.0f, 1.0f), XMVectorSet(0.0f, 0.0f, 1.0f, 1.0f),
+	  XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f));
+	XMMATRIX matProjection =
+	  XMMatrixPerspectiveFovLH(XMConvertToRadians(45.0f), 16.0f / 9.0f, 0.1f, 1000.0f);
+	return matView * matProjection;
+}
+
+// カメラの周りに散らばった物体のワールド行列
+std::vector<XMFLOAT4X4> CreateWorldMatrices(size_t count, uint32_t seed) {
+	Random random = {seed};
+	std::vector<XMFLOAT4X4> matrices(count);
+	for (XMFLOAT4X4& matrix : matrices) {
+		float scale = random.Range(0.5f, 4.0f);
+		XMMATRIX matWorld =
+		  XMMatrixScaling(scale, scale * random.Range(0.5f, 2.0f), scale) *
+		  XMMatrixRotationRollPitchYaw(
+		    random.Range(-3.1f, 3.1f), random.Range(-3.1f, 3.1f), random.Range(-3.1f, 3.1f)) *
+		  XMMatrixTranslation(
+		    random.Range(-500.0f, 500.0f), random.Range(-50.0f, 50.0f),
+		    random.Range(-500.0f, 500.0f));
+		XMStoreFloat4x4(&matrix, matWorld);
+	}
+	return matrices;
+}
+
+TEST_CASE(FrustumCullSpheresMatchesIntersectsSphere) {
+	Frustum frustum;
+	frustum.Extract(GetViewProjection());
+
+	// 視錐台の内外と境界をまたぐ球
+	Random random = {5};
+	std::vector<XMFLOAT4> spheres(10000);
+	for (XMFLOAT4& sphere : spheres) {
+		sphere = {
+		  random.Range(-300.0f, 300.0f), random.Range(-300.0f, 300.0f),
+		  random.Range(-10.0f, 1100.0f), random.Range(0.0f, 20.0f)};
+	}
+	std::vector<uint8_t> visible(spheres.size(), 0xcd);
+	size_t visibleCount = frustum.CullSpheres(spheres.data(), spheres.size(), visible.data());
+
+	size_t expectedCount = 0;
+	for (size_t i = 0; i < spheres.size(); i++) {
+		const XMFLOAT4& sphere = spheres[i];
+		bool expected = frustum.IntersectsSphere({sphere.x, sphere.y, sphere.z}, sphere.w);
+		TEST_CHECK(visible[i] == (expected ? 1 : 0));
+		expectedCount += expected ? 1 : 0;
+	}
+	TEST_CHECK(visibleCount == expectedCount);
+	TEST_CHECK(visibleCount > 0 && visibleCount < spheres.size());
+
+	// 空の配列
+	TEST_CHECK(frustum.CullSpheres(spheres.data(), 0, visible.data()) == 0);
+}
+
+TEST_CASE(FrustumCulling100kBenchmark) {
+	// 10万物体を、Model::DrawMeshes（物体ごとにローカル座標の視錐台で境界箱を判定）と
+	// Model::DrawInstanced（境界球をワールド座標へ移してまとめて判定）の手順で判定する時間
+	const size_t kObjectCount = 100000;
+	const int kRepeatCount = 5;
+	// メッシュの境界（中心0、1辺2の箱とそれを囲む球）
+	const XMFLOAT3 boxCenter = {0.0f, 0.0f, 0.0f};
+	const XMFLOAT3 boxExtents = {1.0f, 1.0f, 1.0f};
+	const XMFLOAT4 boundingSphere = {0.0f, 0.0f, 0.0f, std::sqrt(3.0f)};
+
+	XMMATRIX matViewProjection = GetViewProjection();
+	std::vector<XMFLOAT4X4> matrices = CreateWorldMatrices(kObjectCount, 6);
+	std::vector<XMFLOAT4> spheres(kObjectCount);
+	std::vector<uint8_t> visible(kObjectCount);
+
+	double perObjectBest = INFINITY;
+	double batchedBest = INFINITY;
+	size_t perObjectVisible = 0;
+	size_t batchedVisible = 0;
+	for (int repeat = 0; repeat < kRepeatCount; repeat++) {
+		// DrawMeshesの手順
+		auto start = std::chrono::steady_clock::now();
+		perObjectVisible = 0;
+		for (size_t i = 0; i < kObjectCount; i++) {
+			Frustum frustum;
+			frustum.Extract(XMLoadFloat4x4(&matrices[i]) * matViewProjection);
+			perObjectVisible += frustum.IntersectsBox(boxCenter, boxExtents) ? 1 : 0;
+		}
+		std::chrono::duration<double, std::milli> elapsed =
+		  std::chrono::steady_clock::now() - start;
+		perObjectBest = (std::min)(perObjectBest, elapsed.count());
+
+		// DrawInstancedの手順
+		start = std::chrono::steady_clock::now();
+		Frustum frustum;
+		frustum.Extract(matViewProjection);
+		for (size_t i = 0; i < kObjectCount; i++) {
+			spheres[i] = Frustum::TransformSphere(boundingSphere, XMLoadFloat4x4(&matrices[i]));
+		}
+		batchedVisible = frustum.CullSpheres(spheres.data(), kObjectCount, visible.data());
+		elapsed = std::chrono::steady_clock::now() - start;
+		batchedBest = (std::min)(batchedBest, elapsed.count());
+	}
+
+	// 球は箱を囲むので、箱が見えていれば球も見えている
+	TEST_CHECK(batchedVisible >= perObjectVisible);
+	TEST_CHECK(perObjectVisible > 0 && batchedVisible < kObjectCount);
+	std::printf(
+	  "  per-object box: %.2f ms (%zu visible), batched spheres: %.2f ms (%zu visible)\n",
+	  perObjectBest, perObjectVisible, batchedBest, batchedVisible);
+}
+
+} // namespace
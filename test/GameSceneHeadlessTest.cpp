@@ -0,0 +1,146 @@
+﻿// GameSceneのウィンドウなし実行テスト（main.cppと同じ初期化とループをWARPデバイスで回し、CPUのフレーム時間を測る）
+// 入力はデバイスなし（キーは押されない）、音声は出力なしで初期化する
+// リポジトリにcube.objは含まれないので、無ければBlenderの立方体と同じ形のOBJを書き出して読み込ませる
+#include "Audio.h"
+#include "CookedModel.h"
+#include "DirectXCommon.h"
+#include "GameScene.h"
+#include "Input.h"
+#include "JobSystem.h"
+#include "ModelLoader.h"
+#include "TestGraphics.h"
+#include "TestUtil.h"
+#include "TextureManager.h"
+#include "WorldTransform.h"
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <string>
+
+namespace {
+
+// GameSceneが読み込むモデル
+const std::string kCubeObjPath = "Resources/cube/cube.obj";
+const std::string kCubeCookedPath = std::string("Resources/cube/cube") + CookedModel::kExtension;
+// 時間を測るフレーム数
+const uint32_t kMeasuredFrameCount = 300;
+// モデルの読み込みを待つ最大フレーム数
+const uint32_t kMaxLoadFrameCount = 10000;
+
+// Blenderの立方体（cube.mtlのマテリアルを使う）
+const char* const kCubeObj = "mtllib cube.mtl\n"
+                             "o Cube\n"
+                             "v 1.000000 1.000000 -1.000000\n"
+                             "v 1.000000 -1.000000 -1.000000\n"
+                             "v 1.000000 1.000000 1.000000\n"
+                             "v 1.000000 -1.000000 1.000000\n"
+                             "v -1.000000 1.000000 -1.000000\n"
+                             "v -1.000000 -1.000000 -1.000000\n"
+                             "v -1.000000 1.000000 1.000000\n"
+                             "v -1.000000 -1.000000 1.000000\n"
+                             "vt 0.625000 0.500000\n"
+                             "vt 0.875000 0.500000\n"
+                             "vt 0.875000 0.750000\n"
+                             "vt 0.625000 0.750000\n"
+                             "vt 0.375000 0.750000\n"
+                             "vt 0.625000 1.000000\n"
+                             "vt 0.375000 1.000000\n"
+                             "vt 0.375000 0.000000\n"
+                             "vt 0.625000 0.000000\n"
+                             "vt 0.625000 0.250000\n"
+                             "vt 0.375000 0.250000\n"
+                             "vt 0.125000 0.500000\n"
+                             "vt 0.375000 0.500000\n"
+                             "vt 0.125000 0.750000\n"
+                             "vn 0.0000 1.0000 0.0000\n"
+                             "vn 0.0000 0.0000 1.0000\n"
+                             "vn -1.0000 0.0000 0.0000\n"
+                             "vn 0.0000 -1.0000 0.0000\n"
+                             "vn 1.0000 0.0000 0.0000\n"
+                             "vn 0.0000 0.0000 -1.0000\n"
+                             "usemtl Material\n"
+                             "s off\n"
+                             "f 1/1/1 5/2/1 7/3/1 3/4/1\n"
+                             "f 4/5/2 3/4/2 7/6/2 8/7/2\n"
+                             "f 8/8/3 7/9/3 5/10/3 6/11/3\n"
+                             "f 6/12/4 2/13/4 4/5/4 8/14/4\n"
+                             "f 2/13/5 1/1/5 3/4/5 4/5/5\n"
+                             "f 6/11/6 5/10/6 1/1/6 2/13/6\n";
+
+// ファイルがあるか
+bool FileExists(const std::string& path) { return std::ifstream(path).good(); }
+
+// main.cppのメインループの1フレーム（軸表示は除く）
+void RunFrame(GameScene* gameScene) {
+	DirectXCommon* dxCommon = DirectXCommon::GetInstance();
+
+	WorldTransform::ResetRecomputedCount();
+	TextureManager::GetInstance()->Update();
+	Input::GetInstance()->Update();
+	gameScene->Update();
+
+	dxCommon->PreDraw();
+	gameScene->Draw();
+	dxCommon->PostDraw();
+}
+
+} // namespace
+
+TEST_CASE(GameSceneHeadless) {
+	// main.cppと同じ順番で初期化する（ウィンドウ、入力デバイス、音声出力は使わない）
+	JobSystem::GetInstance()->Initialize(3);
+	InitializeTestRenderers();
+	Input::GetInstance()->InitializeHeadless();
+	Audio::GetInstance()->InitializeHeadless();
+
+	// cube.objが無ければ書き出す（キャッシュは前回の結果を使わないように消す）
+	bool writeCube = !FileExists(kCubeObjPath);
+	if (writeCube) {
+		std::ofstream(kCubeObjPath, std::ios::binary) << kCubeObj;
+	}
+	std::remove(kCubeCookedPath.c_str());
+
+	GameScene* gameScene = new GameScene();
+	gameScene->Initialize();
+
+	// モデルの読み込みが終わって描かれるまで回す
+	uint32_t loadFrameCount = 0;
+	while (Model::GetDrawnMeshCount() == 0 && loadFrameCount < kMaxLoadFrameCount) {
+		RunFrame(gameScene);
+		loadFrameCount++;
+	}
+	TEST_CHECK(Model::GetDrawnMeshCount() > 0);
+
+	// 読み込みが終わった後のフレーム時間を測る
+	auto start = std::chrono::steady_clock::now();
+	for (uint32_t frame = 0; frame < kMeasuredFrameCount; frame++) {
+		RunFrame(gameScene);
+	}
+	auto end = std::chrono::steady_clock::now();
+	double milliseconds = std::chrono::duration<double, std::milli>(end - start).count();
+
+	// 毎フレームモデルが描かれ、描画状態の設定命令が記録されている
+	TEST_CHECK(Model::GetDrawnMeshCount() > 0);
+	const RenderStateCache::Stats& stateStats =
+	  DirectXCommon::GetInstance()->GetRenderContext()->GetStateCache().GetFrameStats();
+	TEST_CHECK(stateStats.GetIssuedCount() > 0);
+
+	std::printf(
+	  "  GameScene headless: model ready after %u frames, %.3f ms/frame CPU over %u frames\n",
+	  loadFrameCount, milliseconds / kMeasuredFrameCount, kMeasuredFrameCount);
+	std::printf(
+	  "  state calls per frame: issued %u, skipped %u\n", stateStats.GetIssuedCount(),
+	  stateStats.GetSkippedCount());
+
+	// main.cppと同じ順番で解放する
+	DirectXCommon::GetInstance()->WaitForGpu();
+	delete gameScene;
+	ModelLoader::GetInstance()->Finalize();
+	JobSystem::GetInstance()->Finalize();
+	Audio::GetInstance()->Finalize();
+
+	std::remove(kCubeCookedPath.c_str());
+	if (writeCube) {
+		std::remove(kCubeObjPath.c_str());
+	}
+}
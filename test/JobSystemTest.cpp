@@ -0,0 +1,155 @@
+﻿// JobSystemのテスト（範囲の分割、時間のかかるジョブ、積む側と盗む側の競合、ワーカー数ごとの処理時間）
+#include "JobSystem.h"
+#include "TestUtil.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// テスト中のワーカー数
+const uint32_t kWorkerCount = 7;
+
+TEST_CASE(JobSystemParallelForCoversRange) {
+	JobSystem* jobSystem = JobSystem::GetInstance();
+	jobSystem->Initialize(kWorkerCount);
+
+	// 全ての要素をちょうど1回ずつ処理する
+	std::vector<std::atomic<uint32_t>> visits(100000);
+	for (std::atomic<uint32_t>& visit : visits) {
+		visit = 0;
+	}
+	jobSystem->ParallelFor(visits.size(), 64, [&](size_t begin, size_t end) {
+		TEST_CHECK(end - begin <= 64);
+		for (size_t i = begin; i < end; i++) {
+			visits[i]++;
+		}
+	});
+	for (std::atomic<uint32_t>& visit : visits) {
+		TEST_CHECK(visit == 1);
+	}
+
+	jobSystem->Finalize();
+}
+
+TEST_CASE(JobSystemBackgroundNested) {
+	JobSystem* jobSystem = JobSystem::GetInstance();
+	jobSystem->Initialize(kWorkerCount);
+
+	// 時間のかかるジョブの中から細かいジョブに分けて待っても止まらない
+	JobSystem::Counter counter;
+	std::atomic<uint32_t> doneCount{0};
+	for (uint32_t i = 0; i < 64; i++) {
+		jobSystem->RunBackground(counter, [&]() {
+			std::atomic<size_t> sum{0};
+			jobSystem->ParallelFor(
+			  1000, 10, [&](size_t begin, size_t end) { sum += end - begin; });
+			TEST_CHECK(sum == 1000);
+			doneCount++;
+		});
+	}
+	jobSystem->Wait(counter);
+	TEST_CHECK(doneCount == 64);
+
+	jobSystem->Finalize();
+}
+
+TEST_CASE(JobSystemStress) {
+	JobSystem* jobSystem = JobSystem::GetInstance();
+	jobSystem->Initialize(kWorkerCount);
+
+	// 積んだ直後に盗まれても数が崩れず、全て処理されて眠りに戻れる
+	for (uint32_t round = 0; round < 2000; round++) {
+		JobSystem::Counter counter;
+		std::atomic<uint32_t> doneCount{0};
+		for (uint32_t i = 0; i < 16; i++) {
+			jobSystem->Run(counter, [&]() { doneCount++; });
+		}
+		jobSystem->Wait(counter);
+		TEST_CHECK(doneCount == 16);
+	}
+
+	jobSystem->Finalize();
+}
+
+// 要素ごとの計算（結果はスレッドによらず同じ）
+float Work(size_t i) {
+	float value = float(i % 1000) * 0.001f;
+	for (int k = 0; k < 16; k++) {
+		value = std::sin(value) + 0.5f;
+	}
+	return value;
+}
+
+TEST_CASE(JobSystemScalingBenchmark) {
+	// 同じ量の仕事を逐次とワーカー数1..Nで処理する（Nはハードウェアスレッド数-1、少なくとも3）
+	const size_t kElementCount = 1 << 18;
+	const size_t kGrainSize = 256;
+	const int kRepeatCount = 3;
+	uint32_t hardwareThreads = std::thread::hardware_concurrency();
+	uint32_t maxWorkerCount = (std::max)(hardwareThreads > 1 ? hardwareThreads - 1 : 0, 3u);
+
+	std::vector<float> expected(kElementCount);
+	double serialTime = INFINITY;
+	for (int r = 0; r < kRepeatCount; r++) {
+		auto start = std::chrono::steady_clock::now();
+		for (size_t i = 0; i < kElementCount; i++) {
+			expected[i] = Work(i);
+		}
+		std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+		serialTime = (std::min)(serialTime, elapsed.count());
+	}
+	std::printf(
+	  "  %zu elements, %u hardware threads: serial %.1f ms\n", kElementCount, hardwareThreads,
+	  serialTime);
+
+	std::vector<float> results(kElementCount);
+	for (uint32_t workerCount = 1; workerCount <= maxWorkerCount; workerCount++) {
+		JobSystem* jobSystem = JobSystem::GetInstance();
+		jobSystem->Initialize(workerCount);
+
+		// 範囲の分割（ParallelFor）と、細かいジョブを積んで待つ（Run/Wait）
+		double parallelForTime = INFINITY;
+		double runTime = INFINITY;
+		for (int r = 0; r < kRepeatCount; r++) {
+			std::fill(results.begin(), results.end(), 0.0f);
+			auto start = std::chrono::steady_clock::now();
+			jobSystem->ParallelFor(kElementCount, kGrainSize, [&](size_t begin, size_t end) {
+				for (size_t i = begin; i < end; i++) {
+					results[i] = Work(i);
+				}
+			});
+			std::chrono::duration<double, std::milli> elapsed =
+			  std::chrono::steady_clock::now() - start;
+			parallelForTime = (std::min)(parallelForTime, elapsed.count());
+			TEST_CHECK(results == expected);
+
+			std::fill(results.begin(), results.end(), 0.0f);
+			start = std::chrono::steady_clock::now();
+			JobSystem::Counter counter;
+			for (size_t begin = 0; begin < kElementCount; begin += kGrainSize) {
+				jobSystem->Run(counter, [&results, begin]() {
+					for (size_t i = begin; i < begin + kGrainSize; i++) {
+						results[i] = Work(i);
+					}
+				});
+			}
+			jobSystem->Wait(counter);
+			elapsed = std::chrono::steady_clock::now() - start;
+			runTime = (std::min)(runTime, elapsed.count());
+			TEST_CHECK(results == expected);
+		}
+		std::printf(
+		  "  %u workers + caller: ParallelFor %.1f ms (%.2fx), Run/Wait %.1f ms (%.2fx)\n",
+		  workerCount, parallelForTime, serialTime / parallelForTime, runTime,
+		  serialTime / runTime);
+
+		jobSystem->Finalize();
+	}
+}
+
+} // namespace
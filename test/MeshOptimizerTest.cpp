@@ -0,0 +1,122 @@
+﻿// MeshOptimizerのテスト（Mesh::Optimizeで頂点キャッシュの統計が良くなり、三角形は変わらない）
+#include "Mesh.h"
+#include "MeshOptimizer.h"
+#include "TestGeometry.h"
+#include "TestUtil.h"
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <map>
+#include <tuple>
+#include <vector>
+
+namespace {
+
+// 頂点の識別（座標とuvが同じ頂点は生成した形状の中に1つしかない）
+using VertexKey = std::tuple<float, float, float, float, float>;
+VertexKey GetVertexKey(const Mesh::VertexPosNormalUv& vertex) {
+	return VertexKey(vertex.pos.x, vertex.pos.y, vertex.pos.z, vertex.uv.x, vertex.uv.y);
+}
+
+// 三角形を元の頂点番号で表し、向きを保ったまま最小の番号が先頭になるよう回す
+using Triangle = std::array<uint32_t, 3>;
+std::vector<Triangle> GetSortedTriangles(
+  const std::vector<Mesh::VertexPosNormalUv>& vertices, const std::vector<uint32_t>& indices,
+  const std::map<VertexKey, uint32_t>& originalIndices) {
+	std::vector<Triangle> triangles;
+	for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+		Triangle triangle;
+		for (size_t k = 0; k < 3; k++) {
+			auto it = originalIndices.find(GetVertexKey(vertices[indices[i + k]]));
+			TEST_CHECK(it != originalIndices.end());
+			triangle[k] = it->second;
+		}
+		std::rotate(
+		  triangle.begin(), std::min_element(triangle.begin(), triangle.end()), triangle.end());
+		triangles.push_back(triangle);
+	}
+	std::sort(triangles.begin(), triangles.end());
+	return triangles;
+}
+
+// 最適化して、統計が良くなり三角形の集合が変わらないことを確かめる
+void CheckOptimize(const char* name, const TestGeometry& geometry) {
+	std::map<VertexKey, uint32_t> originalIndices;
+	for (uint32_t i = 0; i < geometry.vertices.size(); i++) {
+		TEST_CHECK(originalIndices.emplace(GetVertexKey(geometry.vertices[i]), i).second);
+	}
+
+	Mesh mesh;
+	mesh.SetGeometry(
+	  geometry.vertices.data(), geometry.vertices.size(), geometry.indices.data(),
+	  geometry.indices.size());
+
+	auto start = std::chrono::steady_clock::now();
+	mesh.Optimize();
+	std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+
+	// 最適化前の統計は入力そのものの統計
+	const MeshOptimizer::VertexCacheStatistics& before = mesh.GetCacheStatisticsBefore();
+	MeshOptimizer::VertexCacheStatistics input = MeshOptimizer::AnalyzeVertexCache(
+	  geometry.indices.data(), geometry.indices.size(), geometry.vertices.size());
+	TEST_CHECK(before.vertexTransforms == input.vertexTransforms);
+
+	// ACMRとATVRが下がる
+	const MeshOptimizer::VertexCacheStatistics& after = mesh.GetCacheStatisticsAfter();
+	TEST_CHECK(after.acmr < before.acmr);
+	TEST_CHECK(after.atvr < before.atvr);
+	TEST_CHECK(after.atvr >= 1.0f);
+	std::printf(
+	  "  %s: %zu triangles, ACMR %.3f -> %.3f, ATVR %.3f -> %.3f, %.2f ms\n", name,
+	  geometry.indices.size() / 3, before.acmr, after.acmr, before.atvr, after.atvr,
+	  elapsed.count());
+
+	// 頂点は並べ替えただけで（参照されない頂点は除かれる）、
+	// インデックスが指す頂点の集合（三角形の向きも含む）は変わらない
+	std::vector<uint32_t> referenced(geometry.indices);
+	std::sort(referenced.begin(), referenced.end());
+	referenced.erase(std::unique(referenced.begin(), referenced.end()), referenced.end());
+	TEST_CHECK(mesh.GetVertexCount() == referenced.size());
+	TEST_CHECK(mesh.GetIndices().size() == geometry.indices.size());
+	TEST_CHECK(
+	  GetSortedTriangles(mesh.GetVertices(), mesh.GetIndices(), originalIndices) ==
+	  GetSortedTriangles(geometry.vertices, geometry.indices, originalIndices));
+
+	// 頂点は最初に参照された順に並ぶ
+	uint32_t nextVertex = 0;
+	for (uint32_t index : mesh.GetIndices()) {
+		TEST_CHECK(index <= nextVertex);
+		if (index == nextVertex) {
+			nextVertex++;
+		}
+	}
+}
+
+TEST_CASE(MeshOptimizerImprovesVertexCache) {
+	// 生成したままの順（行ごとに並ぶので、キャッシュに入りきらない分だけ再変換される）
+	CheckOptimize("grid", CreateTestGrid(128, 128));
+	CheckOptimize("sphere", CreateTestSphere(64, 128));
+
+	// 三角形の順がばらばら
+	TestGeometry grid = CreateTestGrid(128, 128);
+	ShuffleTestTriangles(grid.indices, 1);
+	CheckOptimize("shuffled grid", grid);
+	TestGeometry sphere = CreateTestSphere(64, 128);
+	ShuffleTestTriangles(sphere.indices, 2);
+	CheckOptimize("shuffled sphere", sphere);
+}
+
+TEST_CASE(MeshOptimizerKeepsSmallMesh) {
+	// キャッシュに収まる大きさでも壊さない（統計は悪くならない）
+	TestGeometry grid = CreateTestGrid(2, 2);
+	Mesh mesh;
+	mesh.SetGeometry(
+	  grid.vertices.data(), grid.vertices.size(), grid.indices.data(), grid.indices.size());
+	mesh.Optimize();
+	TEST_CHECK(mesh.GetCacheStatisticsAfter().acmr <= mesh.GetCacheStatisticsBefore().acmr);
+	TEST_CHECK(mesh.GetCacheStatisticsAfter().atvr == 1.0f);
+	TEST_CHECK(mesh.GetIndices().size() == grid.indices.size());
+}
+
+} // namespace
@@ -0,0 +1,182 @@
+﻿// MeshSimplifierのテストとベンチマーク（LODレベルごとの三角形数と誤差、閉じた形状を保つ、レベルごとの時間）
+#include "Mesh.h"
+#include "MeshSimplifier.h"
+#include "TestGeometry.h"
+#include "TestUtil.h"
+#include <algorithm>
+#include <cfloat>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <map>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace {
+
+// 座標が同じ頂点を1つにまとめる表（縫い目と極の頂点は同じ座標に複数ある）
+std::vector<uint32_t> GetPositionIds(const TestGeometry& geometry) {
+	std::map<std::tuple<float, float, float>, uint32_t> ids;
+	std::vector<uint32_t> result;
+	for (const Mesh::VertexPosNormalUv& vertex : geometry.vertices) {
+		auto key = std::make_tuple(vertex.pos.x, vertex.pos.y, vertex.pos.z);
+		result.push_back(ids.emplace(key, uint32_t(ids.size())).first->second);
+	}
+	return result;
+}
+
+// 座標で見て穴がない（全ての辺に逆向きの辺がちょうど1本ある）
+bool IsClosed(const std::vector<uint32_t>& indices, const std::vector<uint32_t>& positionIds) {
+	std::map<std::pair<uint32_t, uint32_t>, int> edges;
+	for (size_t i = 0; i < indices.size(); i += 3) {
+		for (size_t k = 0; k < 3; k++) {
+			uint32_t a = positionIds[indices[i + k]];
+			uint32_t b = positionIds[indices[i + (k + 1) % 3]];
+			edges[{a, b}]++;
+		}
+	}
+	for (const auto& edge : edges) {
+		auto reverse = edges.find({edge.first.second, edge.first.first});
+		if (edge.second != 1 || reverse == edges.end() || reverse->second != 1) {
+			return false;
+		}
+	}
+	return true;
+}
+
+// 三角形の重心が単位球の表面からどれだけ内側にあるか（頂点は球面上から動かない）の最大値
+float GetMaxSag(const TestGeometry& geometry, const uint32_t* indices, size_t indexCount) {
+	float maxSag = 0.0f;
+	for (size_t i = 0; i < indexCount; i += 3) {
+		float center[3] = {};
+		for (size_t k = 0; k < 3; k++) {
+			const DirectX::XMFLOAT3& p = geometry.vertices[indices[i + k]].pos;
+			center[0] += p.x / 3.0f;
+			center[1] += p.y / 3.0f;
+			center[2] += p.z / 3.0f;
+		}
+		float length =
+		  std::sqrt(center[0] * center[0] + center[1] * center[1] + center[2] * center[2]);
+		maxSag = (std::max)(maxSag, 1.0f - length);
+	}
+	return maxSag;
+}
+
+// 簡略化する（Mesh::BuildLodsと同じ設定）
+size_t Simplify(
+  std::vector<uint32_t>& destination, const std::vector<uint32_t>& source,
+  const TestGeometry& geometry, size_t targetIndexCount, float targetError, float* error) {
+	destination.resize(source.size());
+	return MeshSimplifier::Simplify(
+	  destination.data(), source.data(), source.size(), &geometry.vertices[0].pos.x,
+	  sizeof(Mesh::VertexPosNormalUv), geometry.vertices.size(), targetIndexCount, targetError,
+	  error);
+}
+
+TEST_CASE(MeshSimplifierLodLevels) {
+	// 1レベルごとに三角形を半分にする
+	const uint32_t kLevelCount = 5;
+	const float kReduction = 0.5f;
+	TestGeometry sphere = CreateTestSphere(96, 192);
+	std::vector<uint32_t> positionIds = GetPositionIds(sphere);
+	TEST_CHECK(IsClosed(sphere.indices, positionIds));
+
+	std::vector<uint32_t> source = sphere.indices;
+	std::vector<uint32_t> simplified;
+	std::vector<size_t> levelIndexCounts = {source.size()};
+	std::vector<float> levelErrors = {0.0f};
+	for (uint32_t level = 1; level <= kLevelCount; level++) {
+		size_t targetIndexCount = static_cast<size_t>(float(source.size() / 3) * kReduction) * 3;
+
+		auto start = std::chrono::steady_clock::now();
+		float error = 0.0f;
+		size_t indexCount = Simplify(simplified, source, sphere, targetIndexCount, FLT_MAX, &error);
+		std::chrono::duration<double, std::milli> elapsed =
+		  std::chrono::steady_clock::now() - start;
+
+		// 目標の三角形数まで減り、減らしすぎない
+		TEST_CHECK(indexCount % 3 == 0);
+		TEST_CHECK(indexCount <= targetIndexCount);
+		TEST_CHECK(indexCount >= targetIndexCount * 3 / 4);
+
+		// 頂点は動かさないので、面の凹みは累積誤差以内に収まる（誤差は面の平面からの距離の推定）
+		simplified.resize(indexCount);
+		float totalError = levelErrors.back() + error;
+		float sag = GetMaxSag(sphere, simplified.data(), indexCount);
+		TEST_CHECK(error > 0.0f);
+		TEST_CHECK(sag <= totalError * 2.0f);
+
+		// 穴は開かない（縫い目と極の頂点は動かない）
+		TEST_CHECK(IsClosed(simplified, positionIds));
+
+		std::printf(
+		  "  level %u: %zu -> %zu triangles (target %zu), error %.5f (total %.5f, sag %.5f), "
+		  "%.2f ms\n",
+		  level, source.size() / 3, indexCount / 3, targetIndexCount / 3, error, totalError, sag,
+		  elapsed.count());
+		levelIndexCounts.push_back(indexCount);
+		levelErrors.push_back(totalError);
+		source = simplified;
+	}
+
+	// Mesh::BuildLodsも同じ目標でレベルを作る
+	// （レベルごとに頂点キャッシュ向けに並べ替えてから次を作るので、三角形数は上と一致しない）
+	Mesh mesh;
+	mesh.SetGeometry(
+	  sphere.vertices.data(), sphere.vertices.size(), sphere.indices.data(),
+	  sphere.indices.size());
+	mesh.BuildLods(kLevelCount, kReduction);
+	const std::vector<Mesh::LodLevel>& lods = mesh.GetLods();
+	TEST_CHECK(lods.size() == kLevelCount + 1);
+	TEST_CHECK(lods[0].indexOffset == 0 && lods[0].indexCount == sphere.indices.size());
+	TEST_CHECK(lods[0].error == 0.0f);
+	for (size_t level = 1; level < lods.size(); level++) {
+		// 前のレベルの直後に並び、三角形数は目標以下、誤差は粗いほど大きい
+		const Mesh::LodLevel& lod = lods[level];
+		const Mesh::LodLevel& previous = lods[level - 1];
+		size_t targetIndexCount =
+		  static_cast<size_t>(float(previous.indexCount / 3) * kReduction) * 3;
+		TEST_CHECK(lod.indexOffset == previous.indexOffset + previous.indexCount);
+		TEST_CHECK(lod.indexCount <= targetIndexCount);
+		TEST_CHECK(lod.indexCount >= targetIndexCount * 3 / 4);
+		TEST_CHECK(lod.error > previous.error);
+
+		std::vector<uint32_t> indices(
+		  mesh.GetIndices().begin() + lod.indexOffset,
+		  mesh.GetIndices().begin() + lod.indexOffset + lod.indexCount);
+		TEST_CHECK(GetMaxSag(sphere, indices.data(), indices.size()) <= lod.error * 2.0f);
+		TEST_CHECK(IsClosed(indices, positionIds));
+	}
+	TEST_CHECK(mesh.GetIndices().size() == lods.back().indexOffset + lods.back().indexCount);
+}
+
+TEST_CASE(MeshSimplifierTargetError) {
+	// 誤差の上限を渡せば、三角形数の目標に届かなくてもそこで止まる
+	TestGeometry sphere = CreateTestSphere(64, 128);
+	const float kTargetErrors[] = {0.0005f, 0.002f, 0.01f};
+	size_t previousIndexCount = sphere.indices.size();
+	for (float targetError : kTargetErrors) {
+		std::vector<uint32_t> simplified;
+		float error = 0.0f;
+		size_t indexCount = Simplify(simplified, sphere.indices, sphere, 0, targetError, &error);
+		TEST_CHECK(error <= targetError);
+		TEST_CHECK(indexCount > 0);
+		// 上限が大きいほど減る
+		TEST_CHECK(indexCount < previousIndexCount);
+		previousIndexCount = indexCount;
+		std::printf(
+		  "  target error %.4f: %zu -> %zu triangles, error %.5f\n", targetError,
+		  sphere.indices.size() / 3, indexCount / 3, error);
+	}
+
+	// 平面は誤差0のまま縁だけを残すところまで減る
+	TestGeometry grid = CreateTestGrid(32, 32);
+	std::vector<uint32_t> simplified;
+	float error = 1.0f;
+	size_t indexCount = Simplify(simplified, grid.indices, grid, 0, 0.0f, &error);
+	TEST_CHECK(error == 0.0f);
+	TEST_CHECK(indexCount < grid.indices.size() / 4);
+}
+
+} // namespace
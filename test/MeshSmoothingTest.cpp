@@ -0,0 +1,180 @@
+﻿// Mesh::CalculateSmoothedVertexNormalsのテストとベンチマーク（100万の面の角で、結果の向き、時間、メモリ量）
+// メモリ量はこのテスト実行ファイルのoperator newで数える
+#include "Mesh.h"
+#include "TestGeometry.h"
+#include "TestUtil.h"
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+// 確保中のバイト数と、計測開始からの最大値
+std::atomic<size_t> gAllocatedBytes(0);
+std::atomic<size_t> gPeakBytes(0);
+// 確保したサイズを記録する領域（アライメントを保つ大きさ）
+const size_t kAllocationHeader = 16;
+
+// 計測開始（現在の確保量を最大値にする）
+size_t BeginMeasure() {
+	size_t current = gAllocatedBytes.load();
+	gPeakBytes.store(current);
+	return current;
+}
+
+} // namespace
+
+void* operator new(size_t size) {
+	char* block = static_cast<char*>(std::malloc(size + kAllocationHeader));
+	if (!block) {
+		throw std::bad_alloc();
+	}
+	*reinterpret_cast<size_t*>(block) = size;
+	size_t current = gAllocatedBytes.fetch_add(size) + size;
+	size_t peak = gPeakBytes.load();
+	while (current > peak && !gPeakBytes.compare_exchange_weak(peak, current)) {
+	}
+	return block + kAllocationHeader;
+}
+void operator delete(void* pointer) noexcept {
+	if (!pointer) {
+		return;
+	}
+	char* block = static_cast<char*>(pointer) - kAllocationHeader;
+	gAllocatedBytes.fetch_sub(*reinterpret_cast<size_t*>(block));
+	std::free(block);
+}
+void* operator new[](size_t size) { return operator new(size); }
+void operator delete[](void* pointer) noexcept { operator delete(pointer); }
+void operator delete(void* pointer, size_t) noexcept { operator delete(pointer); }
+void operator delete[](void* pointer, size_t) noexcept { operator delete(pointer); }
+
+namespace {
+
+// 面ごとに頂点を持つ球（フラットシェーディングのOBJを読み込んだ時と同じ、角ごとに1頂点で法線は面法線）
+// positionIdsは角が参照する座標番号
+struct FlatMesh {
+	std::vector<Mesh::VertexPosNormalUv> vertices;
+	std::vector<uint32_t> indices;
+	std::vector<uint32_t> positionIds;
+};
+FlatMesh CreateFlatSphere(uint32_t ringCount, uint32_t segmentCount) {
+	TestGeometry sphere = CreateTestSphere(ringCount, segmentCount);
+	FlatMesh mesh;
+	mesh.vertices.reserve(sphere.indices.size());
+	for (size_t t = 0; t + 2 < sphere.indices.size(); t += 3) {
+		const DirectX::XMFLOAT3& p0 = sphere.vertices[sphere.indices[t]].pos;
+		const DirectX::XMFLOAT3& p1 = sphere.vertices[sphere.indices[t + 1]].pos;
+		const DirectX::XMFLOAT3& p2 = sphere.vertices[sphere.indices[t + 2]].pos;
+		float e1[3] = {p1.x - p0.x, p1.y - p0.y, p1.z - p0.z};
+		float e2[3] = {p2.x - p0.x, p2.y - p0.y, p2.z - p0.z};
+		float n[3] = {
+		  e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2],
+		  e1[0] * e2[1] - e1[1] * e2[0]};
+		float length = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+		for (size_t k = 0; k < 3; k++) {
+			Mesh::VertexPosNormalUv vertex = sphere.vertices[sphere.indices[t + k]];
+			vertex.normal = {n[0] / length, n[1] / length, n[2] / length};
+			mesh.indices.push_back(static_cast<uint32_t>(mesh.vertices.size()));
+			mesh.positionIds.push_back(sphere.indices[t + k] + 1);
+			mesh.vertices.push_back(vertex);
+		}
+	}
+	return mesh;
+}
+
+// 以前の実装（座標番号ごとの頂点リストを連想配列に持ち、元の法線を平均する）
+void SmoothWithMap(std::vector<Mesh::VertexPosNormalUv>& vertices, const FlatMesh& mesh) {
+	std::unordered_map<uint32_t, std::vector<uint32_t>> smoothData;
+	for (size_t i = 0; i < mesh.positionIds.size(); i++) {
+		smoothData[mesh.positionIds[i]].emplace_back(static_cast<uint32_t>(i));
+	}
+	for (auto& entry : smoothData) {
+		float sum[3] = {};
+		for (uint32_t index : entry.second) {
+			sum[0] += vertices[index].normal.x;
+			sum[1] += vertices[index].normal.y;
+			sum[2] += vertices[index].normal.z;
+		}
+		float length = std::sqrt(sum[0] * sum[0] + sum[1] * sum[1] + sum[2] * sum[2]);
+		for (uint32_t index : entry.second) {
+			vertices[index].normal = {sum[0] / length, sum[1] / length, sum[2] / length};
+		}
+	}
+}
+
+// 球の法線は中心からの向きに近い
+bool IsRadial(const Mesh::VertexPosNormalUv& vertex, float minimumDot) {
+	const DirectX::XMFLOAT3& p = vertex.pos;
+	const DirectX::XMFLOAT3& n = vertex.normal;
+	float length = std::sqrt(p.x * p.x + p.y * p.y + p.z * p.z);
+	return (p.x * n.x + p.y * n.y + p.z * n.z) / length >= minimumDot;
+}
+
+TEST_CASE(MeshSmoothingBenchmark) {
+	// 288x576の球を面ごとに分けると約100万の角になる
+	FlatMesh flat = CreateFlatSphere(288, 576);
+	const size_t cornerCount = flat.indices.size();
+	TEST_CHECK(cornerCount >= 990000);
+	const int kRepeatCount = 3;
+
+	// 平滑化データの保持量、計算中の一時確保量の最大値、時間
+	double meshTime = INFINITY;
+	size_t meshDataBytes = 0;
+	size_t meshPeakBytes = 0;
+	std::vector<Mesh::VertexPosNormalUv> smoothed;
+	for (int i = 0; i < kRepeatCount; i++) {
+		Mesh mesh;
+		mesh.SetGeometry(
+		  flat.vertices.data(), flat.vertices.size(), flat.indices.data(), flat.indices.size());
+		size_t base = BeginMeasure();
+		for (size_t v = 0; v < cornerCount; v++) {
+			mesh.AddSmoothData(flat.positionIds[v], static_cast<uint32_t>(v));
+		}
+		meshDataBytes = gAllocatedBytes.load() - base;
+		size_t calculateBase = BeginMeasure();
+		auto start = std::chrono::steady_clock::now();
+		mesh.CalculateSmoothedVertexNormals();
+		std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+		meshTime = (std::min)(meshTime, elapsed.count());
+		meshPeakBytes = gPeakBytes.load() - calculateBase;
+		smoothed = mesh.GetVertices();
+	}
+	// 面の角度で重み付けした法線はどの角も中心からの向きに近い
+	size_t radialCount = 0;
+	for (const Mesh::VertexPosNormalUv& vertex : smoothed) {
+		radialCount += IsRadial(vertex, 0.9999f) ? 1 : 0;
+	}
+	TEST_CHECK(radialCount == cornerCount);
+
+	double mapTime = INFINITY;
+	size_t mapPeakBytes = 0;
+	for (int i = 0; i < kRepeatCount; i++) {
+		std::vector<Mesh::VertexPosNormalUv> vertices = flat.vertices;
+		size_t base = BeginMeasure();
+		auto start = std::chrono::steady_clock::now();
+		SmoothWithMap(vertices, flat);
+		std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+		mapTime = (std::min)(mapTime, elapsed.count());
+		mapPeakBytes = gPeakBytes.load() - base;
+		for (const Mesh::VertexPosNormalUv& vertex : vertices) {
+			TEST_CHECK(IsRadial(vertex, 0.99f));
+		}
+	}
+
+	const double kMegabyte = 1024.0 * 1024.0;
+	std::printf(
+	  "  %zu corners: flat arrays %.1f ms (%.1f MB smooth data + %.1f MB peak while "
+	  "smoothing)\n",
+	  cornerCount, meshTime, meshDataBytes / kMegabyte, meshPeakBytes / kMegabyte);
+	std::printf(
+	  "  %zu corners: unordered_map of vectors %.1f ms (%.1f MB peak)\n", cornerCount, mapTime,
+	  mapPeakBytes / kMegabyte);
+}
+
+} // namespace
@@ -0,0 +1,223 @@
+﻿// Mesh::CalculateTangentsのテスト（立方体と軸の形状で、面の向きから求めた接線と一致する、法線と直交する、wの向き）
+// リポジトリにcube.objとaxis.objは含まれないので、同じ形のOBJを書き出してModel::Importで読み込む
+#include "CookedModel.h"
+#include "JobSystem.h"
+#include "Model.h"
+#include "ModelImportAccess.h"
+#include "TestUtil.h"
+#include <Windows.h>
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace {
+
+// 3次元ベクトル（基準値はdoubleで求める）
+struct Vector3 {
+	double x, y, z;
+};
+Vector3 Subtract(const Vector3& a, const Vector3& b) { return {a.x - b.x, a.y - b.y, a.z - b.z}; }
+Vector3 Scale(const Vector3& a, double s) { return {a.x * s, a.y * s, a.z * s}; }
+double Dot(const Vector3& a, const Vector3& b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+Vector3 Cross(const Vector3& a, const Vector3& b) {
+	return {a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x};
+}
+Vector3 Normalize(const Vector3& a) { return Scale(a, 1.0 / std::sqrt(Dot(a, a))); }
+
+// OBJの形状（面はp/t/nの番号、0始まり）
+struct ObjCorner {
+	uint32_t position;
+	uint32_t uv;
+	uint32_t normal;
+};
+struct ObjShape {
+	std::vector<Vector3> positions;
+	std::vector<Vector3> uvs; // xyのみ使う（OBJのvtの向き）
+	std::vector<Vector3> normals;
+	std::vector<std::vector<ObjCorner>> faces;
+};
+
+// Blenderの立方体（cube.objと同じ頂点・UV・面の並び）
+ObjShape CreateCube() {
+	ObjShape cube;
+	cube.positions = {{1, 1, -1},  {1, -1, -1},  {1, 1, 1},  {1, -1, 1},
+	                  {-1, 1, -1}, {-1, -1, -1}, {-1, 1, 1}, {-1, -1, 1}};
+	cube.uvs = {{0.625, 0.5, 0},  {0.875, 0.5, 0},  {0.875, 0.75, 0}, {0.625, 0.75, 0},
+	            {0.375, 0.75, 0}, {0.625, 1.0, 0},  {0.375, 1.0, 0},  {0.375, 0.0, 0},
+	            {0.625, 0.0, 0},  {0.625, 0.25, 0}, {0.375, 0.25, 0}, {0.125, 0.5, 0},
+	            {0.375, 0.5, 0},  {0.125, 0.75, 0}};
+	cube.normals = {{0, 1, 0}, {0, 0, 1}, {-1, 0, 0}, {0, -1, 0}, {1, 0, 0}, {0, 0, -1}};
+	cube.faces = {
+	  {{0, 0, 0}, {4, 1, 0}, {6, 2, 0}, {2, 3, 0}},
+	  {{3, 4, 1}, {2, 3, 1}, {6, 5, 1}, {7, 6, 1}},
+	  {{7, 7, 2}, {6, 8, 2}, {4, 9, 2}, {5, 10, 2}},
+	  {{5, 11, 3}, {1, 12, 3}, {3, 4, 3}, {7, 13, 3}},
+	  {{1, 12, 4}, {0, 0, 4}, {2, 3, 4}, {3, 4, 4}},
+	  {{5, 10, 5}, {4, 9, 5}, {0, 0, 5}, {1, 12, 5}}};
+	return cube;
+}
+
+// 軸の形状（軸の矢の柄と同じ、y軸に沿った細い円柱の側面。法線は滑らか、uは周方向）
+ObjShape CreateAxisShaft(uint32_t segmentCount) {
+	const double pi = 3.14159265358979;
+	const double radius = 0.05;
+	ObjShape shaft;
+	for (uint32_t s = 0; s <= segmentCount; s++) {
+		double phi = 2.0 * pi * (s % segmentCount) / segmentCount;
+		for (uint32_t r = 0; r <= 1; r++) {
+			shaft.positions.push_back({radius * std::cos(phi), double(r), radius * std::sin(phi)});
+			shaft.uvs.push_back({double(s) / segmentCount, double(r), 0});
+		}
+		shaft.normals.push_back({std::cos(phi), 0, std::sin(phi)});
+	}
+	for (uint32_t s = 0; s < segmentCount; s++) {
+		uint32_t i0 = s * 2;
+		shaft.faces.push_back(
+		  {{i0, i0, s}, {i0 + 1, i0 + 1, s}, {i0 + 3, i0 + 3, s + 1}, {i0 + 2, i0 + 2, s + 1}});
+	}
+	return shaft;
+}
+
+// uを反転する（テクスチャを鏡映した形状）
+ObjShape MirrorU(ObjShape shape) {
+	for (Vector3& uv : shape.uvs) {
+		uv.x = 1.0 - uv.x;
+	}
+	return shape;
+}
+
+// OBJとMTLの書き出し（テクスチャのあるマテリアルでなければUVと法線は読み込まれない）
+void WriteObj(const std::string& directoryPath, const std::string& name, const ObjShape& shape) {
+	std::FILE* file = std::fopen((directoryPath + name + ".mtl").c_str(), "w");
+	TEST_CHECK(file);
+	std::fprintf(file, "newmtl Material\nmap_Kd white1x1.png\n");
+	std::fclose(file);
+
+	file = std::fopen((directoryPath + name + ".obj").c_str(), "w");
+	TEST_CHECK(file);
+	std::fprintf(file, "mtllib %s.mtl\n", name.c_str());
+	for (const Vector3& p : shape.positions) {
+		std::fprintf(file, "v %.9g %.9g %.9g\n", p.x, p.y, p.z);
+	}
+	for (const Vector3& uv : shape.uvs) {
+		std::fprintf(file, "vt %.9g %.9g\n", uv.x, uv.y);
+	}
+	for (const Vector3& n : shape.normals) {
+		std::fprintf(file, "vn %.9g %.9g %.9g\n", n.x, n.y, n.z);
+	}
+	std::fprintf(file, "usemtl Material\ns off\n");
+	for (const std::vector<ObjCorner>& face : shape.faces) {
+		std::fprintf(file, "f");
+		for (const ObjCorner& c : face) {
+			std::fprintf(file, " %u/%u/%u", c.position + 1, c.uv + 1, c.normal + 1);
+		}
+		std::fprintf(file, "\n");
+	}
+	std::fclose(file);
+}
+
+// 面の接線の基準値（頂点の法線に直交化した dP/du と、wは dP/dv の向き）
+// 平面の面はUVが線形なので、2辺から dP/du と dP/dv がちょうど求まる
+struct Frame {
+	Vector3 tangent;
+	double handedness;
+};
+Frame GetFaceFrame(const ObjShape& shape, const std::vector<ObjCorner>& face, size_t corner) {
+	const ObjCorner& c0 = face[corner];
+	const ObjCorner& c1 = face[(corner + 1) % face.size()];
+	const ObjCorner& c2 = face[(corner + face.size() - 1) % face.size()];
+	Vector3 e1 = Subtract(shape.positions[c1.position], shape.positions[c0.position]);
+	Vector3 e2 = Subtract(shape.positions[c2.position], shape.positions[c0.position]);
+	Vector3 uv1 = Subtract(shape.uvs[c1.uv], shape.uvs[c0.uv]);
+	Vector3 uv2 = Subtract(shape.uvs[c2.uv], shape.uvs[c0.uv]);
+	double determinant = uv1.x * uv2.y - uv2.x * uv1.y;
+	Vector3 dpdu = Scale(Subtract(Scale(e1, uv2.y), Scale(e2, uv1.y)), 1.0 / determinant);
+	Vector3 dpdv = Scale(Subtract(Scale(e2, uv1.x), Scale(e1, uv2.x)), 1.0 / determinant);
+
+	Vector3 normal = Normalize(shape.normals[c0.normal]);
+	Frame frame;
+	frame.tangent = Normalize(Subtract(dpdu, Scale(normal, Dot(normal, dpdu))));
+	frame.handedness = Dot(Cross(normal, frame.tangent), dpdv) < 0.0 ? -1.0 : 1.0;
+	return frame;
+}
+
+// 読み込んで接線を確かめる（頂点は座標・法線・UVで面の角を探す）
+// 戻り値は全頂点のwの合計
+int CheckTangents(const char* name, const ObjShape& shape, JobSystem* jobSystem) {
+	const std::string directoryPath = std::string("Resources/") + name + "/";
+	CreateDirectoryA(directoryPath.c_str(), nullptr);
+	WriteObj(directoryPath, name, shape);
+
+	Model::ImportSettings settings;
+	settings.tangents = true;
+	Model* model = new Model;
+	ModelImportAccess::Import(*model, name, settings, jobSystem);
+	TEST_CHECK(model->GetMeshes().size() == 1);
+	Mesh& mesh = *model->GetMeshes()[0];
+	TEST_CHECK(mesh.HasTangents());
+	TEST_CHECK(mesh.GetTangents().size() == mesh.GetVertexCount());
+
+	size_t checkedCount = 0;
+	int handednessSum = 0;
+	for (size_t v = 0; v < mesh.GetVertexCount(); v++) {
+		const Mesh::VertexPosNormalUv& vertex = mesh.GetVertices()[v];
+		const DirectX::XMFLOAT4& tangent = mesh.GetTangents()[v];
+		Vector3 t = {tangent.x, tangent.y, tangent.z};
+		Vector3 n = Normalize({vertex.normal.x, vertex.normal.y, vertex.normal.z});
+
+		// 単位長で法線と直交し、wは±1
+		TEST_CHECK(std::fabs(Dot(t, t) - 1.0) < 1e-5);
+		TEST_CHECK(std::fabs(Dot(t, n)) < 1e-5);
+		TEST_CHECK(tangent.w == 1.0f || tangent.w == -1.0f);
+		handednessSum += tangent.w > 0.0f ? 1 : -1;
+
+		// この頂点を作った面の角の基準値と比べる（読み込み時にVは反転される）
+		for (const std::vector<ObjCorner>& face : shape.faces) {
+			for (size_t c = 0; c < face.size(); c++) {
+				const Vector3& p = shape.positions[face[c].position];
+				const Vector3& uv = shape.uvs[face[c].uv];
+				Vector3 normal = Normalize(shape.normals[face[c].normal]);
+				if (
+				  std::fabs(p.x - vertex.pos.x) > 1e-6 || std::fabs(p.y - vertex.pos.y) > 1e-6 ||
+				  std::fabs(p.z - vertex.pos.z) > 1e-6 || std::fabs(uv.x - vertex.uv.x) > 1e-6 ||
+				  std::fabs(1.0 - uv.y - vertex.uv.y) > 1e-6 || Dot(normal, n) < 0.9999) {
+					continue;
+				}
+				Frame expected = GetFaceFrame(shape, face, c);
+				TEST_CHECK(Dot(expected.tangent, t) > 0.9999);
+				TEST_CHECK(double(tangent.w) == expected.handedness);
+				checkedCount++;
+			}
+		}
+	}
+	// 全ての頂点が少なくとも1つの面の角と比べられた
+	TEST_CHECK(checkedCount >= mesh.GetVertexCount());
+
+	delete model;
+	std::remove((directoryPath + name + CookedModel::kExtension).c_str());
+	std::remove((directoryPath + name + ".obj").c_str());
+	std::remove((directoryPath + name + ".mtl").c_str());
+	RemoveDirectoryA(directoryPath.c_str());
+	return handednessSum;
+}
+
+TEST_CASE(MeshTangentsMatchReference) {
+	// 立方体は面ごとに接線が一定、軸の柄は周方向（滑らかな法線に直交化すると円の接線になる）
+	int cube = CheckTangents("test_tangent_cube", CreateCube(), nullptr);
+	int axis = CheckTangents("test_tangent_axis", CreateAxisShaft(32), nullptr);
+
+	// 鏡映したUVでは接線とwの向きが逆になる
+	TEST_CHECK(cube != 0 && axis != 0);
+	TEST_CHECK(
+	  CheckTangents("test_tangent_cube_mirrored", MirrorU(CreateCube()), nullptr) == -cube);
+	TEST_CHECK(
+	  CheckTangents("test_tangent_axis_mirrored", MirrorU(CreateAxisShaft(32)), nullptr) == -axis);
+
+	// ジョブに分けても同じ
+	JobSystem::GetInstance()->Initialize(3);
+	CheckTangents("test_tangent_axis_parallel", CreateAxisShaft(256), JobSystem::GetInstance());
+	JobSystem::GetInstance()->Finalize();
+}
+
+} // namespace
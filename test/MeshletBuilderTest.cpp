@@ -0,0 +1,173 @@
+﻿// MeshletBuilderのテストとベンチマーク（全ての三角形がちょうど1つのメッシュレットに入る、上限、境界、構築時間）
+#include "MeshletBuilder.h"
+#include "TestGeometry.h"
+#include "TestUtil.h"
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+namespace {
+
+// 三角形（メッシュの頂点番号）
+using Triangle = std::array<uint32_t, 3>;
+
+// 入力の三角形を並べて返す
+std::vector<Triangle> GetSortedTriangles(const std::vector<uint32_t>& indices) {
+	std::vector<Triangle> triangles;
+	for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+		triangles.push_back({indices[i], indices[i + 1], indices[i + 2]});
+	}
+	std::sort(triangles.begin(), triangles.end());
+	return triangles;
+}
+
+// 構築して、分割が正しいことを確かめる
+// 戻り値は全メッシュレットの頂点数の最大値
+uint32_t CheckBuild(const TestGeometry& geometry, uint32_t maxVertices, uint32_t maxTriangles) {
+	MeshletBuilder::MeshletData data;
+	MeshletBuilder::Build(
+	  data, geometry.indices.data(), geometry.indices.size(), &geometry.vertices[0].pos.x,
+	  sizeof(Mesh::VertexPosNormalUv), geometry.vertices.size(), maxVertices, maxTriangles);
+	TEST_CHECK(data.bounds.size() == data.meshlets.size());
+
+	std::vector<Triangle> triangles;
+	uint32_t largestVertexCount = 0;
+	uint32_t vertexOffset = 0;
+	uint32_t triangleOffset = 0;
+	std::vector<bool> inMeshlet(geometry.vertices.size(), false);
+	for (size_t m = 0; m < data.meshlets.size(); m++) {
+		const MeshletBuilder::Meshlet& meshlet = data.meshlets[m];
+
+		// 上限以内で、配列の中で隙間なく並ぶ
+		TEST_CHECK(meshlet.vertexCount >= 1 && meshlet.vertexCount <= maxVertices);
+		TEST_CHECK(meshlet.triangleCount >= 1 && meshlet.triangleCount <= maxTriangles);
+		TEST_CHECK(meshlet.vertexOffset == vertexOffset);
+		TEST_CHECK(meshlet.triangleOffset == triangleOffset);
+		vertexOffset += meshlet.vertexCount;
+		triangleOffset += meshlet.triangleCount * 3;
+		largestVertexCount = (std::max)(largestVertexCount, meshlet.vertexCount);
+
+		// メッシュレット内の頂点は重複しない
+		const uint32_t* vertices = &data.vertices[meshlet.vertexOffset];
+		for (uint32_t i = 0; i < meshlet.vertexCount; i++) {
+			TEST_CHECK(!inMeshlet[vertices[i]]);
+			inMeshlet[vertices[i]] = true;
+		}
+		for (uint32_t i = 0; i < meshlet.vertexCount; i++) {
+			inMeshlet[vertices[i]] = false;
+		}
+
+		// メッシュの頂点番号に戻す
+		const MeshletBuilder::MeshletBounds& bounds = data.bounds[m];
+		for (uint32_t t = 0; t < meshlet.triangleCount; t++) {
+			Triangle triangle;
+			for (uint32_t k = 0; k < 3; k++) {
+				uint8_t local = data.triangles[meshlet.triangleOffset + t * 3 + k];
+				TEST_CHECK(local < meshlet.vertexCount);
+				triangle[k] = vertices[local];
+
+				// 頂点は境界球に入る
+				const DirectX::XMFLOAT3& p = geometry.vertices[triangle[k]].pos;
+				float d[3] = {
+				  p.x - bounds.center[0], p.y - bounds.center[1], p.z - bounds.center[2]};
+				TEST_CHECK(
+				  std::sqrt(d[0] * d[0] + d[1] * d[1] + d[2] * d[2]) <= bounds.radius * 1.0001f);
+			}
+			triangles.push_back(triangle);
+		}
+	}
+	TEST_CHECK(vertexOffset == data.vertices.size());
+	TEST_CHECK(triangleOffset == data.triangles.size());
+
+	// 全ての三角形が、頂点の順も変わらずにちょうど1回ずつ現れる
+	std::sort(triangles.begin(), triangles.end());
+	TEST_CHECK(triangles == GetSortedTriangles(geometry.indices));
+	return largestVertexCount;
+}
+
+TEST_CASE(MeshletBuilderCoversEveryTriangleOnce) {
+	TestGeometry sphere = CreateTestSphere(32, 64);
+	TestGeometry grid = CreateTestGrid(64, 64);
+	TestGeometry shuffled = CreateTestSphere(32, 64);
+	ShuffleTestTriangles(shuffled.indices, 3);
+	// 同じ頂点を2回使う縮退三角形を混ぜる（1つの三角形の中で頂点が新しく入るか2回判定される）
+	TestGeometry degenerate = CreateTestGrid(64, 64);
+	for (size_t i = 0; i < degenerate.indices.size(); i += 3 * 5) {
+		degenerate.indices[i + 2] = degenerate.indices[i];
+	}
+
+	for (const TestGeometry* geometry : {&sphere, &grid, &shuffled, &degenerate}) {
+		// 標準の上限
+		TEST_CHECK(
+		  CheckBuild(*geometry, MeshletBuilder::kMaxVertices, MeshletBuilder::kMaxTriangles) <=
+		  MeshletBuilder::kMaxVertices);
+		// 最小の上限（三角形1つずつ）
+		CheckBuild(*geometry, 3, 1);
+		// 頂点数の上限いっぱいまで詰める（未使用の印0xffと頂点番号がぶつからない）
+		TEST_CHECK(CheckBuild(*geometry, MeshletBuilder::kVertexLimit, 1024) ==
+		           MeshletBuilder::kVertexLimit);
+	}
+}
+
+TEST_CASE(MeshletBuilderBackfacingCone) {
+	// 平面は全てのメッシュレットの法線コーンが+yを向き、下からは裏、上からは表になる
+	TestGeometry grid = CreateTestGrid(32, 32);
+	MeshletBuilder::MeshletData data;
+	MeshletBuilder::Build(
+	  data, grid.indices.data(), grid.indices.size(), &grid.vertices[0].pos.x,
+	  sizeof(Mesh::VertexPosNormalUv), grid.vertices.size());
+	const float below[3] = {0.5f, -10.0f, 0.5f};
+	const float above[3] = {0.5f, 10.0f, 0.5f};
+	for (const MeshletBuilder::MeshletBounds& bounds : data.bounds) {
+		TEST_CHECK(bounds.coneCutoff < 1e-3f);
+		TEST_CHECK(std::fabs(bounds.coneAxis[1] - 1.0f) < 1e-5f);
+		TEST_CHECK(MeshletBuilder::IsBackfacing(bounds, below));
+		TEST_CHECK(!MeshletBuilder::IsBackfacing(bounds, above));
+	}
+
+	// 球全体を覆うメッシュレットは裏面判定に使わない
+	TestGeometry sphere = CreateTestSphere(4, 8);
+	MeshletBuilder::Build(
+	  data, sphere.indices.data(), sphere.indices.size(), &sphere.vertices[0].pos.x,
+	  sizeof(Mesh::VertexPosNormalUv), sphere.vertices.size(), MeshletBuilder::kVertexLimit,
+	  1024);
+	TEST_CHECK(data.meshlets.size() == 1);
+	TEST_CHECK(data.bounds[0].coneCutoff > 1.0f);
+	TEST_CHECK(!MeshletBuilder::IsBackfacing(data.bounds[0], below));
+}
+
+TEST_CASE(MeshletBuilderBenchmark) {
+	// 約26万三角形の球を標準の上限で分割する時間
+	const int kRepeatCount = 3;
+	TestGeometry sphere = CreateTestSphere(256, 512);
+	size_t triangleCount = sphere.indices.size() / 3;
+
+	for (int shuffle = 0; shuffle < 2; shuffle++) {
+		if (shuffle) {
+			ShuffleTestTriangles(sphere.indices, 4);
+		}
+		MeshletBuilder::MeshletData data;
+		double best = INFINITY;
+		for (int i = 0; i < kRepeatCount; i++) {
+			auto start = std::chrono::steady_clock::now();
+			MeshletBuilder::Build(
+			  data, sphere.indices.data(), sphere.indices.size(), &sphere.vertices[0].pos.x,
+			  sizeof(Mesh::VertexPosNormalUv), sphere.vertices.size());
+			std::chrono::duration<double, std::milli> elapsed =
+			  std::chrono::steady_clock::now() - start;
+			best = (std::min)(best, elapsed.count());
+		}
+		TEST_CHECK(!data.meshlets.empty());
+		std::printf(
+		  "  %s: %zu triangles -> %zu meshlets (%.1f vertices, %.1f triangles each), "
+		  "%.1f ms, %.2f Mtri/s\n",
+		  shuffle ? "shuffled" : "ordered", triangleCount, data.meshlets.size(),
+		  double(data.vertices.size()) / data.meshlets.size(),
+		  double(triangleCount) / data.meshlets.size(), best, triangleCount / best / 1000.0);
+	}
+}
+
+} // namespace
@@ -0,0 +1,25 @@
+﻿#pragma once
+
+#include "Model.h"
+#include <string>
+
+// テストからModelのCPU側の読み込みだけを呼ぶ（GPUリソースを作らずに読み込み結果を調べる）
+
+/// <summary>
+/// Model::Importをテストから呼ぶための窓口
+/// </summary>
+class ModelImportAccess {
+  public:
+	/// <summary>
+	/// CPU側の読み込み
+	/// </summary>
+	/// <param name="model">読み込み先のモデル</param>
+	/// <param name="modelname">モデル名</param>
+	/// <param name="settings">インポート設定</param>
+	/// <param name="jobSystem">メッシュ単位の並列処理に使うジョブシステム（nullptrなら逐次）</param>
+	static void Import(
+	  Model& model, const std::string& modelname, const Model::ImportSettings& settings,
+	  JobSystem* jobSystem) {
+		model.Import(modelname, settings, jobSystem);
+	}
+};
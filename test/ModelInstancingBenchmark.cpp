@@ -0,0 +1,181 @@
+﻿// Model::DrawInstancedと物体ごとのDrawの比較（描画数・カリング数の数え方が同じこと、CPU時間と描画命令数）
+// 描画命令はRecordingRenderContextに記録する
+#include "CookedModel.h"
+#include "Model.h"
+#include "RecordingRenderContext.h"
+#include "TestGraphics.h"
+#include "TestUtil.h"
+#include "ViewProjection.h"
+#include "WorldTransform.h"
+#include <Windows.h>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+// テスト用に生成するモデル名
+const char* const kModelName = "test_instancing";
+// モデルのディレクトリ
+const std::string kDirectoryPath = std::string("Resources/") + kModelName + "/";
+// カメラの前に並べるインスタンス数とカメラの後ろに置くインスタンス数
+const uint32_t kFrontCount = 8000;
+const uint32_t kBehindCount = 2000;
+// 時間を測るフレーム数
+const uint32_t kFrameCount = 10;
+
+// 2つのグループ（メッシュ）に分かれた箱のOBJとMTL、テクスチャを書き出す
+void WriteTwoBoxObj() {
+	std::FILE* file = std::fopen((kDirectoryPath + "test_instancing.mtl").c_str(), "w");
+	TEST_CHECK(file);
+	std::fprintf(file, "newmtl Material\nKd 1 1 1\nmap_Kd white1x1.png\n");
+	std::fclose(file);
+
+	// テクスチャはモデルのディレクトリから読むので白1x1を複製する
+	std::ifstream source("Resources/white1x1.png", std::ios::binary);
+	std::ofstream(kDirectoryPath + "white1x1.png", std::ios::binary) << source.rdbuf();
+
+	file = std::fopen((kDirectoryPath + kModelName + ".obj").c_str(), "w");
+	TEST_CHECK(file);
+	std::fprintf(file, "mtllib test_instancing.mtl\n");
+	std::fprintf(file, "vt 0 0\nvt 1 0\nvt 1 1\nvt 0 1\n");
+	std::fprintf(file, "vn 0 0 -1\n");
+	// 2つの箱（手前と奥の面だけ。境界は箱になる）
+	// 2つ目はずっと後ろに置き、カメラの前のインスタンスでも1つ目のメッシュだけが見えるようにする
+	const float boxOffsetZ[] = {0.0f, -1000.0f};
+	for (uint32_t box = 0; box < 2; box++) {
+		float z0 = boxOffsetZ[box] - 1.0f;
+		float z1 = boxOffsetZ[box] + 1.0f;
+		std::fprintf(file, "g box%u\nusemtl Material\n", box);
+		std::fprintf(file, "v -1 -1 %f\nv 1 -1 %f\nv 1 1 %f\nv -1 1 %f\n", z0, z0, z0, z0);
+		std::fprintf(file, "v 1 -1 %f\nv -1 -1 %f\nv -1 1 %f\nv 1 1 %f\n", z1, z1, z1, z1);
+		for (uint32_t face = 0; face < 2; face++) {
+			uint32_t i = box * 8 + face * 4 + 1;
+			std::fprintf(file, "f %u/1/1 %u/4/1 %u/3/1 %u/2/1\n", i, i + 3, i + 2, i + 1);
+		}
+	}
+	std::fclose(file);
+}
+
+// インスタンスの配置（カメラの前に並べたものは1つ目のメッシュだけが視錐台の中、後ろに置いたものは全て外）
+std::vector<WorldTransform> CreateInstances() {
+	std::vector<WorldTransform> instances(kFrontCount + kBehindCount);
+	for (uint32_t i = 0; i < kFrontCount; i++) {
+		instances[i].translation_ = {
+		  float(i % 10) * 2.5f - 11.25f, float(i / 10 % 10) * 2.5f - 11.25f,
+		  float(i / 100) * 5.0f};
+	}
+	for (uint32_t i = 0; i < kBehindCount; i++) {
+		instances[kFrontCount + i].translation_ = {
+		  float(i % 10) * 2.5f, float(i / 10 % 10) * 2.5f, -100.0f - float(i / 100) * 5.0f};
+	}
+	for (WorldTransform& instance : instances) {
+		instance.Initialize();
+	}
+	return instances;
+}
+
+// 1フレーム分の描画結果
+struct FrameResult {
+	double milliseconds;
+	uint32_t drawnMeshCount;
+	uint32_t culledMeshCount;
+	uint32_t drawCommandCount;
+	size_t commandCount;
+};
+
+// 物体ごとのDrawまたはDrawInstancedで1フレーム描く
+FrameResult DrawFrame(
+  Model* model, const std::vector<WorldTransform>& instances,
+  const ViewProjection& viewProjection, bool instanced, RecordingRenderContext& context) {
+	context.Clear();
+
+	auto start = std::chrono::steady_clock::now();
+	Model::PreDraw(&context);
+	if (instanced) {
+		model->DrawInstanced(instances, viewProjection);
+	} else {
+		for (const WorldTransform& instance : instances) {
+			model->Draw(instance, viewProjection);
+		}
+	}
+	// 並べ替えが有効なので描画数はPostDrawで積まれる前に数え終わっている
+	FrameResult result;
+	result.drawnMeshCount = Model::GetDrawnMeshCount();
+	result.culledMeshCount = Model::GetCulledMeshCount();
+	Model::PostDraw();
+	std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+
+	result.milliseconds = elapsed.count();
+	result.drawCommandCount = static_cast<uint32_t>(context.GetDrawCount());
+	result.commandCount = context.GetCommands().size();
+	FinishTestFrame();
+	return result;
+}
+
+} // namespace
+
+TEST_CASE(ModelInstancedVsPerObjectBenchmark) {
+	InitializeTestRenderers();
+
+	CreateDirectoryA(kDirectoryPath.c_str(), nullptr);
+	WriteTwoBoxObj();
+	Model* model = Model::CreateFromOBJ(kModelName);
+
+	std::vector<WorldTransform> instances = CreateInstances();
+	ViewProjection viewProjection;
+	viewProjection.Initialize();
+
+	const uint32_t meshCount = 2;
+	const uint32_t instanceCount = kFrontCount + kBehindCount;
+	RecordingRenderContext context;
+
+	// 視錐台カリングの有無で、2つの描き方の描画数とカリング数が一致する
+	const bool cullingModes[] = {true, false};
+	for (bool culling : cullingModes) {
+		Model::SetFrustumCulling(culling);
+		FrameResult perObject = DrawFrame(model, instances, viewProjection, false, context);
+		FrameResult instanced = DrawFrame(model, instances, viewProjection, true, context);
+
+		// インスタンス描画でも、見えていない2つ目のメッシュは描画数に含めない
+		uint32_t expectedDrawn = culling ? kFrontCount : meshCount * instanceCount;
+		TEST_CHECK(perObject.drawnMeshCount == expectedDrawn);
+		TEST_CHECK(instanced.drawnMeshCount == expectedDrawn);
+		TEST_CHECK(perObject.culledMeshCount == meshCount * instanceCount - expectedDrawn);
+		TEST_CHECK(instanced.culledMeshCount == perObject.culledMeshCount);
+
+		// 物体ごとは見えているメッシュごとに1回、インスタンス描画は見えているメッシュにつき1回だけ描く
+		TEST_CHECK(perObject.drawCommandCount == expectedDrawn);
+		TEST_CHECK(instanced.drawCommandCount == (culling ? 1u : meshCount));
+	}
+	Model::SetFrustumCulling(true);
+
+	// CPU時間（カリングあり、並べ替えありの既定の設定）
+	double perObjectMilliseconds = 0.0;
+	double instancedMilliseconds = 0.0;
+	FrameResult perObject = {};
+	FrameResult instanced = {};
+	for (uint32_t frame = 0; frame < kFrameCount; frame++) {
+		perObject = DrawFrame(model, instances, viewProjection, false, context);
+		perObjectMilliseconds += perObject.milliseconds;
+		instanced = DrawFrame(model, instances, viewProjection, true, context);
+		instancedMilliseconds += instanced.milliseconds;
+	}
+
+	std::printf(
+	  "  %u instances x %u meshes (%u in view): per-object %.3f ms/frame, %u draws, %zu commands\n",
+	  instanceCount, meshCount, kFrontCount, perObjectMilliseconds / kFrameCount,
+	  perObject.drawCommandCount, perObject.commandCount);
+	std::printf(
+	  "  instanced %.3f ms/frame, %u draws, %zu commands\n", instancedMilliseconds / kFrameCount,
+	  instanced.drawCommandCount, instanced.commandCount);
+
+	delete model;
+	std::remove((kDirectoryPath + kModelName + ".obj").c_str());
+	std::remove((kDirectoryPath + "test_instancing.mtl").c_str());
+	std::remove((kDirectoryPath + "white1x1.png").c_str());
+	std::remove((kDirectoryPath + kModelName + CookedModel::kExtension).c_str());
+	RemoveDirectoryA(kDirectoryPath.c_str());
+}
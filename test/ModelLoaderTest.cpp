@@ -0,0 +1,149 @@
+﻿// ModelLoaderのテスト（ワーカーでの読み込みと呼び出しスレッドでの読み込みの結果が一致する）
+// GPUリソースは生成せず、CPU側の読み込み結果とクック済みキャッシュを比べる
+#include "CookedModel.h"
+#include "JobSystem.h"
+#include "Model.h"
+#include "ModelImportAccess.h"
+#include "ModelLoader.h"
+#include "TestUtil.h"
+#include <Windows.h>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+namespace {
+
+// テスト用に生成するモデル名
+const char* const kModelName = "test_determinism";
+// モデルのディレクトリ
+const std::string kDirectoryPath = std::string("Resources/") + kModelName + "/";
+// 球の分割数（接線の生成が複数のジョブに分かれる大きさにする）
+const uint32_t kRingCount = 96;
+const uint32_t kSegmentCount = 128;
+// グループ数（メッシュ単位の後処理も並列になる）
+const uint32_t kGroupCount = 4;
+
+// グループに分けた球のOBJを書き出す
+void WriteSphereObj(const std::string& path) {
+	std::FILE* file = std::fopen(path.c_str(), "w");
+	TEST_CHECK(file);
+
+	const float pi = 3.14159265f;
+	for (uint32_t r = 0; r <= kRingCount; r++) {
+		float theta = pi * r / kRingCount;
+		for (uint32_t s = 0; s <= kSegmentCount; s++) {
+			float phi = 2.0f * pi * s / kSegmentCount;
+			float x = std::sin(theta) * std::cos(phi);
+			float y = std::cos(theta);
+			float z = std::sin(theta) * std::sin(phi);
+			std::fprintf(file, "v %f %f %f\n", x, y, z);
+			std::fprintf(file, "vt %f %f\n", float(s) / kSegmentCount, float(r) / kRingCount);
+			std::fprintf(file, "vn %f %f %f\n", x, y, z);
+		}
+	}
+
+	const uint32_t rowSize = kSegmentCount + 1;
+	for (uint32_t r = 0; r < kRingCount; r++) {
+		if (r % (kRingCount / kGroupCount) == 0) {
+			std::fprintf(file, "g band%u\n", r / (kRingCount / kGroupCount));
+		}
+		for (uint32_t s = 0; s < kSegmentCount; s++) {
+			uint32_t i0 = r * rowSize + s + 1;
+			uint32_t i1 = i0 + 1;
+			uint32_t i2 = i0 + rowSize + 1;
+			uint32_t i3 = i0 + rowSize;
+			std::fprintf(
+			  file, "f %u/%u/%u %u/%u/%u %u/%u/%u %u/%u/%u\n", i0, i0, i0, i1, i1, i1, i2, i2, i2,
+			  i3, i3, i3);
+		}
+	}
+
+	std::fclose(file);
+}
+
+// ファイルの中身を読む
+std::vector<char> ReadFileBytes(const std::string& path) {
+	std::ifstream file(path, std::ios::binary);
+	TEST_CHECK(file);
+	return std::vector<char>(
+	  (std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+}
+
+// 配列の中身がバイト単位で一致するか
+template<class T> bool SameBytes(const std::vector<T>& a, const std::vector<T>& b) {
+	return a.size() == b.size() &&
+	       (a.empty() || std::memcmp(a.data(), b.data(), sizeof(T) * a.size()) == 0);
+}
+
+// 2つのモデルのCPU側のデータがバイト単位で一致するか確かめる
+void CheckSameModel(Model& a, Model& b) {
+	const std::vector<Mesh*>& meshesA = a.GetMeshes();
+	const std::vector<Mesh*>& meshesB = b.GetMeshes();
+	TEST_CHECK(meshesA.size() == kGroupCount);
+	TEST_CHECK(meshesA.size() == meshesB.size());
+	for (size_t i = 0; i < meshesA.size(); i++) {
+		Mesh& meshA = *meshesA[i];
+		Mesh& meshB = *meshesB[i];
+		TEST_CHECK(SameBytes(meshA.GetVertices(), meshB.GetVertices()));
+		TEST_CHECK(SameBytes(meshA.GetIndices(), meshB.GetIndices()));
+		TEST_CHECK(SameBytes(meshA.GetTangents(), meshB.GetTangents()));
+		TEST_CHECK(SameBytes(meshA.GetLods(), meshB.GetLods()));
+		TEST_CHECK(SameBytes(meshA.GetMeshlets().meshlets, meshB.GetMeshlets().meshlets));
+		TEST_CHECK(SameBytes(meshA.GetMeshlets().vertices, meshB.GetMeshlets().vertices));
+		TEST_CHECK(SameBytes(meshA.GetMeshlets().triangles, meshB.GetMeshlets().triangles));
+	}
+}
+
+} // namespace
+
+TEST_CASE(ModelLoaderAsyncMatchesSync) {
+	JobSystem::GetInstance()->Initialize(7);
+
+	const std::string objPath = kDirectoryPath + kModelName + ".obj";
+	const std::string cookedPath = kDirectoryPath + kModelName + CookedModel::kExtension;
+	CreateDirectoryA(kDirectoryPath.c_str(), nullptr);
+	WriteSphereObj(objPath);
+
+	Model::ImportSettings settings;
+	settings.smoothing = true;
+	settings.optimize = true;
+	settings.tangents = true;
+	settings.lodLevels = 2;
+	settings.meshlets = true;
+
+	// 呼び出したスレッドだけで読み込む（キャッシュなし）
+	std::remove(cookedPath.c_str());
+	Model* syncModel = new Model;
+	ModelImportAccess::Import(*syncModel, kModelName, settings, nullptr);
+	std::vector<char> syncCooked = ReadFileBytes(cookedPath);
+
+	// ワーカーで読み込む（キャッシュなし、メッシュの後処理はジョブに分かれる）
+	std::remove(cookedPath.c_str());
+	ModelLoader::Handle handle = ModelLoader::GetInstance()->LoadAsync(kModelName, settings);
+	Model* asyncModel = handle.GetImported();
+	std::vector<char> asyncCooked = ReadFileBytes(cookedPath);
+
+	// 書き出されたキャッシュと読み込み結果が一致する
+	TEST_CHECK(!syncCooked.empty());
+	TEST_CHECK(syncCooked == asyncCooked);
+	CheckSameModel(*syncModel, *asyncModel);
+
+	// キャッシュからの読み込みも同じ結果になる
+	Model* cookedModel = new Model;
+	ModelImportAccess::Import(*cookedModel, kModelName, settings, nullptr);
+	CheckSameModel(*syncModel, *cookedModel);
+
+	delete syncModel;
+	delete asyncModel;
+	delete cookedModel;
+	std::remove(cookedPath.c_str());
+	std::remove(objPath.c_str());
+	RemoveDirectoryA(kDirectoryPath.c_str());
+
+	ModelLoader::GetInstance()->Finalize();
+	JobSystem::GetInstance()->Finalize();
+}
@@ -0,0 +1,169 @@
+﻿// Model::LoadModelの頂点の溶接のテスト（頂点数・インデックス数、65535頂点を超えると32bitインデックス、メモリ量）
+#include "CookedModel.h"
+#include "Model.h"
+#include "ModelImportAccess.h"
+#include "TestUtil.h"
+#include <Windows.h>
+#include <chrono>
+#include <cstdio>
+#include <set>
+#include <string>
+#include <tuple>
+
+namespace {
+
+// グリッドのOBJとMTLを書き出す（xz平面、四角形の面、頂点ごとに1つのUVと共通の法線）
+// splitUv が true なら面ごとに別のUVを持たせる（座標が同じでも溶接してはいけない）
+void WriteGridObj(
+  const std::string& directoryPath, const std::string& name, uint32_t width, uint32_t height,
+  bool splitUv) {
+	std::FILE* file = std::fopen((directoryPath + name + ".mtl").c_str(), "w");
+	TEST_CHECK(file);
+	std::fprintf(file, "newmtl Material\nmap_Kd white1x1.png\n");
+	std::fclose(file);
+
+	file = std::fopen((directoryPath + name + ".obj").c_str(), "w");
+	TEST_CHECK(file);
+	std::fprintf(file, "mtllib %s.mtl\n", name.c_str());
+	for (uint32_t z = 0; z <= height; z++) {
+		for (uint32_t x = 0; x <= width; x++) {
+			std::fprintf(file, "v %u 0 %u\n", x, z);
+			if (!splitUv) {
+				std::fprintf(file, "vt %.9g %.9g\n", float(x) / width, float(z) / height);
+			}
+		}
+	}
+	if (splitUv) {
+		std::fprintf(file, "vt 0 0\nvt 1 0\nvt 1 1\nvt 0 1\n");
+	}
+	std::fprintf(file, "vn 0 1 0\nusemtl Material\ns off\n");
+
+	const uint32_t rowSize = width + 1;
+	for (uint32_t z = 0; z < height; z++) {
+		for (uint32_t x = 0; x < width; x++) {
+			uint32_t i0 = z * rowSize + x + 1;
+			uint32_t i1 = i0 + 1;
+			uint32_t i2 = i1 + rowSize;
+			uint32_t i3 = i0 + rowSize;
+			if (splitUv) {
+				std::fprintf(file, "f %u/1/1 %u/2/1 %u/3/1 %u/4/1\n", i0, i1, i2, i3);
+			} else {
+				std::fprintf(
+				  file, "f %u/%u/1 %u/%u/1 %u/%u/1 %u/%u/1\n", i0, i0, i1, i1, i2, i2, i3, i3);
+			}
+		}
+	}
+	std::fclose(file);
+}
+
+// 書き出したファイルを削除する
+void RemoveModelFiles(const std::string& directoryPath, const std::string& name) {
+	std::remove((directoryPath + name + CookedModel::kExtension).c_str());
+	std::remove((directoryPath + name + ".obj").c_str());
+	std::remove((directoryPath + name + ".mtl").c_str());
+	RemoveDirectoryA(directoryPath.c_str());
+}
+
+// 読み込んだグリッドのメッシュを確かめる
+struct WeldResult {
+	size_t vertexCount;
+	size_t indexCount;
+	DXGI_FORMAT indexFormat;
+};
+WeldResult CheckGrid(const char* name, uint32_t width, uint32_t height, bool splitUv) {
+	const std::string directoryPath = std::string("Resources/") + name + "/";
+	CreateDirectoryA(directoryPath.c_str(), nullptr);
+	WriteGridObj(directoryPath, name, width, height, splitUv);
+	// キャッシュがあればOBJを読まないので消しておく
+	std::remove((directoryPath + name + CookedModel::kExtension).c_str());
+
+	Model* model = new Model;
+	ModelImportAccess::Import(*model, name, Model::ImportSettings(), nullptr);
+	TEST_CHECK(model->GetMeshes().size() == 1);
+	Mesh& mesh = *model->GetMeshes()[0];
+	const std::vector<Mesh::VertexPosNormalUv>& vertices = mesh.GetVertices();
+	const std::vector<uint32_t>& indices = mesh.GetIndices();
+
+	// 四角形は2つの三角形になる
+	const size_t quadCount = size_t(width) * height;
+	TEST_CHECK(indices.size() == quadCount * 6);
+	// 溶接後は座標とUVの組み合わせごとに1頂点
+	size_t expectedVertexCount = splitUv ? quadCount * 4 : size_t(width + 1) * (height + 1);
+	TEST_CHECK(vertices.size() == expectedVertexCount);
+
+	// 同じ組み合わせの頂点は残らず、全てのインデックスは頂点を指す
+	std::set<std::tuple<float, float, float, float>> keys;
+	for (const Mesh::VertexPosNormalUv& vertex : vertices) {
+		TEST_CHECK(vertex.normal.y == 1.0f);
+		keys.insert(std::make_tuple(vertex.pos.x, vertex.pos.z, vertex.uv.x, vertex.uv.y));
+	}
+	TEST_CHECK(keys.size() == vertices.size());
+	for (uint32_t index : indices) {
+		TEST_CHECK(index < vertices.size());
+	}
+
+	// 三角形の角は面の角の座標を指す（四角形 i0,i1,i2,i3 は 0,1,2 と 2,3,0 になる）
+	for (size_t quad = 0; quad < quadCount; quad += quadCount / 97 + 1) {
+		float x = float(quad % width);
+		float z = float(quad / width);
+		const float cornerX[] = {x, x + 1, x + 1, x + 1, x, x};
+		const float cornerZ[] = {z, z, z + 1, z + 1, z + 1, z};
+		for (size_t c = 0; c < 6; c++) {
+			const Mesh::VertexPosNormalUv& vertex = vertices[indices[quad * 6 + c]];
+			TEST_CHECK(vertex.pos.x == cornerX[c] && vertex.pos.z == cornerZ[c]);
+		}
+	}
+
+	WeldResult result = {vertices.size(), indices.size(), mesh.GetIndexFormat()};
+	delete model;
+	RemoveModelFiles(directoryPath, name);
+	return result;
+}
+
+TEST_CASE(ModelWeldSharesCorners) {
+	// 隣り合う面の角は1つの頂点になる
+	WeldResult shared = CheckGrid("test_weld_shared", 16, 8, false);
+	TEST_CHECK(shared.vertexCount == 17 * 9);
+	TEST_CHECK(shared.indexFormat == DXGI_FORMAT_R16_UINT);
+
+	// UVが違えば同じ座標でも別の頂点
+	WeldResult split = CheckGrid("test_weld_split", 16, 8, true);
+	TEST_CHECK(split.vertexCount == 16 * 8 * 4);
+	TEST_CHECK(split.indexCount == shared.indexCount);
+}
+
+TEST_CASE(ModelWeldIndexFormat) {
+	// 65535頂点（255x257）までは16bit、65536頂点（256x256）から32bit
+	WeldResult limit16 = CheckGrid("test_weld_limit16", 254, 256, false);
+	TEST_CHECK(limit16.vertexCount == 0xffff);
+	TEST_CHECK(limit16.indexFormat == DXGI_FORMAT_R16_UINT);
+	WeldResult limit32 = CheckGrid("test_weld_limit32", 255, 255, false);
+	TEST_CHECK(limit32.vertexCount == 0x10000);
+	TEST_CHECK(limit32.indexFormat == DXGI_FORMAT_R32_UINT);
+}
+
+TEST_CASE(ModelWeldLargeMeshFootprint) {
+	// 512x512の四角形（263169頂点）
+	const uint32_t kSize = 512;
+	auto start = std::chrono::steady_clock::now();
+	WeldResult result = CheckGrid("test_weld_large", kSize, kSize, false);
+	std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+	TEST_CHECK(result.indexFormat == DXGI_FORMAT_R32_UINT);
+
+	// 溶接しなければ面の角ごとに1頂点（インデックスは三角形の角ごと）
+	const size_t cornerCount = size_t(kSize) * kSize * 4;
+	size_t indexStride = result.indexFormat == DXGI_FORMAT_R16_UINT ? 2 : 4;
+	size_t weldedBytes =
+	  result.vertexCount * sizeof(Mesh::VertexPosNormalUv) + result.indexCount * indexStride;
+	size_t unweldedBytes =
+	  cornerCount * sizeof(Mesh::VertexPosNormalUv) + result.indexCount * sizeof(uint32_t);
+	TEST_CHECK(result.vertexCount * 3 < cornerCount);
+	TEST_CHECK(weldedBytes * 2 < unweldedBytes);
+	std::printf(
+	  "  %ux%u grid: %zu vertices (%zu corners), %zu indices, %.1f MB welded vs %.1f MB per "
+	  "corner, load %.1f ms\n",
+	  kSize, kSize, result.vertexCount, cornerCount, result.indexCount,
+	  weldedBytes / (1024.0 * 1024.0), unweldedBytes / (1024.0 * 1024.0), elapsed.count());
+}
+
+} // namespace
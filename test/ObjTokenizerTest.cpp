@@ -0,0 +1,342 @@
+﻿// ObjTokenizerのテストとベンチマーク（実数・整数・面頂点の解析、合成したOBJテキストの解析速度）
+#include "ObjTokenizer.h"
+#include "TestUtil.h"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+// 文字列全体を実数として解析する
+bool ParseFloat(const char* text, float& value, size_t& consumed) {
+	const char* cursor = text;
+	bool result = ObjTokenizer::ParseFloat(cursor, text + std::strlen(text), value);
+	consumed = static_cast<size_t>(cursor - text);
+	return result;
+}
+
+// 文字列全体を整数として解析する
+bool ParseInt(const char* text, int32_t& value, size_t& consumed) {
+	const char* cursor = text;
+	bool result = ObjTokenizer::ParseInt(cursor, text + std::strlen(text), value);
+	consumed = static_cast<size_t>(cursor - text);
+	return result;
+}
+
+// 1行の面頂点を全て読む
+std::vector<ObjTokenizer::FaceVertex> ReadFace(const std::string& line) {
+	ObjTokenizer tokenizer(line.data(), line.data() + line.size());
+	TEST_CHECK(tokenizer.NextLine());
+	TEST_CHECK(tokenizer.ReadToken() == "f");
+	std::vector<ObjTokenizer::FaceVertex> result;
+	ObjTokenizer::FaceVertex faceVertex;
+	while (tokenizer.ReadFaceVertex(faceVertex)) {
+		result.push_back(faceVertex);
+	}
+	return result;
+}
+
+// 面頂点の比較
+bool Equals(const ObjTokenizer::FaceVertex& v, int32_t position, int32_t texcoord, int32_t normal) {
+	return v.position == position && v.texcoord == texcoord && v.normal == normal;
+}
+
+// floatの表現で何ULP離れているか
+uint32_t UlpDistance(float a, float b) {
+	int32_t ia;
+	int32_t ib;
+	std::memcpy(&ia, &a, sizeof(ia));
+	std::memcpy(&ib, &b, sizeof(ib));
+	ia = ia < 0 ? INT32_MIN - ia : ia;
+	ib = ib < 0 ? INT32_MIN - ib : ib;
+	return static_cast<uint32_t>(ia > ib ? int64_t(ia) - ib : int64_t(ib) - ia);
+}
+
+TEST_CASE(ObjTokenizerParseFloat) {
+	struct Case {
+		const char* text;
+		float expected;
+		size_t consumed;
+	};
+	const Case cases[] = {
+	  {"0", 0.0f, 1},
+	  {"1.5", 1.5f, 3},
+	  {"-2.25", -2.25f, 5},
+	  {"+3.0", 3.0f, 4},
+	  {".5", 0.5f, 2},
+	  {"-.125", -0.125f, 5},
+	  {"7.", 7.0f, 2},
+	  {"1e3", 1000.0f, 3},
+	  {"1E3", 1000.0f, 3},
+	  {"2.5e-3", 0.0025f, 6},
+	  {"-4.0E+2", -400.0f, 7},
+	  {"0.000001", 1e-6f, 8},
+	  {"000123.4500", 123.45f, 11},
+	  {"3.4028234e38", 3.4028234e38f, 12},
+	  {"1.17549435e-38", 1.17549435e-38f, 14},
+	  // 19桁を超える仮数は指数に回す
+	  {"12345678901234567890123", 1.2345678901234567890123e22f, 23},
+	  {"0.12345678901234567890123", 0.12345678901234567890123f, 25},
+	  // 数字以外で止まる（指数に数字がなければ指数として読まない）
+	  {"1.5/2", 1.5f, 3},
+	  {"2e", 2.0f, 1},
+	  {"2e+", 2.0f, 1},
+	  {"-0.75 1", -0.75f, 5},
+	};
+	for (const Case& c : cases) {
+		float value = 0.0f;
+		size_t consumed = 0;
+		TEST_CHECK(ParseFloat(c.text, value, consumed));
+		TEST_CHECK(UlpDistance(value, c.expected) <= 1);
+		TEST_CHECK(consumed == c.consumed);
+	}
+	// 負のゼロ
+	float value = 1.0f;
+	size_t consumed = 0;
+	TEST_CHECK(ParseFloat("-0.0", value, consumed));
+	TEST_CHECK(value == 0.0f && std::signbit(value));
+
+	// 数字がなければ失敗し、位置は進まない
+	const char* failures[] = {"", "-", "+", ".", "-.", "e5", "abc", "/1"};
+	for (const char* text : failures) {
+		value = 42.0f;
+		TEST_CHECK(!ParseFloat(text, value, consumed));
+		TEST_CHECK(consumed == 0);
+		TEST_CHECK(value == 42.0f);
+	}
+
+	// 書き出し形式の違う乱数を標準ライブラリの結果と比べる
+	uint32_t seed = 7;
+	const char* formats[] = {"%.6f", "%.9g", "%e", "%.3e", "%.12f"};
+	for (int i = 0; i < 20000; i++) {
+		seed = seed * 1664525u + 1013904223u;
+		double magnitude = std::pow(10.0, int(seed >> 24) % 16 - 8);
+		seed = seed * 1664525u + 1013904223u;
+		double number = (double(seed >> 8) / double(1u << 24) - 0.5) * magnitude;
+		char text[64];
+		std::snprintf(text, sizeof(text), formats[i % 5], number);
+		TEST_CHECK(ParseFloat(text, value, consumed));
+		TEST_CHECK(consumed == std::strlen(text));
+		TEST_CHECK(UlpDistance(value, std::strtof(text, nullptr)) <= 1);
+	}
+}
+
+TEST_CASE(ObjTokenizerParseInt) {
+	int32_t value = 0;
+	size_t consumed = 0;
+	TEST_CHECK(ParseInt("42", value, consumed) && value == 42 && consumed == 2);
+	TEST_CHECK(ParseInt("+7", value, consumed) && value == 7 && consumed == 2);
+	TEST_CHECK(ParseInt("-3/", value, consumed) && value == -3 && consumed == 2);
+	TEST_CHECK(ParseInt("0012", value, consumed) && value == 12 && consumed == 4);
+	TEST_CHECK(ParseInt("2147483647", value, consumed) && value == INT32_MAX);
+	// 範囲外は飽和させ、数字は全て読み飛ばす
+	TEST_CHECK(ParseInt("99999999999", value, consumed) && value == INT32_MAX);
+	TEST_CHECK(consumed == 11);
+	TEST_CHECK(ParseInt("-99999999999", value, consumed) && value == -INT32_MAX);
+	// 小数点で止まる
+	TEST_CHECK(ParseInt("5.5", value, consumed) && value == 5 && consumed == 1);
+
+	const char* failures[] = {"", "-", "+", "/", "x1", "-/1"};
+	for (const char* text : failures) {
+		value = 42;
+		TEST_CHECK(!ParseInt(text, value, consumed));
+		TEST_CHECK(consumed == 0);
+		TEST_CHECK(value == 42);
+	}
+}
+
+TEST_CASE(ObjTokenizerFaceVertices) {
+	// v, v/vt, v//vn, v/vt/vn
+	std::vector<ObjTokenizer::FaceVertex> face = ReadFace("f 1 2/3 4//5 6/7/8");
+	TEST_CHECK(face.size() == 4);
+	TEST_CHECK(Equals(face[0], 1, 0, 0));
+	TEST_CHECK(Equals(face[1], 2, 3, 0));
+	TEST_CHECK(Equals(face[2], 4, 0, 5));
+	TEST_CHECK(Equals(face[3], 6, 7, 8));
+
+	// 負の番号（直前からの相対番号）は符号付きのまま返す（解決はModelが行う）
+	face = ReadFace("f -4/-4/-4 -3//-1 -2/-1");
+	TEST_CHECK(face.size() == 3);
+	TEST_CHECK(Equals(face[0], -4, -4, -4));
+	TEST_CHECK(Equals(face[1], -3, 0, -1));
+	TEST_CHECK(Equals(face[2], -2, -1, 0));
+
+	// タブ区切り、CRLF、行末の空白
+	face = ReadFace("f\t1/1/1  2/2/2\t3/3/3 \r\n");
+	TEST_CHECK(face.size() == 3);
+	TEST_CHECK(Equals(face[2], 3, 3, 3));
+
+	// 解析できない残りは次の区切りまで飛ばす
+	face = ReadFace("f 1/2/3x 4/ 5/6/");
+	TEST_CHECK(face.size() == 3);
+	TEST_CHECK(Equals(face[0], 1, 2, 3));
+	TEST_CHECK(Equals(face[1], 4, 0, 0));
+	TEST_CHECK(Equals(face[2], 5, 6, 0));
+
+	// 行をまたがない・BOMと空行
+	const std::string text = "\xEF\xBB\xBFv 1 2 3\n\nf 1 2 3\nv 4";
+	ObjTokenizer tokenizer(text.data(), text.data() + text.size());
+	TEST_CHECK(tokenizer.NextLine());
+	TEST_CHECK(tokenizer.ReadToken() == "v");
+	float x;
+	float y;
+	float z;
+	float w;
+	TEST_CHECK(tokenizer.ReadFloat(x) && tokenizer.ReadFloat(y) && tokenizer.ReadFloat(z));
+	TEST_CHECK(x == 1.0f && y == 2.0f && z == 3.0f);
+	TEST_CHECK(!tokenizer.ReadFloat(w));
+	TEST_CHECK(tokenizer.NextLine());
+	TEST_CHECK(tokenizer.ReadToken().Empty());
+	TEST_CHECK(tokenizer.NextLine());
+	TEST_CHECK(tokenizer.ReadToken() == "f");
+	TEST_CHECK(tokenizer.NextLine());
+	TEST_CHECK(tokenizer.ReadToken() == "v");
+	TEST_CHECK(tokenizer.ReadFloat(x) && x == 4.0f);
+	TEST_CHECK(!tokenizer.NextLine());
+}
+
+// 合成したOBJテキスト（グリッドの頂点・UV・法線と四角形の面）
+std::string CreateObjText(uint32_t size) {
+	std::string text = "# synthetic\nmtllib test.mtl\no grid\n";
+	char line[128];
+	for (uint32_t z = 0; z <= size; z++) {
+		for (uint32_t x = 0; x <= size; x++) {
+			std::snprintf(
+			  line, sizeof(line), "v %f %f %f\n", x * 0.01f - 1.0f, std::sin(x * 0.1f) * 0.25f,
+			  z * 0.01f - 1.0f);
+			text += line;
+		}
+	}
+	for (uint32_t z = 0; z <= size; z++) {
+		for (uint32_t x = 0; x <= size; x++) {
+			std::snprintf(line, sizeof(line), "vt %f %f\n", float(x) / size, float(z) / size);
+			text += line;
+		}
+	}
+	for (uint32_t z = 0; z <= size; z++) {
+		for (uint32_t x = 0; x <= size; x++) {
+			std::snprintf(line, sizeof(line), "vn %.4f %.4f %.4f\n", 0.0f, 1.0f, 0.0f);
+			text += line;
+		}
+	}
+	text += "usemtl Material\ns off\n";
+	for (uint32_t z = 0; z < size; z++) {
+		for (uint32_t x = 0; x < size; x++) {
+			uint32_t i0 = z * (size + 1) + x + 1;
+			uint32_t i1 = i0 + 1;
+			uint32_t i2 = i1 + size + 1;
+			uint32_t i3 = i0 + size + 1;
+			std::snprintf(
+			  line, sizeof(line), "f %u/%u/%u %u/%u/%u %u/%u/%u %u/%u/%u\n", i0, i0, i0, i1, i1, i1,
+			  i2, i2, i2, i3, i3, i3);
+			text += line;
+		}
+	}
+	return text;
+}
+
+// 解析結果の集計（両方の解析方法で一致することを確かめる）
+struct ParseSummary {
+	uint64_t floatCount = 0;
+	uint64_t faceVertexCount = 0;
+	double floatSum = 0.0;
+	int64_t indexSum = 0;
+};
+
+// Model::LoadModelと同じ手順でObjTokenizerで解析する
+ParseSummary ParseWithTokenizer(const std::string& text) {
+	ParseSummary summary;
+	ObjTokenizer tokenizer(text.data(), text.data() + text.size());
+	while (tokenizer.NextLine()) {
+		ObjTokenizer::Token key = tokenizer.ReadToken();
+		if (key == "v" || key == "vt" || key == "vn") {
+			float value;
+			while (tokenizer.ReadFloat(value)) {
+				summary.floatCount++;
+				summary.floatSum += value;
+			}
+		} else if (key == "f") {
+			ObjTokenizer::FaceVertex faceVertex;
+			while (tokenizer.ReadFaceVertex(faceVertex)) {
+				summary.faceVertexCount++;
+				summary.indexSum += faceVertex.position + faceVertex.texcoord + faceVertex.normal;
+			}
+		}
+	}
+	return summary;
+}
+
+// 以前のModel::LoadModelと同じく1行ごとにistringstreamで解析する
+ParseSummary ParseWithStream(const std::string& text) {
+	ParseSummary summary;
+	std::istringstream file(text);
+	std::string line;
+	while (std::getline(file, line)) {
+		std::istringstream lineStream(line);
+		std::string key;
+		std::getline(lineStream, key, ' ');
+		if (key == "v" || key == "vt" || key == "vn") {
+			float value;
+			while (lineStream >> value) {
+				summary.floatCount++;
+				summary.floatSum += value;
+			}
+		} else if (key == "f") {
+			std::string indexString;
+			while (std::getline(lineStream, indexString, ' ')) {
+				std::istringstream indexStream(indexString);
+				int32_t index[3] = {};
+				for (int k = 0; k < 3; k++) {
+					indexStream >> index[k];
+					indexStream.seekg(1, std::ios_base::cur);
+				}
+				summary.faceVertexCount++;
+				summary.indexSum += index[0] + index[1] + index[2];
+			}
+		}
+	}
+	return summary;
+}
+
+TEST_CASE(ObjTokenizerBenchmark) {
+	// 約20MBのOBJテキスト
+	const int kRepeatCount = 3;
+	std::string text = CreateObjText(400);
+	double megabytes = double(text.size()) / (1024.0 * 1024.0);
+
+	ParseSummary tokenizerSummary;
+	ParseSummary streamSummary;
+	double tokenizerBest = INFINITY;
+	double streamBest = INFINITY;
+	for (int i = 0; i < kRepeatCount; i++) {
+		auto start = std::chrono::steady_clock::now();
+		tokenizerSummary = ParseWithTokenizer(text);
+		std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+		tokenizerBest = (std::min)(tokenizerBest, elapsed.count());
+
+		start = std::chrono::steady_clock::now();
+		streamSummary = ParseWithStream(text);
+		elapsed = std::chrono::steady_clock::now() - start;
+		streamBest = (std::min)(streamBest, elapsed.count());
+	}
+
+	// どちらも同じ値を読む
+	TEST_CHECK(tokenizerSummary.floatCount == streamSummary.floatCount);
+	TEST_CHECK(tokenizerSummary.faceVertexCount == streamSummary.faceVertexCount);
+	TEST_CHECK(tokenizerSummary.indexSum == streamSummary.indexSum);
+	TEST_CHECK(
+	  std::fabs(tokenizerSummary.floatSum - streamSummary.floatSum) <=
+	  1e-6 * double(tokenizerSummary.floatCount));
+	TEST_CHECK(tokenizerSummary.faceVertexCount == 400u * 400u * 4u);
+
+	std::printf(
+	  "  %.1f MB: ObjTokenizer %.1f MB/s, istringstream per line %.1f MB/s\n", megabytes,
+	  megabytes / tokenizerBest, megabytes / streamBest);
+}
+
+} // namespace
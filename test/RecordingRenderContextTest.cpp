@@ -0,0 +1,96 @@
+﻿// RecordingRenderContextのテスト（記録した命令列を別の発行先で再生すると同じ命令列になる）
+#include "RecordingRenderContext.h"
+#include "TestUtil.h"
+#include <cstdint>
+
+namespace {
+
+// テスト用のポインタ（指す先には触れないので実体はいらない）
+template<class T> T* FakePointer(uintptr_t value) { return reinterpret_cast<T*>(value); }
+
+// 再生された命令のポインタが元のものに戻っているか確かめる発行先
+class PointerCheckContext : public RecordingRenderContext {
+  public:
+	void SetPipelineState(ID3D12PipelineState* pipelineState) override {
+		lastPipelineState = pipelineState;
+		RecordingRenderContext::SetPipelineState(pipelineState);
+	}
+	void SetDescriptorHeaps(UINT count, ID3D12DescriptorHeap* const* heaps) override {
+		lastHeap = count > 0 ? heaps[0] : nullptr;
+		RecordingRenderContext::SetDescriptorHeaps(count, heaps);
+	}
+
+	ID3D12PipelineState* lastPipelineState = nullptr;
+	ID3D12DescriptorHeap* lastHeap = nullptr;
+};
+
+// モデルとスプライトの描画に近い命令列を記録する
+void RecordFrame(RenderContext& context) {
+	ID3D12RootSignature* rootSignature = FakePointer<ID3D12RootSignature>(0x1000);
+	ID3D12PipelineState* opaque = FakePointer<ID3D12PipelineState>(0x2000);
+	ID3D12PipelineState* blended = FakePointer<ID3D12PipelineState>(0x3000);
+	ID3D12DescriptorHeap* heap = FakePointer<ID3D12DescriptorHeap>(0x4000);
+
+	context.SetGraphicsRootSignature(rootSignature);
+	context.SetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+	context.SetDescriptorHeaps(1, &heap);
+	for (uint32_t i = 0; i < 8; i++) {
+		context.SetPipelineState(i < 6 ? opaque : blended);
+		context.RecordUpload(0x10000 + i * 256, nullptr, 256);
+		context.SetGraphicsRootConstantBufferView(0, 0x10000 + i * 256);
+		D3D12_GPU_DESCRIPTOR_HANDLE descriptor;
+		descriptor.ptr = 0x80000 + (i % 3) * 32;
+		context.SetGraphicsRootDescriptorTable(1, descriptor);
+		D3D12_VERTEX_BUFFER_VIEW vbView;
+		vbView.BufferLocation = 0x100000 + i * 0x1000;
+		vbView.SizeInBytes = 0x1000;
+		vbView.StrideInBytes = 32;
+		context.SetVertexBuffers(0, 1, &vbView);
+		D3D12_INDEX_BUFFER_VIEW ibView;
+		ibView.BufferLocation = 0x200000 + i * 0x400;
+		ibView.SizeInBytes = 0x400;
+		ibView.Format = DXGI_FORMAT_R16_UINT;
+		context.SetIndexBuffer(&ibView);
+		context.DrawIndexedInstanced(36, 1 + i, 0, -int(i), 0);
+	}
+	context.SetIndexBuffer(nullptr);
+	context.DrawInstanced(4, 1, 0, 0);
+}
+
+} // namespace
+
+TEST_CASE(RecordingRenderContextReplay) {
+	RecordingRenderContext recorded;
+	RecordFrame(recorded);
+
+	// 再生した命令列は記録したものと1命令ずつ一致する
+	RecordingRenderContext replayed;
+	recorded.Replay(replayed);
+	TEST_CHECK(replayed.GetCommands().size() == recorded.GetCommands().size());
+	TEST_CHECK(replayed.ToString() == recorded.ToString());
+	TEST_CHECK(replayed.GetDrawCount() == 9);
+	TEST_CHECK(replayed.GetUploadedBytes() == recorded.GetUploadedBytes());
+
+	// 再生を重ねても変わらない
+	RecordingRenderContext replayedTwice;
+	replayed.Replay(replayedTwice);
+	TEST_CHECK(replayedTwice.ToString() == recorded.ToString());
+}
+
+TEST_CASE(RecordingRenderContextReplayRestoresPointers) {
+	RecordingRenderContext recorded;
+	RecordFrame(recorded);
+
+	// 番号にして記録したポインタは再生時に元のポインタに戻る
+	PointerCheckContext target;
+	recorded.Replay(target);
+	TEST_CHECK(target.lastPipelineState == FakePointer<ID3D12PipelineState>(0x3000));
+	TEST_CHECK(target.lastHeap == FakePointer<ID3D12DescriptorHeap>(0x4000));
+
+	// Clearの後は番号を振り直す
+	recorded.Clear();
+	TEST_CHECK(recorded.GetCommands().empty());
+	recorded.SetPipelineState(FakePointer<ID3D12PipelineState>(0x5000));
+	recorded.Replay(target);
+	TEST_CHECK(target.lastPipelineState == FakePointer<ID3D12PipelineState>(0x5000));
+}
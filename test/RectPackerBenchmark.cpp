@@ -0,0 +1,137 @@
+﻿// RectPackerのテストとベンチマーク（詰め込み効率と時間）
+#include "RectPacker.h"
+#include "TestUtil.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+namespace {
+
+// 乱数（線形合同法、実行ごとに同じ列にする）
+uint32_t NextRandom(uint32_t& seed) {
+	seed = seed * 1664525u + 1013904223u;
+	return seed >> 8;
+}
+
+// 2つの矩形が重なっているか
+bool Overlaps(const RectPacker::Rect& a, const RectPacker::Rect& b) {
+	return a.x < b.x + b.width && b.x < a.x + a.width && a.y < b.y + b.height &&
+	       b.y < a.y + a.height;
+}
+
+// 大きさ
+struct Size {
+	uint32_t width;
+	uint32_t height;
+};
+
+// 1ページに詰めて、置いた矩形が範囲内で重ならないことを確かめる
+// 戻り値は置けた数
+size_t PackPage(RectPacker& packer, const std::vector<Size>& sizes) {
+	std::vector<RectPacker::Rect> placed;
+	for (const Size& size : sizes) {
+		RectPacker::Rect rect;
+		if (!packer.Insert(size.width, size.height, rect)) {
+			continue;
+		}
+		TEST_CHECK(rect.width == size.width && rect.height == size.height);
+		TEST_CHECK(rect.x + rect.width <= packer.GetWidth());
+		TEST_CHECK(rect.y + rect.height <= packer.GetHeight());
+		for (const RectPacker::Rect& other : placed) {
+			TEST_CHECK(!Overlaps(rect, other));
+		}
+		placed.push_back(rect);
+	}
+	return placed.size();
+}
+
+// TextureAtlas::Buildと同じく長い辺の大きい順に並べる
+void SortForPacking(std::vector<Size>& sizes) {
+	std::stable_sort(sizes.begin(), sizes.end(), [](const Size& a, const Size& b) {
+		uint32_t longA = (std::max)(a.width, a.height);
+		uint32_t longB = (std::max)(b.width, b.height);
+		if (longA != longB) {
+			return longA > longB;
+		}
+		return a.width * a.height > b.width * b.height;
+	});
+}
+
+} // namespace
+
+TEST_CASE(RectPackerExactFit) {
+	// 隙間なく埋まる組み合わせは使用率100%になる
+	RectPacker packer;
+	packer.Initialize(256, 256);
+	std::vector<Size> sizes(16, Size{64, 64});
+	TEST_CHECK(PackPage(packer, sizes) == 16);
+	TEST_CHECK(packer.GetOccupancy() == 1.0f);
+
+	RectPacker::Rect rect;
+	TEST_CHECK(!packer.Insert(1, 1, rect));
+}
+
+TEST_CASE(RectPackerEfficiency) {
+	const uint32_t kPageSize = 2048;
+	const uint32_t kPadding = 2;
+	// 様々な大きさのスプライト（8〜256画素）の組
+	const uint32_t kSpriteCounts[] = {256, 1024, 4096};
+
+	for (uint32_t spriteCount : kSpriteCounts) {
+		uint32_t seed = spriteCount;
+		std::vector<Size> sizes(spriteCount);
+		for (Size& size : sizes) {
+			size.width = 8 + NextRandom(seed) % 249 + kPadding * 2;
+			size.height = 8 + NextRandom(seed) % 249 + kPadding * 2;
+		}
+		SortForPacking(sizes);
+
+		// 入らなかった分は次のページに詰める
+		auto start = std::chrono::steady_clock::now();
+		std::vector<float> occupancies;
+		std::vector<Size> remaining = sizes;
+		while (!remaining.empty()) {
+			RectPacker packer;
+			packer.Initialize(kPageSize, kPageSize);
+			std::vector<Size> next;
+			for (const Size& size : remaining) {
+				RectPacker::Rect rect;
+				if (!packer.Insert(size.width, size.height, rect)) {
+					next.push_back(size);
+				}
+			}
+			TEST_CHECK(next.size() < remaining.size());
+			occupancies.push_back(packer.GetOccupancy());
+			remaining.swap(next);
+		}
+		std::chrono::duration<double, std::milli> elapsed =
+		  std::chrono::steady_clock::now() - start;
+
+		// 最後のページ以外はほぼ埋まる
+		float fullPageOccupancy = 1.0f;
+		for (size_t page = 0; page + 1 < occupancies.size(); page++) {
+			fullPageOccupancy = (std::min)(fullPageOccupancy, occupancies[page]);
+		}
+		TEST_CHECK(fullPageOccupancy >= 0.85f);
+
+		std::printf(
+		  "  %u sprites: %zu pages, min full page occupancy %.1f%%, last page %.1f%%, %.2f ms\n",
+		  spriteCount, occupancies.size(), fullPageOccupancy * 100.0f,
+		  occupancies.back() * 100.0f, elapsed.count());
+	}
+}
+
+TEST_CASE(RectPackerNoOverlap) {
+	// 小さいページに詰めきれないほど積んでも、置いた矩形は範囲内で重ならない
+	uint32_t seed = 7;
+	std::vector<Size> sizes(512);
+	for (Size& size : sizes) {
+		size.width = 1 + NextRandom(seed) % 96;
+		size.height = 1 + NextRandom(seed) % 96;
+	}
+	RectPacker packer;
+	packer.Initialize(512, 512);
+	size_t placedCount = PackPage(packer, sizes);
+	TEST_CHECK(placedCount > 0 && placedCount < sizes.size());
+}
@@ -0,0 +1,52 @@
+﻿// RenderQueueの並べ替えキーのテスト（不透明は状態順、アルファブレンドは奥から手前）
+#include "RenderQueue.h"
+#include "TestUtil.h"
+#include <vector>
+
+namespace {
+
+// キーで並べ替えた後の、元の番号の並び
+std::vector<uint32_t> SortedOrder(const std::vector<uint64_t>& keys) {
+	std::vector<RenderQueue::SortEntry> entries;
+	for (uint32_t i = 0; i < keys.size(); i++) {
+		entries.push_back({keys[i], i});
+	}
+	std::vector<RenderQueue::SortEntry> temp;
+	RenderQueue::RadixSort(entries, temp);
+
+	std::vector<uint32_t> order;
+	for (const RenderQueue::SortEntry& entry : entries) {
+		order.push_back(entry.index);
+	}
+	return order;
+}
+
+} // namespace
+
+TEST_CASE(RenderQueueOpaqueByState) {
+	// 不透明は状態でまとめ、同じ状態の中は手前から
+	std::vector<uint64_t> keys = {
+	  RenderQueue::MakeSortKey(1, 0, 0, 0.1f), RenderQueue::MakeSortKey(0, 2, 0, 0.9f),
+	  RenderQueue::MakeSortKey(0, 1, 0, 0.5f), RenderQueue::MakeSortKey(0, 1, 0, 0.2f)};
+	std::vector<uint32_t> expected = {3, 2, 1, 0};
+	TEST_CHECK(SortedOrder(keys) == expected);
+}
+
+TEST_CASE(RenderQueueBlendedBackToFront) {
+	// アルファブレンドは不透明の後に、状態に関係なく奥から手前へ
+	std::vector<uint64_t> keys = {
+	  RenderQueue::MakeSortKey(0, 0, 0, 0.2f, true), RenderQueue::MakeSortKey(3, 5, 7, 0.9f),
+	  RenderQueue::MakeSortKey(1, 9, 2, 0.8f, true), RenderQueue::MakeSortKey(0, 0, 0, 0.5f, true),
+	  RenderQueue::MakeSortKey(0, 0, 0, 0.0f)};
+	std::vector<uint32_t> expected = {4, 1, 2, 3, 0};
+	TEST_CHECK(SortedOrder(keys) == expected);
+}
+
+TEST_CASE(RenderQueueBlendedSameDepthByState) {
+	// 同じ深度のアルファブレンドは状態でまとめ、同じキーは積んだ順
+	std::vector<uint64_t> keys = {
+	  RenderQueue::MakeSortKey(1, 0, 0, 0.5f, true), RenderQueue::MakeSortKey(0, 0, 0, 0.5f, true),
+	  RenderQueue::MakeSortKey(1, 0, 0, 0.5f, true)};
+	std::vector<uint32_t> expected = {1, 0, 2};
+	TEST_CHECK(SortedOrder(keys) == expected);
+}
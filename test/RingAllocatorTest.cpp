@@ -0,0 +1,132 @@
+﻿// RingAllocatorのテスト（アライメント、折り返し、フレーム単位の解放）
+#include "RingAllocator.h"
+#include "TestUtil.h"
+#include <vector>
+
+namespace {
+
+// 確保した領域
+struct Range {
+	uint64_t offset;
+	uint64_t size;
+};
+
+// 2つの領域が重なっているか
+bool Overlaps(const Range& a, const Range& b) {
+	return a.offset < b.offset + b.size && b.offset < a.offset + a.size;
+}
+
+TEST_CASE(RingAllocatorAlignment) {
+	RingAllocator ring;
+	ring.Initialize(4096);
+
+	TEST_CHECK(ring.Allocate(1, 256) == 0);
+	TEST_CHECK(ring.Allocate(10, 256) == 256);
+	TEST_CHECK(ring.Allocate(1, 1) == 266);
+	// アライメントで飛ばした分も使用中に数える
+	TEST_CHECK(ring.Allocate(16, 64) == 320);
+	TEST_CHECK(ring.GetUsedSize() == 336);
+}
+
+TEST_CASE(RingAllocatorWrapAround) {
+	RingAllocator ring;
+	ring.Initialize(1024);
+
+	// フレーム1: [0, 512)
+	TEST_CHECK(ring.Allocate(512, 256) == 0);
+	ring.FinishFrame(1);
+	// フレーム2: [512, 896)
+	TEST_CHECK(ring.Allocate(384, 256) == 512);
+	ring.FinishFrame(2);
+
+	// フレーム1が終わっていないので入らない
+	TEST_CHECK(ring.Allocate(256, 256) == RingAllocator::kInvalidOffset);
+
+	// フレーム1が終わると先頭へ折り返す（末尾の128バイトは捨てる）
+	ring.Reclaim(1);
+	TEST_CHECK(ring.Allocate(256, 256) == 0);
+	TEST_CHECK(ring.GetUsedSize() == 384 + 128 + 256);
+	// 使用中の先頭を超えては確保しない
+	TEST_CHECK(ring.Allocate(512, 256) == RingAllocator::kInvalidOffset);
+	ring.FinishFrame(3);
+
+	// 全て終わると空になる
+	ring.Reclaim(3);
+	TEST_CHECK(ring.GetUsedSize() == 0);
+	TEST_CHECK(ring.GetPendingFrameCount() == 0);
+	TEST_CHECK(ring.Allocate(1024, 256) == 0);
+}
+
+TEST_CASE(RingAllocatorEmptyFrame) {
+	RingAllocator ring;
+	ring.Initialize(1024);
+
+	TEST_CHECK(ring.Allocate(256, 256) == 0);
+	ring.FinishFrame(1);
+	// 何も確保しないフレーム
+	ring.FinishFrame(2);
+	ring.Reclaim(1);
+	TEST_CHECK(ring.Allocate(256, 256) == 0);
+	ring.FinishFrame(3);
+	// 空のフレームの古い末尾で先頭を戻さない
+	ring.Reclaim(2);
+	TEST_CHECK(ring.GetUsedSize() == 256);
+	TEST_CHECK(ring.Allocate(768, 256) == 256);
+}
+
+// 2フレームを同時に処理しながら確保と解放を繰り返し、使用中の領域が重ならないことを確かめる
+TEST_CASE(RingAllocatorStress) {
+	const uint64_t capacity = 64 * 1024;
+	const uint32_t framesInFlight = 2;
+
+	RingAllocator ring;
+	ring.Initialize(capacity);
+
+	std::vector<std::vector<Range>> frames;
+	uint32_t seed = 12345;
+	auto random = [&seed]() {
+		seed = seed * 1664525u + 1013904223u;
+		return seed >> 8;
+	};
+
+	uint64_t allocationCount = 0;
+	for (uint64_t frame = 1; frame <= 10000; frame++) {
+		std::vector<Range> ranges;
+		uint32_t count = random() % 32;
+		for (uint32_t i = 0; i < count; i++) {
+			uint64_t size = 1 + random() % 2048;
+			uint64_t alignment = uint64_t(1) << (random() % 9);
+			uint64_t offset = ring.Allocate(size, alignment);
+			if (offset == RingAllocator::kInvalidOffset) {
+				continue;
+			}
+			TEST_CHECK(offset % alignment == 0);
+			TEST_CHECK(offset + size <= capacity);
+			Range range = {offset, size};
+			for (const std::vector<Range>& pending : frames) {
+				for (const Range& other : pending) {
+					TEST_CHECK(!Overlaps(range, other));
+				}
+			}
+			for (const Range& other : ranges) {
+				TEST_CHECK(!Overlaps(range, other));
+			}
+			ranges.push_back(range);
+			allocationCount++;
+		}
+		ring.FinishFrame(frame);
+		frames.push_back(ranges);
+
+		// GPUは同時に処理するフレーム数だけ遅れて終わる
+		if (frames.size() > framesInFlight) {
+			ring.Reclaim(frame - framesInFlight);
+			frames.erase(frames.begin());
+		}
+		TEST_CHECK(ring.GetUsedSize() <= capacity);
+	}
+	ring.Reclaim(UINT64_MAX);
+	TEST_CHECK(ring.GetUsedSize() == 0);
+	TEST_CHECK(allocationCount > 0);
+}
+
+} // namespace
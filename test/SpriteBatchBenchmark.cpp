@@ -0,0 +1,102 @@
+﻿// SpriteBatchの10万スプライトのベンチマーク（描画命令はRecordingRenderContextに記録する）
+#include "ConstantBufferAllocator.h"
+#include "RecordingRenderContext.h"
+#include "SpriteBatch.h"
+#include "TestGraphics.h"
+#include "TestUtil.h"
+#include "TextureManager.h"
+#include <chrono>
+#include <cstdio>
+
+namespace {
+
+// 描画命令が、設定された頂点バッファの範囲だけを読むことを確かめる
+// 戻り値は描いた矩形数
+uint32_t CheckDrawRanges(const RecordingRenderContext& context) {
+	using CommandType = RecordingRenderContext::CommandType;
+
+	uint64_t vertexBufferSize = 0;
+	uint64_t vertexStride = 0;
+	uint32_t quadCount = 0;
+	for (const RecordingRenderContext::Command& command : context.GetCommands()) {
+		if (command.type == CommandType::kSetVertexBuffers) {
+			vertexBufferSize = command.args[3];
+			vertexStride = command.args[4];
+		} else if (command.type == CommandType::kDrawIndexed) {
+			uint64_t indexCount = command.args[0];
+			int64_t baseVertex = static_cast<int64_t>(command.args[3]);
+			TEST_CHECK(indexCount % 6 == 0);
+			TEST_CHECK(indexCount / 6 <= SpriteBatch::kMaxQuadCount);
+			TEST_CHECK(baseVertex >= 0);
+			TEST_CHECK((baseVertex + indexCount / 6 * 4) * vertexStride <= vertexBufferSize);
+			quadCount += static_cast<uint32_t>(indexCount / 6);
+		}
+	}
+	return quadCount;
+}
+
+} // namespace
+
+TEST_CASE(SpriteBatch100kSprites) {
+	const uint32_t kSpriteCount = 100000;
+	const uint32_t kFrameCount = 10;
+
+	InitializeTestRenderers();
+
+	// テクスチャを切り替えながら描く
+	const uint32_t textureHandles[] = {
+	  TextureManager::Load("white1x1.png"), TextureManager::Load("uvChecker.png"),
+	  TextureManager::Load("tex1.png"), TextureManager::Load("mario.jpg")};
+	const uint32_t textureCount = _countof(textureHandles);
+
+	SpriteBatch spriteBatch;
+	RecordingRenderContext context;
+	double totalMilliseconds = 0.0;
+	for (uint32_t frame = 0; frame < kFrameCount; frame++) {
+		context.Clear();
+
+		auto start = std::chrono::steady_clock::now();
+		spriteBatch.Begin(&context);
+		uint32_t seed = 1;
+		for (uint32_t i = 0; i < kSpriteCount; i++) {
+			seed = seed * 1664525u + 1013904223u;
+			float x = float((seed >> 8) % 1280);
+			float y = float((seed >> 16) % 720);
+			SpriteBatch::Vertex vertices[4] = {
+			  {{x, y + 16.0f, 0.0f}, {0.0f, 1.0f}, 0xffffffff},
+			  {{x, y, 0.0f}, {0.0f, 0.0f}, 0xffffffff},
+			  {{x + 16.0f, y + 16.0f, 0.0f}, {1.0f, 1.0f}, 0xffffffff},
+			  {{x + 16.0f, y, 0.0f}, {1.0f, 0.0f}, 0xffffffff},
+			};
+			spriteBatch.DrawQuad(textureHandles[(seed >> 4) % textureCount], vertices);
+		}
+		spriteBatch.End();
+		std::chrono::duration<double, std::milli> elapsed =
+		  std::chrono::steady_clock::now() - start;
+		totalMilliseconds += elapsed.count();
+
+		TEST_CHECK(spriteBatch.GetQuadCount() == kSpriteCount);
+		TEST_CHECK(CheckDrawRanges(context) == kSpriteCount);
+		// 記録した命令列は別の発行先で再生しても同じになる
+		RecordingRenderContext replayed;
+		context.Replay(replayed);
+		TEST_CHECK(replayed.ToString() == context.ToString());
+		// テクスチャごとにまとめるので、描画数は転送の区切りとテクスチャの切り替えの分だけ
+		TEST_CHECK(
+		  spriteBatch.GetDrawCount() <=
+		  (kSpriteCount + SpriteBatch::kMaxQuadCount - 1) / SpriteBatch::kMaxQuadCount +
+		    textureCount);
+
+		FinishTestFrame();
+	}
+
+	std::printf(
+	  "  %u sprites: %.2f ms/frame, %u draws, ring %llu bytes\n", kSpriteCount,
+	  totalMilliseconds / kFrameCount, spriteBatch.GetDrawCount(),
+	  static_cast<unsigned long long>(ConstantBufferAllocator::GetInstance()->GetCapacity()));
+
+	// 後のテストが読み込むテクスチャの参照を残さない
+	for (uint32_t textureHandle : textureHandles) {
+		TextureManager::Release(textureHandle);
+	}
+}
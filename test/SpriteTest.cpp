@@ -0,0 +1,102 @@
+﻿// Spriteの作り直しのテスト（動かしたスプライトだけ頂点データやワールド行列を作り直し、止まっているものは作り直さない）
+// 描画命令はRecordingRenderContextに記録する
+#include "RecordingRenderContext.h"
+#include "Sprite.h"
+#include "TestGraphics.h"
+#include "TestUtil.h"
+#include "TextureManager.h"
+#include <cstdio>
+#include <vector>
+
+namespace {
+
+// 種類ごとのスプライト数
+const uint32_t kSpriteCount = 100;
+// 描画するフレーム数
+const uint32_t kFrameCount = 10;
+
+// 全てのスプライトを1フレーム描く
+void DrawSprites(const std::vector<Sprite*>& sprites, RecordingRenderContext& context) {
+	context.Clear();
+	Sprite::PreDraw(&context);
+	for (Sprite* sprite : sprites) {
+		sprite->Draw();
+	}
+	Sprite::PostDraw();
+	TEST_CHECK(context.GetDrawCount() == sprites.size());
+	FinishTestFrame();
+}
+
+} // namespace
+
+TEST_CASE(SpriteRebuildsOnlyChangedSprites) {
+	InitializeTestRenderers();
+	uint32_t textureHandle = TextureManager::Load("white1x1.png");
+
+	// 止まっている、移動する、回転する、大きさが変わる、反転するスプライト
+	std::vector<Sprite*> staticSprites;
+	std::vector<Sprite*> movingSprites;
+	std::vector<Sprite*> rotatingSprites;
+	std::vector<Sprite*> resizingSprites;
+	std::vector<Sprite*> flippingSprites;
+	std::vector<Sprite*> allSprites;
+	std::vector<Sprite*>* groups[] = {
+	  &staticSprites, &movingSprites, &rotatingSprites, &resizingSprites, &flippingSprites};
+	for (std::vector<Sprite*>* group : groups) {
+		for (uint32_t i = 0; i < kSpriteCount; i++) {
+			Sprite* sprite = Sprite::Create(textureHandle, {float(i), 0.0f});
+			group->push_back(sprite);
+			allSprites.push_back(sprite);
+		}
+	}
+
+	// 最初の描画では全て作る
+	RecordingRenderContext context;
+	Sprite::ResetStats();
+	DrawSprites(allSprites, context);
+	TEST_CHECK(Sprite::GetStats().vertexRebuildCount == allSprites.size());
+	TEST_CHECK(Sprite::GetStats().worldRebuildCount == allSprites.size());
+
+	// 止まっているスプライトだけなら、何も作り直さない
+	Sprite::ResetStats();
+	for (uint32_t frame = 0; frame < kFrameCount; frame++) {
+		DrawSprites(staticSprites, context);
+	}
+	TEST_CHECK(Sprite::GetStats().vertexRebuildCount == 0);
+	TEST_CHECK(Sprite::GetStats().worldRebuildCount == 0);
+	TEST_CHECK(Sprite::GetStats().worldRequestCount == kSpriteCount * kFrameCount);
+
+	// 動かしたスプライトは、変わったものだけを毎フレーム作り直す
+	Sprite::ResetStats();
+	for (uint32_t frame = 0; frame < kFrameCount; frame++) {
+		for (Sprite* sprite : movingSprites) {
+			DirectX::XMFLOAT2 position = sprite->GetPosition();
+			sprite->SetPosition({position.x + 1.0f, position.y + 0.5f});
+		}
+		for (Sprite* sprite : rotatingSprites) {
+			sprite->SetRotation(0.1f * frame);
+		}
+		for (Sprite* sprite : resizingSprites) {
+			sprite->SetSize({16.0f + frame, 16.0f + frame});
+		}
+		for (Sprite* sprite : flippingSprites) {
+			sprite->SetIsFlipX(frame % 2 == 0);
+		}
+		DrawSprites(allSprites, context);
+	}
+	const Sprite::Stats& stats = Sprite::GetStats();
+	// 移動と回転はワールド行列だけ、大きさと反転は頂点データだけ
+	TEST_CHECK(stats.worldRebuildCount == 2 * kSpriteCount * kFrameCount);
+	TEST_CHECK(stats.vertexRebuildCount == 2 * kSpriteCount * kFrameCount);
+	TEST_CHECK(stats.worldRequestCount == allSprites.size() * kFrameCount);
+	TEST_CHECK(stats.vertexRequestCount == 4 * kSpriteCount * kFrameCount);
+	std::printf(
+	  "  %zu sprites, 4/5 animated: %u vertex and %u matrix rebuilds, %u skipped\n",
+	  allSprites.size(), stats.vertexRebuildCount / kFrameCount,
+	  stats.worldRebuildCount / kFrameCount, stats.GetSkippedCount() / kFrameCount);
+
+	for (Sprite* sprite : allSprites) {
+		delete sprite;
+	}
+	TextureManager::Release(textureHandle);
+}
@@ -0,0 +1,83 @@
+﻿#include "TestGeometry.h"
+#include <cmath>
+#include <utility>
+
+TestGeometry CreateTestSphere(uint32_t ringCount, uint32_t segmentCount) {
+	TestGeometry geometry;
+
+	const float pi = 3.14159265f;
+	for (uint32_t r = 0; r <= ringCount; r++) {
+		float theta = pi * r / ringCount;
+		// 極は座標を揃える（sin(pi)は浮動小数点では0にならない）
+		float ringRadius = r == 0 || r == ringCount ? 0.0f : std::sin(theta);
+		float y = r == 0 ? 1.0f : r == ringCount ? -1.0f : std::cos(theta);
+		for (uint32_t s = 0; s <= segmentCount; s++) {
+			// 縫い目は始まりと同じ座標にする
+			float phi = 2.0f * pi * (s % segmentCount) / segmentCount;
+			Mesh::VertexPosNormalUv vertex;
+			vertex.pos.x = ringRadius * std::cos(phi);
+			vertex.pos.y = y;
+			vertex.pos.z = ringRadius * std::sin(phi);
+			vertex.normal = vertex.pos;
+			vertex.uv.x = float(s) / segmentCount;
+			vertex.uv.y = float(r) / ringCount;
+			geometry.vertices.push_back(vertex);
+		}
+	}
+
+	// 外から見て時計回り（左手系の表面）
+	const uint32_t rowSize = segmentCount + 1;
+	for (uint32_t r = 0; r < ringCount; r++) {
+		for (uint32_t s = 0; s < segmentCount; s++) {
+			uint32_t i0 = r * rowSize + s;
+			uint32_t i1 = i0 + 1;
+			uint32_t i2 = i0 + rowSize + 1;
+			uint32_t i3 = i0 + rowSize;
+			if (r != 0) {
+				geometry.indices.insert(geometry.indices.end(), {i0, i1, i3});
+			}
+			if (r != ringCount - 1) {
+				geometry.indices.insert(geometry.indices.end(), {i1, i2, i3});
+			}
+		}
+	}
+	return geometry;
+}
+
+TestGeometry CreateTestGrid(uint32_t width, uint32_t height) {
+	TestGeometry geometry;
+
+	for (uint32_t z = 0; z <= height; z++) {
+		for (uint32_t x = 0; x <= width; x++) {
+			Mesh::VertexPosNormalUv vertex;
+			vertex.pos = {float(x) / width, 0.0f, float(z) / height};
+			vertex.normal = {0.0f, 1.0f, 0.0f};
+			vertex.uv = {float(x) / width, 1.0f - float(z) / height};
+			geometry.vertices.push_back(vertex);
+		}
+	}
+
+	// 上から見て時計回り
+	const uint32_t rowSize = width + 1;
+	for (uint32_t z = 0; z < height; z++) {
+		for (uint32_t x = 0; x < width; x++) {
+			uint32_t i0 = z * rowSize + x;
+			uint32_t i1 = i0 + 1;
+			uint32_t i2 = i0 + rowSize + 1;
+			uint32_t i3 = i0 + rowSize;
+			geometry.indices.insert(geometry.indices.end(), {i0, i3, i1, i1, i3, i2});
+		}
+	}
+	return geometry;
+}
+
+void ShuffleTestTriangles(std::vector<uint32_t>& indices, uint32_t seed) {
+	size_t triangleCount = indices.size() / 3;
+	for (size_t i = triangleCount; i > 1; i--) {
+		seed = seed * 1664525u + 1013904223u;
+		size_t j = (seed >> 8) % i;
+		for (size_t k = 0; k < 3; k++) {
+			std::swap(indices[(i - 1) * 3 + k], indices[j * 3 + k]);
+		}
+	}
+}
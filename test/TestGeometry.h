@@ -0,0 +1,39 @@
+﻿#pragma once
+
+#include "Mesh.h"
+#include <cstdint>
+#include <vector>
+
+// 形状処理のテストで使う形状の生成
+// 頂点はMesh::VertexPosNormalUv、インデックスは三角形リスト
+
+/// <summary>
+/// 生成した形状
+/// </summary>
+struct TestGeometry {
+	std::vector<Mesh::VertexPosNormalUv> vertices;
+	std::vector<uint32_t> indices;
+};
+
+/// <summary>
+/// 半径1のUV球の生成（縫い目と極の頂点はuvが違うので同じ座標で重複させる。極の縮退三角形は作らない）
+/// </summary>
+/// <param name="ringCount">緯度方向の分割数</param>
+/// <param name="segmentCount">経度方向の分割数</param>
+/// <returns>形状</returns>
+TestGeometry CreateTestSphere(uint32_t ringCount, uint32_t segmentCount);
+
+/// <summary>
+/// xz平面上の1辺1の格子の生成（法線は+y）
+/// </summary>
+/// <param name="width">x方向の分割数</param>
+/// <param name="height">z方向の分割数</param>
+/// <returns>形状</returns>
+TestGeometry CreateTestGrid(uint32_t width, uint32_t height);
+
+/// <summary>
+/// 三角形の順番をばらばらにする（頂点キャッシュに不利な入力を作る）
+/// </summary>
+/// <param name="indices">インデックス配列</param>
+/// <param name="seed">乱数の種</param>
+void ShuffleTestTriangles(std::vector<uint32_t>& indices, uint32_t seed);
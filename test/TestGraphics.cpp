@@ -0,0 +1,84 @@
+﻿#include "DebugText.h"
+#include "DirectXCommon.h"
+#include "Model.h"
+#include "Sprite.h"
+#include "SpriteBatch.h"
+#include "TestGraphics.h"
+#include "TestUtil.h"
+#include "TextureManager.h"
+#include <dxgi1_6.h>
+#include <wrl.h>
+
+#pragma comment(lib, "d3d12.lib")
+#pragma comment(lib, "dxgi.lib")
+
+using namespace Microsoft::WRL;
+
+namespace {
+
+// テストの描画先の大きさ
+const int32_t kBackBufferWidth = 1280;
+const int32_t kBackBufferHeight = 720;
+
+} // namespace
+
+ID3D12Device* GetTestDevice() {
+	static ComPtr<ID3D12Device> device;
+	if (device) {
+		return device.Get();
+	}
+
+	HRESULT result;
+
+	// WARPアダプタでデバイスを生成
+	ComPtr<IDXGIFactory4> factory;
+	result = CreateDXGIFactory1(IID_PPV_ARGS(&factory));
+	TEST_CHECK(SUCCEEDED(result));
+	ComPtr<IDXGIAdapter> adapter;
+	result = factory->EnumWarpAdapter(IID_PPV_ARGS(&adapter));
+	TEST_CHECK(SUCCEEDED(result));
+	result = D3D12CreateDevice(adapter.Get(), D3D_FEATURE_LEVEL_11_0, IID_PPV_ARGS(&device));
+	TEST_CHECK(SUCCEEDED(result));
+
+	return device.Get();
+}
+
+void InitializeTestGraphics() {
+	static bool initialized = false;
+	if (initialized) {
+		return;
+	}
+	initialized = true;
+
+	// WICを使うのでCOMを初期化
+	HRESULT result = CoInitializeEx(nullptr, COINIT_MULTITHREADED);
+	TEST_CHECK(SUCCEEDED(result));
+
+	DirectXCommon::GetInstance()->InitializeHeadless(
+	  GetTestDevice(), kBackBufferWidth, kBackBufferHeight);
+	TextureManager::GetInstance()->Initialize(GetTestDevice());
+}
+
+void InitializeTestRenderers() {
+	static bool initialized = false;
+	if (initialized) {
+		return;
+	}
+	initialized = true;
+
+	InitializeTestGraphics();
+
+	// main.cppと同じ順番で初期化する
+	TextureManager::Load("white1x1.png");
+	Sprite::StaticInitialize(GetTestDevice(), kBackBufferWidth, kBackBufferHeight);
+	SpriteBatch::StaticInitialize(GetTestDevice(), kBackBufferWidth, kBackBufferHeight);
+	DebugText::GetInstance()->Initialize();
+	Model::StaticInitialize();
+}
+
+void FinishTestFrame() {
+	DirectXCommon* dxCommon = DirectXCommon::GetInstance();
+	dxCommon->PreDraw();
+	dxCommon->PostDraw();
+	TextureManager::GetInstance()->Update();
+}
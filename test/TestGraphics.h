@@ -0,0 +1,29 @@
+﻿#pragma once
+
+#include <d3d12.h>
+
+// GPUを使うテストの準備
+// 実際のGPUの代わりにWARP（ソフトウェア実装のデバイス）を使い、描画命令はRecordingRenderContextに記録する
+// DirectXCommonはウィンドウなしで初期化するので、メインループと同じ描画もそのまま動く
+// リソースはリポジトリ直下からの相対パスで読み込む（作業ディレクトリはリポジトリ直下）
+
+/// <summary>
+/// テスト用のデバイスを取得（最初の呼び出しで生成する）
+/// </summary>
+/// <returns>デバイス</returns>
+ID3D12Device* GetTestDevice();
+
+/// <summary>
+/// DirectXCommon（ウィンドウなし）とTextureManagerの初期化（最初の呼び出しだけ行う）
+/// </summary>
+void InitializeTestGraphics();
+
+/// <summary>
+/// Sprite、SpriteBatch、DebugText、Modelの静的初期化（最初の呼び出しだけ行う）
+/// </summary>
+void InitializeTestRenderers();
+
+/// <summary>
+/// フレームの終了（空のフレームをDirectXCommonで送り、読み込みの終わったテクスチャを差し替える）
+/// </summary>
+void FinishTestFrame();
@@ -0,0 +1,26 @@
+﻿// テストの実行（引数を渡すと名前にその文字列を含むテストだけ実行する）
+// Visual StudioではDirectXGameTestプロジェクトをビルドして実行する
+// GPUのAPIに依存しないテストは、そのテストと対象のソースだけで他の環境でもビルドできる
+//   例: g++ -std=c++14 -I../base TestMain.cpp RingAllocatorTest.cpp ../base/RingAllocator.cpp
+#include "TestUtil.h"
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+int main(int argc, char* argv[]) {
+	const char* filter = argc > 1 ? argv[1] : nullptr;
+
+	int count = 0;
+	for (const TestCase& testCase : GetTestCases()) {
+		if (filter && !std::strstr(testCase.name, filter)) {
+			continue;
+		}
+		auto start = std::chrono::steady_clock::now();
+		testCase.function();
+		std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+		std::printf("%s: ok (%.1f ms)\n", testCase.name, elapsed.count());
+		count++;
+	}
+	std::printf("%d tests passed\n", count);
+	return 0;
+}
@@ -0,0 +1,47 @@
+﻿#pragma once
+
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+// DirectXGameTestのテスト
+// TEST_CASEで定義したテストをTestMainが順に実行し、失敗すると終了コードが0以外になる
+// （NDEBUGでも確認するのでassertは使わない）
+
+/// <summary>
+/// テスト1つ分
+/// </summary>
+struct TestCase {
+	const char* name;
+	void (*function)();
+};
+
+/// <summary>
+/// 登録されたテストの取得
+/// </summary>
+inline std::vector<TestCase>& GetTestCases() {
+	static std::vector<TestCase> testCases;
+	return testCases;
+}
+
+/// <summary>
+/// テストの登録（静的変数の初期化で登録する）
+/// </summary>
+struct TestRegistrar {
+	TestRegistrar(const char* name, void (*function)()) { GetTestCases().push_back({name, function}); }
+};
+
+// テストの定義
+#define TEST_CASE(name)                                                                            \
+	static void name();                                                                            \
+	static TestRegistrar name##Registrar(#name, name);                                             \
+	static void name()
+
+// 条件を確認し、満たさなければ場所を表示して終了する
+#define TEST_CHECK(condition)                                                                      \
+	do {                                                                                           \
+		if (!(condition)) {                                                                        \
+			std::fprintf(stderr, "%s(%d): failed: %s\n", __FILE__, __LINE__, #condition);          \
+			std::exit(1);                                                                          \
+		}                                                                                          \
+	} while (false)
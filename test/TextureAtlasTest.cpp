@@ -0,0 +1,95 @@
+﻿// TextureAtlasのテストとベンチマーク（余白の引き伸ばし、ミップレベル数、構築時間）
+#include "TestGraphics.h"
+#include "TestUtil.h"
+#include "TextureAtlas.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+TEST_CASE(TextureAtlasExtrude) {
+	const uint32_t kPageWidth = 16;
+	const uint32_t kPadding = 2;
+
+	// 3x2の画像（画素ごとに違う値）
+	const uint32_t kWidth = 3;
+	const uint32_t kHeight = 2;
+	const uint32_t image[kHeight][kWidth] = {{1, 2, 3}, {4, 5, 6}};
+
+	std::vector<uint32_t> page(kPageWidth * kPageWidth, 0xdeadbeef);
+	RectPacker::Rect rect;
+	rect.x = 5;
+	rect.y = 4;
+	rect.width = kWidth + kPadding * 2;
+	rect.height = kHeight + kPadding * 2;
+	TextureAtlas::CopyWithExtrude(
+	  page.data(), kPageWidth, rect, kPadding, reinterpret_cast<const uint8_t*>(image),
+	  sizeof(uint32_t) * kWidth);
+
+	for (uint32_t y = 0; y < kPageWidth; y++) {
+		for (uint32_t x = 0; x < kPageWidth; x++) {
+			uint32_t pixel = page[y * kPageWidth + x];
+			bool inside = x >= rect.x && x < rect.x + rect.width && y >= rect.y &&
+			              y < rect.y + rect.height;
+			if (!inside) {
+				// 置いた範囲の外は書き換えない
+				TEST_CHECK(pixel == 0xdeadbeef);
+				continue;
+			}
+			// 余白の画素は最も近い画像の画素と同じ
+			int32_t imageX = int32_t(x) - int32_t(rect.x + kPadding);
+			int32_t imageY = int32_t(y) - int32_t(rect.y + kPadding);
+			imageX = (std::min)((std::max)(imageX, 0), int32_t(kWidth) - 1);
+			imageY = (std::min)((std::max)(imageY, 0), int32_t(kHeight) - 1);
+			TEST_CHECK(pixel == image[imageY][imageX]);
+		}
+	}
+}
+
+TEST_CASE(TextureAtlasMipLevels) {
+	// 1テクセルが余白に収まるミップレベルまで
+	TEST_CHECK(TextureAtlas::GetMipLevels(0) == 1);
+	TEST_CHECK(TextureAtlas::GetMipLevels(1) == 1);
+	TEST_CHECK(TextureAtlas::GetMipLevels(2) == 2);
+	TEST_CHECK(TextureAtlas::GetMipLevels(3) == 2);
+	TEST_CHECK(TextureAtlas::GetMipLevels(4) == 3);
+	TEST_CHECK(TextureAtlas::GetMipLevels(16) == 5);
+}
+
+TEST_CASE(TextureAtlasBuildTime) {
+	InitializeTestGraphics();
+
+	const std::vector<std::string> fileNames = {
+	  "mario.jpg", "uvChecker.png", "tex1.png", "white1x1.png", "debugfont.png"};
+
+	TextureAtlas* atlas = TextureAtlas::GetInstance();
+	size_t firstPage = atlas->GetPageCount();
+	auto start = std::chrono::steady_clock::now();
+	atlas->Build("test_atlas", fileNames, 2048, TextureAtlas::kDefaultPadding);
+	std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+
+	// 全ての画像が重ならずにページに入っている
+	for (size_t i = 0; i < fileNames.size(); i++) {
+		const TextureAtlas::Region* region = atlas->Find(fileNames[i]);
+		TEST_CHECK(region);
+		TEST_CHECK(region->page >= firstPage && region->page < atlas->GetPageCount());
+		for (size_t j = 0; j < i; j++) {
+			const TextureAtlas::Region* other = atlas->Find(fileNames[j]);
+			if (other->page != region->page) {
+				continue;
+			}
+			bool separated = region->texBase.x + region->texSize.x <= other->texBase.x ||
+			                 other->texBase.x + other->texSize.x <= region->texBase.x ||
+			                 region->texBase.y + region->texSize.y <= other->texBase.y ||
+			                 other->texBase.y + other->texSize.y <= region->texBase.y;
+			TEST_CHECK(separated);
+		}
+	}
+
+	for (size_t page = firstPage; page < atlas->GetPageCount(); page++) {
+		std::printf(
+		  "  page %zu occupancy %.1f%%\n", page - firstPage,
+		  atlas->GetOccupancy(static_cast<uint32_t>(page)) * 100.0f);
+	}
+	std::printf("  %zu images: build %.2f ms\n", fileNames.size(), elapsed.count());
+}
@@ -0,0 +1,156 @@
+﻿// TextureManagerのテスト（WARPデバイスで、ヒープの拡張、解放の遅延、非同期読み込み、参照の持ち主）
+#include "FrameSync.h"
+#include "JobSystem.h"
+#include "Material.h"
+#include "TestGraphics.h"
+#include "TestUtil.h"
+#include "TextureManager.h"
+#include <DirectXTex.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// 1ラウンドで生成するテクスチャ数（最初のデスクリプタの数より多くしてヒープを拡張させる）
+const uint32_t kTextureCount = static_cast<uint32_t>(TextureManager::kNumDescriptors) + 64;
+// 生成と解放を繰り返す回数（合計で1万回以上の生成と解放）
+const uint32_t kRoundCount = 32;
+// 解放したリソースとハンドルが再利用できるようになるまでのフレーム数（GPUが使い終わるまで）
+const uint32_t kReleaseFrames = FrameSync::kMaxFrameCount + 1;
+// 非同期読み込みを待つ最大時間
+const std::chrono::seconds kStreamTimeout(10);
+
+// 解放したリソースとハンドルが再利用できるようになるまでフレームを進める
+void FinishReleaseFrames() {
+	for (uint32_t i = 0; i < kReleaseFrames; i++) {
+		FinishTestFrame();
+	}
+}
+
+// 非同期読み込みが終わるまでフレームを進める
+bool FinishFramesUntilLoaded(uint32_t textureHandle) {
+	auto start = std::chrono::steady_clock::now();
+	while (!TextureManager::GetInstance()->IsLoaded(textureHandle)) {
+		if (std::chrono::steady_clock::now() - start > kStreamTimeout) {
+			return false;
+		}
+		FinishTestFrame();
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+	return true;
+}
+
+} // namespace
+
+TEST_CASE(TextureManagerCreateReleaseStress) {
+	InitializeTestGraphics();
+	TextureManager* textureManager = TextureManager::GetInstance();
+	const uint32_t firstCount = textureManager->GetTextureCount();
+
+	// 4x4の画像（ラウンドとテクスチャごとに色を変える）
+	std::vector<uint32_t> pixels(4 * 4);
+	DirectX::Image image{};
+	image.width = 4;
+	image.height = 4;
+	image.format = DXGI_FORMAT_R8G8B8A8_UNORM;
+	image.rowPitch = sizeof(uint32_t) * image.width;
+	image.slicePitch = image.rowPitch * image.height;
+	image.pixels = reinterpret_cast<uint8_t*>(pixels.data());
+
+	UINT firstCapacity = 0;
+	for (uint32_t round = 0; round < kRoundCount; round++) {
+		std::vector<uint32_t> handles;
+		for (uint32_t i = 0; i < kTextureCount; i++) {
+			std::fill(pixels.begin(), pixels.end(), round * kTextureCount + i);
+			std::string name = "stress_" + std::to_string(round) + "_" + std::to_string(i);
+			uint32_t handle = TextureManager::Create(name, image, 1);
+			handles.push_back(handle);
+
+			// 生成したテクスチャはヒープの容量内にある
+			D3D12_RESOURCE_DESC desc = textureManager->GetResoureDesc(handle);
+			TEST_CHECK(desc.Width == 4 && desc.Height == 4 && desc.MipLevels == 1);
+			TEST_CHECK(handle < textureManager->GetDescriptorHeap()->GetDesc().NumDescriptors);
+		}
+		TEST_CHECK(textureManager->GetTextureCount() == firstCount + kTextureCount);
+
+		// 同じ名前の生成は同じハンドルを返し、参照数だけ増える
+		uint32_t again = TextureManager::Create("stress_" + std::to_string(round) + "_0", image, 1);
+		TEST_CHECK(again == handles[0]);
+		TextureManager::Release(again);
+		TEST_CHECK(textureManager->GetTextureCount() == firstCount + kTextureCount);
+
+		// 最初のラウンドで拡張した後は、解放したハンドルを再利用してヒープは増えない
+		UINT capacity = textureManager->GetDescriptorHeap()->GetDesc().NumDescriptors;
+		TEST_CHECK(capacity > TextureManager::kNumDescriptors);
+		if (round == 0) {
+			firstCapacity = capacity;
+		}
+		TEST_CHECK(capacity == firstCapacity);
+
+		// 全て解放すると数が戻る（ハンドルはGPUが使い終わるフレーム数の後に再利用できる）
+		for (uint32_t handle : handles) {
+			TextureManager::Release(handle);
+		}
+		TEST_CHECK(textureManager->GetTextureCount() == firstCount);
+		FinishReleaseFrames();
+	}
+	std::printf(
+	  "  %u create/release cycles, heap %u descriptors\n", kRoundCount * kTextureCount,
+	  firstCapacity);
+}
+
+TEST_CASE(TextureManagerLoadAsyncStress) {
+	InitializeTestGraphics();
+	JobSystem::GetInstance()->Initialize(3);
+	TextureManager* textureManager = TextureManager::GetInstance();
+	const uint32_t firstCount = textureManager->GetTextureCount();
+
+	// 読み込めないファイルは仮のテクスチャのまま
+	uint32_t missingHandle = TextureManager::LoadAsync("test_missing_texture.png");
+	// 読み込めるファイルは差し替わる
+	uint32_t loadedHandle = TextureManager::LoadAsync("uvChecker.png");
+	TEST_CHECK(FinishFramesUntilLoaded(loadedHandle));
+	TEST_CHECK(textureManager->GetResoureDesc(loadedHandle).Width > 1);
+
+	// 読み込み中のジョブを待ってから確認する
+	textureManager->Finalize();
+	FinishReleaseFrames();
+	TEST_CHECK(!textureManager->IsLoaded(missingHandle));
+
+	TextureManager::Release(missingHandle);
+	TextureManager::Release(loadedHandle);
+	TEST_CHECK(textureManager->GetTextureCount() == firstCount);
+	FinishReleaseFrames();
+
+	JobSystem::GetInstance()->Finalize();
+}
+
+TEST_CASE(TextureManagerMaterialReleasesTexture) {
+	InitializeTestGraphics();
+	TextureManager* textureManager = TextureManager::GetInstance();
+	const uint32_t firstCount = textureManager->GetTextureCount();
+
+	// マテリアルが読み込んだテクスチャは、マテリアルを破棄すると解放される
+	Material* material = Material::Create();
+	material->textureFilename_ = "uvChecker.png";
+	material->LoadTexture("");
+	TEST_CHECK(textureManager->GetTextureCount() == firstCount + 1);
+
+	// 読み込み直しても参照は1つだけ
+	material->textureFilename_ = "tex1.png";
+	material->LoadTexture("");
+	TEST_CHECK(textureManager->GetTextureCount() == firstCount + 1);
+
+	delete material;
+	TEST_CHECK(textureManager->GetTextureCount() == firstCount);
+	FinishReleaseFrames();
+
+	// 読み込んでいないマテリアルは何も解放しない
+	delete Material::Create();
+	TEST_CHECK(textureManager->GetTextureCount() == firstCount);
+}
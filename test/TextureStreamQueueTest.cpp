@@ -0,0 +1,170 @@
+﻿// TextureStreamQueueのテスト（取り出す順番、優先度の引き上げ、メモリ予算、複数スレッドからの操作）
+#include "TestUtil.h"
+#include "TextureStreamQueue.h"
+#include <atomic>
+#include <thread>
+#include <vector>
+
+TEST_CASE(TextureStreamQueueOrdering) {
+	TextureStreamQueue queue;
+	TextureStreamQueue::Request request;
+	TEST_CHECK(!queue.Pop(request));
+
+	// 同じミップなら積んだ順に取り出す
+	for (uint32_t handle = 0; handle < 8; handle++) {
+		queue.Push(handle, 2);
+	}
+	TEST_CHECK(queue.GetPendingCount() == 8);
+	for (uint32_t handle = 0; handle < 8; handle++) {
+		TEST_CHECK(queue.Pop(request));
+		TEST_CHECK(request.handle == handle);
+		TEST_CHECK(request.requestedMip == 2);
+	}
+	TEST_CHECK(!queue.Pop(request));
+	TEST_CHECK(queue.GetPendingCount() == 0);
+}
+
+TEST_CASE(TextureStreamQueuePriority) {
+	TextureStreamQueue queue;
+	TextureStreamQueue::Request request;
+
+	// 細かいミップを要求したものから取り出す
+	queue.Push(10, 3);
+	queue.Push(11, 0);
+	queue.Push(12, 1);
+	queue.Push(13, 0);
+	const uint32_t expected[] = {11, 13, 12, 10};
+	for (uint32_t handle : expected) {
+		TEST_CHECK(queue.Pop(request));
+		TEST_CHECK(request.handle == handle);
+	}
+
+	// 積み直すと優先度だけ上がり、同じミップの中では最初に積んだ順番を保つ
+	queue.Push(20, 2);
+	queue.Push(21, 1);
+	queue.Push(22, 2);
+	queue.Push(20, 1);
+	TEST_CHECK(queue.GetPendingCount() == 3);
+	TEST_CHECK(queue.Raise(22, 1));
+	// 粗いミップへの変更では下がらない
+	TEST_CHECK(queue.Raise(21, 3));
+	const uint32_t raised[] = {20, 21, 22};
+	for (uint32_t handle : raised) {
+		TEST_CHECK(queue.Pop(request));
+		TEST_CHECK(request.handle == handle);
+		TEST_CHECK(request.requestedMip == 1);
+	}
+
+	// 取り出し済みのものは引き上げられない
+	TEST_CHECK(!queue.Raise(20, 0));
+
+	// Clearで全て捨てる
+	queue.Push(30, 0);
+	queue.Push(31, 0);
+	queue.Clear();
+	TEST_CHECK(!queue.Pop(request));
+}
+
+TEST_CASE(TextureStreamQueueBudget) {
+	// 256x256 RGBA8、ミップ9枚
+	const uint32_t kSize = 256;
+	const uint32_t kBytesPerPixel = 4;
+	const uint32_t kMipLevels = 9;
+	const uint64_t fullBytes =
+	  TextureStreamQueue::CalcMipChainBytes(kSize, kSize, kBytesPerPixel, kMipLevels, 0);
+	const uint64_t halfBytes =
+	  TextureStreamQueue::CalcMipChainBytes(kSize, kSize, kBytesPerPixel, kMipLevels, 1);
+	TEST_CHECK(fullBytes == 349524);
+	TEST_CHECK(halfBytes == 87380);
+	// 最後の1x1まで
+	TEST_CHECK(
+	  TextureStreamQueue::CalcMipChainBytes(kSize, kSize, kBytesPerPixel, kMipLevels, 8) == 4);
+
+	TextureStreamQueue queue;
+	// 予算がなければ要求通り
+	TEST_CHECK(queue.FitMip(kSize, kSize, kBytesPerPixel, kMipLevels, 0) == 0);
+	TEST_CHECK(queue.FitMip(kSize, kSize, kBytesPerPixel, kMipLevels, 2) == 2);
+
+	// 原寸が入らなければ細かいミップを削る
+	queue.SetBudget(fullBytes + halfBytes);
+	TEST_CHECK(queue.Reserve(fullBytes));
+	TEST_CHECK(queue.GetResidentBytes() == fullBytes);
+	TEST_CHECK(queue.FitMip(kSize, kSize, kBytesPerPixel, kMipLevels, 0) == 1);
+	TEST_CHECK(queue.Reserve(halfBytes));
+
+	// 最も粗いミップも入らなければ待つ
+	TEST_CHECK(queue.FitMip(kSize, kSize, kBytesPerPixel, kMipLevels, 0) == UINT32_MAX);
+	TEST_CHECK(!queue.Reserve(1));
+	TEST_CHECK(queue.GetResidentBytes() == fullBytes + halfBytes);
+
+	// 要求を捨てても差し替え済みの使用量は残る
+	queue.Clear();
+	TEST_CHECK(queue.GetResidentBytes() == fullBytes + halfBytes);
+
+	// 返せば再び入る
+	queue.Release(fullBytes);
+	TEST_CHECK(queue.FitMip(kSize, kSize, kBytesPerPixel, kMipLevels, 0) == 0);
+	queue.Release(halfBytes);
+	TEST_CHECK(queue.GetResidentBytes() == 0);
+}
+
+TEST_CASE(TextureStreamQueueThreads) {
+	const uint32_t kProducerCount = 4;
+	const uint32_t kConsumerCount = 4;
+	const uint32_t kRequestsPerProducer = 20000;
+	const uint32_t kRequestCount = kProducerCount * kRequestsPerProducer;
+
+	TextureStreamQueue queue;
+	std::vector<std::atomic<uint32_t>> popCounts(kRequestCount);
+	for (std::atomic<uint32_t>& count : popCounts) {
+		count = 0;
+	}
+	std::atomic<uint32_t> producersDone{0};
+	std::atomic<uint32_t> poppedCount{0};
+
+	// 積みながら優先度を上げるスレッドと、取り出すスレッドを同時に動かす
+	std::vector<std::thread> threads;
+	for (uint32_t p = 0; p < kProducerCount; p++) {
+		threads.emplace_back([&, p]() {
+			for (uint32_t i = 0; i < kRequestsPerProducer; i++) {
+				uint32_t handle = p * kRequestsPerProducer + i;
+				queue.Push(handle, 4 + handle % 4);
+				if (i % 3 == 0) {
+					queue.Raise(handle, handle % 4);
+				}
+			}
+			producersDone++;
+		});
+	}
+	for (uint32_t c = 0; c < kConsumerCount; c++) {
+		threads.emplace_back([&]() {
+			TextureStreamQueue::Request request;
+			while (true) {
+				if (queue.Pop(request)) {
+					TEST_CHECK(request.handle < kRequestCount);
+					popCounts[request.handle]++;
+					poppedCount++;
+				} else if (producersDone == kProducerCount) {
+					// 積み終わった後に空なら終わり
+					if (!queue.Pop(request)) {
+						break;
+					}
+					popCounts[request.handle]++;
+					poppedCount++;
+				} else {
+					std::this_thread::yield();
+				}
+			}
+		});
+	}
+	for (std::thread& thread : threads) {
+		thread.join();
+	}
+
+	// 全ての要求をちょうど1回ずつ取り出す
+	TEST_CHECK(poppedCount == kRequestCount);
+	for (std::atomic<uint32_t>& count : popCounts) {
+		TEST_CHECK(count == 1);
+	}
+	TEST_CHECK(queue.GetPendingCount() == 0);
+}
@@ -0,0 +1,403 @@
+﻿// TransformSystemのテスト（WorldTransform::UpdateMatrixとの一致、変更のあった部分木だけの再計算、
+// 回転する輪の階層、10万ノードの更新時間）
+#include "JobSystem.h"
+#include "TestUtil.h"
+#include "TransformSystem.h"
+#include "WorldTransform.h"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+using namespace DirectX;
+
+namespace {
+
+// 並列に更新する時のワーカー数
+const uint32_t kWorkerCount = 7;
+// 親の無いノードの親（コンテナに参照で渡すのでここに定義しておく）
+const uint32_t kNoParent = TransformSystem::kInvalidNode;
+
+// 乱数（テストごとに同じ列になるよう線形合同法）
+struct Random {
+	uint32_t seed = 1;
+
+	uint32_t Next() {
+		seed = seed * 1664525u + 1013904223u;
+		return seed >> 8;
+	}
+	float Range(float low, float high) {
+		return low + (high - low) * float(Next() % 10000) / 9999.0f;
+	}
+};
+
+// ランダムなローカルの値
+struct LocalTransform {
+	XMFLOAT3 scale;
+	XMFLOAT3 rotation;
+	XMFLOAT3 translation;
+};
+
+LocalTransform RandomLocal(Random& random) {
+	LocalTransform local;
+	local.scale = {random.Range(0.5f, 1.5f), random.Range(0.5f, 1.5f), random.Range(0.5f, 1.5f)};
+	local.rotation = {
+	  random.Range(-XM_PI, XM_PI), random.Range(-XM_PI, XM_PI), random.Range(-XM_PI, XM_PI)};
+	local.translation = {
+	  random.Range(-2.0f, 2.0f), random.Range(-2.0f, 2.0f), random.Range(-2.0f, 2.0f)};
+	return local;
+}
+
+// ランダムな階層（parents[i]はkInvalidNodeかiより前に作ったノード、番号の大小とは無関係）
+struct Hierarchy {
+	// 作った順のノード番号
+	std::vector<uint32_t> order;
+	// ノード番号ごとの親
+	std::vector<uint32_t> parents;
+};
+
+Hierarchy CreateRandomHierarchy(TransformSystem& system, uint32_t nodeCount, Random& random) {
+	Hierarchy hierarchy;
+	hierarchy.parents.assign(nodeCount, kNoParent);
+	for (uint32_t i = 0; i < nodeCount; i++) {
+		system.CreateNode();
+	}
+	// 番号の大きいノードが親になることもあるように、ばらばらの順で親を付ける
+	hierarchy.order.resize(nodeCount);
+	for (uint32_t i = 0; i < nodeCount; i++) {
+		hierarchy.order[i] = i;
+	}
+	for (uint32_t i = nodeCount - 1; i > 0; i--) {
+		std::swap(hierarchy.order[i], hierarchy.order[random.Next() % (i + 1)]);
+	}
+	for (uint32_t i = 1; i < nodeCount; i++) {
+		uint32_t node = hierarchy.order[i];
+		// 約5%はルート
+		if (random.Next() % 20 == 0) {
+			continue;
+		}
+		uint32_t parent = hierarchy.order[random.Next() % i];
+		system.SetParent(node, parent);
+		hierarchy.parents[node] = parent;
+	}
+	return hierarchy;
+}
+
+// 同じ大きさの木を並べた階層（シーンに置いた多数のオブジェクトの想定）
+Hierarchy CreateForestHierarchy(
+  TransformSystem& system, uint32_t treeCount, uint32_t treeSize, Random& random) {
+	Hierarchy hierarchy;
+	for (uint32_t tree = 0; tree < treeCount; tree++) {
+		uint32_t root = system.CreateNode();
+		hierarchy.order.push_back(root);
+		hierarchy.parents.push_back(kNoParent);
+		for (uint32_t i = 1; i < treeSize; i++) {
+			uint32_t parent = root + random.Next() % i;
+			hierarchy.order.push_back(system.CreateNode(parent));
+			hierarchy.parents.push_back(parent);
+		}
+	}
+	return hierarchy;
+}
+
+// 行列の各要素が誤差の範囲で一致するか
+bool NearlyEqual(const XMMATRIX& a, const XMMATRIX& b) {
+	XMFLOAT4X4 fa, fb;
+	XMStoreFloat4x4(&fa, a);
+	XMStoreFloat4x4(&fb, b);
+	for (int row = 0; row < 4; row++) {
+		for (int column = 0; column < 4; column++) {
+			float expected = fb.m[row][column];
+			if (std::fabs(fa.m[row][column] - expected) > 1e-4f * (1.0f + std::fabs(expected))) {
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+// 同じ値を設定したWorldTransformの階層を親から順に更新して比べる
+void CheckMatchesWorldTransform(
+  const TransformSystem& system, const Hierarchy& hierarchy,
+  std::vector<WorldTransform>& transforms) {
+	for (uint32_t node : hierarchy.order) {
+		WorldTransform& transform = transforms[node];
+		transform.scale_ = system.GetScale(node);
+		transform.rotation_ = system.GetRotation(node);
+		transform.translation_ = system.GetTranslation(node);
+		uint32_t parent = hierarchy.parents[node];
+		transform.parent_ = parent != TransformSystem::kInvalidNode ? &transforms[parent] : nullptr;
+		transform.UpdateMatrix();
+	}
+	for (uint32_t node : hierarchy.order) {
+		TEST_CHECK(NearlyEqual(system.GetWorldMatrix(node), transforms[node].matWorld_));
+	}
+}
+
+void SetLocal(TransformSystem& system, uint32_t node, const LocalTransform& local) {
+	system.SetScale(node, local.scale);
+	system.SetRotation(node, local.rotation);
+	system.SetTranslation(node, local.translation);
+}
+
+TEST_CASE(TransformSystemMatchesWorldTransform) {
+	const uint32_t kNodeCount = 5000;
+	JobSystem* jobSystem = JobSystem::GetInstance();
+	jobSystem->Initialize(kWorkerCount);
+
+	// 逐次と並列のどちらの更新でも一致する
+	for (JobSystem* updateJobSystem : {static_cast<JobSystem*>(nullptr), jobSystem}) {
+		Random random;
+		TransformSystem system;
+		system.Initialize(kNodeCount, false);
+		Hierarchy hierarchy = CreateRandomHierarchy(system, kNodeCount, random);
+		for (uint32_t node = 0; node < kNodeCount; node++) {
+			SetLocal(system, node, RandomLocal(random));
+		}
+		std::vector<WorldTransform> transforms(kNodeCount);
+
+		system.Update(updateJobSystem);
+		TEST_CHECK(system.GetRecomputedCount() == kNodeCount);
+		CheckMatchesWorldTransform(system, hierarchy, transforms);
+
+		// 一部を動かし、付け替えても一致し続ける
+		for (uint32_t frame = 0; frame < 4; frame++) {
+			for (uint32_t i = 0; i < kNodeCount / 10; i++) {
+				SetLocal(system, random.Next() % kNodeCount, RandomLocal(random));
+			}
+			uint32_t node = hierarchy.order[kNodeCount - 1 - frame];
+			system.SetParent(node, TransformSystem::kInvalidNode);
+			hierarchy.parents[node] = TransformSystem::kInvalidNode;
+
+			system.Update(updateJobSystem);
+			CheckMatchesWorldTransform(system, hierarchy, transforms);
+		}
+	}
+
+	jobSystem->Finalize();
+}
+
+// 動いたノードとその子孫の数（orderは親が子より前）
+uint32_t CountMovedSubtrees(const Hierarchy& hierarchy, const std::vector<uint8_t>& moved) {
+	std::vector<uint8_t> affected(moved);
+	uint32_t count = 0;
+	for (uint32_t node : hierarchy.order) {
+		uint32_t parent = hierarchy.parents[node];
+		if (parent != TransformSystem::kInvalidNode && affected[parent]) {
+			affected[node] = 1;
+		}
+		count += affected[node];
+	}
+	return count;
+}
+
+TEST_CASE(TransformSystemRecomputesMovedSubtrees) {
+	// 1%のノードが動くシーン
+	const uint32_t kNodeCount = 20000;
+	const uint32_t kMovedCount = kNodeCount / 100;
+	const uint32_t kFrameCount = 8;
+
+	Random random;
+	TransformSystem system;
+	system.Initialize(kNodeCount, false);
+	Hierarchy hierarchy = CreateForestHierarchy(system, kNodeCount / 100, 100, random);
+	std::vector<WorldTransform> transforms(kNodeCount);
+	for (uint32_t node = 0; node < kNodeCount; node++) {
+		LocalTransform local = RandomLocal(random);
+		SetLocal(system, node, local);
+		WorldTransform& transform = transforms[node];
+		transform.scale_ = local.scale;
+		transform.rotation_ = local.rotation;
+		transform.translation_ = local.translation;
+		uint32_t parent = hierarchy.parents[node];
+		transform.parent_ = parent != TransformSystem::kInvalidNode ? &transforms[parent] : nullptr;
+	}
+
+	// 最初は全て計算する
+	system.Update();
+	TEST_CHECK(system.GetRecomputedCount() == kNodeCount);
+	WorldTransform::ResetRecomputedCount();
+	for (uint32_t node : hierarchy.order) {
+		transforms[node].UpdateMatrix();
+	}
+	TEST_CHECK(WorldTransform::GetRecomputedCount() == kNodeCount);
+
+	for (uint32_t frame = 0; frame < kFrameCount; frame++) {
+		// 何も動かないフレームは再計算しない
+		system.Update();
+		TEST_CHECK(system.GetRecomputedCount() == 0);
+		WorldTransform::ResetRecomputedCount();
+		for (uint32_t node : hierarchy.order) {
+			transforms[node].UpdateMatrix();
+		}
+		TEST_CHECK(WorldTransform::GetRecomputedCount() == 0);
+
+		// 1%を動かすと、そのノードと子孫だけを再計算する
+		std::vector<uint8_t> moved(kNodeCount, 0);
+		for (uint32_t i = 0; i < kMovedCount; i++) {
+			uint32_t node = random.Next() % kNodeCount;
+			moved[node] = 1;
+			XMFLOAT3 translation = system.GetTranslation(node);
+			translation.x += 0.5f;
+			system.SetTranslation(node, translation);
+			transforms[node].translation_ = translation;
+		}
+		uint32_t expectedCount = CountMovedSubtrees(hierarchy, moved);
+		TEST_CHECK(expectedCount < kNodeCount / 2);
+
+		system.Update();
+		TEST_CHECK(system.GetRecomputedCount() == expectedCount);
+		WorldTransform::ResetRecomputedCount();
+		for (uint32_t node : hierarchy.order) {
+			transforms[node].UpdateMatrix();
+		}
+		TEST_CHECK(WorldTransform::GetRecomputedCount() == expectedCount);
+
+		// 再計算しなかったノードも含めて結果は一致する
+		for (uint32_t node : hierarchy.order) {
+			TEST_CHECK(NearlyEqual(system.GetWorldMatrix(node), transforms[node].matWorld_));
+		}
+	}
+}
+
+TEST_CASE(TransformSystemRotatingRings) {
+	// 親の回転で子がまとめて回る輪（64個の親に24個ずつの子）
+	const uint32_t kRingCount = 64;
+	const uint32_t kRingChildCount = 24;
+	const uint32_t kFrameCount = 16;
+	const float kRotationSpeed = 0.02f;
+	JobSystem::GetInstance()->Initialize(kWorkerCount);
+
+	for (JobSystem* updateJobSystem :
+	     {static_cast<JobSystem*>(nullptr), JobSystem::GetInstance()}) {
+		TransformSystem system;
+		system.Initialize(kRingCount * (kRingChildCount + 1), false);
+		std::vector<uint32_t> ringNodes;
+		std::vector<uint32_t> childNodes;
+		for (uint32_t i = 0; i < kRingCount; i++) {
+			uint32_t ring = system.CreateNode();
+			system.SetTranslation(ring, {(i % 8) * 5.0f - 17.5f, (i / 8) * 5.0f - 17.5f, 0.0f});
+			ringNodes.push_back(ring);
+			for (uint32_t j = 0; j < kRingChildCount; j++) {
+				float angle = XM_2PI * j / kRingChildCount;
+				uint32_t child = system.CreateNode(ring);
+				system.SetTranslation(child, {cosf(angle) * 2.0f, sinf(angle) * 2.0f, 0.0f});
+				system.SetScale(child, {0.2f, 0.2f, 0.2f});
+				childNodes.push_back(child);
+			}
+		}
+
+		for (uint32_t frame = 1; frame <= kFrameCount; frame++) {
+			for (uint32_t ring : ringNodes) {
+				XMFLOAT3 rotation = system.GetRotation(ring);
+				rotation.z += kRotationSpeed;
+				system.SetRotation(ring, rotation);
+			}
+			system.Update(updateJobSystem);
+			// 親が全て動くので全ノードを再計算する
+			TEST_CHECK(system.GetRecomputedCount() == kRingCount * (kRingChildCount + 1));
+
+			// 子は親の位置を中心に、親の回転の分だけ円周上を進む
+			float rotation = kRotationSpeed * frame;
+			for (uint32_t i = 0; i < kRingCount; i++) {
+				XMFLOAT3 center = system.GetTranslation(ringNodes[i]);
+				for (uint32_t j = 0; j < kRingChildCount; j++) {
+					float angle = XM_2PI * j / kRingChildCount + rotation;
+					uint32_t child = childNodes[i * kRingChildCount + j];
+					XMFLOAT4X4 world;
+					XMStoreFloat4x4(&world, system.GetWorldMatrix(child));
+					TEST_CHECK(std::fabs(world._41 - (center.x + cosf(angle) * 2.0f)) < 1e-4f);
+					TEST_CHECK(std::fabs(world._42 - (center.y + sinf(angle) * 2.0f)) < 1e-4f);
+					TEST_CHECK(std::fabs(world._43) < 1e-4f);
+					// 子の拡大率はそのまま
+					float scaleSq = world._11 * world._11 + world._12 * world._12;
+					TEST_CHECK(std::fabs(scaleSq - 0.04f) < 1e-5f);
+				}
+			}
+		}
+	}
+
+	JobSystem::GetInstance()->Finalize();
+}
+
+// 全ノードを毎フレーム動かした時の更新時間（逐次、並列、WorldTransform::UpdateMatrix）
+void BenchmarkUpdate(
+  const char* name, TransformSystem& system, const Hierarchy& hierarchy, Random& random) {
+	const uint32_t kFrameCount = 20;
+	const uint32_t nodeCount = static_cast<uint32_t>(hierarchy.order.size());
+
+	std::vector<LocalTransform> locals(nodeCount);
+	for (LocalTransform& local : locals) {
+		local = RandomLocal(random);
+	}
+
+	for (JobSystem* updateJobSystem :
+	     {static_cast<JobSystem*>(nullptr), JobSystem::GetInstance()}) {
+		double totalMilliseconds = 0.0;
+		for (uint32_t frame = 0; frame < kFrameCount; frame++) {
+			for (uint32_t node = 0; node < nodeCount; node++) {
+				LocalTransform& local = locals[node];
+				local.rotation.y += 0.01f;
+				SetLocal(system, node, local);
+			}
+			auto start = std::chrono::steady_clock::now();
+			system.Update(updateJobSystem);
+			std::chrono::duration<double, std::milli> elapsed =
+			  std::chrono::steady_clock::now() - start;
+			totalMilliseconds += elapsed.count();
+			TEST_CHECK(system.GetRecomputedCount() == nodeCount);
+		}
+		std::printf(
+		  "  %u nodes (%s), TransformSystem %s: %.2f ms/update\n", nodeCount, name,
+		  updateJobSystem ? "parallel" : "serial", totalMilliseconds / kFrameCount);
+	}
+
+	// 比較用: 同じ階層をWorldTransform::UpdateMatrixで親から順に更新
+	std::vector<WorldTransform> transforms(nodeCount);
+	for (uint32_t node = 0; node < nodeCount; node++) {
+		uint32_t parent = hierarchy.parents[node];
+		transforms[node].parent_ =
+		  parent != TransformSystem::kInvalidNode ? &transforms[parent] : nullptr;
+	}
+	double totalMilliseconds = 0.0;
+	for (uint32_t frame = 0; frame < kFrameCount; frame++) {
+		for (uint32_t node = 0; node < nodeCount; node++) {
+			transforms[node].rotation_.y += 0.01f;
+		}
+		auto start = std::chrono::steady_clock::now();
+		for (uint32_t node : hierarchy.order) {
+			transforms[node].UpdateMatrix();
+		}
+		std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+		totalMilliseconds += elapsed.count();
+	}
+	std::printf(
+	  "  %u nodes (%s), WorldTransform::UpdateMatrix: %.2f ms/update\n", nodeCount, name,
+	  totalMilliseconds / kFrameCount);
+}
+
+TEST_CASE(TransformSystemUpdate100kBenchmark) {
+	const uint32_t kNodeCount = 100000;
+	JobSystem::GetInstance()->Initialize(kWorkerCount);
+
+	// ランダムな階層（ほとんどが1つの大きな木になるので並列にできる単位は少ない）
+	{
+		Random random;
+		TransformSystem system;
+		system.Initialize(kNodeCount, false);
+		Hierarchy hierarchy = CreateRandomHierarchy(system, kNodeCount, random);
+		BenchmarkUpdate("random tree", system, hierarchy, random);
+	}
+	// 100ノードの木を1000個
+	{
+		Random random;
+		TransformSystem system;
+		system.Initialize(kNodeCount, false);
+		Hierarchy hierarchy = CreateForestHierarchy(system, kNodeCount / 100, 100, random);
+		BenchmarkUpdate("1000 trees", system, hierarchy, random);
+	}
+
+	JobSystem::GetInstance()->Finalize();
+}
+
+} // namespace